@@ -0,0 +1,778 @@
+#include "BatchCompiler.h"
+
+#include <new>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#include "Compiler.h"
+#include "CompilationCache.h"
+#include "TextEncoder.h"
+#include "Logger.h"
+
+#include "FatalErrorCode.h"
+#include "ErrorLogger.h"
+
+namespace lyrics
+{
+	using std::unique_lock;
+
+	constexpr char BatchCompiler::RESPONSE_FILE_PREFIX;
+	constexpr char BatchCompiler::SOURCE_CODE_EXTENSION[];
+	constexpr char BatchCompiler::MODULE_EXTENSION[];
+
+	bool BatchCompiler::IsBatch(const Option &option)
+	{
+		const vector<string> &names = option.SourceCodeFileNames();
+
+		return names.size() > 1 || (names.size() == 1 && (names.front()[0] == BatchCompiler::RESPONSE_FILE_PREFIX || IsDirectory(names.front())));
+	}
+
+	bool BatchCompiler::Compile(const Option &option)
+	{
+		using std::bad_alloc;
+
+		mOption = &option;
+
+		try
+		{
+			for (auto &i : option.SourceCodeFileNames())
+			{
+				Expand(i);
+			}
+
+			if (mUnits.empty())
+			{
+				throw FatalErrorCode::NO_INPUT_FILE;
+			}
+
+			RunWorkers(&BatchCompiler::ParseWork);
+
+			for (size_t i = 0; i < mUnits.size(); i++)
+			{
+				if (mUnits[i]->isGiven)
+				{
+					mOrder.push_back(i);
+				}
+			}
+
+			vector<pair<string, size_t>> found;
+
+			for (size_t i = 0; i < mUnits.size(); i++)
+			{
+				if (!mUnits[i]->isGiven)
+				{
+					found.emplace_back(mUnits[i]->fileName, i);
+				}
+			}
+
+			std::sort(found.begin(), found.end());	// The workers find them in any order.
+
+			for (auto &i : found)
+			{
+				mOrder.push_back(i.second);
+			}
+
+			Link();
+
+			vector<size_t> stack;
+			vector<Color> colors(mUnits.size(), Color::WHITE);
+
+			for (auto i : mOrder)
+			{
+				if (colors[i] == Color::WHITE)
+				{
+					FindCycles(i, stack, colors);
+				}
+			}
+
+			FindCollisions();
+
+			for (size_t i = 0; i < mUnits.size(); i++)
+			{
+				if (mUnits[i]->isFailed && !mUnits[i]->isFinished)
+				{
+					Finish(i);
+				}
+			}
+
+			for (auto i : mOrder)
+			{
+				if (!mUnits[i]->isFinished && mUnits[i]->pendingCount == 0)
+				{
+					mQueue.push_back(i);
+				}
+			}
+
+			RunWorkers(&BatchCompiler::CompileWork);
+		}
+		catch (const bad_alloc &e)
+		{
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+
+		bool isSucceeded = true;
+
+		for (auto i : mOrder)
+		{
+			Logger::Write(mUnits[i]->output.str(), mUnits[i]->errorOutput.str());
+
+			isSucceeded = isSucceeded && !mUnits[i]->isFailed;
+		}
+
+		return isSucceeded;
+	}
+
+	// Parses the units queued, and queues the ones they import that are not known yet. Done once the queue is empty and no worker may add to it.
+	void BatchCompiler::ParseWork()
+	{
+		Logger::Configure(mOption->IsJsonLog() ? Logger::Format::JSON_LINES : Logger::Format::TEXT, mOption->ErrorLimit());
+
+		unique_lock<mutex> lock(mMutex);
+
+		for (;;)
+		{
+			while (mQueue.empty() && mBusyCount != 0)
+			{
+				mCondition.wait(lock);
+			}
+
+			if (mQueue.empty())
+			{
+				break;
+			}
+
+			Unit &unit = *mUnits[mQueue.front()];
+			vector<pair<string, Location>> imports;
+
+			mQueue.pop_front();
+			mBusyCount++;
+			lock.unlock();
+
+			Parse(unit, imports);
+
+			lock.lock();
+
+			for (auto &i : imports)
+			{
+				unit.edges.emplace_back(Add(i.first, false), i.second);
+			}
+
+			mBusyCount--;
+			mCondition.notify_all();
+		}
+	}
+
+	// A server keeps the outline of each script it parsed, so that one not changed is parsed again only if its module has to be compiled again.
+	void BatchCompiler::Parse(Unit &unit, vector<pair<string, Location>> &imports)
+	{
+		Logger::Redirect(&unit.output, &unit.errorOutput);
+
+		try
+		{
+			const CompilationCache cache(mOption->CacheDirectoryName());
+			CompilationCache::Outline outline;
+
+			if (CompilationCache::IsResident() && cache.Fetch(unit.key = cache.Key(unit.fileName), outline))
+			{
+				unit.dependencies = std::move(outline.dependencies);
+				unit.output << outline.output;
+				unit.errorOutput << outline.errorOutput;
+			}
+			else
+			{
+				unit.root = Compiler().Parse(mOption->ForSource(unit.fileName, ModuleFileName(unit.fileName)), unit.key, false);
+
+				DependencyScanner().Scan(unit.root, unit.dependencies);
+
+				if (CompilationCache::IsResident())
+				{
+					Logger::Flush();
+
+					outline.dependencies = DependencyScanner::Dependencies(unit.dependencies);
+					outline.output = unit.output.str();
+					outline.errorOutput = unit.errorOutput.str();
+
+					cache.Store(unit.key, outline);
+				}
+			}
+
+			unit.fingerprint = CompilationCache::Fingerprint(unit.dependencies.interface);
+
+			for (auto &i : unit.dependencies.imports)
+			{
+				const string fileName = Resolve(i, unit.fileName);
+
+				if (fileName.empty())
+				{
+					ErrorLogger::Warning(i.location, WarningCode::UNRESOLVED_IMPORT);
+				}
+				else
+				{
+					imports.emplace_back(fileName, i.location);
+				}
+			}
+		}
+		catch (const FatalErrorCode fatalErrorCode)
+		{
+			ErrorLogger::FatalError(fatalErrorCode);
+			unit.isFailed = true;
+		}
+		catch (const std::bad_alloc &e)
+		{
+			ErrorLogger::FatalError(FatalErrorCode::NOT_ENOUGH_MEMORY);
+			unit.isFailed = true;
+		}
+
+		Logger::Redirect(nullptr, nullptr);
+	}
+
+	// Adds the packages each class includes from another script, counts what each unit waits for and keys it on the interfaces of its dependencies.
+	void BatchCompiler::Link()
+	{
+		unordered_map<u32string, size_t> packages;
+
+		for (auto i : mOrder)
+		{
+			for (auto &j : mUnits[i]->dependencies.packages)
+			{
+				packages.emplace(j, i);
+			}
+		}
+
+		for (auto i : mOrder)
+		{
+			Unit &unit = *mUnits[i];
+
+			for (auto &j : unit.dependencies.includes)
+			{
+				auto package = packages.find(j.names.front());
+
+				if (package != packages.end() && package->second != i)
+				{
+					unit.edges.emplace_back(package->second, j.location);
+				}
+			}
+
+			vector<Edge> edges;
+
+			for (auto &j : unit.edges)
+			{
+				bool isFound = false;
+
+				for (auto &k : edges)
+				{
+					isFound = isFound || k.unit == j.unit;
+				}
+
+				if (!isFound)
+				{
+					edges.push_back(j);
+				}
+			}
+
+			unit.edges.swap(edges);
+			unit.pendingCount = unit.edges.size();
+
+			vector<string> fingerprints;
+
+			for (auto &j : unit.edges)
+			{
+				mUnits[j.unit]->dependents.push_back(i);
+				fingerprints.push_back(mUnits[j.unit]->fingerprint);
+			}
+
+			if (!unit.key.empty())
+			{
+				unit.key = CompilationCache(mOption->CacheDirectoryName()).Key(unit.key, fingerprints);
+			}
+		}
+	}
+
+	// Fails every unit on a cycle found by the depth first search, reporting the dependency of each that closes it.
+	void BatchCompiler::FindCycles(const size_t index, vector<size_t> &stack, vector<Color> &colors)
+	{
+		colors[index] = Color::GRAY;
+		stack.push_back(index);
+
+		for (auto &i : mUnits[index]->edges)
+		{
+			if (colors[i.unit] == Color::WHITE)
+			{
+				FindCycles(i.unit, stack, colors);
+			}
+			else if (colors[i.unit] == Color::GRAY)
+			{
+				for (size_t j = std::find(stack.begin(), stack.end(), i.unit) - stack.begin(); j < stack.size(); j++)
+				{
+					Unit &unit = *mUnits[stack[j]];
+					const size_t next = j + 1 < stack.size() ? stack[j + 1] : i.unit;
+
+					if (unit.isFailed)
+					{
+						continue;
+					}
+
+					for (auto &k : unit.edges)
+					{
+						if (k.unit == next)
+						{
+							Report(unit, k.location, ErrorCode::CYCLIC_DEPENDENCY);
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		stack.pop_back();
+		colors[index] = Color::BLACK;
+	}
+
+	// Fails every unit whose module would overwrite that of one before it, as sources of the same name in different directories share a module file name.
+	void BatchCompiler::FindCollisions()
+	{
+		unordered_map<string, size_t> owners;
+
+		for (auto i : mOrder)
+		{
+			const string moduleFileName = ModuleFileName(mUnits[i]->fileName);
+
+			if (!moduleFileName.empty() && !owners.emplace(moduleFileName, i).second)
+			{
+				Report(*mUnits[i], Location(mUnits[i]->fileName), ErrorCode::DUPLICATED_MODULE);
+			}
+		}
+	}
+
+	// Compiles the units ready, each of which may make its dependents ready. Done once every unit is finished.
+	void BatchCompiler::CompileWork()
+	{
+		Logger::Configure(mOption->IsJsonLog() ? Logger::Format::JSON_LINES : Logger::Format::TEXT, mOption->ErrorLimit());
+
+		unique_lock<mutex> lock(mMutex);
+
+		for (;;)
+		{
+			while (mQueue.empty() && mFinishedCount != mUnits.size())
+			{
+				mCondition.wait(lock);
+			}
+
+			if (mQueue.empty())
+			{
+				break;
+			}
+
+			const size_t index = mQueue.front();
+			Unit &unit = *mUnits[index];
+
+			mQueue.pop_front();
+			lock.unlock();
+
+			Logger::Redirect(&unit.output, &unit.errorOutput);
+
+			try
+			{
+				const Option option = mOption->ForSource(unit.fileName, ModuleFileName(unit.fileName));
+				BlockNode *root = unit.root;
+
+				unit.root = nullptr;
+				unit.dependencies = DependencyScanner::Dependencies();
+
+				// One not parsed, for its outline was kept, is parsed now unless its module was kept too.
+				if (root || !CompilationCache(mOption->CacheDirectoryName()).Fetch(unit.key, option.ModuleFileName()))
+				{
+					if (!root)
+					{
+						root = Reparse(unit, option);
+					}
+
+					Compiler().Generate(option, root, unit.key);
+				}
+				Logger::CompilationTerminated();
+			}
+			catch (const FatalErrorCode fatalErrorCode)
+			{
+				ErrorLogger::FatalError(fatalErrorCode);
+				unit.isFailed = true;
+			}
+			catch (const ErrorCode errorCode)
+			{
+				unit.isFailed = true;
+			}
+			catch (const std::bad_alloc &e)
+			{
+				ErrorLogger::FatalError(FatalErrorCode::NOT_ENOUGH_MEMORY);
+				unit.isFailed = true;
+			}
+
+			Logger::Redirect(nullptr, nullptr);
+
+			lock.lock();
+			Finish(index);
+			mCondition.notify_all();
+		}
+	}
+
+	// A unit that failed fails its dependents without compiling them.
+	void BatchCompiler::Finish(const size_t index)
+	{
+		Unit &unit = *mUnits[index];
+
+		unit.isFinished = true;
+		mFinishedCount++;
+
+		for (auto i : unit.dependents)
+		{
+			Unit &dependent = *mUnits[i];
+
+			if (dependent.isFinished)
+			{
+				continue;
+			}
+
+			if (unit.isFailed)
+			{
+				// One that failed itself has already said why.
+				for (size_t j = 0; !dependent.isFailed && j < dependent.edges.size(); j++)
+				{
+					if (dependent.edges[j].unit == index)
+					{
+						Report(dependent, dependent.edges[j].location, ErrorCode::FAILED_DEPENDENCY);
+					}
+				}
+
+				Finish(i);
+			}
+			else if (--dependent.pendingCount == 0)
+			{
+				mQueue.push_back(i);
+			}
+		}
+	}
+
+	// The logs of parsing it are in the outline already.
+	BlockNode *BatchCompiler::Reparse(Unit &unit, const Option &option)
+	{
+		ostringstream logs;
+		string key;
+		BlockNode *root;
+
+		Logger::Redirect(&logs, &logs);
+
+		try
+		{
+			root = Compiler().Parse(option, key, false);
+		}
+		catch (const FatalErrorCode fatalErrorCode)
+		{
+			Logger::Redirect(&unit.output, &unit.errorOutput);
+			throw fatalErrorCode;
+		}
+		catch (const std::bad_alloc &e)
+		{
+			Logger::Redirect(&unit.output, &unit.errorOutput);
+			throw;
+		}
+
+		Logger::Redirect(&unit.output, &unit.errorOutput);
+
+		return root;
+	}
+
+	void BatchCompiler::Report(Unit &unit, const Location &location, const ErrorCode errorCode)
+	{
+		Logger::Redirect(&unit.output, &unit.errorOutput);
+		ErrorLogger::Error(location, errorCode);
+		Logger::Redirect(nullptr, nullptr);
+
+		unit.isFailed = true;
+	}
+
+	void BatchCompiler::RunWorkers(void (BatchCompiler::*work)())
+	{
+		using std::thread;
+
+		size_t count = mOption->ThreadCount() != 0 ? mOption->ThreadCount() : thread::hardware_concurrency();
+
+		count = std::max<size_t>(1, std::min(count, mUnits.size()));
+
+		vector<thread> workers;
+
+		try
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				workers.emplace_back(work, this);
+			}
+		}
+		catch (...)
+		{
+			for (auto &i : workers)
+			{
+				i.join();
+			}
+
+			throw;
+		}
+
+		for (auto &i : workers)
+		{
+			i.join();
+		}
+	}
+
+	// The index of the unit of the file, queued to be parsed if it is new.
+	size_t BatchCompiler::Add(const string &fileName, const bool isGiven)
+	{
+		const string name = Normalize(fileName);
+		auto index = mIndices.find(name);
+
+		if (index != mIndices.end())
+		{
+			return index->second;
+		}
+
+		mUnits.push_back(nullptr);
+		mUnits.back() = new Unit(name, isGiven);
+		mIndices.emplace(name, mUnits.size() - 1);
+		mQueue.push_back(mUnits.size() - 1);
+
+		return mUnits.size() - 1;
+	}
+
+	void BatchCompiler::Expand(const string &name)
+	{
+		if (!name.empty() && name[0] == BatchCompiler::RESPONSE_FILE_PREFIX)
+		{
+			ReadResponseFile(name.substr(1));
+		}
+		else if (IsDirectory(name))
+		{
+			ReadDirectory(name);
+		}
+		else
+		{
+			Add(name, true);
+		}
+	}
+
+	// A name per line, any of which may be a directory or a response file itself.
+	void BatchCompiler::ReadResponseFile(const string &name)
+	{
+		using std::ifstream;
+		using std::getline;
+
+		ifstream input(name);
+
+		if (!input.is_open())
+		{
+			throw FatalErrorCode::CANNOT_OPEN_FILE;
+		}
+
+		string line;
+
+		while (getline(input, line))
+		{
+			while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+			{
+				line.pop_back();
+			}
+
+			if (!line.empty())
+			{
+				Expand(line);
+			}
+		}
+
+		if (input.bad())
+		{
+			throw FatalErrorCode::CANNOT_READ_FILE;
+		}
+	}
+
+	// The source files of the directory and of the ones under it, sorted so that a batch is logged the same each time.
+	void BatchCompiler::ReadDirectory(const string &name)
+	{
+		const size_t extensionLength = sizeof(BatchCompiler::SOURCE_CODE_EXTENSION) - 1;
+		const string prefix = name.back() == '/' || name.back() == '\\' ? name : name + '/';
+		vector<string> entries;
+
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		const HANDLE find = FindFirstFileA((prefix + '*').c_str(), &data);
+
+		if (find == INVALID_HANDLE_VALUE)
+		{
+			throw FatalErrorCode::CANNOT_OPEN_FILE;
+		}
+
+		do
+		{
+			entries.push_back(data.cFileName);
+		} while (FindNextFileA(find, &data));
+
+		FindClose(find);
+#else
+		DIR * const directory = opendir(name.c_str());
+
+		if (!directory)
+		{
+			throw FatalErrorCode::CANNOT_OPEN_FILE;
+		}
+
+		for (const dirent *entry = readdir(directory); entry; entry = readdir(directory))
+		{
+			entries.push_back(entry->d_name);
+		}
+
+		closedir(directory);
+#endif
+		std::sort(entries.begin(), entries.end());
+
+		for (auto &i : entries)
+		{
+			if (i == "." || i == "..")
+			{
+				continue;
+			}
+
+			const string path = prefix + i;
+
+			if (IsDirectory(path))
+			{
+				ReadDirectory(path);
+			}
+			else if (i.size() > extensionLength && i.compare(i.size() - extensionLength, extensionLength, BatchCompiler::SOURCE_CODE_EXTENSION) == 0)
+			{
+				Add(path, true);
+			}
+		}
+	}
+
+	// import a.b names a/b.lyc, looked for from the directory of the script importing it, each directory given by the option, and then the working directory. Empty if it is nowhere.
+	string BatchCompiler::Resolve(const DependencyScanner::Reference &reference, const string &fileName) const
+	{
+		string path;
+
+		for (auto &i : reference.names)
+		{
+			path += (path.empty() ? "" : "/") + TextEncoder().EncodeUTF_8(i);
+		}
+
+		path += BatchCompiler::SOURCE_CODE_EXTENSION;
+
+		const size_t slash = fileName.find_last_of("/\\");
+		const string candidate = slash != string::npos ? fileName.substr(0, slash + 1) + path : path;
+
+		if (IsFile(candidate))
+		{
+			return candidate;
+		}
+
+		for (auto &i : mOption->ImportDirectoryNames())
+		{
+			const string candidate = i.empty() || i.back() == '/' || i.back() == '\\' ? i + path : i + '/' + path;
+
+			if (IsFile(candidate))
+			{
+				return candidate;
+			}
+		}
+
+		return IsFile(path) ? path : string();
+	}
+
+	// In the directory given by the option, named after the source file less its extension. None if no directory is given.
+	string BatchCompiler::ModuleFileName(const string &sourceCodeFileName) const
+	{
+		const string &directoryName = mOption->ModuleFileName();
+
+		if (directoryName.empty())
+		{
+			return string();
+		}
+
+		const size_t slash = sourceCodeFileName.find_last_of("/\\");
+		string stem = slash != string::npos ? sourceCodeFileName.substr(slash + 1) : sourceCodeFileName;
+		const size_t dot = stem.find_last_of('.');
+
+		if (dot != string::npos && dot != 0)
+		{
+			stem.erase(dot);
+		}
+
+		const string prefix = directoryName.back() == '/' || directoryName.back() == '\\' ? directoryName : directoryName + '/';
+
+		return prefix + stem + BatchCompiler::MODULE_EXTENSION;
+	}
+
+	bool BatchCompiler::IsDirectory(const string &name)
+	{
+#ifdef _WIN32
+		const DWORD attributes = GetFileAttributesA(name.c_str());
+
+		return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+		struct stat status;
+
+		return stat(name.c_str(), &status) == 0 && S_ISDIR(status.st_mode);
+#endif
+	}
+
+	// Drops the . and the .. that can be dropped from the name, so that a file found through different names is a single unit.
+	string BatchCompiler::Normalize(const string &name)
+	{
+		vector<string> parts;
+		size_t start = 0;
+
+		for (size_t i = 0; i <= name.size(); i++)
+		{
+			if (i == name.size() || name[i] == '/' || name[i] == '\\')
+			{
+				const string part = name.substr(start, i - start);
+
+				if (part == ".." && !parts.empty() && !parts.back().empty() && parts.back() != "..")
+				{
+					parts.pop_back();
+				}
+				else if (part != "." && (!part.empty() || parts.empty()))
+				{
+					parts.push_back(part);
+				}
+
+				start = i + 1;
+			}
+		}
+
+		string normalized;
+
+		for (size_t i = 0; i < parts.size(); i++)
+		{
+			normalized += (i == 0 ? "" : "/") + parts[i];
+		}
+
+		return normalized.empty() ? string(".") : normalized;
+	}
+
+	bool BatchCompiler::IsFile(const string &name)
+	{
+#ifdef _WIN32
+		const DWORD attributes = GetFileAttributesA(name.c_str());
+
+		return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+#else
+		struct stat status;
+
+		return stat(name.c_str(), &status) == 0 && S_ISREG(status.st_mode);
+#endif
+	}
+}
\ No newline at end of file
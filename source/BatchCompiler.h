@@ -0,0 +1,139 @@
+#ifndef BATCH_COMPILER
+#define BATCH_COMPILER
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <mutex>
+#include <sstream>
+#include <condition_variable>
+#include <unordered_map>
+
+#include "Option.h"
+#include "Node.h"
+#include "Location.h"
+#include "ErrorCode.h"
+#include "DependencyScanner.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::string;
+	using std::vector;
+	using std::deque;
+	using std::pair;
+	using std::mutex;
+	using std::ostringstream;
+	using std::condition_variable;
+	using std::unordered_map;
+
+	// Compiles many scripts on a pool of threads, together with every script they import.
+	// Each script is parsed once, by the first worker to find it, and compiled only after the scripts it imports and the ones defining the packages its classes include.
+	// With a cache, a script is compiled again only if it or the interface of a script it depends on changed, so a change to the body of a function does not reach its dependents.
+	// The logs of each script are kept apart and written once all are done, those of the scripts given first, in order, and then those of the ones found by name.
+	class BatchCompiler
+	{
+	public:
+		BatchCompiler() : mOption(nullptr), mBusyCount(0), mFinishedCount(0)
+		{
+		}
+
+		~BatchCompiler()
+		{
+			for (auto i : mUnits)
+			{
+				Utility::SafeDelete(i);
+			}
+		}
+
+		BatchCompiler(const BatchCompiler &) = delete;
+		BatchCompiler &operator=(const BatchCompiler &) = delete;
+
+		static bool IsBatch(const Option &option);
+
+		bool Compile(const Option &option);	// False if any script failed.
+
+	private:
+		enum struct Color : unsigned char { WHITE, GRAY, BLACK };
+
+		// A dependency, and where the script asks for it.
+		struct Edge
+		{
+			Edge(const size_t unit, const Location &location) : unit(unit), location(location)
+			{
+			}
+
+			size_t unit;
+			Location location;
+		};
+
+		// A script from the time it is found until it is compiled.
+		struct Unit
+		{
+			Unit(const string &fileName, const bool isGiven) : fileName(fileName), root(nullptr), isGiven(isGiven), isFailed(false), isFinished(false), pendingCount(0)
+			{
+			}
+
+			~Unit()
+			{
+				Utility::SafeDelete(root);
+			}
+
+			const string fileName;
+			BlockNode *root;	// nullptr if a server kept its outline.
+			string key;	// In the cache, of the source until linked and then of the interfaces it depends on too.
+			string fingerprint;	// Of its interface.
+			DependencyScanner::Dependencies dependencies;	// Until it is compiled.
+			vector<Edge> edges;
+			vector<size_t> dependents;
+			const bool isGiven;
+			bool isFailed;
+			bool isFinished;
+			size_t pendingCount;	// Of the dependencies not finished yet.
+			ostringstream output;
+			ostringstream errorOutput;
+		};
+
+		void ParseWork();
+		void Parse(Unit &unit, vector<pair<string, Location>> &imports);
+		void Link();
+		void FindCycles(const size_t index, vector<size_t> &stack, vector<Color> &colors);
+		void FindCollisions();
+		void CompileWork();
+		BlockNode *Reparse(Unit &unit, const Option &option);
+		void Finish(const size_t index);
+		void Report(Unit &unit, const Location &location, const ErrorCode errorCode);
+		void RunWorkers(void (BatchCompiler::*work)());
+
+		size_t Add(const string &fileName, const bool isGiven);
+		void Expand(const string &name);
+		void ReadResponseFile(const string &name);
+		void ReadDirectory(const string &name);
+		string Resolve(const DependencyScanner::Reference &reference, const string &fileName) const;
+		string ModuleFileName(const string &sourceCodeFileName) const;
+
+		static string Normalize(const string &name);
+		static bool IsDirectory(const string &name);
+		static bool IsFile(const string &name);
+
+		static constexpr char RESPONSE_FILE_PREFIX = '@';
+		static constexpr char SOURCE_CODE_EXTENSION[] = ".lyc";
+		static constexpr char MODULE_EXTENSION[] = ".lym";
+
+		const Option *mOption;
+		vector<Unit *> mUnits;
+		unordered_map<string, size_t> mIndices;	// Of the units, by the normalized name of the file.
+		vector<size_t> mOrder;	// Of the logs.
+		mutex mMutex;	// Over the units found, the queues and the counts, but not the units being parsed or compiled.
+		condition_variable mCondition;
+		deque<size_t> mQueue;	// Of the units to be parsed, then of the ones ready to be compiled.
+		size_t mBusyCount;	// Of the workers parsing.
+		size_t mFinishedCount;
+	};
+}
+
+#endif
\ No newline at end of file
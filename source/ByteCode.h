@@ -15,15 +15,20 @@ namespace lyrics
 			SUBTRACT,
 			MULTIPLY,
 			DIVIDE,
+			REMAINDER,
+			NEGATE,
 			ADD_IMMEDIATE,
 			FLOATING_POINT_ADD,
 			FLOATING_POINT_SUBTRACT,
 			FLOATING_POINT_MULTIPLY,
 			FLOATING_POINT_DIVIDE,
+			FLOATING_POINT_NEGATE,
+			CONVERT_TO_FLOATING_POINT,
 
 			LOAD_WORD,
 			STORE_WORD,
 			LOAD_WORD_IMMEDIATE,
+			LOAD_CONSTANT,
 			MOVE,
 
 			NOT,
@@ -36,6 +41,7 @@ namespace lyrics
 			OR_IMMEDIATE,
 			SHIFT_LEFT,
 			SHIFT_RIGHT,
+			LOGICAL_NOT,
 
 			BRANCH_ON_EQUAL,
 			BRANCH_ON_NOT_EQUAL,
@@ -43,22 +49,88 @@ namespace lyrics
 			BRANCH_IF_GREATER_THAN,
 			BRANCH_IF_LESS_THAN_OR_EQUAL,
 			BRANCH_IF_GREATER_THAN_OR_EQUAL,
+			BRANCH_IF_TRUE,
+			BRANCH_IF_FALSE,
+			BRANCH_IF_NOT_OUTPUT,	// Branches unless the parameter given of the callee in the frame slot given is an output parameter. Only reached with V1 set, while the slot still holds the function called.
 			SET_ON_LESS_THAN,
 			SET_ON_LESS_THAN_IMMEDIATE,
+			SET_ON_LESS_THAN_OR_EQUAL,
+			SET_ON_EQUAL,
+			SET_ON_NOT_EQUAL,
+			FLOATING_POINT_SET_ON_LESS_THAN,
+			FLOATING_POINT_SET_ON_LESS_THAN_OR_EQUAL,
+			FLOATING_POINT_SET_ON_EQUAL,
+			FLOATING_POINT_SET_ON_NOT_EQUAL,
+
+			// Check the operand types at run time, used where they could not be inferred.
+			DYNAMIC_ADD,
+			DYNAMIC_SUBTRACT,
+			DYNAMIC_MULTIPLY,
+			DYNAMIC_DIVIDE,
+			DYNAMIC_REMAINDER,
+			DYNAMIC_NEGATE,
+			DYNAMIC_PLUS,
+			DYNAMIC_NOT,
+			DYNAMIC_AND,
+			DYNAMIC_OR,
+			DYNAMIC_XOR,
+			DYNAMIC_SHIFT_LEFT,
+			DYNAMIC_SHIFT_RIGHT,
+			DYNAMIC_LOGICAL_NOT,
+			DYNAMIC_SET_ON_LESS_THAN,
+			DYNAMIC_SET_ON_LESS_THAN_OR_EQUAL,
+			DYNAMIC_SET_ON_EQUAL,
+			DYNAMIC_SET_ON_NOT_EQUAL,
 
 			JUMP,
 			JUMP_REGISTER,
+			TABLE_SWITCH,	// Jumps through a jump table of the function by an integer, or falls through given any other type.
+			HASH_SWITCH,	// Jumps through a jump table of the function by a string, or falls through given any other type.
 			CALL,
+			TAIL_CALL,	// Moves the callee and the arguments to the bottom of the frame and reuses it, which keeps the output parameters of the function the frame was called for.
+			RETURN,	// Sets V1 if the function the frame was called for has any output parameter, not one it reached by a tail call, and clears it if not.
 
 			NEW,
 			CONSTRUCT_ARRAY,
+			CONSTRUCT_LOCAL_ARRAY,	// Builds the object in the frame slot given instead of on the heap.
 			REFERENCE_ARRAY_ELEMENT,
+			STORE_ARRAY_ELEMENT,
 			CONSTRUCT_HASH,
+			CONSTRUCT_LOCAL_HASH,
 			REFERENCE_HASH_ELEMENT,
+			STORE_HASH_ELEMENT,
+			REFERENCE_ELEMENT,
+			STORE_ELEMENT,
+			REFERENCE_MEMBER,
+			STORE_MEMBER,
+			CALL_MEMBER,
+			TAIL_CALL_MEMBER,
+			CALL_BASE_CLASS_CONSTRUCTOR,
+			CONSTRUCT_FUNCTION,	// Copies the upvalues of the function into the closure.
+			CONSTRUCT_BOX,	// Moves the value of a frame slot into a box, shared with the closures capturing the slot.
+			LOAD_BOX,
+			STORE_BOX,
+			LOAD_UPVALUE,
+			LOAD_BOXED_UPVALUE,
+			STORE_BOXED_UPVALUE,
+			CONSTRUCT_ITERATOR,
+			NEXT_ELEMENT,
 			CONSTRUCT_IMAGE,
 			CONSTRUCT_TEXT,
 			CONSTRUCT_SOUND,
 			CONSTRUCT_VIDEO,
+
+			// Superinstructions, each doing what the instructions fused into it did, except for writing the registers nothing reads after.
+			STORE_WORD_IMMEDIATE,	// LOAD_WORD_IMMEDIATE, STORE_WORD
+			ADD_IMMEDIATE_WORD,	// LOAD_WORD, ADD_IMMEDIATE, STORE_WORD to the same word
+			BRANCH_ON_EQUAL_IMMEDIATE,	// LOAD_WORD_IMMEDIATE, BRANCH_ON_EQUAL
+			BRANCH_ON_NOT_EQUAL_IMMEDIATE,
+			BRANCH_IF_LESS_THAN_IMMEDIATE,
+			BRANCH_IF_GREATER_THAN_IMMEDIATE,
+			BRANCH_IF_LESS_THAN_OR_EQUAL_IMMEDIATE,
+			BRANCH_IF_GREATER_THAN_OR_EQUAL_IMMEDIATE,
+			RETURN_REGISTER,	// MOVE to V0, RETURN
+			RETURN_CONSTANT,	// LOAD_CONSTANT to V0, RETURN
 		};
 
 		explicit ByteCode(Opcode opcode) : opcode(opcode), operand16(0), operand32(0)
@@ -73,7 +145,7 @@ namespace lyrics
 		{
 		}
 
-		ByteCode(Opcode opcode, short operand16, short operand32High, short operand32Low) : opcode(opcode), operand16(operand16), operand32(operand32High << 16 | (operand32Low & 0x0000FFFFu))
+		ByteCode(Opcode opcode, short operand16, short operand32High, short operand32Low) : opcode(opcode), operand16(operand16), operand32(static_cast<int>(static_cast<unsigned int>(static_cast<unsigned short>(operand32High)) << 16 | static_cast<unsigned short>(operand32Low)))
 		{
 		}
 
@@ -0,0 +1,451 @@
+#include "ClosureConverter.h"
+
+namespace lyrics
+{
+	void ClosureConverter::Convert(const BlockNode * const root, Closures &closures)
+	{
+		mClosures = &closures;
+
+		Enter(root, true);
+		ConvertBlock(root);
+		Leave();
+	}
+
+	void ClosureConverter::ConvertBlock(const BlockNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		for (auto i : node->list)
+		{
+			if (i)
+			{
+				ConvertStatement(i);
+			}
+		}
+	}
+
+	// Everything run by a loop may run more than once, so a variable assigned there is never taken as assigned only once.
+	void ClosureConverter::ConvertStatement(const StatementNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::IMPORT:
+		case Node::Type::BREAK:
+		case Node::Type::NEXT:
+			break;
+
+		case Node::Type::IF:
+			{
+				const IfNode * const ifNode = static_cast<const IfNode *>(node);
+
+				for (auto i : ifNode->list)
+				{
+					ConvertExpression(i->condition);
+					ConvertBlock(i->block);
+				}
+
+				ConvertBlock(ifNode->block);
+			}
+			break;
+
+		case Node::Type::CASE:
+			{
+				const CaseNode * const caseNode = static_cast<const CaseNode *>(node);
+
+				ConvertExpression(caseNode->value);
+
+				for (auto i : caseNode->list)
+				{
+					ConvertExpression(i->condition);
+					ConvertBlock(i->block);
+				}
+
+				ConvertBlock(caseNode->block);
+			}
+			break;
+
+		case Node::Type::WHILE:
+			mFrames.front().loopDepth++;
+
+			ConvertExpression(static_cast<const WhileNode *>(node)->condition);
+			ConvertBlock(static_cast<const WhileNode *>(node)->block);
+
+			mFrames.front().loopDepth--;
+			break;
+
+		case Node::Type::FOR:
+			{
+				const ForNode * const forNode = static_cast<const ForNode *>(node);
+
+				ConvertExpression(forNode->initializer);
+
+				mFrames.front().loopDepth++;
+
+				ConvertExpression(forNode->condition);
+				ConvertBlock(forNode->block);
+				ConvertExpression(forNode->iterator);
+
+				mFrames.front().loopDepth--;
+			}
+			break;
+
+		case Node::Type::FOREACH:
+			{
+				const ForEachNode * const forEachNode = static_cast<const ForEachNode *>(node);
+
+				ConvertExpression(forEachNode->collection);
+
+				mFrames.front().loopDepth++;
+
+				if (forEachNode->variable && forEachNode->variable->type == Node::Type::IDENTIFIER)
+				{
+					const u32string &identifier = *static_cast<const IdentifierNode *>(forEachNode->variable)->identifier;
+
+					if (!IsDeclared(identifier))
+					{
+						Declare(identifier, false);
+					}
+
+					Refer(identifier, true);
+				}
+
+				ConvertBlock(forEachNode->block);
+
+				mFrames.front().loopDepth--;
+			}
+			break;
+
+		case Node::Type::RETURN:
+			ConvertExpression(static_cast<const ReturnNode *>(node)->value);
+			break;
+
+		case Node::Type::ERROR:
+			break;
+
+		default:
+			ConvertExpression(static_cast<const ExpressionNode *>(node));
+			break;
+		}
+	}
+
+	void ClosureConverter::ConvertExpression(const ExpressionNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::IDENTIFIER:
+			Refer(*static_cast<const IdentifierNode *>(node)->identifier, false);
+			break;
+
+		case Node::Type::ARRAY_LITERAL:
+			for (auto i : static_cast<const ArrayLiteralNode *>(node)->list)
+			{
+				ConvertExpression(i);
+			}
+			break;
+
+		case Node::Type::HASH_LITERAL:
+			for (auto i : static_cast<const HashLiteralNode *>(node)->list)
+			{
+				ConvertExpression(i->key);
+				ConvertExpression(i->value);
+			}
+			break;
+
+		case Node::Type::FUNCTION_LITERAL:
+			ConvertFunction(static_cast<const FunctionLiteralNode *>(node));
+			break;
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			ConvertExpression(static_cast<const ParenthesizedExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			ConvertExpression(static_cast<const IndexReferenceNode *>(node)->expression);
+			ConvertExpression(static_cast<const IndexReferenceNode *>(node)->index);
+			break;
+
+		case Node::Type::FUNCTION_CALL:
+			ConvertExpression(static_cast<const FunctionCallNode *>(node)->expression);
+			ConvertArguments(static_cast<const FunctionCallNode *>(node)->list);
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			ConvertExpression(static_cast<const MemberReferenceNode *>(node)->expression);
+			break;
+
+		case Node::Type::UNARY_EXPRESSION:
+			ConvertExpression(static_cast<const UnaryExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			ConvertExpression(static_cast<const MultiplicativeExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const MultiplicativeExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			ConvertExpression(static_cast<const AdditiveExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const AdditiveExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::SHIFT_EXPRESSION:
+			ConvertExpression(static_cast<const ShiftExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const ShiftExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::AND_EXPRESSION:
+			ConvertExpression(static_cast<const AndExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const AndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::OR_EXPRESSION:
+			ConvertExpression(static_cast<const OrExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const OrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			ConvertExpression(static_cast<const RelationalExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const RelationalExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			ConvertExpression(static_cast<const EqualityExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const EqualityExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_AND_EXPRESSION:
+			ConvertExpression(static_cast<const LogicalAndExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const LogicalAndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			ConvertExpression(static_cast<const LogicalOrExpressionNode *>(node)->left);
+			ConvertExpression(static_cast<const LogicalOrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ASSIGNMENT_EXPRESSION:
+			ConvertAssignment(static_cast<const AssignmentExpressionNode *>(node));
+			break;
+
+		case Node::Type::CLASS:
+			ConvertClass(static_cast<const ClassNode *>(node));
+			break;
+
+		case Node::Type::PACKAGE:
+			Enter(node, false);
+			ConvertBlock(static_cast<const PackageNode *>(node)->block);
+			Leave();
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// The variable is assigned after the right hand side is evaluated, so a function referring to it from there captures it before it is assigned.
+	void ClosureConverter::ConvertAssignment(const AssignmentExpressionNode * const node)
+	{
+		if (node->lhs->type == Node::Type::IDENTIFIER)
+		{
+			const u32string &identifier = *static_cast<const IdentifierNode *>(node->lhs)->identifier;
+
+			if (!IsDeclared(identifier))
+			{
+				Declare(identifier, false);
+			}
+
+			ConvertExpression(node->rhs);
+			Refer(identifier, true);
+		}
+		else
+		{
+			ConvertExpression(node->lhs);
+			ConvertExpression(node->rhs);
+		}
+	}
+
+	void ClosureConverter::ConvertFunction(const FunctionLiteralNode * const node)
+	{
+		Enter(node, false);
+
+		for (auto i : node->list)
+		{
+			Declare(*i->name->identifier, true);
+
+			if (i->type == Node::Type::VALUE_PARAMETER)
+			{
+				ConvertExpression(static_cast<const ValueParameterNode *>(i)->defalutArgument);
+			}
+		}
+
+		ConvertBlock(node->block);
+
+		Leave();
+	}
+
+	void ClosureConverter::ConvertClass(const ClassNode * const node)
+	{
+		Enter(node, false);
+
+		for (auto i : node->list)
+		{
+			if (i->type == Node::Type::ASSIGNMENT_EXPRESSION)
+			{
+				const AssignmentExpressionNode * const assignment = static_cast<const AssignmentExpressionNode *>(i);
+
+				if (assignment->lhs->type == Node::Type::IDENTIFIER)
+				{
+					Declare(*static_cast<const IdentifierNode *>(assignment->lhs)->identifier, true);
+				}
+
+				ConvertExpression(assignment->rhs);
+			}
+			else if (i->type == Node::Type::IDENTIFIER)
+			{
+				Declare(*static_cast<const IdentifierNode *>(i)->identifier, true);
+			}
+		}
+
+		if (node->baseClassConstructorCall)
+		{
+			Refer(*node->baseClassConstructorCall->baseClass->identifier, false);
+			ConvertArguments(node->baseClassConstructorCall->list);
+		}
+
+		ConvertBlock(node->block);
+
+		Leave();
+	}
+
+	// A variable passed to a function may be written back by an output parameter.
+	void ClosureConverter::ConvertArguments(const forward_list<ExpressionNode *> &arguments)
+	{
+		for (auto i : arguments)
+		{
+			if (i->type == Node::Type::IDENTIFIER)
+			{
+				Refer(*static_cast<const IdentifierNode *>(i)->identifier, true);
+			}
+			else
+			{
+				ConvertExpression(i);
+			}
+		}
+	}
+
+	// A variable of an enclosing function has to be passed down through every function in between, which capture it as well.
+	void ClosureConverter::Refer(const u32string &identifier, const bool isAssigned)
+	{
+		for (auto i = mFrames.begin(); i != mFrames.end(); i++)
+		{
+			auto found = i->variables.find(identifier);
+
+			if (found == i->variables.end())
+			{
+				continue;
+			}
+
+			Variable &variable = found->second;
+			const bool isCaptured = i != mFrames.begin() && !i->isTopLevel;
+
+			if (isAssigned)
+			{
+				variable.assignmentCount++;
+				variable.isShared |= variable.assignmentCount > 1 || i->loopDepth > 0 || isCaptured;
+			}
+
+			if (!isCaptured)
+			{
+				return;
+			}
+
+			if (!variable.isMember)
+			{
+				variable.isShared |= variable.assignmentCount == 0;
+				variable.isCaptured = true;
+			}
+
+			Capture capture;
+
+			capture.owner = i->owner;
+
+			if (!variable.isMember)
+			{
+				capture.name = identifier;
+			}
+
+			for (auto j = mFrames.begin(); j != i; j++)
+			{
+				vector<Capture> &captures = mClosures->captures[j->owner];
+				bool isFound = false;
+
+				for (auto &k : captures)
+				{
+					isFound |= k.owner == capture.owner && k.name == capture.name;
+				}
+
+				if (!isFound)
+				{
+					captures.push_back(capture);
+				}
+			}
+
+			return;
+		}
+	}
+
+	bool ClosureConverter::IsDeclared(const u32string &identifier) const
+	{
+		for (auto &i : mFrames)
+		{
+			if (i.variables.count(identifier) != 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Only the parameters of a class have a slot in its frame. Anything else declared in a class or a package is a member.
+	void ClosureConverter::Declare(const u32string &identifier, const bool isParameter)
+	{
+		Frame &frame = mFrames.front();
+		auto variable = frame.variables.emplace(identifier, Variable(isParameter ? 1 : 0));
+
+		if (variable.second)
+		{
+			variable.first->second.isMember = !isParameter && frame.owner->type != Node::Type::FUNCTION_LITERAL;
+			frame.declarations.push_back(identifier);
+		}
+	}
+
+	void ClosureConverter::Enter(const Node * const owner, const bool isTopLevel)
+	{
+		mFrames.emplace_front(owner, isTopLevel);
+	}
+
+	void ClosureConverter::Leave()
+	{
+		const Frame &frame = mFrames.front();
+
+		for (auto &i : frame.declarations)
+		{
+			const Variable &variable = frame.variables.at(i);
+
+			if (variable.isCaptured && variable.isShared)
+			{
+				mClosures->boxes[frame.owner].push_back(i);
+			}
+		}
+
+		mFrames.pop_front();
+	}
+}
\ No newline at end of file
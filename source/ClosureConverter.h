@@ -0,0 +1,83 @@
+#ifndef CLOSURE_CONVERTER
+#define CLOSURE_CONVERTER
+
+#include <string>
+#include <vector>
+#include <forward_list>
+#include <unordered_map>
+
+#include "Node.h"
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::vector;
+	using std::forward_list;
+	using std::unordered_map;
+
+	// Finds the variables each function captures from the functions enclosing it, so that a closure carries them in a flat list instead of referring to the frames.
+	// A captured variable that is never reassigned once captured is copied. Any other is moved to a box the frame and the closures share.
+	class ClosureConverter
+	{
+	public:
+		// A variable of the frame of a function literal, a class or a package. The empty name is the receiver, through which members are captured.
+		struct Capture
+		{
+			const Node *owner;
+			u32string name;
+		};
+
+		struct Closures
+		{
+			unordered_map<const Node *, vector<Capture>> captures;	// In the order of the upvalues of the function.
+			unordered_map<const Node *, vector<u32string>> boxes;
+		};
+
+		void Convert(const BlockNode * const root, Closures &closures);
+
+	private:
+		struct Variable
+		{
+			explicit Variable(const unsigned int assignmentCount) : assignmentCount(assignmentCount), isMember(false), isCaptured(false), isShared(false)
+			{
+			}
+
+			unsigned int assignmentCount;	// A parameter counts as assigned once by the call.
+			bool isMember;
+			bool isCaptured;
+			bool isShared;
+		};
+
+		struct Frame
+		{
+			Frame(const Node * const owner, const bool isTopLevel) : owner(owner), isTopLevel(isTopLevel), loopDepth(0)
+			{
+			}
+
+			const Node * const owner;
+			const bool isTopLevel;
+			vector<u32string> declarations;
+			unordered_map<u32string, Variable> variables;
+			unsigned int loopDepth;
+		};
+
+		void ConvertBlock(const BlockNode * const node);
+		void ConvertStatement(const StatementNode * const node);
+		void ConvertExpression(const ExpressionNode * const node);
+		void ConvertAssignment(const AssignmentExpressionNode * const node);
+		void ConvertFunction(const FunctionLiteralNode * const node);
+		void ConvertClass(const ClassNode * const node);
+		void ConvertArguments(const forward_list<ExpressionNode *> &arguments);
+
+		void Refer(const u32string &identifier, const bool isAssigned);
+		bool IsDeclared(const u32string &identifier) const;
+		void Declare(const u32string &identifier, const bool isParameter);
+		void Enter(const Node * const owner, const bool isTopLevel);
+		void Leave();
+
+		forward_list<Frame> mFrames;	// Innermost first.
+		Closures *mClosures;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,1920 @@
+#include "CodeGenerator.h"
+
+#include <new>
+#include <climits>
+#include <algorithm>
+
+#include "FatalErrorCode.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	constexpr unsigned short CodeGenerator::MEMBER;
+	constexpr unsigned int CodeGenerator::MINIMUM_JUMP_TABLE_SIZE;
+	constexpr unsigned int CodeGenerator::MAXIMUM_JUMP_TABLE_SPARSENESS;
+
+	Module *CodeGenerator::Generate(const BlockNode * const root, const StaticTypeChecker::TypeTable &typeTable)
+	{
+		using std::bad_alloc;
+
+		mModule = nullptr;
+		mTypeTable = &typeTable;
+		mLine = root ? root->location.Line() : 0;
+
+		try
+		{
+			EscapeAnalyzer().Analyze(root, mLocalLiterals);
+			ClosureConverter().Convert(root, mClosures);
+
+			mModule = new Module();
+
+			Enter(Kind::TOP_LEVEL, mModule->functions[CreateFunction()], root);
+			mTopLevel = &mContexts.front();
+
+			GenerateBlock(root);
+			GenerateReturn(nullptr);
+
+			Leave();
+		}
+		catch (const bad_alloc &e)
+		{
+			mContexts.clear();
+			Utility::SafeDelete(mModule);
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+
+		if (mIsOverflowed)	// Generated again for a function too long, by a generator that starts afresh.
+		{
+			Utility::SafeDelete(mModule);
+
+			if (mIsLongBranch)
+			{
+				throw FatalErrorCode::FUNCTION_TOO_LONG;
+			}
+
+			CodeGenerator generator;
+
+			generator.mIsLongBranch = true;
+
+			return generator.Generate(root, typeTable);
+		}
+
+		return mModule;
+	}
+
+	void CodeGenerator::GenerateBlock(const BlockNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		for (auto i : node->list)
+		{
+			if (i)
+			{
+				GenerateStatement(i);
+			}
+		}
+	}
+
+	void CodeGenerator::GenerateStatement(const StatementNode * const node)
+	{
+		const unsigned int line = mLine;
+
+		mLine = node->location.Line();
+
+		switch (node->type)
+		{
+		case Node::Type::IMPORT:
+			break;
+
+		case Node::Type::IF:
+			GenerateIf(static_cast<const IfNode *>(node));
+			break;
+
+		case Node::Type::CASE:
+			GenerateCase(static_cast<const CaseNode *>(node));
+			break;
+
+		case Node::Type::WHILE:
+			GenerateWhile(static_cast<const WhileNode *>(node));
+			break;
+
+		case Node::Type::FOR:
+			GenerateFor(static_cast<const ForNode *>(node));
+			break;
+
+		case Node::Type::FOREACH:
+			GenerateForEach(static_cast<const ForEachNode *>(node));
+			break;
+
+		case Node::Type::BREAK:
+			if (!mContexts.front().loops.empty())
+			{
+				mContexts.front().loops.back().breaks.push_back(Emit(ByteCode::Opcode::JUMP, 0l));
+			}
+			break;
+
+		case Node::Type::NEXT:
+			if (!mContexts.front().loops.empty())
+			{
+				mContexts.front().loops.back().nexts.push_back(Emit(ByteCode::Opcode::JUMP, 0l));
+			}
+			break;
+
+		case Node::Type::RETURN:
+			GenerateReturn(static_cast<const ReturnNode *>(node)->value);
+			break;
+
+		case Node::Type::ERROR:
+			break;
+
+		default:
+			GenerateExpression(static_cast<const ExpressionNode *>(node));
+			break;
+		}
+
+		mLine = line;
+	}
+
+	void CodeGenerator::GenerateExpression(const ExpressionNode * const node)
+	{
+		auto hoisted = mHoisted.find(node);
+
+		if (hoisted != mHoisted.end())
+		{
+			Emit(ByteCode::Opcode::LOAD_WORD, Register::T0, Register::FP, hoisted->second);
+
+			return;
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::IDENTIFIER:
+		case Node::Type::THIS:
+		case Node::Type::NULL_LITERAL:
+		case Node::Type::BOOLEAN_LITERAL:
+		case Node::Type::INTEGER_LITERAL:
+		case Node::Type::REAL_LITERAL:
+		case Node::Type::STRING_LITERAL:
+			GenerateLeaf(node, Register::T0);
+			break;
+
+		case Node::Type::ARRAY_LITERAL:
+			{
+				const ArrayLiteralNode * const arrayLiteral = static_cast<const ArrayLiteralNode *>(node);
+				unsigned short count = 0;
+
+				for (auto i = arrayLiteral->list.cbegin(); i != arrayLiteral->list.cend(); i++)
+				{
+					count++;
+				}
+
+				const unsigned short first = Allocate(count);
+
+				GenerateArguments(arrayLiteral->list, first);
+				GenerateLiteral(node, ByteCode::Opcode::CONSTRUCT_ARRAY, ByteCode::Opcode::CONSTRUCT_LOCAL_ARRAY, first, count);
+
+				Release(count);
+			}
+			break;
+
+		case Node::Type::HASH_LITERAL:
+			{
+				const HashLiteralNode * const hashLiteral = static_cast<const HashLiteralNode *>(node);
+				unsigned short count = 0;
+
+				for (auto i = hashLiteral->list.cbegin(); i != hashLiteral->list.cend(); i++)
+				{
+					count++;
+				}
+
+				const unsigned short first = Allocate(count * 2);
+				unsigned short slot = first;
+
+				for (auto i : hashLiteral->list)
+				{
+					GenerateExpression(i->key);
+					Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, slot++);
+					GenerateExpression(i->value);
+					Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, slot++);
+				}
+
+				GenerateLiteral(node, ByteCode::Opcode::CONSTRUCT_HASH, ByteCode::Opcode::CONSTRUCT_LOCAL_HASH, first, count);
+
+				Release(count * 2);
+			}
+			break;
+
+		case Node::Type::FUNCTION_LITERAL:
+			GenerateFunction(static_cast<const FunctionLiteralNode *>(node));
+			break;
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			GenerateExpression(static_cast<const ParenthesizedExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			{
+				const IndexReferenceNode * const indexReference = static_cast<const IndexReferenceNode *>(node);
+				const StaticTypeChecker::TypeSet typeSet = TypeOf(indexReference->expression);
+				ByteCode::Opcode opcode = ByteCode::Opcode::REFERENCE_ELEMENT;
+
+				if (StaticTypeChecker::IsOnly(typeSet, Literal::Type::ARRAY))
+				{
+					opcode = ByteCode::Opcode::REFERENCE_ARRAY_ELEMENT;
+				}
+				else if (StaticTypeChecker::IsOnly(typeSet, Literal::Type::HASH))
+				{
+					opcode = ByteCode::Opcode::REFERENCE_HASH_ELEMENT;
+				}
+
+				GenerateOperands(indexReference->expression, indexReference->index);
+				Emit(opcode, Register::T0, Register::T0, Register::T1);
+			}
+			break;
+
+		case Node::Type::FUNCTION_CALL:
+			GenerateCall(static_cast<const FunctionCallNode *>(node), false);
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			{
+				const MemberReferenceNode * const memberReference = static_cast<const MemberReferenceNode *>(node);
+
+				GenerateExpression(memberReference->expression);
+				Emit(ByteCode::Opcode::REFERENCE_MEMBER, Register::T0, Register::T0, static_cast<int>(Cache(*memberReference->member->identifier)));
+			}
+			break;
+
+		case Node::Type::UNARY_EXPRESSION:
+			GenerateUnary(static_cast<const UnaryExpressionNode *>(node));
+			break;
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			{
+				const MultiplicativeExpressionNode * const binary = static_cast<const MultiplicativeExpressionNode *>(node);
+
+				GenerateBinary(binary->op, binary->left, binary->right);
+			}
+			break;
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			{
+				const AdditiveExpressionNode * const binary = static_cast<const AdditiveExpressionNode *>(node);
+
+				GenerateBinary(binary->op, binary->left, binary->right);
+			}
+			break;
+
+		case Node::Type::SHIFT_EXPRESSION:
+			{
+				const ShiftExpressionNode * const binary = static_cast<const ShiftExpressionNode *>(node);
+
+				GenerateBinary(binary->op, binary->left, binary->right);
+			}
+			break;
+
+		case Node::Type::AND_EXPRESSION:
+			{
+				const AndExpressionNode * const binary = static_cast<const AndExpressionNode *>(node);
+
+				GenerateBinary(static_cast<Token::Type>(U'&'), binary->left, binary->right);
+			}
+			break;
+
+		case Node::Type::OR_EXPRESSION:
+			{
+				const OrExpressionNode * const binary = static_cast<const OrExpressionNode *>(node);
+
+				GenerateBinary(binary->op, binary->left, binary->right);
+			}
+			break;
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			{
+				const RelationalExpressionNode * const binary = static_cast<const RelationalExpressionNode *>(node);
+
+				GenerateBinary(binary->op, binary->left, binary->right);
+			}
+			break;
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			{
+				const EqualityExpressionNode * const binary = static_cast<const EqualityExpressionNode *>(node);
+
+				GenerateBinary(binary->op, binary->left, binary->right);
+			}
+			break;
+
+		case Node::Type::LOGICAL_AND_EXPRESSION:
+			{
+				const LogicalAndExpressionNode * const logical = static_cast<const LogicalAndExpressionNode *>(node);
+
+				GenerateLogical(true, logical->left, logical->right);
+			}
+			break;
+
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			{
+				const LogicalOrExpressionNode * const logical = static_cast<const LogicalOrExpressionNode *>(node);
+
+				GenerateLogical(false, logical->left, logical->right);
+			}
+			break;
+
+		case Node::Type::ASSIGNMENT_EXPRESSION:
+			GenerateAssignment(static_cast<const AssignmentExpressionNode *>(node));
+			break;
+
+		case Node::Type::CLASS:
+			GenerateClass(static_cast<const ClassNode *>(node));
+			break;
+
+		case Node::Type::PACKAGE:
+			GeneratePackage(static_cast<const PackageNode *>(node));
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// A literal that does not escape gets a frame slot of its own, which is reused each time the literal is evaluated.
+	void CodeGenerator::GenerateLiteral(const ExpressionNode * const node, const ByteCode::Opcode opcode, const ByteCode::Opcode localOpcode, const unsigned short first, const unsigned short count)
+	{
+		if (mLocalLiterals.count(node))
+		{
+			const unsigned short slot = mContexts.front().function->variableCount++;
+
+			Emit(localOpcode, slot, first, count);
+			Emit(ByteCode::Opcode::LOAD_WORD, Register::T0, Register::FP, slot);
+		}
+		else
+		{
+			Emit(opcode, static_cast<short>(Register::T0), first, count);
+		}
+	}
+
+	void CodeGenerator::GenerateLeaf(const ExpressionNode * const node, const Register rd)
+	{
+		auto hoisted = mHoisted.find(node);
+
+		if (hoisted != mHoisted.end())
+		{
+			Emit(ByteCode::Opcode::LOAD_WORD, rd, Register::FP, hoisted->second);
+
+			return;
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::IDENTIFIER:
+			LoadVariable(*static_cast<const IdentifierNode *>(node)->identifier, rd);
+			break;
+
+		case Node::Type::THIS:
+			Emit(ByteCode::Opcode::LOAD_WORD, rd, Register::FP, 0);
+			break;
+
+		case Node::Type::BOOLEAN_LITERAL:
+			LoadLiteral(Literal(static_cast<const BooleanLiteralNode *>(node)->boolean), rd);
+			break;
+
+		case Node::Type::INTEGER_LITERAL:
+			LoadLiteral(Literal(static_cast<const IntegerLiteralNode *>(node)->integer), rd);
+			break;
+
+		case Node::Type::REAL_LITERAL:
+			LoadLiteral(Literal(static_cast<const RealLiteralNode *>(node)->real), rd);
+			break;
+
+		case Node::Type::STRING_LITERAL:
+			LoadLiteral(Literal(Literal::Type::STRING, mModule->strings[Intern(*static_cast<const StringLiteralNode *>(node)->string)]), rd);
+			break;
+
+		default:
+			LoadLiteral(Literal(), rd);
+			break;
+		}
+	}
+
+	// A leaf on the right is loaded straight into T1, anything else is evaluated first and the left operand is kept in a temporary meanwhile.
+	void CodeGenerator::GenerateOperands(const ExpressionNode * const left, const ExpressionNode * const right)
+	{
+		GenerateExpression(left);
+
+		if (CodeGenerator::IsLeaf(right) || mHoisted.count(right) != 0)
+		{
+			GenerateLeaf(right, Register::T1);
+		}
+		else
+		{
+			const unsigned short temporary = Allocate(1);
+
+			Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary);
+			GenerateExpression(right);
+			Emit(ByteCode::Opcode::MOVE, Register::T1, Register::T0, Register::T0);
+			Emit(ByteCode::Opcode::LOAD_WORD, Register::T0, Register::SP, temporary);
+
+			Release(1);
+		}
+	}
+
+	void CodeGenerator::GenerateUnary(const UnaryExpressionNode * const node)
+	{
+		const StaticTypeChecker::TypeSet typeSet = TypeOf(node->expression);
+
+		GenerateExpression(node->expression);
+
+		switch (node->op)
+		{
+		case static_cast<Token::Type>(U'-'):
+			if (StaticTypeChecker::IsOnly(typeSet, Literal::Type::INTEGER))
+			{
+				Emit(ByteCode::Opcode::NEGATE, Register::T0, Register::T0, Register::T0);
+			}
+			else if (StaticTypeChecker::IsOnly(typeSet, Literal::Type::REAL))
+			{
+				Emit(ByteCode::Opcode::FLOATING_POINT_NEGATE, Register::T0, Register::T0, Register::T0);
+			}
+			else
+			{
+				Emit(ByteCode::Opcode::DYNAMIC_NEGATE, Register::T0, Register::T0, Register::T0);
+			}
+			break;
+
+		case static_cast<Token::Type>(U'+'):
+			if (!StaticTypeChecker::IsOnly(typeSet, Literal::Type::INTEGER) && !StaticTypeChecker::IsOnly(typeSet, Literal::Type::REAL))
+			{
+				Emit(ByteCode::Opcode::DYNAMIC_PLUS, Register::T0, Register::T0, Register::T0);
+			}
+			break;
+
+		case static_cast<Token::Type>(U'~'):
+			if (StaticTypeChecker::IsOnly(typeSet, Literal::Type::INTEGER))
+			{
+				Emit(ByteCode::Opcode::NOT, Register::T0, Register::T0, Register::T0);
+			}
+			else
+			{
+				Emit(ByteCode::Opcode::DYNAMIC_NOT, Register::T0, Register::T0, Register::T0);
+			}
+			break;
+
+		case static_cast<Token::Type>(U'!'):
+			if (StaticTypeChecker::IsOnly(typeSet, Literal::Type::BOOLEAN))
+			{
+				Emit(ByteCode::Opcode::LOGICAL_NOT, Register::T0, Register::T0, Register::T0);
+			}
+			else
+			{
+				Emit(ByteCode::Opcode::DYNAMIC_LOGICAL_NOT, Register::T0, Register::T0, Register::T0);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// Operands inferred to be integers or reals get the specialized opcodes, the others are checked at run time.
+	void CodeGenerator::GenerateBinary(const Token::Type op, const ExpressionNode * const left, const ExpressionNode * const right)
+	{
+		const StaticTypeChecker::TypeSet leftTypeSet = TypeOf(left);
+		const StaticTypeChecker::TypeSet rightTypeSet = TypeOf(right);
+		const bool isInteger = StaticTypeChecker::IsOnly(leftTypeSet, Literal::Type::INTEGER) && StaticTypeChecker::IsOnly(rightTypeSet, Literal::Type::INTEGER);
+		const bool isBoolean = StaticTypeChecker::IsOnly(leftTypeSet, Literal::Type::BOOLEAN) && StaticTypeChecker::IsOnly(rightTypeSet, Literal::Type::BOOLEAN);
+		const bool isReal = !isInteger &&
+			(StaticTypeChecker::IsOnly(leftTypeSet, Literal::Type::INTEGER) || StaticTypeChecker::IsOnly(leftTypeSet, Literal::Type::REAL)) &&
+			(StaticTypeChecker::IsOnly(rightTypeSet, Literal::Type::INTEGER) || StaticTypeChecker::IsOnly(rightTypeSet, Literal::Type::REAL));
+
+		if (isInteger && right->type == Node::Type::INTEGER_LITERAL)
+		{
+			const long long integer = static_cast<const IntegerLiteralNode *>(right)->integer;
+			ByteCode::Opcode opcode = ByteCode::Opcode::NO_OPERATION;
+			long long immediate = integer;
+
+			switch (op)
+			{
+			case static_cast<Token::Type>(U'+'):
+				opcode = ByteCode::Opcode::ADD_IMMEDIATE;
+				break;
+
+			case static_cast<Token::Type>(U'-'):
+				if (integer != LLONG_MIN)
+				{
+					opcode = ByteCode::Opcode::ADD_IMMEDIATE;
+					immediate = -integer;
+				}
+				break;
+
+			case static_cast<Token::Type>(U'<'):
+				opcode = ByteCode::Opcode::SET_ON_LESS_THAN_IMMEDIATE;
+				break;
+
+			case Token::Type::LESS_THAN_OR_EQUAL:
+				if (integer != LLONG_MAX)
+				{
+					opcode = ByteCode::Opcode::SET_ON_LESS_THAN_IMMEDIATE;
+					immediate = integer + 1;
+				}
+				break;
+
+			case static_cast<Token::Type>(U'&'):
+				opcode = ByteCode::Opcode::AND_IMMEDIATE;
+				break;
+
+			case static_cast<Token::Type>(U'|'):
+				opcode = ByteCode::Opcode::OR_IMMEDIATE;
+				break;
+
+			default:
+				break;
+			}
+
+			if (opcode != ByteCode::Opcode::NO_OPERATION && CodeGenerator::IsImmediate(immediate))
+			{
+				GenerateExpression(left);
+				Emit(opcode, Register::T0, Register::T0, static_cast<int>(immediate));
+
+				return;
+			}
+		}
+
+		ByteCode::Opcode integerOpcode = ByteCode::Opcode::NO_OPERATION;
+		ByteCode::Opcode realOpcode = ByteCode::Opcode::NO_OPERATION;
+		ByteCode::Opcode dynamicOpcode = ByteCode::Opcode::NO_OPERATION;
+		bool isSwapped = false;
+
+		switch (op)
+		{
+		case static_cast<Token::Type>(U'*'):
+			integerOpcode = ByteCode::Opcode::MULTIPLY;
+			realOpcode = ByteCode::Opcode::FLOATING_POINT_MULTIPLY;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_MULTIPLY;
+			break;
+
+		case static_cast<Token::Type>(U'/'):
+			integerOpcode = ByteCode::Opcode::DIVIDE;
+			realOpcode = ByteCode::Opcode::FLOATING_POINT_DIVIDE;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_DIVIDE;
+			break;
+
+		case static_cast<Token::Type>(U'%'):
+			integerOpcode = ByteCode::Opcode::REMAINDER;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_REMAINDER;
+			break;
+
+		case static_cast<Token::Type>(U'+'):
+			integerOpcode = ByteCode::Opcode::ADD;
+			realOpcode = ByteCode::Opcode::FLOATING_POINT_ADD;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_ADD;
+			break;
+
+		case static_cast<Token::Type>(U'-'):
+			integerOpcode = ByteCode::Opcode::SUBTRACT;
+			realOpcode = ByteCode::Opcode::FLOATING_POINT_SUBTRACT;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_SUBTRACT;
+			break;
+
+		case Token::Type::SHIFT_LEFT:
+			integerOpcode = ByteCode::Opcode::SHIFT_LEFT;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_SHIFT_LEFT;
+			break;
+
+		case Token::Type::SHIFT_RIGHT:
+			integerOpcode = ByteCode::Opcode::SHIFT_RIGHT;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_SHIFT_RIGHT;
+			break;
+
+		case static_cast<Token::Type>(U'&'):
+			integerOpcode = ByteCode::Opcode::AND;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_AND;
+			break;
+
+		case static_cast<Token::Type>(U'|'):
+			integerOpcode = ByteCode::Opcode::OR;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_OR;
+			break;
+
+		case static_cast<Token::Type>(U'^'):
+			integerOpcode = ByteCode::Opcode::XOR;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_XOR;
+			break;
+
+		case static_cast<Token::Type>(U'<'):
+		case static_cast<Token::Type>(U'>'):
+			isSwapped = op == static_cast<Token::Type>(U'>');
+			integerOpcode = ByteCode::Opcode::SET_ON_LESS_THAN;
+			realOpcode = ByteCode::Opcode::FLOATING_POINT_SET_ON_LESS_THAN;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_SET_ON_LESS_THAN;
+			break;
+
+		case Token::Type::LESS_THAN_OR_EQUAL:
+		case Token::Type::GREATER_THAN_OR_EQUAL:
+			isSwapped = op == Token::Type::GREATER_THAN_OR_EQUAL;
+			integerOpcode = ByteCode::Opcode::SET_ON_LESS_THAN_OR_EQUAL;
+			realOpcode = ByteCode::Opcode::FLOATING_POINT_SET_ON_LESS_THAN_OR_EQUAL;
+			dynamicOpcode = ByteCode::Opcode::DYNAMIC_SET_ON_LESS_THAN_OR_EQUAL;
+			break;
+
+		case Token::Type::EQUAL:
+			integerOpcode = ByteCode::Opcode::SET_ON_EQUAL;
+			realOpcode = ByteCode::Opcode::FLOATING_POINT_SET_ON_EQUAL;
+			dynamicOpcode = isBoolean ? ByteCode::Opcode::SET_ON_EQUAL : ByteCode::Opcode::DYNAMIC_SET_ON_EQUAL;
+			break;
+
+		case Token::Type::NOT_EQUAL:
+			integerOpcode = ByteCode::Opcode::SET_ON_NOT_EQUAL;
+			realOpcode = ByteCode::Opcode::FLOATING_POINT_SET_ON_NOT_EQUAL;
+			dynamicOpcode = isBoolean ? ByteCode::Opcode::SET_ON_NOT_EQUAL : ByteCode::Opcode::DYNAMIC_SET_ON_NOT_EQUAL;
+			break;
+
+		default:
+			break;
+		}
+
+		GenerateOperands(left, right);
+
+		ByteCode::Opcode opcode = dynamicOpcode;
+
+		if (isInteger)
+		{
+			opcode = integerOpcode;
+		}
+		else if (isReal && realOpcode != ByteCode::Opcode::NO_OPERATION)
+		{
+			opcode = realOpcode;
+
+			if (!StaticTypeChecker::IsOnly(leftTypeSet, Literal::Type::REAL))
+			{
+				Emit(ByteCode::Opcode::CONVERT_TO_FLOATING_POINT, Register::T0, Register::T0, Register::T0);
+			}
+
+			if (!StaticTypeChecker::IsOnly(rightTypeSet, Literal::Type::REAL))
+			{
+				Emit(ByteCode::Opcode::CONVERT_TO_FLOATING_POINT, Register::T1, Register::T1, Register::T1);
+			}
+		}
+
+		if (isSwapped)
+		{
+			Emit(opcode, Register::T0, Register::T1, Register::T0);
+		}
+		else
+		{
+			Emit(opcode, Register::T0, Register::T0, Register::T1);
+		}
+	}
+
+	// The value of the left operand is the result when the right one is skipped.
+	void CodeGenerator::GenerateLogical(const bool isAnd, const ExpressionNode * const left, const ExpressionNode * const right)
+	{
+		GenerateExpression(left);
+
+		const unsigned int branch = Emit(isAnd ? ByteCode::Opcode::BRANCH_IF_FALSE : ByteCode::Opcode::BRANCH_IF_TRUE, Register::T0, 0l);
+
+		GenerateExpression(right);
+
+		Patch(vector<unsigned int>(1, branch), Here());
+	}
+
+	void CodeGenerator::GenerateAssignment(const AssignmentExpressionNode * const node)
+	{
+		switch (node->lhs->type)
+		{
+		case Node::Type::IDENTIFIER:
+			{
+				const u32string &identifier = *static_cast<const IdentifierNode *>(node->lhs)->identifier;
+				bool isDeclared = false;
+
+				for (auto &i : mContexts)
+				{
+					isDeclared |= i.variables.count(identifier) != 0;
+				}
+
+				if (!isDeclared)	// Declared before the right hand side is generated, as LocalResolver does.
+				{
+					Declare(identifier);
+				}
+
+				GenerateExpression(node->rhs);
+				StoreVariable(identifier, Register::T0);
+			}
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			{
+				const IndexReferenceNode * const indexReference = static_cast<const IndexReferenceNode *>(node->lhs);
+				const unsigned short temporary = Allocate(2);
+
+				GenerateExpression(indexReference->expression);
+				Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary);
+				GenerateExpression(indexReference->index);
+				Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary + 1);
+				GenerateExpression(node->rhs);
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::A0, Register::SP, temporary);
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::A1, Register::SP, temporary + 1);
+				Emit(StoreElementOpcode(indexReference->expression), Register::T0, Register::A0, Register::A1);
+
+				Release(2);
+			}
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			{
+				const MemberReferenceNode * const memberReference = static_cast<const MemberReferenceNode *>(node->lhs);
+				const unsigned short temporary = Allocate(1);
+
+				GenerateExpression(memberReference->expression);
+				Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary);
+				GenerateExpression(node->rhs);
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::A0, Register::SP, temporary);
+				Emit(ByteCode::Opcode::STORE_MEMBER, Register::T0, Register::A0, static_cast<int>(Cache(*memberReference->member->identifier)));
+
+				Release(1);
+			}
+			break;
+
+		default:
+			GenerateExpression(node->rhs);
+			break;
+		}
+	}
+
+	// The callee or the receiver goes to the first temporary and the arguments follow it, so that the temporaries become the frame of the callee.
+	void CodeGenerator::GenerateCall(const FunctionCallNode * const node, const bool isTailCall)
+	{
+		unsigned short count = 0;
+
+		for (auto i = node->list.cbegin(); i != node->list.cend(); i++)
+		{
+			count++;
+		}
+
+		const unsigned short first = Allocate(count + 1);
+
+		if (node->expression->type == Node::Type::MEMBER_REFERENCE)
+		{
+			const MemberReferenceNode * const memberReference = static_cast<const MemberReferenceNode *>(node->expression);
+
+			GenerateExpression(memberReference->expression);
+			Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, first);
+			GenerateArguments(node->list, first + 1);
+			Emit(isTailCall ? ByteCode::Opcode::TAIL_CALL_MEMBER : ByteCode::Opcode::CALL_MEMBER, first, Cache(*memberReference->member->identifier), count);
+		}
+		else
+		{
+			GenerateExpression(node->expression);
+			Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, first);
+			GenerateArguments(node->list, first + 1);
+			Emit(isTailCall ? ByteCode::Opcode::TAIL_CALL : ByteCode::Opcode::CALL, first, 0, count);
+		}
+
+		if (!isTailCall)
+		{
+			GenerateWriteBack(node->list, first);
+			Emit(ByteCode::Opcode::MOVE, Register::T0, Register::V0, Register::V0);
+		}
+
+		Release(count + 1);
+	}
+
+	void CodeGenerator::GenerateFunction(const FunctionLiteralNode * const node)
+	{
+		const unsigned int index = CreateFunction();
+		Function * const function = mModule->functions[index];
+
+		Capture(node, function);
+		Enter(Kind::FUNCTION, function, node);
+
+		bool hasDefaultArgument = false;
+
+		for (auto i : node->list)
+		{
+			mContexts.front().variables[*i->name->identifier] = function->variableCount++;
+
+			if (i->type == Node::Type::OUTPUT_PARAMETER)
+			{
+				function->outputParameters.push_back(function->parameterCount);
+			}
+			else
+			{
+				hasDefaultArgument |= static_cast<const ValueParameterNode *>(i)->defalutArgument != nullptr;
+			}
+
+			function->parameterCount++;
+		}
+
+		if (hasDefaultArgument)
+		{
+			for (auto i : node->list)
+			{
+				GenerateEntry(i->name, i->type == Node::Type::VALUE_PARAMETER ? static_cast<const ValueParameterNode *>(i)->defalutArgument : nullptr);
+			}
+
+			function->entries.push_back(Here());
+		}
+
+		Box(node);
+		GenerateBlock(node->block);
+		GenerateReturn(nullptr);
+
+		Leave();
+
+		Emit(ByteCode::Opcode::CONSTRUCT_FUNCTION, Register::T0, static_cast<long>(index));
+	}
+
+	void CodeGenerator::GenerateClass(const ClassNode * const node)
+	{
+		const unsigned int index = CreateFunction();
+		Function * const function = mModule->functions[index];
+
+		function->isClass = true;
+
+		Capture(node, function);
+		Enter(Kind::CLASS, function, node);
+
+		bool hasDefaultArgument = false;
+
+		for (auto i : node->list)
+		{
+			const ExpressionNode *parameter = i;
+
+			if (i->type == Node::Type::ASSIGNMENT_EXPRESSION)
+			{
+				parameter = static_cast<const AssignmentExpressionNode *>(i)->lhs;
+			}
+
+			if (parameter->type == Node::Type::IDENTIFIER)
+			{
+				mContexts.front().variables[*static_cast<const IdentifierNode *>(parameter)->identifier] = function->variableCount++;
+				function->parameterCount++;
+				hasDefaultArgument |= parameter != i;
+			}
+		}
+
+		if (hasDefaultArgument)
+		{
+			for (auto i : node->list)
+			{
+				if (i->type == Node::Type::IDENTIFIER)
+				{
+					GenerateEntry(static_cast<const IdentifierNode *>(i), nullptr);
+				}
+				else if (i->type == Node::Type::ASSIGNMENT_EXPRESSION && static_cast<const AssignmentExpressionNode *>(i)->lhs->type == Node::Type::IDENTIFIER)
+				{
+					GenerateEntry(static_cast<const IdentifierNode *>(static_cast<const AssignmentExpressionNode *>(i)->lhs), static_cast<const AssignmentExpressionNode *>(i)->rhs);
+				}
+			}
+
+			function->entries.push_back(Here());
+		}
+
+		Box(node);
+
+		if (node->baseClassConstructorCall)
+		{
+			const BaseClassConstructorCallNode * const call = node->baseClassConstructorCall;
+			unsigned short count = 0;
+
+			for (auto i = call->list.cbegin(); i != call->list.cend(); i++)
+			{
+				count++;
+			}
+
+			const unsigned short first = Allocate(count + 1);
+
+			LoadVariable(*call->baseClass->identifier, Register::T0);
+			Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, first);
+			GenerateArguments(call->list, first + 1);
+			Emit(ByteCode::Opcode::CALL_BASE_CLASS_CONSTRUCTOR, first, 0, count);
+
+			Release(count + 1);
+		}
+
+		GenerateBlock(node->block);
+
+		Emit(ByteCode::Opcode::LOAD_WORD, Register::V0, Register::FP, 0);
+		Emit(ByteCode::Opcode::RETURN);
+
+		Leave();
+
+		Emit(ByteCode::Opcode::CONSTRUCT_FUNCTION, Register::T0, static_cast<long>(index));
+	}
+
+	// A package is a class constructed once, where it is defined.
+	void CodeGenerator::GeneratePackage(const PackageNode * const node)
+	{
+		const unsigned int index = CreateFunction();
+		Function * const function = mModule->functions[index];
+
+		function->isClass = true;
+
+		Capture(node, function);
+		Enter(Kind::CLASS, function, node);
+
+		GenerateBlock(node->block);
+
+		Emit(ByteCode::Opcode::LOAD_WORD, Register::V0, Register::FP, 0);
+		Emit(ByteCode::Opcode::RETURN);
+
+		Leave();
+
+		const unsigned short first = Allocate(1);
+
+		Emit(ByteCode::Opcode::CONSTRUCT_FUNCTION, Register::T0, static_cast<long>(index));
+		Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, first);
+		Emit(ByteCode::Opcode::CALL, first, 0, 0);
+		Emit(ByteCode::Opcode::MOVE, Register::T0, Register::V0, Register::V0);
+
+		Release(1);
+	}
+
+	void CodeGenerator::GenerateIf(const IfNode * const node)
+	{
+		vector<unsigned int> exits;
+
+		for (auto i : node->list)
+		{
+			GenerateExpression(i->condition);
+
+			const unsigned int branch = Emit(ByteCode::Opcode::BRANCH_IF_FALSE, Register::T0, 0l);
+
+			GenerateBlock(i->block);
+			exits.push_back(Emit(ByteCode::Opcode::JUMP, 0l));
+
+			Patch(vector<unsigned int>(1, branch), Here());
+		}
+
+		GenerateBlock(node->block);
+
+		Patch(exits, Here());
+	}
+
+	// A case over enough integer constants in a dense range, or over enough string constants, jumps through a table. Values of another type fall through to the comparisons.
+	void CodeGenerator::GenerateCase(const CaseNode * const node)
+	{
+		const StaticTypeChecker::TypeSet typeSet = TypeOf(node->value);
+		Function * const function = mContexts.front().function;
+		unsigned int count = 0;
+		bool isInteger = true;
+		bool isString = true;
+		long long minimum = LLONG_MAX;
+		long long maximum = LLONG_MIN;
+
+		for (auto i : node->list)
+		{
+			count++;
+			isInteger &= i->condition->type == Node::Type::INTEGER_LITERAL;
+			isString &= i->condition->type == Node::Type::STRING_LITERAL;
+
+			if (isInteger)
+			{
+				minimum = std::min(minimum, static_cast<const IntegerLiteralNode *>(i->condition)->integer);
+				maximum = std::max(maximum, static_cast<const IntegerLiteralNode *>(i->condition)->integer);
+			}
+		}
+
+		isInteger &= count >= CodeGenerator::MINIMUM_JUMP_TABLE_SIZE && static_cast<unsigned long long>(maximum) - static_cast<unsigned long long>(minimum) < count * CodeGenerator::MAXIMUM_JUMP_TABLE_SPARSENESS;
+		isString &= count >= CodeGenerator::MINIMUM_JUMP_TABLE_SIZE;
+
+		const bool isExhaustive = (isInteger || isString) && StaticTypeChecker::IsOnly(typeSet, isInteger ? Literal::Type::INTEGER : Literal::Type::STRING);
+		const unsigned int table = function->jumpTables.size();
+		const unsigned short temporary = isExhaustive ? 0 : Allocate(1);
+		vector<unsigned int> branches;
+		vector<unsigned int> starts;
+		vector<unsigned int> exits;
+
+		GenerateExpression(node->value);
+
+		if (isInteger || isString)
+		{
+			function->jumpTables.emplace_back();
+			Emit(isInteger ? ByteCode::Opcode::TABLE_SWITCH : ByteCode::Opcode::HASH_SWITCH, Register::T0, static_cast<long>(table));
+		}
+
+		if (!isExhaustive)
+		{
+			Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary);
+
+			for (auto i : node->list)
+			{
+				const StaticTypeChecker::TypeSet conditionTypeSet = TypeOf(i->condition);
+				ByteCode::Opcode opcode = ByteCode::Opcode::DYNAMIC_SET_ON_EQUAL;
+
+				if ((StaticTypeChecker::IsOnly(typeSet, Literal::Type::INTEGER) && StaticTypeChecker::IsOnly(conditionTypeSet, Literal::Type::INTEGER)) ||
+					(StaticTypeChecker::IsOnly(typeSet, Literal::Type::BOOLEAN) && StaticTypeChecker::IsOnly(conditionTypeSet, Literal::Type::BOOLEAN)))
+				{
+					opcode = ByteCode::Opcode::SET_ON_EQUAL;
+				}
+
+				GenerateExpression(i->condition);
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::T1, Register::SP, temporary);
+				Emit(opcode, Register::T0, Register::T1, Register::T0);
+
+				branches.push_back(Emit(ByteCode::Opcode::BRANCH_IF_TRUE, Register::T0, 0l));
+			}
+
+			exits.push_back(Emit(ByteCode::Opcode::JUMP, 0l));
+
+			Release(1);
+		}
+
+		unsigned int index = 0;
+
+		for (auto i : node->list)
+		{
+			starts.push_back(Here());
+
+			if (!isExhaustive)
+			{
+				Patch(vector<unsigned int>(1, branches[index]), Here());
+			}
+
+			GenerateBlock(i->block);
+			exits.push_back(Emit(ByteCode::Opcode::JUMP, 0l));
+
+			index++;
+		}
+
+		const unsigned int defaultTarget = Here();
+
+		if (!isExhaustive)
+		{
+			Patch(vector<unsigned int>(1, exits.front()), defaultTarget);
+			exits.erase(exits.begin());
+		}
+
+		GenerateBlock(node->block);
+
+		Patch(exits, Here());
+
+		if (isInteger || isString)
+		{
+			JumpTable &jumpTable = function->jumpTables[table];
+
+			jumpTable.defaultTarget = defaultTarget;
+			index = 0;
+
+			if (isInteger)
+			{
+				jumpTable.minimum = minimum;
+				jumpTable.targets.assign(static_cast<size_t>(maximum - minimum) + 1, defaultTarget);
+			}
+
+			for (auto i : node->list)	// The first of the when values alike is taken, as the comparisons do.
+			{
+				if (isInteger)
+				{
+					unsigned int &target = jumpTable.targets[static_cast<size_t>(static_cast<const IntegerLiteralNode *>(i->condition)->integer - minimum)];
+
+					if (target == defaultTarget)
+					{
+						target = starts[index];
+					}
+				}
+				else
+				{
+					jumpTable.strings.emplace(*static_cast<const StringLiteralNode *>(i->condition)->string, starts[index]);
+				}
+
+				index++;
+			}
+		}
+	}
+
+	// The condition is tested at the bottom, so that an iteration runs a single branch.
+	void CodeGenerator::GenerateWhile(const WhileNode * const node)
+	{
+		LoopOptimizer::ExpressionList invariants;
+
+		GenerateInvariants(node, invariants);
+
+		const unsigned int entry = Emit(ByteCode::Opcode::JUMP, 0l);
+		const unsigned int body = Here();
+
+		mContexts.front().loops.emplace_back();
+
+		GenerateBlock(node->block);
+
+		const Loop loop = mContexts.front().loops.back();
+
+		mContexts.front().loops.pop_back();
+
+		Patch(vector<unsigned int>(1, entry), Here());
+		Patch(loop.nexts, Here());
+
+		GenerateBranch(node->condition, body);
+
+		Patch(loop.breaks, Here());
+
+		for (auto i : invariants)
+		{
+			mHoisted.erase(i);
+		}
+	}
+
+	void CodeGenerator::GenerateFor(const ForNode * const node)
+	{
+		LoopOptimizer::ExpressionList invariants;
+
+		GenerateExpression(node->initializer);
+		GenerateInvariants(node, invariants);
+
+		const unsigned int entry = Emit(ByteCode::Opcode::JUMP, 0l);
+		const unsigned int body = Here();
+
+		mContexts.front().loops.emplace_back();
+
+		GenerateBlock(node->block);
+
+		const Loop loop = mContexts.front().loops.back();
+
+		mContexts.front().loops.pop_back();
+
+		Patch(loop.nexts, Here());
+
+		GenerateExpression(node->iterator);
+
+		Patch(vector<unsigned int>(1, entry), Here());
+
+		GenerateBranch(node->condition, body);
+
+		Patch(loop.breaks, Here());
+
+		for (auto i : invariants)
+		{
+			mHoisted.erase(i);
+		}
+	}
+
+	// NEXT_ELEMENT loads the next element of the iterator, or branches out of the loop when there is none.
+	void CodeGenerator::GenerateForEach(const ForEachNode * const node)
+	{
+		const unsigned short temporary = Allocate(1);
+		LoopOptimizer::ExpressionList invariants;
+
+		GenerateExpression(node->collection);
+		Emit(ByteCode::Opcode::CONSTRUCT_ITERATOR, Register::T0, Register::T0, Register::T0);
+		Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary);
+		GenerateInvariants(node, invariants);
+
+		const unsigned int head = Here();
+
+		Emit(ByteCode::Opcode::LOAD_WORD, Register::A0, Register::SP, temporary);
+
+		const unsigned int next = Branch(Emit(ByteCode::Opcode::NEXT_ELEMENT, Register::T0, Register::A0, 0));
+
+		GenerateStore(node->variable);
+
+		mContexts.front().loops.emplace_back();
+
+		GenerateBlock(node->block);
+		Emit(ByteCode::Opcode::JUMP, static_cast<long>(head));
+
+		const Loop loop = mContexts.front().loops.back();
+
+		mContexts.front().loops.pop_back();
+
+		Patch(loop.nexts, head);
+		Patch(vector<unsigned int>(1, next), Here());
+		Patch(loop.breaks, Here());
+
+		Release(1);
+
+		for (auto i : invariants)
+		{
+			mHoisted.erase(i);
+		}
+	}
+
+	// Hoisted values live in frame slots of their own, as the loop may call functions that use the temporaries.
+	void CodeGenerator::GenerateInvariants(const StatementNode * const loop, LoopOptimizer::ExpressionList &invariants)
+	{
+		Context &context = mContexts.front();
+
+		if (context.kind != Kind::FUNCTION)	// Anything else is a global or a member, which a call may assign.
+		{
+			return;
+		}
+
+		unordered_set<u32string> variables;
+		LoopOptimizer::ExpressionList found;
+
+		for (auto &i : context.variables)
+		{
+			if (context.boxes.count(i.first) == 0)
+			{
+				variables.insert(i.first);
+			}
+		}
+
+		LoopOptimizer().FindInvariants(loop, *mTypeTable, variables, found);
+
+		for (auto i : found)
+		{
+			if (mHoisted.count(i) == 0)	// Already hoisted out of an enclosing loop.
+			{
+				const unsigned short slot = context.function->variableCount++;
+
+				GenerateExpression(i);
+				Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::FP, slot);
+
+				mHoisted[i] = slot;
+				invariants.push_back(i);
+			}
+		}
+	}
+
+	// Branches to the target if the condition holds. A comparison of integers is made by the branch itself.
+	void CodeGenerator::GenerateBranch(const ExpressionNode * const condition, const unsigned int target)
+	{
+		const ExpressionNode *comparison = condition;
+
+		while (comparison->type == Node::Type::PARENTHESIZED_EXPRESSION)
+		{
+			comparison = static_cast<const ParenthesizedExpressionNode *>(comparison)->expression;
+		}
+
+		const ExpressionNode *left = nullptr;
+		const ExpressionNode *right = nullptr;
+		ByteCode::Opcode opcode = ByteCode::Opcode::NO_OPERATION;
+
+		if (comparison->type == Node::Type::RELATIONAL_EXPRESSION || comparison->type == Node::Type::EQUALITY_EXPRESSION)
+		{
+			Token::Type op;
+
+			if (comparison->type == Node::Type::RELATIONAL_EXPRESSION)
+			{
+				op = static_cast<const RelationalExpressionNode *>(comparison)->op;
+				left = static_cast<const RelationalExpressionNode *>(comparison)->left;
+				right = static_cast<const RelationalExpressionNode *>(comparison)->right;
+			}
+			else
+			{
+				op = static_cast<const EqualityExpressionNode *>(comparison)->op;
+				left = static_cast<const EqualityExpressionNode *>(comparison)->left;
+				right = static_cast<const EqualityExpressionNode *>(comparison)->right;
+			}
+
+			switch (op)
+			{
+			case static_cast<Token::Type>(U'<'):
+				opcode = ByteCode::Opcode::BRANCH_IF_LESS_THAN;
+				break;
+
+			case static_cast<Token::Type>(U'>'):
+				opcode = ByteCode::Opcode::BRANCH_IF_GREATER_THAN;
+				break;
+
+			case Token::Type::LESS_THAN_OR_EQUAL:
+				opcode = ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL;
+				break;
+
+			case Token::Type::GREATER_THAN_OR_EQUAL:
+				opcode = ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL;
+				break;
+
+			case Token::Type::EQUAL:
+				opcode = ByteCode::Opcode::BRANCH_ON_EQUAL;
+				break;
+
+			case Token::Type::NOT_EQUAL:
+				opcode = ByteCode::Opcode::BRANCH_ON_NOT_EQUAL;
+				break;
+
+			default:
+				break;
+			}
+
+			if (!StaticTypeChecker::IsOnly(TypeOf(left), Literal::Type::INTEGER) || !StaticTypeChecker::IsOnly(TypeOf(right), Literal::Type::INTEGER) || target > 0xFFFFu)
+			{
+				opcode = ByteCode::Opcode::NO_OPERATION;
+			}
+		}
+
+		if (opcode != ByteCode::Opcode::NO_OPERATION)
+		{
+			GenerateOperands(left, right);
+			Emit(opcode, static_cast<int>(Register::T0), static_cast<int>(Register::T1), static_cast<int>(target));
+		}
+		else
+		{
+			GenerateExpression(condition);
+			Emit(ByteCode::Opcode::BRANCH_IF_TRUE, Register::T0, static_cast<long>(target));
+		}
+	}
+
+	// A call in tail position of a function returns to the caller of the function itself.
+	void CodeGenerator::GenerateReturn(const ExpressionNode * const value)
+	{
+		const ExpressionNode *call = value;
+
+		while (call && call->type == Node::Type::PARENTHESIZED_EXPRESSION)
+		{
+			call = static_cast<const ParenthesizedExpressionNode *>(call)->expression;
+		}
+
+		if (call && call->type == Node::Type::FUNCTION_CALL && mContexts.front().kind == Kind::FUNCTION && mContexts.front().function->outputParameters.empty() &&
+			IsFrameOnly(static_cast<const FunctionCallNode *>(call)->list))
+		{
+			GenerateCall(static_cast<const FunctionCallNode *>(call), true);
+
+			return;
+		}
+
+		if (value)
+		{
+			GenerateExpression(value);
+			Emit(ByteCode::Opcode::MOVE, Register::V0, Register::T0, Register::T0);
+		}
+		else
+		{
+			LoadLiteral(Literal(), Register::V0);
+		}
+
+		const Context &context = mContexts.front();
+
+		for (auto i : context.function->outputParameters)	// The caller reads the values, not the boxes.
+		{
+			for (auto &j : context.boxes)
+			{
+				if (j.second == i + 1)
+				{
+					Emit(ByteCode::Opcode::LOAD_BOX, Register::T1, Register::FP, j.second);
+					Emit(ByteCode::Opcode::STORE_WORD, Register::T1, Register::FP, j.second);
+				}
+			}
+		}
+
+		Emit(ByteCode::Opcode::RETURN);
+	}
+
+	// Stores T0 to the variable of a statement such as foreach, which is an identifier it may declare or an element or a member as the lhs of an assignment is.
+	void CodeGenerator::GenerateStore(const ExpressionNode * const lhs)
+	{
+		switch (lhs->type)
+		{
+		case Node::Type::IDENTIFIER:
+			{
+				const u32string &identifier = *static_cast<const IdentifierNode *>(lhs)->identifier;
+				bool isDeclared = false;
+
+				for (auto &i : mContexts)
+				{
+					isDeclared |= i.variables.count(identifier) != 0;
+				}
+
+				if (!isDeclared)
+				{
+					Declare(identifier);
+				}
+
+				StoreVariable(identifier, Register::T0);
+			}
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			{
+				const IndexReferenceNode * const indexReference = static_cast<const IndexReferenceNode *>(lhs);
+				const unsigned short temporary = Allocate(3);
+
+				Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary + 2);
+				GenerateExpression(indexReference->expression);
+				Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary);
+				GenerateExpression(indexReference->index);
+				Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary + 1);
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::T0, Register::SP, temporary + 2);
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::A0, Register::SP, temporary);
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::A1, Register::SP, temporary + 1);
+				Emit(StoreElementOpcode(indexReference->expression), Register::T0, Register::A0, Register::A1);
+
+				Release(3);
+			}
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			{
+				const MemberReferenceNode * const memberReference = static_cast<const MemberReferenceNode *>(lhs);
+				const unsigned short temporary = Allocate(1);
+
+				Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, temporary);
+				GenerateExpression(memberReference->expression);
+				Emit(ByteCode::Opcode::MOVE, Register::A0, Register::T0, Register::T0);
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::T0, Register::SP, temporary);
+				Emit(ByteCode::Opcode::STORE_MEMBER, Register::T0, Register::A0, static_cast<int>(Cache(*memberReference->member->identifier)));
+
+				Release(1);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// A call given fewer arguments than parameters starts at the entry of the first parameter missing.
+	void CodeGenerator::GenerateEntry(const IdentifierNode * const name, const ExpressionNode * const defaultArgument)
+	{
+		mContexts.front().function->entries.push_back(Here());
+
+		if (defaultArgument)
+		{
+			GenerateExpression(defaultArgument);
+			StoreVariable(*name->identifier, Register::T0);
+		}
+	}
+
+	void CodeGenerator::GenerateArguments(const forward_list<ExpressionNode *> &arguments, const unsigned short first)
+	{
+		unsigned short slot = first;
+
+		for (auto i : arguments)
+		{
+			GenerateExpression(i);
+			Emit(ByteCode::Opcode::STORE_WORD, Register::T0, Register::SP, slot++);
+		}
+	}
+
+	// Output parameters are left in the frame of the callee, which is made of the temporaries of the caller. Only variables passed are written back.
+	// A callee without output parameters may replace itself in the first slot by a tail call to one with some, so V1 is tested first, as RETURN sets it by the function called and not by the one returning.
+	void CodeGenerator::GenerateWriteBack(const forward_list<ExpressionNode *> &arguments, const unsigned short first)
+	{
+		vector<unsigned int> exits;
+		unsigned short index = 0;
+
+		for (auto i : arguments)
+		{
+			if (i->type == Node::Type::IDENTIFIER)
+			{
+				if (exits.empty())
+				{
+					exits.push_back(Emit(ByteCode::Opcode::BRANCH_IF_FALSE, Register::V1, 0l));
+				}
+
+				const unsigned int branch = Branch(Emit(ByteCode::Opcode::BRANCH_IF_NOT_OUTPUT, first, index, 0));
+
+				Emit(ByteCode::Opcode::LOAD_WORD, Register::T1, Register::SP, first + 1 + index);
+				StoreVariable(*static_cast<const IdentifierNode *>(i)->identifier, Register::T1);
+
+				Patch(vector<unsigned int>(1, branch), Here());
+			}
+
+			index++;
+		}
+
+		Patch(exits, Here());
+	}
+
+	// A tail call discards the frame, so it may only drop write backs to the variables in there.
+	bool CodeGenerator::IsFrameOnly(const forward_list<ExpressionNode *> &arguments)
+	{
+		for (auto i : arguments)
+		{
+			if (i->type == Node::Type::IDENTIFIER)
+			{
+				const u32string &identifier = *static_cast<const IdentifierNode *>(i)->identifier;
+				const Variable variable = Lookup(identifier);
+
+				if (variable.depth != 0 || variable.context->kind != Kind::FUNCTION || variable.context->boxes.count(identifier) != 0)
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	unsigned int CodeGenerator::CreateFunction()
+	{
+		mModule->functions.push_back(nullptr);
+		mModule->functions.back() = new Function();
+
+		return mModule->functions.size() - 1;
+	}
+
+	void CodeGenerator::Declare(const u32string &identifier)
+	{
+		Context &context = mContexts.front();
+
+		switch (context.kind)
+		{
+		case Kind::TOP_LEVEL:
+			context.variables[identifier] = mModule->globals.size();
+			mModule->globals.push_back(Intern(identifier));
+			break;
+
+		case Kind::FUNCTION:
+			{
+				auto box = context.boxes.find(identifier);
+
+				context.variables[identifier] = box != context.boxes.end() ? box->second : context.function->variableCount++;
+			}
+			break;
+
+		default:
+			context.variables[identifier] = CodeGenerator::MEMBER;
+			break;
+		}
+	}
+
+	// An identifier not declared anywhere is a global defined elsewhere.
+	CodeGenerator::Variable CodeGenerator::Lookup(const u32string &identifier)
+	{
+		Variable variable;
+
+		variable.depth = 0;
+
+		for (auto &i : mContexts)
+		{
+			auto slot = i.variables.find(identifier);
+
+			if (slot != i.variables.end())
+			{
+				variable.context = &i;
+				variable.slot = slot->second;
+
+				return variable;
+			}
+
+			variable.depth++;
+		}
+
+		mTopLevel->variables[identifier] = mModule->globals.size();
+		mModule->globals.push_back(Intern(identifier));
+
+		variable.context = mTopLevel;
+		variable.slot = mModule->globals.size() - 1;
+
+		return variable;
+	}
+
+	void CodeGenerator::LoadVariable(const u32string &identifier, const Register rd)
+	{
+		const Variable variable = Lookup(identifier);
+		const bool isBoxed = variable.context->boxes.count(identifier) != 0;
+
+		if (variable.context->kind == Kind::TOP_LEVEL)
+		{
+			Emit(ByteCode::Opcode::LOAD_WORD, rd, Register::GP, variable.slot);
+		}
+		else if (variable.slot == CodeGenerator::MEMBER)
+		{
+			LoadReceiver(rd, variable);
+			Emit(ByteCode::Opcode::REFERENCE_MEMBER, rd, rd, static_cast<int>(Cache(identifier)));
+		}
+		else if (variable.depth == 0)
+		{
+			Emit(isBoxed ? ByteCode::Opcode::LOAD_BOX : ByteCode::Opcode::LOAD_WORD, rd, Register::FP, variable.slot);
+		}
+		else
+		{
+			Emit(isBoxed ? ByteCode::Opcode::LOAD_BOXED_UPVALUE : ByteCode::Opcode::LOAD_UPVALUE, rd, static_cast<long>(FindUpvalue(variable.context->owner, identifier)));
+		}
+	}
+
+	// ClosureConverter boxes every variable assigned through an upvalue.
+	void CodeGenerator::StoreVariable(const u32string &identifier, const Register rs)
+	{
+		const Variable variable = Lookup(identifier);
+		const bool isBoxed = variable.context->boxes.count(identifier) != 0;
+
+		if (variable.context->kind == Kind::TOP_LEVEL)
+		{
+			Emit(ByteCode::Opcode::STORE_WORD, rs, Register::GP, variable.slot);
+		}
+		else if (variable.slot == CodeGenerator::MEMBER)
+		{
+			LoadReceiver(Register::A1, variable);
+			Emit(ByteCode::Opcode::STORE_MEMBER, rs, Register::A1, static_cast<int>(Cache(identifier)));
+		}
+		else if (variable.depth == 0)
+		{
+			Emit(isBoxed ? ByteCode::Opcode::STORE_BOX : ByteCode::Opcode::STORE_WORD, rs, Register::FP, variable.slot);
+		}
+		else
+		{
+			Emit(ByteCode::Opcode::STORE_BOXED_UPVALUE, rs, static_cast<long>(FindUpvalue(variable.context->owner, identifier)));
+		}
+	}
+
+	// Members of an enclosing class are reached through its receiver, which is captured as an upvalue with no name.
+	void CodeGenerator::LoadReceiver(const Register rd, const Variable &variable)
+	{
+		if (variable.depth == 0)
+		{
+			Emit(ByteCode::Opcode::LOAD_WORD, rd, Register::FP, 0);
+		}
+		else
+		{
+			Emit(ByteCode::Opcode::LOAD_UPVALUE, rd, static_cast<long>(FindUpvalue(variable.context->owner, u32string())));
+		}
+	}
+
+	// Describes where CONSTRUCT_FUNCTION finds each upvalue, in the frame constructing the closure.
+	void CodeGenerator::Capture(const Node * const owner, Function * const function)
+	{
+		auto captures = mClosures.captures.find(owner);
+
+		if (captures == mClosures.captures.end())
+		{
+			return;
+		}
+
+		Context &context = mContexts.front();
+
+		for (auto &i : captures->second)
+		{
+			Function::Upvalue upvalue;
+
+			upvalue.isLocal = i.owner == context.owner;
+
+			if (!upvalue.isLocal)
+			{
+				upvalue.index = FindUpvalue(i.owner, i.name);
+			}
+			else if (i.name.empty())
+			{
+				upvalue.index = 0;
+			}
+			else
+			{
+				auto box = context.boxes.find(i.name);
+
+				upvalue.index = box != context.boxes.end() ? box->second : context.variables[i.name];
+			}
+
+			function->upvalues.push_back(upvalue);
+		}
+	}
+
+	// Boxes are made on entry, so that all the closures constructed by a call share the same one.
+	void CodeGenerator::Box(const Node * const owner)
+	{
+		auto boxes = mClosures.boxes.find(owner);
+
+		if (boxes == mClosures.boxes.end())
+		{
+			return;
+		}
+
+		Context &context = mContexts.front();
+
+		for (auto &i : boxes->second)
+		{
+			auto parameter = context.variables.find(i);
+			const unsigned short slot = parameter != context.variables.end() ? parameter->second : context.function->variableCount++;
+
+			context.boxes[i] = slot;
+			Emit(ByteCode::Opcode::CONSTRUCT_BOX, Register::FP, static_cast<long>(slot));
+		}
+	}
+
+	unsigned short CodeGenerator::FindUpvalue(const Node * const owner, const u32string &identifier)
+	{
+		const vector<ClosureConverter::Capture> &captures = mClosures.captures[mContexts.front().owner];
+		unsigned short index = 0;
+
+		while (index < captures.size() && (captures[index].owner != owner || captures[index].name != identifier))
+		{
+			index++;
+		}
+
+		return index;
+	}
+
+	void CodeGenerator::LoadLiteral(const Literal &literal, const Register rd)
+	{
+		if (literal.type == Literal::Type::INTEGER && literal.value.integer >= INT_MIN && literal.value.integer <= INT_MAX)
+		{
+			Emit(ByteCode::Opcode::LOAD_WORD_IMMEDIATE, rd, static_cast<long>(literal.value.integer));
+		}
+		else
+		{
+			Emit(ByteCode::Opcode::LOAD_CONSTANT, rd, static_cast<long>(Constant(literal)));
+		}
+	}
+
+	void CodeGenerator::Enter(const Kind kind, Function * const function, const Node * const owner)
+	{
+		mContexts.emplace_front(kind, function, owner);
+	}
+
+	void CodeGenerator::Leave()
+	{
+		mContexts.pop_front();
+	}
+
+	void CodeGenerator::Patch(const vector<unsigned int> &jumps, const unsigned int target)
+	{
+		vector<ByteCode> &code = mContexts.front().function->code;
+
+		for (auto i : jumps)
+		{
+			if (code[i].opcode == ByteCode::Opcode::NEXT_ELEMENT || code[i].opcode == ByteCode::Opcode::BRANCH_IF_NOT_OUTPUT)
+			{
+				mIsOverflowed |= target > 0xFFFFu;
+				code[i].operand32 = (code[i].operand32 & ~0xFFFFl) | (target & 0xFFFFu);
+			}
+			else
+			{
+				code[i].operand32 = target;
+			}
+		}
+	}
+
+	// The branch to patch for one with a 16 bit target. For a function too long for those, the branch goes to a JUMP after a JUMP that skips it, and the second JUMP is what is patched.
+	unsigned int CodeGenerator::Branch(const unsigned int branch)
+	{
+		if (!mIsLongBranch)
+		{
+			return branch;
+		}
+
+		Patch(vector<unsigned int>(1, branch), branch + 2);
+		Emit(ByteCode::Opcode::JUMP, static_cast<long>(branch + 3));
+
+		return Emit(ByteCode::Opcode::JUMP, 0l);
+	}
+
+	unsigned short CodeGenerator::Allocate(const unsigned short count)
+	{
+		Context &context = mContexts.front();
+		const unsigned short first = context.temporaryCount;
+
+		context.temporaryCount += count;
+
+		if (context.temporaryCount > context.function->temporaryCount)
+		{
+			context.function->temporaryCount = context.temporaryCount;
+		}
+
+		return first;
+	}
+
+	void CodeGenerator::Release(const unsigned short count)
+	{
+		mContexts.front().temporaryCount -= count;
+	}
+
+	unsigned int CodeGenerator::Constant(const Literal &literal)
+	{
+		Context &context = mContexts.front();
+		vector<Literal> &constants = context.function->constants;
+
+		if (literal.type == Literal::Type::REAL && literal.value.real == 0.0)	// HashTable does not tell -0.0 from 0.0.
+		{
+			constants.push_back(literal);
+
+			return constants.size() - 1;
+		}
+
+		Literal &index = context.constants.Insert(literal);
+
+		if (index.type == Literal::Type::NULL_LITERAL)
+		{
+			constants.push_back(literal);
+			index = Literal(static_cast<long long>(constants.size() - 1));
+		}
+
+		return static_cast<unsigned int>(index.value.integer);
+	}
+
+	unsigned int CodeGenerator::Intern(const u32string &string)
+	{
+		const HashTable::Key key(Literal(Literal::Type::STRING, const_cast<u32string *>(&string)));
+		const Literal *index = mStrings.Find(key);
+
+		if (index)
+		{
+			return static_cast<unsigned int>(index->value.integer);
+		}
+
+		u32string *copy = new u32string(string);
+
+		try
+		{
+			mModule->strings.push_back(copy);
+		}
+		catch (...)
+		{
+			Utility::SafeDelete(copy);
+			throw;
+		}
+
+		mStrings.Insert(HashTable::Key(Literal(Literal::Type::STRING, copy), key.hash)) = Literal(static_cast<long long>(mModule->strings.size() - 1));
+
+		return mModule->strings.size() - 1;
+	}
+
+	unsigned int CodeGenerator::Cache(const u32string &member)
+	{
+		vector<InlineCache> &inlineCaches = mContexts.front().function->inlineCaches;
+
+		inlineCaches.emplace_back(Intern(member));
+
+		return inlineCaches.size() - 1;
+	}
+
+	StaticTypeChecker::TypeSet CodeGenerator::TypeOf(const ExpressionNode * const node) const
+	{
+		auto typeSet = mTypeTable->find(node);
+
+		return typeSet != mTypeTable->cend() ? typeSet->second : StaticTypeChecker::ANY;
+	}
+
+	// Of an element of the collection, which a store needs to check at run time only if its type is not known.
+	ByteCode::Opcode CodeGenerator::StoreElementOpcode(const ExpressionNode * const collection) const
+	{
+		const StaticTypeChecker::TypeSet typeSet = TypeOf(collection);
+
+		if (StaticTypeChecker::IsOnly(typeSet, Literal::Type::ARRAY))
+		{
+			return ByteCode::Opcode::STORE_ARRAY_ELEMENT;
+		}
+		else if (StaticTypeChecker::IsOnly(typeSet, Literal::Type::HASH))
+		{
+			return ByteCode::Opcode::STORE_HASH_ELEMENT;
+		}
+
+		return ByteCode::Opcode::STORE_ELEMENT;
+	}
+
+	unsigned int CodeGenerator::Emit(const ByteCode::Opcode opcode)
+	{
+		return Emit(opcode, 0l);
+	}
+
+	unsigned int CodeGenerator::Emit(const ByteCode::Opcode opcode, const long operand32)
+	{
+		vector<ByteCode> &code = mContexts.front().function->code;
+
+		code.emplace_back(opcode, 0, operand32);
+		mContexts.front().function->lines.push_back(mLine);
+
+		return code.size() - 1;
+	}
+
+	unsigned int CodeGenerator::Emit(const ByteCode::Opcode opcode, const Register rd, const long operand32)
+	{
+		vector<ByteCode> &code = mContexts.front().function->code;
+
+		code.emplace_back(opcode, static_cast<short>(rd), operand32);
+		mContexts.front().function->lines.push_back(mLine);
+
+		return code.size() - 1;
+	}
+
+	unsigned int CodeGenerator::Emit(const ByteCode::Opcode opcode, const Register rd, const Register rs, const Register rt)
+	{
+		return Emit(opcode, static_cast<short>(rd), static_cast<short>(rs), static_cast<short>(rt));
+	}
+
+	unsigned int CodeGenerator::Emit(const ByteCode::Opcode opcode, const Register rd, const Register rs, const int immediate)
+	{
+		return Emit(opcode, static_cast<short>(rd), static_cast<short>(rs), immediate);
+	}
+
+	unsigned int CodeGenerator::Emit(const ByteCode::Opcode opcode, const int operand16, const int operand32High, const int operand32Low)
+	{
+		vector<ByteCode> &code = mContexts.front().function->code;
+
+		code.emplace_back(opcode, static_cast<short>(operand16), static_cast<short>(operand32High), static_cast<short>(operand32Low));
+		mContexts.front().function->lines.push_back(mLine);
+
+		return code.size() - 1;
+	}
+
+	unsigned int CodeGenerator::Here() const
+	{
+		return mContexts.front().function->code.size();
+	}
+
+	bool CodeGenerator::IsLeaf(const ExpressionNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::IDENTIFIER:
+		case Node::Type::THIS:
+		case Node::Type::NULL_LITERAL:
+		case Node::Type::BOOLEAN_LITERAL:
+		case Node::Type::INTEGER_LITERAL:
+		case Node::Type::REAL_LITERAL:
+		case Node::Type::STRING_LITERAL:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	bool CodeGenerator::IsImmediate(const long long integer)
+	{
+		return integer >= SHRT_MIN && integer <= SHRT_MAX;
+	}
+}
\ No newline at end of file
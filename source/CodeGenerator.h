@@ -0,0 +1,152 @@
+#ifndef CODE_GENERATOR
+#define CODE_GENERATOR
+
+#include <string>
+#include <vector>
+#include <forward_list>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Token.h"
+#include "Node.h"
+#include "ByteCode.h"
+#include "Literal.h"
+#include "HashTable.h"
+#include "Function.h"
+#include "Module.h"
+#include "StaticTypeChecker.h"
+#include "EscapeAnalyzer.h"
+#include "ClosureConverter.h"
+#include "LoopOptimizer.h"
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::vector;
+	using std::forward_list;
+	using std::unordered_map;
+	using std::unordered_set;
+
+	// Expressions are evaluated into T0. T1, A0 and A1 hold the other operands.
+	class CodeGenerator
+	{
+	public:
+		CodeGenerator() : mIsLongBranch(false), mIsOverflowed(false)
+		{
+		}
+
+		Module *Generate(const BlockNode * const root, const StaticTypeChecker::TypeTable &typeTable);
+
+	private:
+		enum struct Kind { TOP_LEVEL, FUNCTION, CLASS };
+
+		struct Loop
+		{
+			vector<unsigned int> breaks;
+			vector<unsigned int> nexts;
+		};
+
+		struct Context
+		{
+			Context(const Kind kind, Function * const function, const Node * const owner) : kind(kind), function(function), owner(owner), temporaryCount(0)
+			{
+			}
+
+			const Kind kind;
+			Function * const function;
+			const Node * const owner;
+			unordered_map<u32string, unsigned short> variables;
+			unordered_map<u32string, unsigned short> boxes;	// Slots reserved on entry for the variables shared with closures.
+			HashTable constants;
+			vector<Loop> loops;
+			unsigned short temporaryCount;
+		};
+
+		struct Variable
+		{
+			Context *context;
+			unsigned short slot;
+			unsigned short depth;
+		};
+
+		static constexpr unsigned short MEMBER = 0xFFFFu;
+		static constexpr unsigned int MINIMUM_JUMP_TABLE_SIZE = 4;
+		static constexpr unsigned int MAXIMUM_JUMP_TABLE_SPARSENESS = 2;	// Entries of the table per when value.
+
+		void GenerateBlock(const BlockNode * const node);
+		void GenerateStatement(const StatementNode * const node);
+		void GenerateExpression(const ExpressionNode * const node);
+		void GenerateLiteral(const ExpressionNode * const node, const ByteCode::Opcode opcode, const ByteCode::Opcode localOpcode, const unsigned short first, const unsigned short count);
+		void GenerateLeaf(const ExpressionNode * const node, const Register rd);
+		void GenerateOperands(const ExpressionNode * const left, const ExpressionNode * const right);
+		void GenerateUnary(const UnaryExpressionNode * const node);
+		void GenerateBinary(const Token::Type op, const ExpressionNode * const left, const ExpressionNode * const right);
+		void GenerateLogical(const bool isAnd, const ExpressionNode * const left, const ExpressionNode * const right);
+		void GenerateAssignment(const AssignmentExpressionNode * const node);
+		void GenerateCall(const FunctionCallNode * const node, const bool isTailCall);
+		void GenerateFunction(const FunctionLiteralNode * const node);
+		void GenerateClass(const ClassNode * const node);
+		void GeneratePackage(const PackageNode * const node);
+		void GenerateIf(const IfNode * const node);
+		void GenerateCase(const CaseNode * const node);
+		void GenerateWhile(const WhileNode * const node);
+		void GenerateFor(const ForNode * const node);
+		void GenerateForEach(const ForEachNode * const node);
+		void GenerateInvariants(const StatementNode * const loop, LoopOptimizer::ExpressionList &invariants);
+		void GenerateBranch(const ExpressionNode * const condition, const unsigned int target);
+		void GenerateReturn(const ExpressionNode * const value);
+		void GenerateStore(const ExpressionNode * const lhs);
+
+		void GenerateEntry(const IdentifierNode * const name, const ExpressionNode * const defaultArgument);
+		void GenerateArguments(const forward_list<ExpressionNode *> &arguments, const unsigned short first);
+		void GenerateWriteBack(const forward_list<ExpressionNode *> &arguments, const unsigned short first);
+		bool IsFrameOnly(const forward_list<ExpressionNode *> &arguments);
+		unsigned int CreateFunction();
+		void Declare(const u32string &identifier);
+		Variable Lookup(const u32string &identifier);
+		void LoadVariable(const u32string &identifier, const Register rd);
+		void StoreVariable(const u32string &identifier, const Register rs);
+		void LoadReceiver(const Register rd, const Variable &variable);
+		void Capture(const Node * const owner, Function * const function);
+		void Box(const Node * const owner);
+		unsigned short FindUpvalue(const Node * const owner, const u32string &identifier);
+		void LoadLiteral(const Literal &literal, const Register rd);
+		void Enter(const Kind kind, Function * const function, const Node * const owner);
+		void Leave();
+		void Patch(const vector<unsigned int> &jumps, const unsigned int target);
+		unsigned int Branch(const unsigned int branch);
+
+		unsigned short Allocate(const unsigned short count);
+		void Release(const unsigned short count);
+		unsigned int Constant(const Literal &literal);
+		unsigned int Intern(const u32string &string);
+		unsigned int Cache(const u32string &member);
+		StaticTypeChecker::TypeSet TypeOf(const ExpressionNode * const node) const;
+		ByteCode::Opcode StoreElementOpcode(const ExpressionNode * const collection) const;
+
+		unsigned int Emit(const ByteCode::Opcode opcode);
+		unsigned int Emit(const ByteCode::Opcode opcode, const long operand32);
+		unsigned int Emit(const ByteCode::Opcode opcode, const Register rd, const long operand32);
+		unsigned int Emit(const ByteCode::Opcode opcode, const Register rd, const Register rs, const Register rt);
+		unsigned int Emit(const ByteCode::Opcode opcode, const Register rd, const Register rs, const int immediate);
+		unsigned int Emit(const ByteCode::Opcode opcode, const int operand16, const int operand32High, const int operand32Low);
+		unsigned int Here() const;
+
+		static bool IsLeaf(const ExpressionNode * const node);
+		static bool IsImmediate(const long long integer);
+
+		Module *mModule;
+		const StaticTypeChecker::TypeTable *mTypeTable;
+		EscapeAnalyzer::LiteralSet mLocalLiterals;
+		ClosureConverter::Closures mClosures;
+		unordered_map<const ExpressionNode *, unsigned short> mHoisted;	// Frame slots of the loop invariants hoisted.
+		forward_list<Context> mContexts;	// Innermost first.
+		Context *mTopLevel;
+		HashTable mStrings;
+		unsigned int mLine;	// Of the statement being generated, recorded for each instruction emitted.
+		bool mIsLongBranch;	// Whether the branches with 16 bit targets patched later go through a JUMP right after them, which reaches any target.
+		bool mIsOverflowed;	// Whether such a target did not fit in 16 bits.
+	};
+}
+
+#endif
\ No newline at end of file
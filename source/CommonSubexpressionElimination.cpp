@@ -0,0 +1,201 @@
+#include "CommonSubexpressionElimination.h"
+
+#include <utility>
+#include <functional>
+
+namespace lyrics
+{
+	using std::pair;
+
+	void CommonSubexpressionElimination::Run(IR &ir)
+	{
+		mExpressions.clear();
+
+		Eliminate(ir, ir.blocks.front());
+	}
+
+	// The expressions of a block are known in the blocks it dominates, and forgotten once they are done.
+	void CommonSubexpressionElimination::Eliminate(const IR &ir, IR::BasicBlock * const block)
+	{
+		vector<pair<Expression, IR::Value *>> shadowed;
+		vector<IR::Value *> state(block->values.size());
+
+		for (size_t i = 0; i < state.size(); i++)
+		{
+			state[i] = IR::Resolve(block->values[i]);
+		}
+
+		for (auto i : block->instructions)
+		{
+			const ByteCode &code = i->code;
+
+			if (CommonSubexpressionElimination::IsCommon(code.opcode))
+			{
+				const long immediate = i->operands.size() == 1 && i->fields.front() == IR::Field::HIGH ? static_cast<short>(code.operand32 & 0xFFFF) : i->operands.empty() ? code.operand32 : 0;
+				IR::Value *left = i->operands.size() > 0 ? IR::Root(i->operands[0]) : nullptr;
+				IR::Value *right = i->operands.size() > 1 ? IR::Root(i->operands[1]) : nullptr;
+
+				if (CommonSubexpressionElimination::IsCommutative(code.opcode) && std::less<IR::Value *>()(right, left))
+				{
+					std::swap(left, right);
+				}
+
+				const Expression expression(code.opcode, immediate, left, right);
+				auto found = mExpressions.find(expression);
+				IR::Value *held = nullptr;
+
+				// Loading from a frame slot is no cheaper than an instruction without operands.
+				if (found != mExpressions.end())
+				{
+					for (unsigned short j = 0; j < state.size() && !held; j++)
+					{
+						if (IR::Root(state[j]) == found->second && (IR::IsRegister(j) || !i->operands.empty()))
+						{
+							held = state[j];
+						}
+					}
+				}
+
+				if (held)
+				{
+					Rewrite(ir, i, held);
+				}
+				else
+				{
+					shadowed.emplace_back(expression, found != mExpressions.end() ? found->second : nullptr);
+					mExpressions[expression] = i->results.front();
+				}
+			}
+
+			for (auto j : i->results)
+			{
+				state[j->location] = j;
+			}
+		}
+
+		for (auto i : block->dominated)
+		{
+			Eliminate(ir, i);
+		}
+
+		for (auto i = shadowed.rbegin(); i != shadowed.rend(); i++)
+		{
+			if (i->second)
+			{
+				mExpressions[i->first] = i->second;
+			}
+			else
+			{
+				mExpressions.erase(i->first);
+			}
+		}
+	}
+
+	// Registers are searched before the frame slots, so the value is moved rather than loaded where it can be.
+	void CommonSubexpressionElimination::Rewrite(const IR &ir, IR::Instruction * const instruction, IR::Value * const value)
+	{
+		const short rd = instruction->code.operand16;
+
+		for (auto i : instruction->operands)
+		{
+			IR::RemoveUse(i, instruction);
+		}
+
+		instruction->operands.assign(1, value);
+		instruction->hasSideEffect = false;
+		IR::AddUse(value, instruction);
+
+		if (IR::IsRegister(value->location))
+		{
+			instruction->code = ByteCode(ByteCode::Opcode::MOVE, rd, static_cast<short>(value->location), static_cast<short>(value->location));
+			instruction->fields.assign(1, IR::Field::HIGH_AND_LOW);
+		}
+		else
+		{
+			const unsigned short slot = value->location - IR::SlotLocation(0);
+
+			if (slot < ir.variableCount)
+			{
+				instruction->code = ByteCode(ByteCode::Opcode::LOAD_WORD, rd, static_cast<short>(Register::FP), static_cast<short>(slot));
+			}
+			else
+			{
+				instruction->code = ByteCode(ByteCode::Opcode::LOAD_WORD, rd, static_cast<short>(Register::SP), static_cast<short>(slot - ir.variableCount));
+			}
+
+			instruction->fields.assign(1, IR::Field::IMPLICIT);
+		}
+	}
+
+	// Integer division is common as well, as the one dominating it would have raised the error first.
+	bool CommonSubexpressionElimination::IsCommon(const ByteCode::Opcode opcode)
+	{
+		switch (opcode)
+		{
+		case ByteCode::Opcode::ADD:
+		case ByteCode::Opcode::SUBTRACT:
+		case ByteCode::Opcode::MULTIPLY:
+		case ByteCode::Opcode::DIVIDE:
+		case ByteCode::Opcode::REMAINDER:
+		case ByteCode::Opcode::NEGATE:
+		case ByteCode::Opcode::ADD_IMMEDIATE:
+		case ByteCode::Opcode::FLOATING_POINT_ADD:
+		case ByteCode::Opcode::FLOATING_POINT_SUBTRACT:
+		case ByteCode::Opcode::FLOATING_POINT_MULTIPLY:
+		case ByteCode::Opcode::FLOATING_POINT_DIVIDE:
+		case ByteCode::Opcode::FLOATING_POINT_NEGATE:
+		case ByteCode::Opcode::CONVERT_TO_FLOATING_POINT:
+		case ByteCode::Opcode::LOAD_WORD_IMMEDIATE:
+		case ByteCode::Opcode::LOAD_CONSTANT:
+		case ByteCode::Opcode::LOAD_UPVALUE:
+		case ByteCode::Opcode::NOT:
+		case ByteCode::Opcode::NAND:
+		case ByteCode::Opcode::NOR:
+		case ByteCode::Opcode::AND:
+		case ByteCode::Opcode::OR:
+		case ByteCode::Opcode::XOR:
+		case ByteCode::Opcode::AND_IMMEDIATE:
+		case ByteCode::Opcode::OR_IMMEDIATE:
+		case ByteCode::Opcode::SHIFT_LEFT:
+		case ByteCode::Opcode::SHIFT_RIGHT:
+		case ByteCode::Opcode::LOGICAL_NOT:
+		case ByteCode::Opcode::SET_ON_LESS_THAN:
+		case ByteCode::Opcode::SET_ON_LESS_THAN_IMMEDIATE:
+		case ByteCode::Opcode::SET_ON_LESS_THAN_OR_EQUAL:
+		case ByteCode::Opcode::SET_ON_EQUAL:
+		case ByteCode::Opcode::SET_ON_NOT_EQUAL:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_LESS_THAN:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_LESS_THAN_OR_EQUAL:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_EQUAL:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_NOT_EQUAL:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	bool CommonSubexpressionElimination::IsCommutative(const ByteCode::Opcode opcode)
+	{
+		switch (opcode)
+		{
+		case ByteCode::Opcode::ADD:
+		case ByteCode::Opcode::MULTIPLY:
+		case ByteCode::Opcode::FLOATING_POINT_ADD:
+		case ByteCode::Opcode::FLOATING_POINT_MULTIPLY:
+		case ByteCode::Opcode::NAND:
+		case ByteCode::Opcode::NOR:
+		case ByteCode::Opcode::AND:
+		case ByteCode::Opcode::OR:
+		case ByteCode::Opcode::XOR:
+		case ByteCode::Opcode::SET_ON_EQUAL:
+		case ByteCode::Opcode::SET_ON_NOT_EQUAL:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_EQUAL:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_NOT_EQUAL:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef COMMON_SUBEXPRESSION_ELIMINATION
+#define COMMON_SUBEXPRESSION_ELIMINATION
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "ByteCode.h"
+#include "Pass.h"
+#include "IR.h"
+
+namespace lyrics
+{
+	using std::map;
+	using std::tuple;
+	using std::vector;
+
+	// Walks the dominator tree, and turns an instruction computing what a dominating one did into a copy from a location still holding the value.
+	class CommonSubexpressionElimination : public Pass
+	{
+	public:
+		virtual void Run(IR &ir);
+
+	private:
+		typedef tuple<ByteCode::Opcode, long, IR::Value *, IR::Value *> Expression;	// The opcode, the immediate and the values the operands were copied from.
+
+		void Eliminate(const IR &ir, IR::BasicBlock * const block);
+		void Rewrite(const IR &ir, IR::Instruction * const instruction, IR::Value * const value);
+
+		static bool IsCommon(const ByteCode::Opcode opcode);
+		static bool IsCommutative(const ByteCode::Opcode opcode);
+
+		map<Expression, IR::Value *> mExpressions;
+	};
+}
+
+#endif
\ No newline at end of file
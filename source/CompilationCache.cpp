@@ -0,0 +1,384 @@
+#include "CompilationCache.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <functional>
+
+#include "Compiler.h"
+#include "Loader.h"
+#include "ModuleFormat.h"
+#include "ModuleImage.h"
+#include "ModuleWriter.h"
+
+#include "FatalErrorCode.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	constexpr unsigned long long CompilationCache::OFFSET_BASIS;
+	constexpr unsigned long long CompilationCache::PRIME;
+	constexpr char CompilationCache::EXTENSION[];
+
+	string CompilationCache::Key(const char * const data, const unsigned int size) const
+	{
+		const uint32_t format[] = { ModuleFormat::VERSION, ModuleFormat::BYTE_ORDER_MARK, static_cast<uint32_t>(sizeof(ByteCode)) };
+
+		// No option changes the code generated yet, so the source and the compiler are all there is to tell apart.
+		unsigned long long hash = CompilationCache::OFFSET_BASIS;
+
+		hash = Hash(hash, Compiler::VERSION, sizeof(Compiler::VERSION));
+		hash = Hash(hash, reinterpret_cast<const char *>(format), sizeof(format));
+		hash = Hash(hash, data, size);
+
+		return Digest(hash);
+	}
+
+	string CompilationCache::Key(const string &sourceCodeFileName) const
+	{
+		unsigned int size;
+		char *data = Loader().Load(sourceCodeFileName, size);
+		const string key = Key(data, size);
+
+		Utility::SafeArrayDelete(data);
+
+		return key;
+	}
+
+	string CompilationCache::Key(const string &key, vector<string> fingerprints) const
+	{
+		if (fingerprints.empty())
+		{
+			return key;
+		}
+
+		std::sort(fingerprints.begin(), fingerprints.end());
+
+		unsigned long long hash = Hash(CompilationCache::OFFSET_BASIS, key.data(), static_cast<unsigned int>(key.size()));
+
+		for (auto &i : fingerprints)
+		{
+			hash = Hash(hash, i.data(), static_cast<unsigned int>(i.size()));
+		}
+
+		return Digest(hash);
+	}
+
+	string CompilationCache::Fingerprint(const u32string &interface)
+	{
+		return Digest(Hash(CompilationCache::OFFSET_BASIS, reinterpret_cast<const char *>(interface.data()), static_cast<unsigned int>(interface.size() * sizeof(char32_t))));
+	}
+
+	bool CompilationCache::Fetch(const string &key, const string &moduleFileName) const
+	{
+		if (IsResident())
+		{
+			vector<char> data;
+			Memory &memory = Resident();
+
+			{
+				std::lock_guard<mutex> lock(memory.guard);
+
+				auto i = memory.modules.find(key);
+
+				if (i != memory.modules.end())
+				{
+					data = i->second;
+				}
+			}
+
+			if (!data.empty())
+			{
+				if (!moduleFileName.empty())
+				{
+					WriteFile(moduleFileName, data.data(), data.size());
+				}
+
+				return true;
+			}
+		}
+
+		if (mDirectoryName.empty())
+		{
+			return false;
+		}
+
+		ModuleImage image;
+
+		try
+		{
+			image.Map(Path(key));
+		}
+		catch (const FatalErrorCode fatalErrorCode)
+		{
+			if (fatalErrorCode == FatalErrorCode::NOT_ENOUGH_MEMORY)
+			{
+				throw fatalErrorCode;
+			}
+
+			return false;
+		}
+
+		if (IsResident())
+		{
+			Keep(key, image.Data(), image.Size());
+		}
+
+		if (!moduleFileName.empty())
+		{
+			WriteFile(moduleFileName, image.Data(), image.Size());
+		}
+
+		return true;
+	}
+
+	// Written aside and renamed, so that a module is never found half written. The threads of a batch compiling the same source each write their own.
+	void CompilationCache::Store(const string &key, const Module &module) const
+	{
+		ModuleWriter writer;
+		const vector<char> &image = writer.Image(module);
+
+		if (IsResident())
+		{
+			Keep(key, image.data(), image.size());
+		}
+
+		if (mDirectoryName.empty())
+		{
+			return;
+		}
+
+		const string path = Path(key);
+		const string temporary = path + '.' + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+
+		try
+		{
+			WriteFile(temporary, image.data(), image.size());
+		}
+		catch (const FatalErrorCode fatalErrorCode)
+		{
+			std::remove(temporary.c_str());
+
+			if (fatalErrorCode == FatalErrorCode::NOT_ENOUGH_MEMORY)
+			{
+				throw fatalErrorCode;
+			}
+
+			return;
+		}
+
+		if (std::rename(temporary.c_str(), path.c_str()) != 0)	// Which fails on Windows if the file is there.
+		{
+			std::remove(path.c_str());
+
+			if (std::rename(temporary.c_str(), path.c_str()) != 0)
+			{
+				std::remove(temporary.c_str());
+			}
+		}
+	}
+
+	bool CompilationCache::Fetch(const string &key, Outline &outline) const
+	{
+		if (!IsResident())
+		{
+			return false;
+		}
+
+		Memory &memory = Resident();
+		std::lock_guard<mutex> lock(memory.guard);
+
+		auto i = memory.outlines.find(key);
+
+		if (i == memory.outlines.end())
+		{
+			return false;
+		}
+
+		outline.dependencies = DependencyScanner::Dependencies(i->second.dependencies);
+		outline.output = i->second.output;
+		outline.errorOutput = i->second.errorOutput;
+
+		return true;
+	}
+
+	void CompilationCache::Store(const string &key, const Outline &outline) const
+	{
+		if (!IsResident())
+		{
+			return;
+		}
+
+		Memory &memory = Resident();
+		std::lock_guard<mutex> lock(memory.guard);
+
+		if (memory.outlines.emplace(key, outline).second)
+		{
+			memory.order.emplace_back(key, true);
+			memory.size += SizeOf(outline);
+
+			Trim(memory);
+		}
+	}
+
+	void CompilationCache::KeepResident(const size_t limit)
+	{
+		Memory &memory = Resident();
+		std::lock_guard<mutex> lock(memory.guard);
+
+		memory.limit = limit;
+
+		Trim(memory);
+	}
+
+	bool CompilationCache::IsResident()
+	{
+		Memory &memory = Resident();
+		std::lock_guard<mutex> lock(memory.guard);
+
+		return memory.limit != 0;
+	}
+
+	CompilationCache::Memory &CompilationCache::Resident()
+	{
+		static Memory memory;
+
+		return memory;
+	}
+
+	void CompilationCache::Keep(const string &key, const char * const data, const size_t size)
+	{
+		Memory &memory = Resident();
+		std::lock_guard<mutex> lock(memory.guard);
+
+		if (memory.modules.emplace(key, vector<char>(data, data + size)).second)
+		{
+			memory.order.emplace_back(key, false);
+			memory.size += size;
+
+			Trim(memory);
+		}
+	}
+
+	// With the lock held. Keeps the newest even if it alone is past the limit.
+	void CompilationCache::Trim(Memory &memory)
+	{
+		while (memory.size > memory.limit && memory.order.size() > 1)
+		{
+			const pair<string, bool> &oldest = memory.order.front();
+
+			if (oldest.second)
+			{
+				auto i = memory.outlines.find(oldest.first);
+
+				memory.size -= SizeOf(i->second);
+				memory.outlines.erase(i);
+			}
+			else
+			{
+				auto i = memory.modules.find(oldest.first);
+
+				memory.size -= i->second.size();
+				memory.modules.erase(i);
+			}
+
+			memory.order.pop_front();
+		}
+	}
+
+	// Roughly, what it takes in memory.
+	size_t CompilationCache::SizeOf(const Outline &outline)
+	{
+		size_t size = sizeof(Outline) + outline.output.size() + outline.errorOutput.size() + outline.dependencies.interface.size() * sizeof(char32_t);
+
+		for (auto &i : outline.dependencies.imports)
+		{
+			size += sizeof(i);
+
+			for (auto &j : i.names)
+			{
+				size += sizeof(j) + j.size() * sizeof(char32_t);
+			}
+		}
+
+		for (auto &i : outline.dependencies.includes)
+		{
+			size += sizeof(i);
+
+			for (auto &j : i.names)
+			{
+				size += sizeof(j) + j.size() * sizeof(char32_t);
+			}
+		}
+
+		for (auto &i : outline.dependencies.packages)
+		{
+			size += sizeof(i) + i.size() * sizeof(char32_t);
+		}
+
+		return size;
+	}
+
+	void CompilationCache::WriteFile(const string &name, const char * const data, const size_t size)
+	{
+		using std::ios;
+		using std::ofstream;
+
+		ofstream output(name, ios::out | ios::binary | ios::trunc);
+
+		if (!output.is_open())
+		{
+			throw FatalErrorCode::CANNOT_OPEN_FILE;
+		}
+
+		output.write(data, size);
+		if (!output)
+		{
+			throw FatalErrorCode::CANNOT_WRITE_FILE;
+		}
+
+		output.close();
+		if (output.fail())
+		{
+			throw FatalErrorCode::CANNOT_CLOSE_FILE;
+		}
+	}
+
+	string CompilationCache::Path(const string &key) const
+	{
+		if (mDirectoryName.empty() || mDirectoryName.back() == '/' || mDirectoryName.back() == '\\')
+		{
+			return mDirectoryName + key + CompilationCache::EXTENSION;
+		}
+
+		return mDirectoryName + '/' + key + CompilationCache::EXTENSION;
+	}
+
+	unsigned long long CompilationCache::Hash(unsigned long long hash, const char * const data, const unsigned int size)
+	{
+		for (unsigned int i = 0; i < size; i++)
+		{
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= CompilationCache::PRIME;
+		}
+
+		return hash;
+	}
+
+	string CompilationCache::Digest(unsigned long long hash)
+	{
+		static constexpr char DIGITS[] = "0123456789abcdef";
+
+		string digest(16, '0');
+
+		for (int i = 15; i >= 0; i--)
+		{
+			digest[i] = DIGITS[hash & 0xF];
+			hash >>= 4;
+		}
+
+		return digest;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef COMPILATION_CACHE
+#define COMPILATION_CACHE
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <mutex>
+#include <unordered_map>
+
+#include "Module.h"
+#include "DependencyScanner.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::string;
+	using std::u32string;
+	using std::vector;
+	using std::deque;
+	using std::pair;
+	using std::mutex;
+	using std::unordered_map;
+
+	// Compiled modules kept in a directory, each in a file named after a hash of the source bytes, the compiler version and the module format.
+	// A script that depends on others is keyed on the fingerprints of their interfaces as well, so that only a change to what it uses of them compiles it again.
+	// A hit skips every phase of the compiler. Storing is best effort, a module that cannot be stored is compiled again next time.
+	// A server keeps the modules in memory too, with or without a directory, and the outline of each script it parsed, so that a script not changed is not even parsed again.
+	class CompilationCache
+	{
+	public:
+		// What a batch needs of a script until it is compiled, and the logs of parsing it.
+		struct Outline
+		{
+			DependencyScanner::Dependencies dependencies;
+			string output;
+			string errorOutput;
+		};
+
+		explicit CompilationCache(const string &directoryName) : mDirectoryName(directoryName)	// None if empty.
+		{
+		}
+
+		string Key(const char * const data, const unsigned int size) const;
+		string Key(const string &sourceCodeFileName) const;
+		string Key(const string &key, vector<string> fingerprints) const;	// Of the source with the key, depending on the interfaces with the fingerprints, in any order.
+		bool Fetch(const string &key, const string &moduleFileName) const;	// Copies the module to the file, if it is cached and the name is not empty.
+		void Store(const string &key, const Module &module) const;
+		bool Fetch(const string &key, Outline &outline) const;	// Of the source with the key, from memory only.
+		void Store(const string &key, const Outline &outline) const;
+
+		static string Fingerprint(const u32string &interface);
+		static void KeepResident(const size_t limit);	// In bytes, past which the oldest are dropped. Nothing is kept in memory before it is called.
+		static bool IsResident();
+
+	private:
+		struct Memory
+		{
+			Memory() : size(0), limit(0)
+			{
+			}
+
+			mutex guard;
+			unordered_map<string, vector<char>> modules;
+			unordered_map<string, Outline> outlines;
+			deque<pair<string, bool>> order;	// Of the keys kept, oldest first, and whether each is of an outline.
+			size_t size;
+			size_t limit;
+		};
+
+		string Path(const string &key) const;
+
+		static Memory &Resident();
+		static void Keep(const string &key, const char * const data, const size_t size);
+		static void Trim(Memory &memory);
+		static size_t SizeOf(const Outline &outline);
+		static void WriteFile(const string &name, const char * const data, const size_t size);
+		static string Digest(unsigned long long hash);
+
+		static unsigned long long Hash(unsigned long long hash, const char * const data, const unsigned int size);
+
+		static constexpr unsigned long long OFFSET_BASIS = 14695981039346656037ull;	// 64 bit FNV-1a.
+		static constexpr unsigned long long PRIME = 1099511628211ull;
+		static constexpr char EXTENSION[] = ".lym";
+
+		const string mDirectoryName;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,392 @@
+#include "CompileServer.h"
+
+#include <new>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "Option.h"
+#include "Compiler.h"
+#include "BatchCompiler.h"
+#include "CompilationCache.h"
+#include "Logger.h"
+#include "ErrorCode.h"
+#include "FatalErrorCode.h"
+#include "ErrorLogger.h"
+
+namespace lyrics
+{
+	constexpr size_t CompileServer::RESIDENT_LIMIT;
+	constexpr size_t CompileServer::REQUEST_LIMIT;
+	constexpr int CompileServer::BACKLOG;
+	constexpr size_t CompileServer::HEADER_SIZE;
+
+#ifdef _WIN32
+	void CompileServer::Serve(const string &socketName)
+	{
+		(void)socketName;
+
+		throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+	}
+
+	int CompileServer::Request(const string &socketName, const int argc, const char * const argv[])
+	{
+		(void)socketName;
+		(void)argc;
+		(void)argv;
+
+		throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+	}
+
+	bool CompileServer::Receive(const int socket, vector<string> &request)
+	{
+		(void)socket;
+		(void)request;
+
+		return false;
+	}
+
+	bool CompileServer::Send(const int socket, const char *data, size_t size)
+	{
+		(void)socket;
+		(void)data;
+		(void)size;
+
+		return false;
+	}
+
+	string CompileServer::WorkingDirectory()
+	{
+		return string();
+	}
+#else
+	void CompileServer::Serve(const string &socketName)
+	{
+		using std::ostringstream;
+
+		sockaddr_un address;
+
+		if (socketName.size() >= sizeof(address.sun_path))
+		{
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		std::memcpy(address.sun_path, socketName.c_str(), socketName.size());
+
+		const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		if (server < 0)
+		{
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		if (bind(server, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+		{
+			// Taken over if it was left by a server that is gone, but not from one that still answers on it.
+			const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+			const bool isAnswered = client >= 0 && connect(client, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0;
+
+			if (client >= 0)
+			{
+				close(client);
+			}
+
+			if (isAnswered || unlink(socketName.c_str()) != 0 || bind(server, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+			{
+				close(server);
+
+				throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+			}
+		}
+
+		const string directoryName = WorkingDirectory();
+
+		if (directoryName.empty() || listen(server, CompileServer::BACKLOG) != 0)
+		{
+			close(server);
+			unlink(socketName.c_str());
+
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		std::signal(SIGPIPE, SIG_IGN);	// A client gone before its reply is no reason to stop.
+		CompilationCache::KeepResident(CompileServer::RESIDENT_LIMIT);
+
+		for (;;)
+		{
+			const int client = accept(server, nullptr, nullptr);
+
+			if (client < 0)
+			{
+				if (errno == EINTR || errno == ECONNABORTED)
+				{
+					continue;
+				}
+
+				break;
+			}
+
+			vector<string> request;
+
+			if (Receive(client, request))
+			{
+				ostringstream output;
+				ostringstream errorOutput;
+				const int status = Compile(request, output, errorOutput);
+				const string text = output.str();
+				const size_t length = text.size();
+				const char header[CompileServer::HEADER_SIZE] = { static_cast<char>(status), static_cast<char>(length >> 24), static_cast<char>(length >> 16), static_cast<char>(length >> 8), static_cast<char>(length) };
+				const string errorText = errorOutput.str();
+
+				if (Send(client, header, sizeof(header)) && Send(client, text.data(), text.size()))
+				{
+					Send(client, errorText.data(), errorText.size());
+				}
+
+				if (chdir(directoryName.c_str()) != 0)
+				{
+					close(client);
+					break;
+				}
+			}
+
+			close(client);
+		}
+
+		close(server);
+		unlink(socketName.c_str());
+
+		throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+	}
+
+	int CompileServer::Request(const string &socketName, const int argc, const char * const argv[])
+	{
+		sockaddr_un address;
+
+		if (socketName.size() >= sizeof(address.sun_path))
+		{
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		std::memcpy(address.sun_path, socketName.c_str(), socketName.size());
+
+		string request = WorkingDirectory();
+
+		if (request.empty())
+		{
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		request += '\0';
+
+		for (int i = 1; i < argc; i++)
+		{
+			if (std::strcmp(argv[i], "-C") == 0 && i + 1 < argc)
+			{
+				i++;
+			}
+			else if (argv[i][0] != '\0')	// An empty one would end the request.
+			{
+				request += argv[i];
+				request += '\0';
+			}
+		}
+
+		request += '\0';
+
+		const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+
+		if (client < 0)
+		{
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		if (connect(client, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 || !Send(client, request.data(), request.size()))
+		{
+			close(client);
+
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		string reply;
+		char buffer[4096];
+
+		for (;;)
+		{
+			const ssize_t size = read(client, buffer, sizeof(buffer));
+
+			if (size > 0)
+			{
+				reply.append(buffer, static_cast<size_t>(size));
+			}
+			else if (size < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		close(client);
+
+		if (reply.size() < CompileServer::HEADER_SIZE)
+		{
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		size_t length = 0;
+
+		for (size_t i = 1; i < CompileServer::HEADER_SIZE; i++)
+		{
+			length = (length << 8) | static_cast<unsigned char>(reply[i]);
+		}
+
+		if (length > reply.size() - CompileServer::HEADER_SIZE)
+		{
+			throw FatalErrorCode::CANNOT_OPEN_SOCKET;
+		}
+
+		Logger::Write(reply.substr(CompileServer::HEADER_SIZE, length), reply.substr(CompileServer::HEADER_SIZE + length));
+
+		return static_cast<unsigned char>(reply[0]);
+	}
+
+	bool CompileServer::Receive(const int socket, vector<string> &request)
+	{
+		string data;
+		char buffer[4096];
+
+		while (data.size() < 2 || data[data.size() - 1] != '\0' || data[data.size() - 2] != '\0')
+		{
+			const ssize_t size = read(socket, buffer, sizeof(buffer));
+
+			if (size < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (size <= 0 || data.size() + static_cast<size_t>(size) > CompileServer::REQUEST_LIMIT)
+			{
+				return false;
+			}
+
+			data.append(buffer, static_cast<size_t>(size));
+		}
+
+		for (size_t i = 0; data[i] != '\0'; i += request.back().size() + 1)
+		{
+			request.emplace_back(data.c_str() + i);
+		}
+
+		return !request.empty();
+	}
+
+	bool CompileServer::Send(const int socket, const char *data, size_t size)
+	{
+		while (size != 0)
+		{
+			const ssize_t written = write(socket, data, size);
+
+			if (written < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if (written <= 0)
+			{
+				return false;
+			}
+
+			data += written;
+			size -= static_cast<size_t>(written);
+		}
+
+		return true;
+	}
+
+	string CompileServer::WorkingDirectory()
+	{
+		vector<char> buffer(256);
+
+		while (!getcwd(buffer.data(), buffer.size()))
+		{
+			if (errno != ERANGE)
+			{
+				return string();
+			}
+
+			buffer.resize(buffer.size() * 2);
+		}
+
+		return buffer.data();
+	}
+#endif
+
+	// As the process would be run, except that an error raised past the compiler fails the request and not the server.
+	int CompileServer::Compile(const vector<string> &request, ostream &output, ostream &errorOutput) const
+	{
+		vector<const char *> arguments(1, "lyrics");	// Which Option skips, as it does the name of the program.
+		int status = 0;
+
+		for (size_t i = 1; i < request.size(); i++)
+		{
+			arguments.push_back(request[i].c_str());
+		}
+
+		Logger::Redirect(&output, &errorOutput);
+
+		try
+		{
+#ifndef _WIN32
+			if (chdir(request.front().c_str()) != 0)
+			{
+				throw FatalErrorCode::CANNOT_OPEN_FILE;
+			}
+#endif
+
+			const Option option(static_cast<int>(arguments.size()), arguments.data());
+
+			Logger::Configure(option.IsJsonLog() ? Logger::Format::JSON_LINES : Logger::Format::TEXT, option.ErrorLimit());
+
+			if (BatchCompiler::IsBatch(option))
+			{
+				status = BatchCompiler().Compile(option) ? 0 : 1;
+			}
+			else
+			{
+				Compiler().Compile(option);
+			}
+		}
+		catch (const FatalErrorCode fatalErrorCode)
+		{
+			ErrorLogger::FatalError(fatalErrorCode);
+			status = 1;
+		}
+		catch (const ErrorCode errorCode)
+		{
+			status = 1;
+		}
+		catch (const std::bad_alloc &e)
+		{
+			ErrorLogger::FatalError(FatalErrorCode::NOT_ENOUGH_MEMORY);
+			status = 1;
+		}
+
+		Logger::Redirect(nullptr, nullptr);
+
+		return status;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef COMPILE_SERVER
+#define COMPILE_SERVER
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::string;
+	using std::vector;
+	using std::ostream;
+
+	// Compiles for clients on a Unix domain socket, one request at a time, each as the process would with the same options from the same directory.
+	// Modules and outlines of the scripts stay in memory between requests, so that a script not changed since is neither parsed nor compiled again.
+	// A request is the working directory of the client and then its arguments, each ended by a null character, and an empty string after them.
+	// The reply is the exit status in a byte, the length of the output in four bytes, most significant first, the output and then the error output until the socket is closed.
+	class CompileServer
+	{
+	public:
+		void Serve(const string &socketName);	// Returns only by throwing, once it cannot listen.
+
+		static int Request(const string &socketName, const int argc, const char * const argv[]);	// As a client, with every argument but the ones naming the socket. The exit status.
+
+	private:
+		int Compile(const vector<string> &request, ostream &output, ostream &errorOutput) const;
+
+		static bool Receive(const int socket, vector<string> &request);
+		static bool Send(const int socket, const char *data, size_t size);
+		static string WorkingDirectory();	// Empty if it cannot be told.
+
+		static constexpr size_t RESIDENT_LIMIT = static_cast<size_t>(256) << 20;	// Bytes kept in memory.
+		static constexpr size_t REQUEST_LIMIT = static_cast<size_t>(1) << 20;
+		static constexpr int BACKLOG = 16;
+		static constexpr size_t HEADER_SIZE = 5;
+	};
+}
+
+#endif
\ No newline at end of file
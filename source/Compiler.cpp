@@ -1,10 +1,18 @@
 #include "Compiler.h"
 
+#include "Loader.h"
 #include "TextLoader.h"
 #include "Tokenizer.h"
 #include "Parser.h"
 #include "SemanticAnalyzer.h"
+#include "StaticTypeChecker.h"
+#include "CodeGenerator.h"
+#include "PassManager.h"
+#include "ModuleWriter.h"
+#include "CompilationCache.h"
+#include "Module.h"
 
+#include "ErrorCode.h"
 #include "FatalErrorCode.h"
 #include "Logger.h"
 
@@ -12,37 +20,82 @@
 
 namespace lyrics
 {
+	constexpr char Compiler::VERSION[];
+
 	void Compiler::Compile(const Option &option) const
+	{
+		string key;
+		BlockNode * const root = Parse(option, key, true);
+
+		if (root)
+		{
+			Generate(option, root, key);
+		}
+		Logger::CompilationTerminated();
+
+		return;
+	}
+
+	BlockNode *Compiler::Parse(const Option &option, string &key, const bool isFetched) const
 	{
 		if (option.SourceCodeFileName().empty())
 		{
 			throw FatalErrorCode::NO_INPUT_FILE;
 		}
 
+		char *data = nullptr;
 		char32_t *text = nullptr;
 		forward_list<Token> *tokenList = nullptr;
 		BlockNode *root = nullptr;
 
+		key.clear();
+
 		try
 		{
 			unsigned int textLength;
 
-			text = TextLoader().Load(option.SourceCodeFileName(), textLength);
+			if (option.CacheDirectoryName().empty() && !CompilationCache::IsResident())
+			{
+				text = TextLoader().Load(option.SourceCodeFileName(), textLength);
+			}
+			else
+			{
+				const CompilationCache cache(option.CacheDirectoryName());
+				unsigned int size;
+
+				data = Loader().Load(option.SourceCodeFileName(), size);
+				key = cache.Key(data, size);
+
+				if (isFetched && cache.Fetch(key, option.ModuleFileName()))
+				{
+					Utility::SafeArrayDelete(data);
+
+					return nullptr;
+				}
+
+				text = TextLoader().Decode(data, size, textLength);
+				Utility::SafeArrayDelete(data);
+			}
 
 			tokenList = Tokenizer().Tokenize(option.SourceCodeFileName(), text, textLength);
 			Utility::SafeArrayDelete(text);
+			StopIfTooManyErrors();
 
 			root = Parser().Parse(tokenList);
 			Utility::SafeDelete(tokenList);
-
-			root = SemanticAnalyzer().SemanticAnalysis(root);
-			Utility::SafeDelete(root);
+			StopIfTooManyErrors();
 		}
 		catch (const FatalErrorCode fatalErrorCode)
 		{
 			switch (fatalErrorCode)
 			{
 			case FatalErrorCode::NOT_ENOUGH_MEMORY:
+			case FatalErrorCode::CANNOT_OPEN_FILE:
+			case FatalErrorCode::CANNOT_WRITE_FILE:
+			case FatalErrorCode::CANNOT_CLOSE_FILE:
+			case FatalErrorCode::CANNOT_PARSE:
+			case FatalErrorCode::TOO_MANY_ERRORS:
+				Utility::SafeArrayDelete(data);
 				Utility::SafeArrayDelete(text);
 				Utility::SafeDelete(tokenList);
 				Utility::SafeDelete(root);
@@ -54,8 +107,65 @@ namespace lyrics
 
 			throw fatalErrorCode;
 		}
-		Logger::CompilationTerminated();
 
-		return;
+		return root;
+	}
+
+	void Compiler::Generate(const Option &option, BlockNode *root, const string &key) const
+	{
+		const CompilationCache cache(option.CacheDirectoryName());
+		Module *module = nullptr;
+
+		try
+		{
+			if (!key.empty() && cache.Fetch(key, option.ModuleFileName()))
+			{
+				Utility::SafeDelete(root);
+
+				return;
+			}
+
+			StaticTypeChecker::TypeTable typeTable;
+
+			root = SemanticAnalyzer().SemanticAnalysis(root, typeTable);
+
+			module = CodeGenerator().Generate(root, typeTable);
+			Utility::SafeDelete(root);
+
+			PassManager().Run(*module);
+
+			if (!option.ModuleFileName().empty())
+			{
+				ModuleWriter().Write(*module, option.ModuleFileName());
+			}
+			if (!key.empty())
+			{
+				cache.Store(key, *module);
+			}
+			Utility::SafeDelete(module);
+		}
+		catch (const FatalErrorCode fatalErrorCode)
+		{
+			Utility::SafeDelete(root);
+			Utility::SafeDelete(module);
+
+			throw fatalErrorCode;
+		}
+		catch (const ErrorCode errorCode)	// Of the semantic analysis, in a batch or a server that goes on.
+		{
+			Utility::SafeDelete(root);
+			Utility::SafeDelete(module);
+
+			throw errorCode;
+		}
+	}
+
+	// Between the phases, where what is held is freed on a fatal error, once errors past the limit are being dropped.
+	void Compiler::StopIfTooManyErrors()
+	{
+		if (Logger::IsErrorLimitReached())
+		{
+			throw FatalErrorCode::TOO_MANY_ERRORS;
+		}
 	}
 }
\ No newline at end of file
@@ -1,14 +1,28 @@
 #ifndef COMPILER
 #define COMPILER
 
+#include <string>
+
 #include "Option.h"
+#include "Node.h"
 
 namespace lyrics
 {
+	using std::string;
+
 	class Compiler
 	{
 	public:
 		void Compile(const Option &option) const;
+
+		// The phases of Compile, run apart by BatchCompiler, which reads the imports of a file before compiling it.
+		BlockNode *Parse(const Option &option, string &key, const bool isFetched) const;	// nullptr if isFetched and the module is copied from the cache. key is that of the cache, if any.
+		void Generate(const Option &option, BlockNode *root, const string &key) const;	// Takes root. Nothing but a copy if the cache has the module.
+
+		static constexpr char VERSION[] = "0.1.0";	// Part of the keys of CompilationCache, to be changed with anything that changes the code generated.
+
+	private:
+		static void StopIfTooManyErrors();
 	};
 }
 
@@ -0,0 +1,969 @@
+#include "ConstantFolder.h"
+
+#include <iterator>
+#include <climits>
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	BlockNode *ConstantFolder::Fold(BlockNode * const root)
+	{
+		mTypeTable = nullptr;
+
+		FoldBlock(root);
+
+		return root;
+	}
+
+	// Folds again with the types inferred, which prove the operands of the identities that are not numeric literals or operators to be numbers.
+	// Returns whether one was, after which the types are to be inferred again, as the nodes deleted are still in the table.
+	bool ConstantFolder::Refold(BlockNode * const root, const StaticTypeChecker::TypeTable &typeTable)
+	{
+		mTypeTable = &typeTable;
+		mIsInferredUsed = false;
+
+		FoldBlock(root);
+
+		mTypeTable = nullptr;
+
+		return mIsInferredUsed;
+	}
+
+	void ConstantFolder::FoldBlock(BlockNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		auto previous = node->list.before_begin();
+
+		for (auto i = node->list.begin(); i != node->list.end();)
+		{
+			if (!*i)
+			{
+				previous = i++;
+				continue;
+			}
+
+			BlockNode *block = nullptr;
+			StatementNode * const statement = FoldStatement(*i, block);
+
+			if (block)	// The statement was replaced by the statements of the branch always taken.
+			{
+				i = node->list.erase_after(previous);
+				node->list.splice_after(previous, block->list);
+				Utility::SafeDelete(block);
+
+				while (std::next(previous) != i)
+				{
+					previous++;
+				}
+			}
+			else if (!statement)
+			{
+				i = node->list.erase_after(previous);
+			}
+			else
+			{
+				*i = statement;
+				previous = i++;
+			}
+		}
+
+		node->last = previous;
+	}
+
+	StatementNode *ConstantFolder::FoldStatement(StatementNode * const node, BlockNode *&block)
+	{
+		switch (node->type)
+		{
+		case Node::Type::IF:
+			return FoldIf(static_cast<IfNode *>(node), block);
+
+		case Node::Type::CASE:
+			{
+				CaseNode * const caseNode = static_cast<CaseNode *>(node);
+
+				caseNode->value = FoldExpression(caseNode->value);
+
+				for (auto i : caseNode->list)
+				{
+					if (i)
+					{
+						i->condition = FoldExpression(i->condition);
+						FoldBlock(i->block);
+					}
+				}
+
+				FoldBlock(caseNode->block);
+			}
+			return node;
+
+		case Node::Type::WHILE:
+			{
+				WhileNode * const whileNode = static_cast<WhileNode *>(node);
+
+				whileNode->condition = FoldExpression(whileNode->condition);
+				FoldBlock(whileNode->block);
+
+				if (ConstantFolder::IsBoolean(whileNode->condition, false))
+				{
+					delete whileNode;
+					return nullptr;
+				}
+			}
+			return node;
+
+		case Node::Type::FOR:
+			{
+				ForNode * const forNode = static_cast<ForNode *>(node);
+
+				forNode->initializer = FoldExpression(forNode->initializer);
+				forNode->condition = FoldExpression(forNode->condition);
+				forNode->iterator = FoldExpression(forNode->iterator);
+				FoldBlock(forNode->block);
+
+				if (ConstantFolder::IsBoolean(forNode->condition, false))	// Only the initializer is ever evaluated.
+				{
+					ExpressionNode * const initializer = forNode->initializer;
+
+					forNode->initializer = nullptr;
+					delete forNode;
+					return initializer;
+				}
+			}
+			return node;
+
+		case Node::Type::FOREACH:
+			{
+				ForEachNode * const forEachNode = static_cast<ForEachNode *>(node);
+
+				forEachNode->variable = FoldExpression(forEachNode->variable);
+				forEachNode->collection = FoldExpression(forEachNode->collection);
+				FoldBlock(forEachNode->block);
+			}
+			return node;
+
+		case Node::Type::RETURN:
+			{
+				ReturnNode * const returnNode = static_cast<ReturnNode *>(node);
+
+				returnNode->value = FoldExpression(returnNode->value);
+			}
+			return node;
+
+		case Node::Type::IMPORT:
+		case Node::Type::BREAK:
+		case Node::Type::NEXT:
+		case Node::Type::ERROR:
+			return node;
+
+		default:
+			return FoldExpression(static_cast<ExpressionNode *>(node));
+		}
+	}
+
+	StatementNode *ConstantFolder::FoldIf(IfNode * const node, BlockNode *&block)
+	{
+		FoldBlock(node->block);
+
+		auto previous = node->list.before_begin();
+
+		for (auto i = node->list.begin(); i != node->list.end();)
+		{
+			ElseIfNode *elseIfNode = *i;
+
+			if (!elseIfNode)
+			{
+				previous = i++;
+				continue;
+			}
+
+			elseIfNode->condition = FoldExpression(elseIfNode->condition);
+			FoldBlock(elseIfNode->block);
+
+			if (ConstantFolder::IsBoolean(elseIfNode->condition, false))
+			{
+				Utility::SafeDelete(elseIfNode);
+				i = node->list.erase_after(previous);
+			}
+			else if (ConstantFolder::IsBoolean(elseIfNode->condition, true))	// Following branches are unreachable, and this one becomes the else block.
+			{
+				for (auto j = std::next(i); j != node->list.end(); j = node->list.erase_after(i))
+				{
+					Utility::SafeDelete(*j);
+				}
+
+				Utility::SafeDelete(node->block);
+				node->block = elseIfNode->block;
+				elseIfNode->block = nullptr;
+
+				Utility::SafeDelete(elseIfNode);
+				node->list.erase_after(previous);
+				break;
+			}
+			else
+			{
+				previous = i++;
+			}
+		}
+
+		node->last = previous;
+
+		if (node->list.empty())
+		{
+			block = node->block;
+			node->block = nullptr;
+
+			delete node;
+			return nullptr;
+		}
+
+		return node;
+	}
+
+	ExpressionNode *ConstantFolder::FoldExpression(ExpressionNode * const node)
+	{
+		if (!node)
+		{
+			return node;
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::ARRAY_LITERAL:
+			for (auto &i : static_cast<ArrayLiteralNode *>(node)->list)
+			{
+				i = FoldExpression(i);
+			}
+			return node;
+
+		case Node::Type::HASH_LITERAL:
+			for (auto i : static_cast<HashLiteralNode *>(node)->list)
+			{
+				if (i)
+				{
+					i->key = FoldExpression(i->key);
+					i->value = FoldExpression(i->value);
+				}
+			}
+			return node;
+
+		case Node::Type::FUNCTION_LITERAL:
+			{
+				FunctionLiteralNode * const functionLiteralNode = static_cast<FunctionLiteralNode *>(node);
+
+				for (auto i : functionLiteralNode->list)
+				{
+					if (i && i->type == Node::Type::VALUE_PARAMETER)
+					{
+						ValueParameterNode * const valueParameterNode = static_cast<ValueParameterNode *>(i);
+
+						valueParameterNode->defalutArgument = FoldExpression(valueParameterNode->defalutArgument);
+					}
+				}
+
+				FoldBlock(functionLiteralNode->block);
+			}
+			return node;
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			{
+				ParenthesizedExpressionNode * const parenthesizedExpressionNode = static_cast<ParenthesizedExpressionNode *>(node);
+
+				parenthesizedExpressionNode->expression = FoldExpression(parenthesizedExpressionNode->expression);
+
+				return ConstantFolder::Replace(parenthesizedExpressionNode, parenthesizedExpressionNode->expression);	// The tree already keeps the precedence.
+			}
+
+		case Node::Type::INDEX_REFERENCE:
+			{
+				IndexReferenceNode * const indexReferenceNode = static_cast<IndexReferenceNode *>(node);
+
+				indexReferenceNode->expression = FoldExpression(indexReferenceNode->expression);
+				indexReferenceNode->index = FoldExpression(indexReferenceNode->index);
+			}
+			return node;
+
+		case Node::Type::FUNCTION_CALL:
+			{
+				FunctionCallNode * const functionCallNode = static_cast<FunctionCallNode *>(node);
+
+				functionCallNode->expression = FoldExpression(functionCallNode->expression);
+
+				for (auto &i : functionCallNode->list)
+				{
+					i = FoldExpression(i);
+				}
+			}
+			return node;
+
+		case Node::Type::MEMBER_REFERENCE:
+			{
+				MemberReferenceNode * const memberReferenceNode = static_cast<MemberReferenceNode *>(node);
+
+				memberReferenceNode->expression = FoldExpression(memberReferenceNode->expression);
+			}
+			return node;
+
+		case Node::Type::UNARY_EXPRESSION:
+			return FoldUnary(static_cast<UnaryExpressionNode *>(node));
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			{
+				MultiplicativeExpressionNode * const multiplicativeExpressionNode = static_cast<MultiplicativeExpressionNode *>(node);
+
+				return FoldBinary(multiplicativeExpressionNode, multiplicativeExpressionNode->op, multiplicativeExpressionNode->left, multiplicativeExpressionNode->right);
+			}
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			{
+				AdditiveExpressionNode * const additiveExpressionNode = static_cast<AdditiveExpressionNode *>(node);
+
+				return FoldBinary(additiveExpressionNode, additiveExpressionNode->op, additiveExpressionNode->left, additiveExpressionNode->right);
+			}
+
+		case Node::Type::SHIFT_EXPRESSION:
+			{
+				ShiftExpressionNode * const shiftExpressionNode = static_cast<ShiftExpressionNode *>(node);
+
+				return FoldBinary(shiftExpressionNode, shiftExpressionNode->op, shiftExpressionNode->left, shiftExpressionNode->right);
+			}
+
+		case Node::Type::AND_EXPRESSION:
+			{
+				AndExpressionNode * const andExpressionNode = static_cast<AndExpressionNode *>(node);
+
+				return FoldBinary(andExpressionNode, static_cast<Token::Type>(U'&'), andExpressionNode->left, andExpressionNode->right);
+			}
+
+		case Node::Type::OR_EXPRESSION:
+			{
+				OrExpressionNode * const orExpressionNode = static_cast<OrExpressionNode *>(node);
+
+				return FoldBinary(orExpressionNode, orExpressionNode->op, orExpressionNode->left, orExpressionNode->right);
+			}
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			{
+				RelationalExpressionNode * const relationalExpressionNode = static_cast<RelationalExpressionNode *>(node);
+
+				return FoldBinary(relationalExpressionNode, relationalExpressionNode->op, relationalExpressionNode->left, relationalExpressionNode->right);
+			}
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			{
+				EqualityExpressionNode * const equalityExpressionNode = static_cast<EqualityExpressionNode *>(node);
+
+				return FoldBinary(equalityExpressionNode, equalityExpressionNode->op, equalityExpressionNode->left, equalityExpressionNode->right);
+			}
+
+		case Node::Type::LOGICAL_AND_EXPRESSION:
+			{
+				LogicalAndExpressionNode * const logicalAndExpressionNode = static_cast<LogicalAndExpressionNode *>(node);
+
+				return FoldLogical(logicalAndExpressionNode, true, logicalAndExpressionNode->left, logicalAndExpressionNode->right);
+			}
+
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			{
+				LogicalOrExpressionNode * const logicalOrExpressionNode = static_cast<LogicalOrExpressionNode *>(node);
+
+				return FoldLogical(logicalOrExpressionNode, false, logicalOrExpressionNode->left, logicalOrExpressionNode->right);
+			}
+
+		case Node::Type::ASSIGNMENT_EXPRESSION:
+			{
+				AssignmentExpressionNode * const assignmentExpressionNode = static_cast<AssignmentExpressionNode *>(node);
+
+				assignmentExpressionNode->lhs = FoldExpression(assignmentExpressionNode->lhs);
+				assignmentExpressionNode->rhs = FoldExpression(assignmentExpressionNode->rhs);
+			}
+			return node;
+
+		case Node::Type::CLASS:
+			{
+				ClassNode * const classNode = static_cast<ClassNode *>(node);
+
+				for (auto &i : classNode->list)
+				{
+					i = FoldExpression(i);
+				}
+
+				if (classNode->baseClassConstructorCall)
+				{
+					for (auto &i : classNode->baseClassConstructorCall->list)
+					{
+						i = FoldExpression(i);
+					}
+				}
+
+				FoldBlock(classNode->block);
+			}
+			return node;
+
+		case Node::Type::PACKAGE:
+			FoldBlock(static_cast<PackageNode *>(node)->block);
+			return node;
+
+		default:
+			return node;
+		}
+	}
+
+	ExpressionNode *ConstantFolder::FoldUnary(UnaryExpressionNode * const node)
+	{
+		node->expression = FoldExpression(node->expression);
+
+		Literal operand;
+
+		if (!ConstantFolder::ToLiteral(node->expression, operand))
+		{
+			return node;
+		}
+
+		Literal result;
+
+		switch (node->op)
+		{
+		case static_cast<Token::Type>(U'+'):
+			if (operand.type == Literal::Type::INTEGER || operand.type == Literal::Type::REAL)
+			{
+				return ConstantFolder::Replace(node, node->expression);
+			}
+			return node;
+
+		case static_cast<Token::Type>(U'-'):
+			if (operand.type == Literal::Type::INTEGER)
+			{
+				result = Literal(static_cast<long long>(0ull - static_cast<unsigned long long>(operand.value.integer)));
+			}
+			else if (operand.type == Literal::Type::REAL)
+			{
+				result = Literal(-operand.value.real);
+			}
+			else
+			{
+				return node;
+			}
+			break;
+
+		case static_cast<Token::Type>(U'~'):
+			if (operand.type != Literal::Type::INTEGER)
+			{
+				return node;
+			}
+			result = Literal(~operand.value.integer);
+			break;
+
+		case static_cast<Token::Type>(U'!'):
+			if (operand.type != Literal::Type::BOOLEAN)
+			{
+				return node;
+			}
+			result = Literal(!operand.value.boolean);
+			break;
+
+		default:
+			return node;
+		}
+
+		ExpressionNode * const folded = ConstantFolder::ToNode(result, node->location);
+
+		delete node;
+		return folded;
+	}
+
+	ExpressionNode *ConstantFolder::FoldBinary(ExpressionNode * const node, const Token::Type op, ExpressionNode *&left, ExpressionNode *&right)
+	{
+		left = FoldExpression(left);
+		right = FoldExpression(right);
+
+		Literal leftLiteral;
+		Literal rightLiteral;
+		Literal result;
+
+		if (ConstantFolder::ToLiteral(left, leftLiteral) && ConstantFolder::ToLiteral(right, rightLiteral) && ConstantFolder::Evaluate(op, leftLiteral, rightLiteral, result))
+		{
+			ExpressionNode * const folded = ConstantFolder::ToNode(result, node->location);
+
+			delete node;
+			return folded;
+		}
+
+		return Simplify(node, op, left, right);
+	}
+
+	ExpressionNode *ConstantFolder::FoldLogical(ExpressionNode * const node, const bool isAnd, ExpressionNode *&left, ExpressionNode *&right)
+	{
+		left = FoldExpression(left);
+		right = FoldExpression(right);
+
+		Literal leftLiteral;
+		Literal rightLiteral;
+		Literal result;
+
+		if (ConstantFolder::ToLiteral(left, leftLiteral) && ConstantFolder::ToLiteral(right, rightLiteral) && ConstantFolder::Evaluate(isAnd ? Token::Type::AND : Token::Type::OR, leftLiteral, rightLiteral, result))
+		{
+			ExpressionNode * const folded = ConstantFolder::ToNode(result, node->location);
+
+			delete node;
+			return folded;
+		}
+
+		if (ConstantFolder::IsBoolean(left, !isAnd))	// Short circuited, so the right operand is never evaluated.
+		{
+			return ConstantFolder::Replace(node, left);
+		}
+
+		if (ConstantFolder::IsBoolean(left, isAnd) && ConstantFolder::IsBoolean(right))
+		{
+			return ConstantFolder::Replace(node, right);
+		}
+
+		if (ConstantFolder::IsBoolean(right, isAnd) && ConstantFolder::IsBoolean(left))
+		{
+			return ConstantFolder::Replace(node, left);
+		}
+
+		return node;
+	}
+
+	// Identities are applied only when they keep the type of the result, e.g. x + 0 is not x when x is -0.0.
+	ExpressionNode *ConstantFolder::Simplify(ExpressionNode * const node, const Token::Type op, ExpressionNode *&left, ExpressionNode *&right)
+	{
+		switch (op)
+		{
+		case static_cast<Token::Type>(U'*'):
+			if (ConstantFolder::IsInteger(right, 1) && ConstantFolder::IsNumber(left))
+			{
+				return ConstantFolder::Replace(node, left);
+			}
+			else if (ConstantFolder::IsInteger(left, 1) && ConstantFolder::IsNumber(right))
+			{
+				return ConstantFolder::Replace(node, right);
+			}
+			break;
+
+		case static_cast<Token::Type>(U'/'):
+		case static_cast<Token::Type>(U'-'):
+			if (ConstantFolder::IsInteger(right, op == static_cast<Token::Type>(U'/') ? 1 : 0) && ConstantFolder::IsNumber(left))
+			{
+				return ConstantFolder::Replace(node, left);
+			}
+			break;
+
+		case static_cast<Token::Type>(U'+'):
+		case static_cast<Token::Type>(U'|'):
+		case static_cast<Token::Type>(U'^'):
+			if (ConstantFolder::IsInteger(right, 0) && ConstantFolder::IsInteger(left))
+			{
+				return ConstantFolder::Replace(node, left);
+			}
+			else if (ConstantFolder::IsInteger(left, 0) && ConstantFolder::IsInteger(right))
+			{
+				return ConstantFolder::Replace(node, right);
+			}
+			break;
+
+		case static_cast<Token::Type>(U'&'):
+			if (ConstantFolder::IsInteger(right, -1) && ConstantFolder::IsInteger(left))
+			{
+				return ConstantFolder::Replace(node, left);
+			}
+			else if (ConstantFolder::IsInteger(left, -1) && ConstantFolder::IsInteger(right))
+			{
+				return ConstantFolder::Replace(node, right);
+			}
+			break;
+
+		case Token::Type::SHIFT_LEFT:
+		case Token::Type::SHIFT_RIGHT:
+			if (ConstantFolder::IsInteger(right, 0) && ConstantFolder::IsInteger(left))
+			{
+				return ConstantFolder::Replace(node, left);
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		return node;
+	}
+
+	bool ConstantFolder::Evaluate(const Token::Type op, const Literal &left, const Literal &right, Literal &result)
+	{
+		const bool isInteger = left.type == Literal::Type::INTEGER && right.type == Literal::Type::INTEGER;
+		const bool isNumber = (left.type == Literal::Type::INTEGER || left.type == Literal::Type::REAL) && (right.type == Literal::Type::INTEGER || right.type == Literal::Type::REAL);
+
+		if (isInteger)
+		{
+			const long long l = left.value.integer;
+			const long long r = right.value.integer;
+			const unsigned long long ul = static_cast<unsigned long long>(l);
+			const unsigned long long ur = static_cast<unsigned long long>(r);
+
+			switch (op)
+			{
+			case static_cast<Token::Type>(U'*'):
+				result = Literal(static_cast<long long>(ul * ur));
+				return true;
+
+			case static_cast<Token::Type>(U'/'):
+			case static_cast<Token::Type>(U'%'):
+				if (r == 0 || (l == LLONG_MIN && r == -1))	// Left to fail at run time.
+				{
+					return false;
+				}
+				result = Literal(op == static_cast<Token::Type>(U'/') ? l / r : l % r);
+				return true;
+
+			case static_cast<Token::Type>(U'+'):
+				result = Literal(static_cast<long long>(ul + ur));
+				return true;
+
+			case static_cast<Token::Type>(U'-'):
+				result = Literal(static_cast<long long>(ul - ur));
+				return true;
+
+			case Token::Type::SHIFT_LEFT:
+				if (r < 0 || r > 63)
+				{
+					return false;
+				}
+				result = Literal(static_cast<long long>(ul << r));
+				return true;
+
+			case Token::Type::SHIFT_RIGHT:
+				if (r < 0 || r > 63)
+				{
+					return false;
+				}
+				result = Literal(l < 0 ? ~(~l >> r) : l >> r);
+				return true;
+
+			case static_cast<Token::Type>(U'&'):
+				result = Literal(l & r);
+				return true;
+
+			case static_cast<Token::Type>(U'|'):
+				result = Literal(l | r);
+				return true;
+
+			case static_cast<Token::Type>(U'^'):
+				result = Literal(l ^ r);
+				return true;
+
+			case static_cast<Token::Type>(U'<'):
+				result = Literal(l < r);
+				return true;
+
+			case static_cast<Token::Type>(U'>'):
+				result = Literal(l > r);
+				return true;
+
+			case Token::Type::LESS_THAN_OR_EQUAL:
+				result = Literal(l <= r);
+				return true;
+
+			case Token::Type::GREATER_THAN_OR_EQUAL:
+				result = Literal(l >= r);
+				return true;
+
+			case Token::Type::EQUAL:
+				result = Literal(l == r);
+				return true;
+
+			case Token::Type::NOT_EQUAL:
+				result = Literal(l != r);
+				return true;
+
+			default:
+				return false;
+			}
+		}
+		else if (isNumber)
+		{
+			const double l = left.type == Literal::Type::INTEGER ? static_cast<double>(left.value.integer) : left.value.real;
+			const double r = right.type == Literal::Type::INTEGER ? static_cast<double>(right.value.integer) : right.value.real;
+
+			switch (op)
+			{
+			case static_cast<Token::Type>(U'*'):
+				result = Literal(l * r);
+				return true;
+
+			case static_cast<Token::Type>(U'/'):
+				if (r == 0.0)
+				{
+					return false;
+				}
+				result = Literal(l / r);
+				return true;
+
+			case static_cast<Token::Type>(U'+'):
+				result = Literal(l + r);
+				return true;
+
+			case static_cast<Token::Type>(U'-'):
+				result = Literal(l - r);
+				return true;
+
+			case static_cast<Token::Type>(U'<'):
+				result = Literal(l < r);
+				return true;
+
+			case static_cast<Token::Type>(U'>'):
+				result = Literal(l > r);
+				return true;
+
+			case Token::Type::LESS_THAN_OR_EQUAL:
+				result = Literal(l <= r);
+				return true;
+
+			case Token::Type::GREATER_THAN_OR_EQUAL:
+				result = Literal(l >= r);
+				return true;
+
+			case Token::Type::EQUAL:
+				result = Literal(l == r);
+				return true;
+
+			case Token::Type::NOT_EQUAL:
+				result = Literal(l != r);
+				return true;
+
+			default:
+				return false;
+			}
+		}
+		else if (left.type == right.type && (op == Token::Type::EQUAL || op == Token::Type::NOT_EQUAL))
+		{
+			bool isEqual;
+
+			switch (left.type)
+			{
+			case Literal::Type::NULL_LITERAL:
+				isEqual = true;
+				break;
+
+			case Literal::Type::BOOLEAN:
+				isEqual = left.value.boolean == right.value.boolean;
+				break;
+
+			case Literal::Type::STRING:
+				isEqual = *left.value.string == *right.value.string;
+				break;
+
+			default:
+				return false;
+			}
+
+			result = Literal(op == Token::Type::EQUAL ? isEqual : !isEqual);
+			return true;
+		}
+		else if (left.type == Literal::Type::BOOLEAN && right.type == Literal::Type::BOOLEAN && (op == Token::Type::AND || op == Token::Type::OR))
+		{
+			result = Literal(op == Token::Type::AND ? left.value.boolean && right.value.boolean : left.value.boolean || right.value.boolean);
+			return true;
+		}
+
+		return false;
+	}
+
+	bool ConstantFolder::ToLiteral(const ExpressionNode * const node, Literal &literal)
+	{
+		if (!node)
+		{
+			return false;
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::NULL_LITERAL:
+			literal = Literal();
+			return true;
+
+		case Node::Type::BOOLEAN_LITERAL:
+			literal = Literal(static_cast<const BooleanLiteralNode *>(node)->boolean);
+			return true;
+
+		case Node::Type::INTEGER_LITERAL:
+			literal = Literal(static_cast<const IntegerLiteralNode *>(node)->integer);
+			return true;
+
+		case Node::Type::REAL_LITERAL:
+			literal = Literal(static_cast<const RealLiteralNode *>(node)->real);
+			return true;
+
+		case Node::Type::STRING_LITERAL:
+			literal = Literal(Literal::Type::STRING, static_cast<const StringLiteralNode *>(node)->string);
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	ExpressionNode *ConstantFolder::ToNode(const Literal &literal, const Location &location)
+	{
+		switch (literal.type)
+		{
+		case Literal::Type::BOOLEAN:
+			return new BooleanLiteralNode(location, literal.value.boolean);
+
+		case Literal::Type::INTEGER:
+			return new IntegerLiteralNode(location, literal.value.integer);
+
+		case Literal::Type::REAL:
+			return new RealLiteralNode(location, literal.value.real);
+
+		default:
+			return new NullLiteralNode(location);
+		}
+	}
+
+	bool ConstantFolder::IsBoolean(const ExpressionNode * const node, const bool boolean)
+	{
+		return node && node->type == Node::Type::BOOLEAN_LITERAL && static_cast<const BooleanLiteralNode *>(node)->boolean == boolean;
+	}
+
+	bool ConstantFolder::IsInteger(const ExpressionNode * const node, const long long integer)
+	{
+		return node && node->type == Node::Type::INTEGER_LITERAL && static_cast<const IntegerLiteralNode *>(node)->integer == integer;
+	}
+
+	bool ConstantFolder::IsBoolean(const ExpressionNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::BOOLEAN_LITERAL:
+		case Node::Type::RELATIONAL_EXPRESSION:
+		case Node::Type::EQUALITY_EXPRESSION:
+		case Node::Type::LOGICAL_AND_EXPRESSION:
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			return true;
+
+		case Node::Type::UNARY_EXPRESSION:
+			return static_cast<const UnaryExpressionNode *>(node)->op == static_cast<Token::Type>(U'!');
+
+		default:
+			return false;
+		}
+	}
+
+	// Bitwise and shift operators are defined only on integers.
+	bool ConstantFolder::IsInteger(const ExpressionNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::INTEGER_LITERAL:
+		case Node::Type::SHIFT_EXPRESSION:
+		case Node::Type::AND_EXPRESSION:
+		case Node::Type::OR_EXPRESSION:
+			return true;
+
+		case Node::Type::UNARY_EXPRESSION:
+			{
+				const UnaryExpressionNode * const unaryExpressionNode = static_cast<const UnaryExpressionNode *>(node);
+
+				return unaryExpressionNode->op == static_cast<Token::Type>(U'~') || (unaryExpressionNode->op != static_cast<Token::Type>(U'!') && ConstantFolder::IsInteger(unaryExpressionNode->expression));
+			}
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			{
+				const MultiplicativeExpressionNode * const multiplicativeExpressionNode = static_cast<const MultiplicativeExpressionNode *>(node);
+
+				return ConstantFolder::IsInteger(multiplicativeExpressionNode->left) && ConstantFolder::IsInteger(multiplicativeExpressionNode->right);
+			}
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			{
+				const AdditiveExpressionNode * const additiveExpressionNode = static_cast<const AdditiveExpressionNode *>(node);
+
+				return ConstantFolder::IsInteger(additiveExpressionNode->left) && ConstantFolder::IsInteger(additiveExpressionNode->right);
+			}
+
+		default:
+			return ConstantFolder::IsInferred(node, StaticTypeChecker::TypeOf(Literal::Type::INTEGER));
+		}
+	}
+
+	bool ConstantFolder::IsNumber(const ExpressionNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::REAL_LITERAL:
+			return true;
+
+		case Node::Type::UNARY_EXPRESSION:
+			{
+				const UnaryExpressionNode * const unaryExpressionNode = static_cast<const UnaryExpressionNode *>(node);
+
+				return unaryExpressionNode->op != static_cast<Token::Type>(U'!') && ConstantFolder::IsNumber(unaryExpressionNode->expression);
+			}
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			{
+				const MultiplicativeExpressionNode * const multiplicativeExpressionNode = static_cast<const MultiplicativeExpressionNode *>(node);
+
+				return ConstantFolder::IsNumber(multiplicativeExpressionNode->left) && ConstantFolder::IsNumber(multiplicativeExpressionNode->right);
+			}
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			{
+				const AdditiveExpressionNode * const additiveExpressionNode = static_cast<const AdditiveExpressionNode *>(node);
+
+				return ConstantFolder::IsNumber(additiveExpressionNode->left) && ConstantFolder::IsNumber(additiveExpressionNode->right);
+			}
+
+		default:
+			return ConstantFolder::IsInteger(node) || ConstantFolder::IsInferred(node, StaticTypeChecker::TypeOf(Literal::Type::INTEGER) | StaticTypeChecker::TypeOf(Literal::Type::REAL));
+		}
+	}
+
+	// Whether every type the node can evaluate to is in the set. Literals created by folding are never looked up, as they may reuse the address of a node deleted.
+	bool ConstantFolder::IsInferred(const ExpressionNode * const node, const StaticTypeChecker::TypeSet typeSet)
+	{
+		if (!mTypeTable)
+		{
+			return false;
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::NULL_LITERAL:
+		case Node::Type::BOOLEAN_LITERAL:
+		case Node::Type::INTEGER_LITERAL:
+		case Node::Type::REAL_LITERAL:
+			return false;
+
+		default:
+			break;
+		}
+
+		auto inferred = mTypeTable->find(node);
+
+		if (inferred == mTypeTable->cend() || inferred->second == StaticTypeChecker::NONE || (inferred->second & ~typeSet) != 0u)
+		{
+			return false;
+		}
+
+		mIsInferredUsed = true;
+
+		return true;
+	}
+
+	ExpressionNode *ConstantFolder::Replace(ExpressionNode * const node, ExpressionNode *&child)
+	{
+		ExpressionNode * const replacement = child;
+
+		child = nullptr;
+		delete node;
+
+		return replacement;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef CONSTANT_FOLDER
+#define CONSTANT_FOLDER
+
+#include "Token.h"
+#include "Location.h"
+#include "Node.h"
+#include "Literal.h"
+#include "StaticTypeChecker.h"
+
+namespace lyrics
+{
+	class ConstantFolder
+	{
+	public:
+		BlockNode *Fold(BlockNode * const root);
+		bool Refold(BlockNode * const root, const StaticTypeChecker::TypeTable &typeTable);
+
+	private:
+		void FoldBlock(BlockNode * const node);
+		StatementNode *FoldStatement(StatementNode * const node, BlockNode *&block);
+		ExpressionNode *FoldExpression(ExpressionNode * const node);
+		StatementNode *FoldIf(IfNode * const node, BlockNode *&block);
+		ExpressionNode *FoldUnary(UnaryExpressionNode * const node);
+		ExpressionNode *FoldBinary(ExpressionNode * const node, const Token::Type op, ExpressionNode *&left, ExpressionNode *&right);
+		ExpressionNode *FoldLogical(ExpressionNode * const node, const bool isAnd, ExpressionNode *&left, ExpressionNode *&right);
+		ExpressionNode *Simplify(ExpressionNode * const node, const Token::Type op, ExpressionNode *&left, ExpressionNode *&right);
+
+		static bool Evaluate(const Token::Type op, const Literal &left, const Literal &right, Literal &result);
+		static bool ToLiteral(const ExpressionNode * const node, Literal &literal);
+		static ExpressionNode *ToNode(const Literal &literal, const Location &location);
+		static bool IsBoolean(const ExpressionNode * const node, const bool boolean);
+		static bool IsInteger(const ExpressionNode * const node, const long long integer);
+		static bool IsBoolean(const ExpressionNode * const node);
+		bool IsInteger(const ExpressionNode * const node);
+		bool IsNumber(const ExpressionNode * const node);
+		bool IsInferred(const ExpressionNode * const node, const StaticTypeChecker::TypeSet typeSet);
+		static ExpressionNode *Replace(ExpressionNode * const node, ExpressionNode *&child);
+
+		const StaticTypeChecker::TypeTable *mTypeTable;	// Or nullptr before the types are inferred.
+		bool mIsInferredUsed;
+	};
+}
+
+#endif
\ No newline at end of file
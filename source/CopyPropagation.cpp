@@ -0,0 +1,76 @@
+#include "CopyPropagation.h"
+
+namespace lyrics
+{
+	void CopyPropagation::Run(IR &ir)
+	{
+		vector<IR::Value *> state;
+
+		for (auto i : ir.blocks)
+		{
+			state.resize(i->values.size());
+
+			for (size_t j = 0; j < state.size(); j++)
+			{
+				state[j] = IR::Resolve(i->values[j]);
+			}
+
+			const vector<IR::Instruction *> instructions = i->instructions;
+
+			for (auto j : instructions)
+			{
+				for (size_t k = 0; k < j->operands.size(); k++)
+				{
+					if (j->fields[k] != IR::Field::IMPLICIT)
+					{
+						IR::Value * const found = CopyPropagation::Find(state, IR::Root(j->operands[k]));
+
+						if (found && found->location != j->operands[k]->location)
+						{
+							IR::SetOperand(j, k, found);
+						}
+					}
+				}
+
+				if (j->IsCopy())
+				{
+					IR::Value * const result = j->results.front();
+					IR::Value * const held = state[result->location];
+
+					if (IR::Root(held) == IR::Root(j->operands.front()))
+					{
+						IR::Replace(result, held);
+						IR::Remove(j);
+						continue;
+					}
+				}
+
+				for (auto k : j->results)
+				{
+					state[k->location] = k;
+				}
+			}
+		}
+	}
+
+	// The first register holding the value itself, or else the first holding a copy of it.
+	IR::Value *CopyPropagation::Find(const vector<IR::Value *> &state, IR::Value * const root)
+	{
+		IR::Value *copy = nullptr;
+
+		for (unsigned short i = 0; IR::IsRegister(i); i++)
+		{
+			if (state[i] == root)
+			{
+				return state[i];
+			}
+
+			if (!copy && IR::Root(state[i]) == root)
+			{
+				copy = state[i];
+			}
+		}
+
+		return copy;
+	}
+}
\ No newline at end of file
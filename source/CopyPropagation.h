@@ -0,0 +1,24 @@
+#ifndef COPY_PROPAGATION
+#define COPY_PROPAGATION
+
+#include <vector>
+
+#include "Pass.h"
+#include "IR.h"
+
+namespace lyrics
+{
+	using std::vector;
+
+	// Makes the code read a value from the register it was copied from while that register still holds it, and drops the copies to a location that holds the value already.
+	class CopyPropagation : public Pass
+	{
+	public:
+		virtual void Run(IR &ir);
+
+	private:
+		static IR::Value *Find(const vector<IR::Value *> &state, IR::Value * const root);
+	};
+}
+
+#endif
\ No newline at end of file
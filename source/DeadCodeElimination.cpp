@@ -0,0 +1,111 @@
+#include "DeadCodeElimination.h"
+
+#include <vector>
+#include <unordered_set>
+
+namespace lyrics
+{
+	using std::vector;
+	using std::unordered_set;
+
+	void DeadCodeElimination::Run(IR &ir)
+	{
+		unordered_set<const IR::Instruction *> live;
+		vector<IR::Instruction *> work;
+
+		for (auto i : ir.blocks)
+		{
+			for (auto j : i->instructions)
+			{
+				if (j->hasSideEffect)
+				{
+					live.insert(j);
+					work.push_back(j);
+				}
+			}
+		}
+
+		while (!work.empty())
+		{
+			const IR::Instruction * const instruction = work.back();
+
+			work.pop_back();
+
+			for (auto i : instruction->operands)
+			{
+				IR::Instruction * const definition = i->definition;
+
+				if (definition && live.insert(definition).second)
+				{
+					work.push_back(definition);
+				}
+			}
+		}
+
+		// A location keeps the value it had before a dead instruction, so its results are replaced with that.
+		vector<IR::Value *> state;
+
+		for (auto i : ir.blocks)
+		{
+			vector<IR::Instruction *> instructions;
+			vector<IR::Instruction *> phis;
+
+			// Nothing live reads a dead phi, which would otherwise tie the values it joins together.
+			for (auto j : i->phis)
+			{
+				if (live.count(j) != 0)
+				{
+					phis.push_back(j);
+				}
+				else
+				{
+					for (auto k : j->operands)
+					{
+						IR::RemoveUse(k, j);
+					}
+
+					j->operands.clear();
+					j->fields.clear();
+				}
+			}
+
+			i->phis.swap(phis);
+			state.resize(i->values.size());
+
+			for (size_t j = 0; j < state.size(); j++)
+			{
+				state[j] = IR::Resolve(i->values[j]);
+			}
+
+			for (auto j : i->instructions)
+			{
+				if (live.count(j) != 0)
+				{
+					instructions.push_back(j);
+
+					for (auto k : j->results)
+					{
+						state[k->location] = k;
+					}
+				}
+				else
+				{
+					for (auto k : j->operands)
+					{
+						IR::RemoveUse(k, j);
+					}
+
+					j->operands.clear();
+					j->fields.clear();
+
+					for (auto k : j->results)
+					{
+						IR::Replace(k, state[k->location]);
+					}
+				}
+			}
+
+			i->instructions.swap(instructions);
+		}
+	}
+}
\ No newline at end of file
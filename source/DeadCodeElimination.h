@@ -0,0 +1,17 @@
+#ifndef DEAD_CODE_ELIMINATION
+#define DEAD_CODE_ELIMINATION
+
+#include "Pass.h"
+#include "IR.h"
+
+namespace lyrics
+{
+	// Drops the instructions that have no side effect and whose results nothing live uses, stores to frame slots included.
+	class DeadCodeElimination : public Pass
+	{
+	public:
+		virtual void Run(IR &ir);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include "DependencyScanner.h"
+
+namespace lyrics
+{
+	void DependencyScanner::Scan(const BlockNode * const root, Dependencies &dependencies)
+	{
+		mDependencies = &dependencies;
+
+		for (auto i : root->list)
+		{
+			if (i && i->type == Node::Type::ASSIGNMENT_EXPRESSION)
+			{
+				const AssignmentExpressionNode * const assignment = static_cast<const AssignmentExpressionNode *>(i);
+
+				if (assignment->lhs->type != Node::Type::IDENTIFIER || !assignment->rhs)
+				{
+					continue;
+				}
+
+				const u32string &name = *static_cast<const IdentifierNode *>(assignment->lhs)->identifier;
+
+				if (assignment->rhs->type == Node::Type::PACKAGE)
+				{
+					dependencies.packages.push_back(name);
+				}
+
+				if (assignment->rhs->type == Node::Type::PACKAGE || assignment->rhs->type == Node::Type::CLASS)
+				{
+					Describe(name, assignment->rhs);
+				}
+			}
+		}
+
+		ScanBlock(root);
+	}
+
+	void DependencyScanner::ScanBlock(const BlockNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		for (auto i : node->list)
+		{
+			if (i)
+			{
+				ScanStatement(i);
+			}
+		}
+	}
+
+	void DependencyScanner::ScanStatement(const StatementNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::IMPORT:
+			mDependencies->imports.emplace_back(node->location);
+
+			for (auto i : static_cast<const ImportNode *>(node)->list)
+			{
+				mDependencies->imports.back().names.push_back(*i->identifier);
+			}
+			break;
+
+		case Node::Type::BREAK:
+		case Node::Type::NEXT:
+			break;
+
+		case Node::Type::IF:
+			for (auto i : static_cast<const IfNode *>(node)->list)
+			{
+				ScanExpression(i->condition);
+				ScanBlock(i->block);
+			}
+
+			ScanBlock(static_cast<const IfNode *>(node)->block);
+			break;
+
+		case Node::Type::CASE:
+			ScanExpression(static_cast<const CaseNode *>(node)->value);
+
+			for (auto i : static_cast<const CaseNode *>(node)->list)
+			{
+				ScanExpression(i->condition);
+				ScanBlock(i->block);
+			}
+
+			ScanBlock(static_cast<const CaseNode *>(node)->block);
+			break;
+
+		case Node::Type::WHILE:
+			ScanExpression(static_cast<const WhileNode *>(node)->condition);
+			ScanBlock(static_cast<const WhileNode *>(node)->block);
+			break;
+
+		case Node::Type::FOR:
+			ScanExpression(static_cast<const ForNode *>(node)->initializer);
+			ScanExpression(static_cast<const ForNode *>(node)->condition);
+			ScanExpression(static_cast<const ForNode *>(node)->iterator);
+			ScanBlock(static_cast<const ForNode *>(node)->block);
+			break;
+
+		case Node::Type::FOREACH:
+			ScanExpression(static_cast<const ForEachNode *>(node)->collection);
+			ScanBlock(static_cast<const ForEachNode *>(node)->block);
+			break;
+
+		case Node::Type::RETURN:
+			ScanExpression(static_cast<const ReturnNode *>(node)->value);
+			break;
+
+		case Node::Type::ERROR:
+			break;
+
+		default:
+			ScanExpression(static_cast<const ExpressionNode *>(node));
+			break;
+		}
+	}
+
+	void DependencyScanner::ScanExpression(const ExpressionNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::ARRAY_LITERAL:
+			ScanList(static_cast<const ArrayLiteralNode *>(node)->list);
+			break;
+
+		case Node::Type::HASH_LITERAL:
+			for (auto i : static_cast<const HashLiteralNode *>(node)->list)
+			{
+				ScanExpression(i->key);
+				ScanExpression(i->value);
+			}
+			break;
+
+		case Node::Type::FUNCTION_LITERAL:
+			for (auto i : static_cast<const FunctionLiteralNode *>(node)->list)
+			{
+				if (i->type == Node::Type::VALUE_PARAMETER)
+				{
+					ScanExpression(static_cast<const ValueParameterNode *>(i)->defalutArgument);
+				}
+			}
+
+			ScanBlock(static_cast<const FunctionLiteralNode *>(node)->block);
+			break;
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			ScanExpression(static_cast<const ParenthesizedExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			ScanExpression(static_cast<const IndexReferenceNode *>(node)->expression);
+			ScanExpression(static_cast<const IndexReferenceNode *>(node)->index);
+			break;
+
+		case Node::Type::FUNCTION_CALL:
+			ScanExpression(static_cast<const FunctionCallNode *>(node)->expression);
+			ScanList(static_cast<const FunctionCallNode *>(node)->list);
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			ScanExpression(static_cast<const MemberReferenceNode *>(node)->expression);
+			break;
+
+		case Node::Type::UNARY_EXPRESSION:
+			ScanExpression(static_cast<const UnaryExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			ScanExpression(static_cast<const MultiplicativeExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const MultiplicativeExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			ScanExpression(static_cast<const AdditiveExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const AdditiveExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::SHIFT_EXPRESSION:
+			ScanExpression(static_cast<const ShiftExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const ShiftExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::AND_EXPRESSION:
+			ScanExpression(static_cast<const AndExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const AndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::OR_EXPRESSION:
+			ScanExpression(static_cast<const OrExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const OrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			ScanExpression(static_cast<const RelationalExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const RelationalExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			ScanExpression(static_cast<const EqualityExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const EqualityExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_AND_EXPRESSION:
+			ScanExpression(static_cast<const LogicalAndExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const LogicalAndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			ScanExpression(static_cast<const LogicalOrExpressionNode *>(node)->left);
+			ScanExpression(static_cast<const LogicalOrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ASSIGNMENT_EXPRESSION:
+			ScanExpression(static_cast<const AssignmentExpressionNode *>(node)->lhs);
+			ScanExpression(static_cast<const AssignmentExpressionNode *>(node)->rhs);
+			break;
+
+		case Node::Type::CLASS:
+			{
+				const ClassNode * const classNode = static_cast<const ClassNode *>(node);
+
+				ScanList(classNode->list);
+
+				if (classNode->baseClassConstructorCall)
+				{
+					ScanList(classNode->baseClassConstructorCall->list);
+				}
+
+				if (classNode->include)
+				{
+					for (auto i : classNode->include->list)
+					{
+						mDependencies->includes.emplace_back(i->location);
+						mDependencies->includes.back().names.push_back(*i->identifier);
+					}
+				}
+
+				ScanBlock(classNode->block);
+			}
+			break;
+
+		case Node::Type::PACKAGE:
+			ScanBlock(static_cast<const PackageNode *>(node)->block);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void DependencyScanner::ScanList(const forward_list<ExpressionNode *> &list)
+	{
+		for (auto i : list)
+		{
+			ScanExpression(i);
+		}
+	}
+
+	// Bodies and values are left out, a change to them does not change how the names are used.
+	void DependencyScanner::Describe(const u32string &name, const ExpressionNode * const node)
+	{
+		u32string &interface = mDependencies->interface;
+
+		switch (node ? node->type : Node::Type::IDENTIFIER)
+		{
+		case Node::Type::PACKAGE:
+			interface += U"package " + name + U" {";
+			DescribeMembers(static_cast<const PackageNode *>(node)->block);
+			interface += U'}';
+			break;
+
+		case Node::Type::CLASS:
+			{
+				const ClassNode * const classNode = static_cast<const ClassNode *>(node);
+
+				interface += U"class " + name + U'(';
+
+				for (auto i : classNode->list)
+				{
+					DescribeParameter(i);
+				}
+
+				interface += U')';
+
+				if (classNode->baseClassConstructorCall && classNode->baseClassConstructorCall->baseClass)
+				{
+					interface += U" : " + *classNode->baseClassConstructorCall->baseClass->identifier;
+				}
+
+				if (classNode->include)
+				{
+					interface += U" include";
+
+					for (auto i : classNode->include->list)
+					{
+						interface += U' ' + *i->identifier;
+					}
+				}
+
+				interface += U" {";
+				DescribeMembers(classNode->block);
+				interface += U'}';
+			}
+			break;
+
+		case Node::Type::FUNCTION_LITERAL:
+			interface += U"do " + name + U'(';
+
+			for (auto i : static_cast<const FunctionLiteralNode *>(node)->list)
+			{
+				if (i->type == Node::Type::OUTPUT_PARAMETER)
+				{
+					interface += U"out ";
+				}
+
+				interface += *i->name->identifier;
+
+				if (i->type == Node::Type::VALUE_PARAMETER && static_cast<const ValueParameterNode *>(i)->defalutArgument)
+				{
+					interface += U'=';
+				}
+
+				interface += U',';
+			}
+
+			interface += U')';
+			break;
+
+		default:
+			interface += name;
+			break;
+		}
+
+		interface += U';';
+	}
+
+	void DependencyScanner::DescribeMembers(const BlockNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		for (auto i : node->list)
+		{
+			if (i && i->type == Node::Type::ASSIGNMENT_EXPRESSION)
+			{
+				const AssignmentExpressionNode * const assignment = static_cast<const AssignmentExpressionNode *>(i);
+
+				if (assignment->lhs->type == Node::Type::IDENTIFIER)
+				{
+					Describe(*static_cast<const IdentifierNode *>(assignment->lhs)->identifier, assignment->rhs);
+				}
+			}
+		}
+	}
+
+	void DependencyScanner::DescribeParameter(const ExpressionNode * const node)
+	{
+		u32string &interface = mDependencies->interface;
+
+		if (node && node->type == Node::Type::IDENTIFIER)
+		{
+			interface += *static_cast<const IdentifierNode *>(node)->identifier;
+		}
+		else if (node && node->type == Node::Type::ASSIGNMENT_EXPRESSION && static_cast<const AssignmentExpressionNode *>(node)->lhs->type == Node::Type::IDENTIFIER)
+		{
+			interface += *static_cast<const IdentifierNode *>(static_cast<const AssignmentExpressionNode *>(node)->lhs)->identifier + U'=';
+		}
+		else
+		{
+			interface += U'?';
+		}
+
+		interface += U',';
+	}
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef DEPENDENCY_SCANNER
+#define DEPENDENCY_SCANNER
+
+#include <string>
+#include <vector>
+#include <forward_list>
+
+#include "Node.h"
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::vector;
+	using std::forward_list;
+
+	// Finds what a script needs from other scripts, the modules it imports and the packages its classes include, and the packages it defines for them.
+	// Describes what the packages and classes it defines show to other scripts too, so that a change to anything else is not taken for a change to them.
+	class DependencyScanner
+	{
+	public:
+		// A name, dotted for an import, and where the script gives it. Apart from the tree, so that it can be kept once the tree is gone.
+		struct Reference
+		{
+			explicit Reference(const Location &location) : location(location)
+			{
+			}
+
+			vector<u32string> names;
+			Location location;
+		};
+
+		struct Dependencies
+		{
+			vector<Reference> imports;
+			vector<Reference> includes;
+			vector<u32string> packages;	// Assigned at the top level.
+			u32string interface;	// The names, parameters, base classes and includes of the packages and classes assigned at the top level and of their members.
+		};
+
+		void Scan(const BlockNode * const root, Dependencies &dependencies);
+
+	private:
+		void ScanBlock(const BlockNode * const node);
+		void ScanStatement(const StatementNode * const node);
+		void ScanExpression(const ExpressionNode * const node);
+		void ScanList(const forward_list<ExpressionNode *> &list);
+		void Describe(const u32string &name, const ExpressionNode * const node);
+		void DescribeMembers(const BlockNode * const node);
+		void DescribeParameter(const ExpressionNode * const node);
+
+		Dependencies *mDependencies;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -624,21 +624,9 @@ namespace lyrics
 
 	bool DereferenceChecker::Visit(const ImportNode * const node)
 	{
-		bool canProgress = true;
+		(void)node;	// The names are of a script, which BatchCompiler finds, not of variables.
 
-		for (auto i : node->list)
-		{
-			if (i)
-			{
-				canProgress &= i->Accept(*this);
-			}
-			else
-			{
-				canProgress = false;
-			}
-		}
-
-		return canProgress;
+		return true;
 	}
 
 	bool DereferenceChecker::Visit(const IfNode * const node)
@@ -861,4 +849,10 @@ namespace lyrics
 
 		return canProgress;
 	}
+	bool DereferenceChecker::Visit(const ErrorNode * const node)
+	{
+		(void)node;	// Hide warning.
+
+		return false;
+	}
 }
\ No newline at end of file
@@ -46,6 +46,7 @@ namespace lyrics
 		virtual bool Visit(const ForNode * const node);
 		virtual bool Visit(const ForEachNode * const node);
 		virtual bool Visit(const ReturnNode * const node);
+		virtual bool Visit(const ErrorNode * const node);
 	};
 }
 
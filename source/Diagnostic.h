@@ -0,0 +1,39 @@
+#ifndef DIAGNOSTIC
+#define DIAGNOSTIC
+
+#include "Location.h"
+
+namespace lyrics
+{
+	// A log with a location, kept to be written later or for a client to show. The message is a literal, which is not copied.
+	struct Diagnostic
+	{
+		enum struct Severity : unsigned char { WARNING, ERROR, FATAL_ERROR };
+
+		Diagnostic(const Location &location, const Severity severity, const unsigned int code, const char * const message) : location(location), severity(severity), code(code), message(message)
+		{
+		}
+
+		static const char *Name(const Severity severity)	// As it is written in a log.
+		{
+			switch (severity)
+			{
+			case Severity::WARNING:
+				return "warning";
+
+			case Severity::ERROR:
+				return "error";
+
+			default:
+				return "fatal error";
+			}
+		}
+
+		Location location;
+		Severity severity;
+		unsigned int code;
+		const char *message;	// Empty if there is no text for the code.
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,779 @@
+#include "Document.h"
+
+#include <algorithm>
+#include <iterator>
+#include <new>
+
+#include "Tokenizer.h"
+#include "Logger.h"
+
+#include "FatalErrorCode.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	Document::Document(const string &fileName, const u32string &text) : mFileName(fileName), mText(text), mRoot(nullptr), mShift(nullptr), mBlocks(nullptr)
+	{
+		using std::bad_alloc;
+
+		vector<Diagnostic> * const captured = Logger::Captured();
+		Parser::Spans spans;
+
+		Logger::Capture(&mDiagnostics);
+
+		try
+		{
+			forward_list<Token> *tokenList = Tokenizer().Tokenize(mFileName, mText.data(), static_cast<unsigned int>(mText.size()));
+
+			mTokens.swap(*tokenList);
+			Utility::SafeDelete(tokenList);
+
+			mRoot = Parser().Parse(&mTokens, spans);
+		}
+		catch (...)
+		{
+			Logger::Capture(captured);
+
+			for (auto &i : mTokens)
+			{
+				Release(i);
+			}
+
+			throw;
+		}
+
+		Logger::Capture(captured);
+
+		try
+		{
+			unordered_set<const BlockNode *> blocks;
+
+			mBlocks = &blocks;
+			Walk(mRoot);
+			mBlocks = nullptr;
+
+			Keep(spans, blocks);
+		}
+		catch (const bad_alloc &e)
+		{
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+	}
+
+	Document::~Document()
+	{
+		Utility::SafeDelete(mRoot);
+
+		for (auto &i : mTokens)
+		{
+			Release(i);
+		}
+	}
+
+	void Document::Edit(unsigned int offset, unsigned int length, const u32string &text)
+	{
+		using std::bad_alloc;
+
+		offset = std::min(offset, static_cast<unsigned int>(mText.size()));
+		length = std::min(length, static_cast<unsigned int>(mText.size()) - offset);
+
+		vector<Diagnostic> * const captured = Logger::Captured();
+
+		try
+		{
+			const long long delta = static_cast<long long>(text.size()) - length;
+			const unsigned int end = offset + static_cast<unsigned int>(text.size());
+
+			mText.replace(offset, length, text);
+
+			// From the last token starting before the edit, which may run into it.
+			auto beforeFirst = mTokens.before_begin();
+
+			for (auto i = mTokens.before_begin(), j = mTokens.begin(); j->type != Token::Type::END_OF_FILE && j->offset < offset; i = j++)
+			{
+				beforeFirst = i;
+			}
+
+			const auto first = std::next(beforeFirst);
+			const bool isAfterFirst = first->type != Token::Type::END_OF_FILE && first->offset < offset;
+
+			forward_list<Token> tokens;
+			auto last = tokens.before_begin();
+			auto kept = first;
+			bool isKept = false;
+			Location location = isAfterFirst ? first->location : Location(mFileName);
+			Shift shift;
+			Tokenizer tokenizer;
+			vector<Diagnostic> diagnostics;
+
+			Logger::Capture(&diagnostics);
+
+			// Until a token after the edit starts where one did, from which on they are the same.
+			tokenizer.Start(mText.data(), static_cast<unsigned int>(mText.size()), isAfterFirst ? first->offset : 0, tokens.before_begin());
+
+			for (bool isLeft = true; isLeft && !isKept; )
+			{
+				isLeft = tokenizer.Next(&tokens, location);
+
+				const auto token = std::next(last);
+
+				if (token == tokens.end())
+				{
+					continue;
+				}
+
+				if (token->offset >= end)
+				{
+					while (kept->type != Token::Type::END_OF_FILE && kept->offset + delta < token->offset)
+					{
+						kept++;
+					}
+
+					if (kept->type != Token::Type::END_OF_FILE && kept->offset + delta == token->offset)
+					{
+						isKept = true;
+						shift.newLine = token->location.Line();
+						shift.newColumn = token->location.Column();
+
+						Release(*token);
+						tokens.erase_after(last);
+
+						continue;
+					}
+				}
+
+				last = token;
+			}
+
+			// The token kept logs again.
+			for (auto i = diagnostics.begin(); isKept && i != diagnostics.end(); i++)
+			{
+				if (!IsBefore(i->location, shift.newLine, shift.newColumn))
+				{
+					diagnostics.erase(i, diagnostics.end());
+					break;
+				}
+			}
+
+			if (!isKept)
+			{
+				while (kept->type != Token::Type::END_OF_FILE)
+				{
+					kept++;
+				}
+
+				shift.newLine = location.Line();
+				shift.newColumn = location.Column();
+			}
+
+			shift.offset = kept->offset;
+			shift.line = kept->location.Line();
+			shift.column = kept->location.Column();
+
+			mShift = &shift;
+			Walk(mRoot);
+			mShift = nullptr;
+
+			mShifts.push_back(shift);
+
+			// Those of the tokens tokenized again go, and those of the statements go with the statements.
+			for (auto &i : mDiagnostics)
+			{
+				if ((isAfterFirst && IsBefore(i.location, first->location.Line(), first->location.Column())) || (isKept && !IsBefore(i.location, shift.line, shift.column)))
+				{
+					shift.Move(i.location);
+					diagnostics.push_back(i);
+				}
+			}
+
+			mDiagnostics.swap(diagnostics);
+			diagnostics.clear();
+
+			for (auto &i : mSpans)
+			{
+				for (auto &j : i.second.diagnostics)
+				{
+					for (auto &k : j)
+					{
+						shift.Move(k.location);
+					}
+				}
+			}
+
+			Range range = Select(first->offset, kept->offset);
+			const Parser::Span &span = mSpans.at(range.block);
+			const bool isBeginKept = range.first < span.statements.size() && span.statements[range.first]->offset < first->offset;
+			forward_list<Token>::const_iterator begin = isBeginKept ? span.statements[range.first] : forward_list<Token>::const_iterator();
+			forward_list<Token>::const_iterator stop = End(range);
+			const bool isPastEnd = first->offset > stop->offset;	// Of a script whose first block ends early, where there is nothing to parse.
+
+			Remove(range);
+
+			for (auto i = first; i != kept; i++)
+			{
+				Release(*i);
+			}
+
+			mTokens.erase_after(beforeFirst, kept);
+			mTokens.splice_after(beforeFirst, tokens);
+
+			if (!isBeginKept)
+			{
+				begin = isPastEnd ? stop : std::next(beforeFirst);
+			}
+
+			for (auto i = kept; i != mTokens.end(); i++)
+			{
+				i->offset = static_cast<unsigned int>(i->offset + delta);
+				shift.Move(i->location);
+			}
+
+			// Until the statements end where the ones they replace did, in a block further out each time they do not.
+			for (;;)
+			{
+				forward_list<StatementNode *> statements;
+				Parser::Span parsed;
+				Parser::Spans spans;
+				const bool isLast = range.first == mSpans.at(range.block).statements.size();
+				const auto token = Parser().Parse(begin, stop, statements, parsed, spans);
+
+				if (token == stop || (range.block == mRoot && isLast))
+				{
+					if (isLast)
+					{
+						mSpans.at(range.block).end = token;
+					}
+
+					if (range.block == mRoot)
+					{
+						mChanges.insert(statements.cbegin(), statements.cend());
+					}
+
+					Insert(range, statements, parsed, spans);
+
+					if (range.block != mRoot)
+					{
+						mChanges.insert(Statement(begin->offset));
+					}
+
+					break;
+				}
+
+				for (auto i : statements)
+				{
+					Utility::SafeDelete(i);
+				}
+
+				range = Select(begin->offset, mSpans.at(range.block).end->offset + 1);
+
+				const Parser::Span &outer = mSpans.at(range.block);
+
+				if (range.first < outer.statements.size() && outer.statements[range.first]->offset <= begin->offset)
+				{
+					begin = outer.statements[range.first];
+				}
+
+				stop = End(range);
+
+				Remove(range);
+			}
+
+			Logger::Capture(captured);
+		}
+		catch (const bad_alloc &e)
+		{
+			Logger::Capture(captured);
+
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+	}
+
+	void Document::Diagnostics(vector<Diagnostic> &diagnostics) const
+	{
+		diagnostics.insert(diagnostics.end(), mDiagnostics.cbegin(), mDiagnostics.cend());
+
+		for (auto &i : mSpans)
+		{
+			for (auto &j : i.second.diagnostics)
+			{
+				diagnostics.insert(diagnostics.end(), j.cbegin(), j.cend());
+			}
+		}
+
+		std::sort(diagnostics.begin(), diagnostics.end(), Document::IsEarlier);
+	}
+
+	const StatementNode *Document::Statement(const unsigned int offset) const
+	{
+		const StatementNode *statement = nullptr;
+		auto j = mRoot->list.cbegin();
+
+		for (auto &i : mSpans.at(mRoot).statements)
+		{
+			if (i->offset > offset)
+			{
+				break;
+			}
+
+			statement = *j++;
+		}
+
+		return statement;
+	}
+
+	void Document::TakeChanges(unordered_set<const StatementNode *> &statements, vector<Shift> &shifts)
+	{
+		statements.clear();
+		statements.swap(mChanges);
+
+		shifts.clear();
+		shifts.swap(mShifts);
+	}
+
+	// The innermost block whose statements hold the tokens from the offset begin until the offset end, unless the first of them starts there, which what comes before the block may take in.
+	Document::Range Document::Select(const unsigned int begin, const unsigned int end) const
+	{
+		const BlockNode *block = mRoot;
+		unsigned int blockBegin = 0;
+
+		for (auto &i : mSpans)
+		{
+			const Parser::Span &span = i.second;
+
+			if (i.first == mRoot || span.statements.empty() || span.statements.front()->offset >= begin || span.end->offset < end)
+			{
+				continue;
+			}
+
+			if (block == mRoot || span.statements.front()->offset > blockBegin)
+			{
+				block = i.first;
+				blockBegin = span.statements.front()->offset;
+			}
+		}
+
+		const vector<forward_list<Token>::const_iterator> &statements = mSpans.at(block).statements;
+		Range range = { const_cast<BlockNode *>(block), 0, 0 };
+		size_t last = 0;
+
+		for (size_t i = 0; i < statements.size(); i++)
+		{
+			if (statements[i]->offset <= begin)
+			{
+				range.first = i;
+			}
+
+			if (statements[i]->offset < end)
+			{
+				last = i + 1;
+			}
+		}
+
+		// The statement before may take in the first token, as no token ends a statement.
+		if (range.first > 0 && statements[range.first]->offset == begin)
+		{
+			range.first--;
+		}
+
+		range.count = last > range.first ? last - range.first : 0;
+
+		return range;
+	}
+
+	// The token after the statements.
+	forward_list<Token>::const_iterator Document::End(const Range &range) const
+	{
+		const Parser::Span &span = mSpans.at(range.block);
+
+		return range.first + range.count < span.statements.size() ? span.statements[range.first + range.count] : span.end;
+	}
+
+	// The statements, and the spans of the blocks in them.
+	void Document::Remove(const Range &range)
+	{
+		Parser::Span &span = mSpans.at(range.block);
+
+		if (range.count == 0)
+		{
+			return;
+		}
+
+		const unsigned int begin = span.statements[range.first]->offset;
+		const unsigned int end = End(range)->offset;
+
+		for (auto i = mSpans.begin(); i != mSpans.end(); )
+		{
+			if (i->first != range.block && begin <= i->second.end->offset && i->second.end->offset < end)
+			{
+				i = mSpans.erase(i);
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		auto before = range.block->list.before_begin();
+
+		std::advance(before, range.first);
+
+		for (size_t i = 0; i < range.count; i++)
+		{
+			StatementNode *statement = *std::next(before);
+
+			Utility::SafeDelete(statement);
+			range.block->list.erase_after(before);
+		}
+
+		span.statements.erase(span.statements.begin() + range.first, span.statements.begin() + range.first + range.count);
+		span.diagnostics.erase(span.diagnostics.begin() + range.first, span.diagnostics.begin() + range.first + range.count);
+	}
+
+	void Document::Insert(const Range &range, forward_list<StatementNode *> &statements, Parser::Span &parsed, Parser::Spans &spans)
+	{
+		unordered_set<const BlockNode *> blocks;
+
+		mBlocks = &blocks;
+
+		for (auto i : statements)
+		{
+			Walk(i);
+		}
+
+		mBlocks = nullptr;
+
+		Keep(spans, blocks);
+
+		Parser::Span &span = mSpans.at(range.block);
+		BlockNode * const block = range.block;
+		auto before = block->list.before_begin();
+
+		std::advance(before, range.first);
+		block->list.splice_after(before, statements);
+		span.statements.insert(span.statements.begin() + range.first, parsed.statements.begin(), parsed.statements.end());
+		span.diagnostics.insert(span.diagnostics.begin() + range.first, std::make_move_iterator(parsed.diagnostics.begin()), std::make_move_iterator(parsed.diagnostics.end()));
+
+		for (block->last = block->list.cbefore_begin(); std::next(block->last) != block->list.cend(); block->last++);
+
+		const Location &location = span.statements.empty() ? span.end->location : span.statements.front()->location;
+
+		block->location.MoveTo(location.Line(), location.Column());
+	}
+
+	// Those of the blocks the walk found, and not of the ones deleted on errors.
+	void Document::Keep(Parser::Spans &spans, const unordered_set<const BlockNode *> &blocks)
+	{
+		for (auto &i : spans)
+		{
+			if (blocks.count(i.first) != 0)
+			{
+				mSpans.insert(std::move(i));
+			}
+		}
+	}
+
+	// Moves the nodes if there is a shift and finds the blocks if there is a set for them.
+	void Document::Walk(const Node * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		// The nodes are those of the tree of the document, which its parser made and which it owns, so none of them is const itself.
+		if (mShift)
+		{
+			mShift->Move(const_cast<Node *>(node)->location);
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::BLOCK:
+		{
+			const BlockNode * const block = static_cast<const BlockNode *>(node);
+			const auto span = mShift ? mSpans.find(block) : mSpans.end();
+			size_t index = 0;
+
+			if (mBlocks)
+			{
+				mBlocks->insert(block);
+			}
+
+			for (auto i : block->list)
+			{
+				// If no line is added or taken out, the statements from a line after the token kept on stay where they are as well.
+				if (span != mSpans.end() && index < span->second.statements.size() && mShift->newLine == mShift->line && span->second.statements[index]->location.Line() > mShift->line)
+				{
+					break;
+				}
+
+				// The statements before the token kept stay where they are.
+				if (span == mSpans.end() || index + 1 >= span->second.statements.size() || span->second.statements[index + 1]->offset > mShift->offset)
+				{
+					Walk(i);
+				}
+
+				index++;
+			}
+			break;
+		}
+
+		case Node::Type::ARRAY_LITERAL:
+			for (auto i : static_cast<const ArrayLiteralNode *>(node)->list)
+			{
+				Walk(i);
+			}
+			break;
+
+		case Node::Type::HASH_LITERAL:
+			for (auto i : static_cast<const HashLiteralNode *>(node)->list)
+			{
+				Walk(i);
+			}
+			break;
+
+		case Node::Type::HASH:
+			Walk(static_cast<const HashNode *>(node)->key);
+			Walk(static_cast<const HashNode *>(node)->value);
+			break;
+
+		case Node::Type::FUNCTION_LITERAL:
+			for (auto i : static_cast<const FunctionLiteralNode *>(node)->list)
+			{
+				Walk(i);
+			}
+
+			Walk(static_cast<const FunctionLiteralNode *>(node)->block);
+			break;
+
+		case Node::Type::VALUE_PARAMETER:
+			Walk(static_cast<const ValueParameterNode *>(node)->name);
+			Walk(static_cast<const ValueParameterNode *>(node)->defalutArgument);
+			break;
+
+		case Node::Type::OUTPUT_PARAMETER:
+			Walk(static_cast<const OutputParameterNode *>(node)->name);
+			break;
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			Walk(static_cast<const ParenthesizedExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			Walk(static_cast<const IndexReferenceNode *>(node)->expression);
+			Walk(static_cast<const IndexReferenceNode *>(node)->index);
+			break;
+
+		case Node::Type::FUNCTION_CALL:
+			Walk(static_cast<const FunctionCallNode *>(node)->expression);
+
+			for (auto i : static_cast<const FunctionCallNode *>(node)->list)
+			{
+				Walk(i);
+			}
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			Walk(static_cast<const MemberReferenceNode *>(node)->expression);
+			Walk(static_cast<const MemberReferenceNode *>(node)->member);
+			break;
+
+		case Node::Type::UNARY_EXPRESSION:
+			Walk(static_cast<const UnaryExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			Walk(static_cast<const MultiplicativeExpressionNode *>(node)->left);
+			Walk(static_cast<const MultiplicativeExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			Walk(static_cast<const AdditiveExpressionNode *>(node)->left);
+			Walk(static_cast<const AdditiveExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::SHIFT_EXPRESSION:
+			Walk(static_cast<const ShiftExpressionNode *>(node)->left);
+			Walk(static_cast<const ShiftExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::AND_EXPRESSION:
+			Walk(static_cast<const AndExpressionNode *>(node)->left);
+			Walk(static_cast<const AndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::OR_EXPRESSION:
+			Walk(static_cast<const OrExpressionNode *>(node)->left);
+			Walk(static_cast<const OrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			Walk(static_cast<const RelationalExpressionNode *>(node)->left);
+			Walk(static_cast<const RelationalExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			Walk(static_cast<const EqualityExpressionNode *>(node)->left);
+			Walk(static_cast<const EqualityExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_AND_EXPRESSION:
+			Walk(static_cast<const LogicalAndExpressionNode *>(node)->left);
+			Walk(static_cast<const LogicalAndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			Walk(static_cast<const LogicalOrExpressionNode *>(node)->left);
+			Walk(static_cast<const LogicalOrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ASSIGNMENT_EXPRESSION:
+			Walk(static_cast<const AssignmentExpressionNode *>(node)->lhs);
+			Walk(static_cast<const AssignmentExpressionNode *>(node)->rhs);
+			break;
+
+		case Node::Type::CLASS:
+			for (auto i : static_cast<const ClassNode *>(node)->list)
+			{
+				Walk(i);
+			}
+
+			Walk(static_cast<const ClassNode *>(node)->baseClassConstructorCall);
+			Walk(static_cast<const ClassNode *>(node)->include);
+			Walk(static_cast<const ClassNode *>(node)->block);
+			break;
+
+		case Node::Type::BASE_CLASS_CONSTRUCTOR_CALL:
+			Walk(static_cast<const BaseClassConstructorCallNode *>(node)->baseClass);
+
+			for (auto i : static_cast<const BaseClassConstructorCallNode *>(node)->list)
+			{
+				Walk(i);
+			}
+			break;
+
+		case Node::Type::INCLUDE:
+			for (auto i : static_cast<const IncludeNode *>(node)->list)
+			{
+				Walk(i);
+			}
+			break;
+
+		case Node::Type::PACKAGE:
+			Walk(static_cast<const PackageNode *>(node)->block);
+			break;
+
+		case Node::Type::IMPORT:
+			for (auto i : static_cast<const ImportNode *>(node)->list)
+			{
+				Walk(i);
+			}
+			break;
+
+		case Node::Type::IF:
+			for (auto i : static_cast<const IfNode *>(node)->list)
+			{
+				Walk(i);
+			}
+
+			Walk(static_cast<const IfNode *>(node)->block);
+			break;
+
+		case Node::Type::ELSEIF:
+			Walk(static_cast<const ElseIfNode *>(node)->condition);
+			Walk(static_cast<const ElseIfNode *>(node)->block);
+			break;
+
+		case Node::Type::CASE:
+			Walk(static_cast<const CaseNode *>(node)->value);
+
+			for (auto i : static_cast<const CaseNode *>(node)->list)
+			{
+				Walk(i);
+			}
+
+			Walk(static_cast<const CaseNode *>(node)->block);
+			break;
+
+		case Node::Type::WHEN:
+			Walk(static_cast<const WhenNode *>(node)->condition);
+			Walk(static_cast<const WhenNode *>(node)->block);
+			break;
+
+		case Node::Type::WHILE:
+			Walk(static_cast<const WhileNode *>(node)->condition);
+			Walk(static_cast<const WhileNode *>(node)->block);
+			break;
+
+		case Node::Type::FOR:
+			Walk(static_cast<const ForNode *>(node)->initializer);
+			Walk(static_cast<const ForNode *>(node)->condition);
+			Walk(static_cast<const ForNode *>(node)->iterator);
+			Walk(static_cast<const ForNode *>(node)->block);
+			break;
+
+		case Node::Type::FOREACH:
+			Walk(static_cast<const ForEachNode *>(node)->variable);
+			Walk(static_cast<const ForEachNode *>(node)->collection);
+			Walk(static_cast<const ForEachNode *>(node)->block);
+			break;
+
+		case Node::Type::RETURN:
+			Walk(static_cast<const ReturnNode *>(node)->value);
+			break;
+
+		case Node::Type::ERROR:
+			Walk(static_cast<const ErrorNode *>(node)->name);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// The names and the strings of the tokens are their own.
+	void Document::Release(Token &token)
+	{
+		if (token.type == Token::Type::IDENTIFIER)
+		{
+			Utility::SafeDelete(token.value.identifier);
+		}
+		else if (token.type == Token::Type::STRING_LITERAL)
+		{
+			Utility::SafeDelete(token.value.string);
+		}
+	}
+
+	bool Document::IsBefore(const Location &location, const unsigned int line, const unsigned int column)
+	{
+		return location.Line() < line || (location.Line() == line && location.Column() < column);
+	}
+
+	bool Document::IsEarlier(const Diagnostic &diagnostic, const Diagnostic &other)
+	{
+		if (diagnostic.location.Line() != other.location.Line() || diagnostic.location.Column() != other.location.Column())
+		{
+			return IsBefore(diagnostic.location, other.location.Line(), other.location.Column());
+		}
+
+		return diagnostic.code < other.code;
+	}
+
+	void Document::Shift::Move(Location &location) const
+	{
+		if (IsBefore(location, line, column))
+		{
+			return;
+		}
+
+		if (location.Line() == line)
+		{
+			location.MoveTo(newLine, location.Column() - column + newColumn);
+		}
+		else
+		{
+			location.MoveTo(location.Line() - line + newLine, location.Column());
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef DOCUMENT
+#define DOCUMENT
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <forward_list>
+#include <unordered_set>
+
+#include "Token.h"
+#include "Node.h"
+#include "Location.h"
+#include "Diagnostic.h"
+#include "Parser.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::string;
+	using std::u32string;
+	using std::vector;
+	using std::forward_list;
+	using std::unordered_set;
+
+	// The text of a script open in an editor, with its tokens and its tree, which an edit changes only where it has to.
+	// The tokens are tokenized again from the one the edit starts in until one starts where one did, and the statements parsed again are those of the innermost block around them, from the one before to the one after, or those of the block around that if the block no longer ends where it did.
+	// The tokens and the nodes after the edit are kept and moved, and the tokens own their names and strings.
+	// The logs of the tokenizer and of each statement are kept instead of being written, and go with what logged them.
+	class Document
+	{
+	public:
+		// Where the first token kept after an edit was, and is.
+		struct Shift
+		{
+			void Move(Location &location) const;	// If it is at or after the token.
+
+			unsigned int offset;	// Before the edit.
+			unsigned int line;
+			unsigned int column;
+			unsigned int newLine;
+			unsigned int newColumn;
+		};
+
+		Document(const string &fileName, const u32string &text);
+		~Document();
+
+		Document(const Document &) = delete;
+		Document &operator=(const Document &) = delete;
+
+		void Edit(unsigned int offset, unsigned int length, const u32string &text);	// Replaces the characters from the offset on with the text.
+		void Diagnostics(vector<Diagnostic> &diagnostics) const;	// In the order of their locations.
+		const StatementNode *Statement(const unsigned int offset) const;	// Of the root block, that the character at the offset is in, or nullptr.
+		void TakeChanges(unordered_set<const StatementNode *> &statements, vector<Shift> &shifts);	// Since the last call, the statements of the root block parsed again or with a block in them parsed again, and the shifts of the edits in order.
+
+		const string &FileName() const
+		{
+			return mFileName;
+		}
+
+		const u32string &Text() const
+		{
+			return mText;
+		}
+
+		const forward_list<Token> &Tokens() const
+		{
+			return mTokens;
+		}
+
+		const BlockNode *Root() const
+		{
+			return mRoot;
+		}
+
+	private:
+		// The statements of a block to be parsed again.
+		struct Range
+		{
+			BlockNode *block;
+			size_t first;
+			size_t count;
+		};
+
+		Range Select(const unsigned int begin, const unsigned int end) const;
+		forward_list<Token>::const_iterator End(const Range &range) const;
+		void Remove(const Range &range);
+		void Insert(const Range &range, forward_list<StatementNode *> &statements, Parser::Span &parsed, Parser::Spans &spans);
+		void Keep(Parser::Spans &spans, const unordered_set<const BlockNode *> &blocks);
+		void Walk(const Node * const node);
+
+		static void Release(Token &token);
+		static bool IsBefore(const Location &location, const unsigned int line, const unsigned int column);
+		static bool IsEarlier(const Diagnostic &diagnostic, const Diagnostic &other);
+
+		const string mFileName;
+		u32string mText;
+		forward_list<Token> mTokens;
+		BlockNode *mRoot;
+		Parser::Spans mSpans;	// Of every block in the tree.
+		vector<Diagnostic> mDiagnostics;	// Of the tokens.
+		unordered_set<const StatementNode *> mChanges;	// Since they were last taken.
+		vector<Shift> mShifts;	// Since they were last taken.
+		const Shift *mShift;	// Of the nodes walked.
+		unordered_set<const BlockNode *> *mBlocks;	// Found by the walk.
+	};
+}
+
+#endif
\ No newline at end of file
@@ -42,6 +42,10 @@ namespace lyrics
 		DUPLICATED_IDENTIFIER,
 
 		SEMANTIC_ERROR = 5001,
+
+		CYCLIC_DEPENDENCY = 6001,
+		FAILED_DEPENDENCY,
+		DUPLICATED_MODULE,
 	};
 }
 
@@ -4,11 +4,11 @@
 
 namespace lyrics
 {
-	constexpr char ErrorLogger::WARNING[];
-	constexpr char ErrorLogger::ERROR[];
-	constexpr char ErrorLogger::FATAL_ERROR[];
+	constexpr Diagnostic::Severity ErrorLogger::WARNING;
+	constexpr Diagnostic::Severity ErrorLogger::ERROR;
+	constexpr Diagnostic::Severity ErrorLogger::FATAL_ERROR;
 
-	void ErrorLogger::Warning(const Location location, const WarningCode warningCode)
+	void ErrorLogger::Warning(const Location &location, const WarningCode warningCode)
 	{
 		switch (warningCode)
 		{
@@ -16,13 +16,17 @@ namespace lyrics
 			Logger::Log(location, ErrorLogger::WARNING, static_cast<unsigned int>(warningCode), "Unknown escape sequence.");
 			break;
 
+		case WarningCode::UNRESOLVED_IMPORT:
+			Logger::Log(location, ErrorLogger::WARNING, static_cast<unsigned int>(warningCode), "No script found for import.");
+			break;
+
 		default:
 			Logger::StandardErrorLog(location, ErrorLogger::WARNING, static_cast<unsigned int>(warningCode));
 			break;
 		}
 	}
 
-	void ErrorLogger::Error(const Location location, const ErrorCode errorCode)
+	void ErrorLogger::Error(const Location &location, const ErrorCode errorCode)
 	{
 		switch (errorCode)
 		{
@@ -158,6 +162,18 @@ namespace lyrics
 			Logger::Log(location, ErrorLogger::ERROR, static_cast<unsigned int>(errorCode), "Duplicated identifier.");
 			break;
 
+		case ErrorCode::CYCLIC_DEPENDENCY:
+			Logger::Log(location, ErrorLogger::ERROR, static_cast<unsigned int>(errorCode), "Cyclic dependency.");
+			break;
+
+		case ErrorCode::FAILED_DEPENDENCY:
+			Logger::Log(location, ErrorLogger::ERROR, static_cast<unsigned int>(errorCode), "Dependency failed to compile.");
+			break;
+
+		case ErrorCode::DUPLICATED_MODULE:
+			Logger::Log(location, ErrorLogger::ERROR, static_cast<unsigned int>(errorCode), "Module file name taken by another source file.");
+			break;
+
 		default:
 			Logger::StandardErrorLog(location, ErrorLogger::ERROR, static_cast<unsigned int>(errorCode));
 			break;
@@ -188,6 +204,26 @@ namespace lyrics
 			Logger::Log(ErrorLogger::FATAL_ERROR, static_cast<unsigned int>(fatalErrorCode), "Not enough memory.");
 			break;
 
+		case FatalErrorCode::CANNOT_WRITE_FILE:
+			Logger::Log(ErrorLogger::FATAL_ERROR, static_cast<unsigned int>(fatalErrorCode), "Cannot write file.");
+			break;
+
+		case FatalErrorCode::INVALID_MODULE:
+			Logger::Log(ErrorLogger::FATAL_ERROR, static_cast<unsigned int>(fatalErrorCode), "Invalid module.");
+			break;
+
+		case FatalErrorCode::CANNOT_OPEN_SOCKET:
+			Logger::Log(ErrorLogger::FATAL_ERROR, static_cast<unsigned int>(fatalErrorCode), "Cannot open socket.");
+			break;
+
+		case FatalErrorCode::TOO_MANY_ERRORS:
+			Logger::Log(ErrorLogger::FATAL_ERROR, static_cast<unsigned int>(fatalErrorCode), "Too many errors.");
+			break;
+
+		case FatalErrorCode::FUNCTION_TOO_LONG:
+			Logger::Log(ErrorLogger::FATAL_ERROR, static_cast<unsigned int>(fatalErrorCode), "Function too long.");
+			break;
+
 		default:
 			Logger::StandardErrorLog(ErrorLogger::FATAL_ERROR, static_cast<unsigned int>(fatalErrorCode));
 			break;
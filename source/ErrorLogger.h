@@ -2,6 +2,7 @@
 #define ERROR_LOGGER
 
 #include "Location.h"
+#include "Diagnostic.h"
 #include "WarningCode.h"
 #include "ErrorCode.h"
 #include "FatalErrorCode.h"
@@ -14,14 +15,13 @@ namespace lyrics
 		ErrorLogger() = delete;
 
 	public:
-		static void Warning(const Location location, const WarningCode warningCode);
-		static void Error(const Location location, const ErrorCode errorCode);
+		static void Warning(const Location &location, const WarningCode warningCode);
+		static void Error(const Location &location, const ErrorCode errorCode);
 		static void FatalError(const FatalErrorCode &fatalErrorCode);
 
-	private:
-		static constexpr char WARNING[] = "warning";
-		static constexpr char ERROR[] = "error";
-		static constexpr char FATAL_ERROR[] = "fatal error";
+		static constexpr Diagnostic::Severity WARNING = Diagnostic::Severity::WARNING;
+		static constexpr Diagnostic::Severity ERROR = Diagnostic::Severity::ERROR;
+		static constexpr Diagnostic::Severity FATAL_ERROR = Diagnostic::Severity::FATAL_ERROR;
 	};
 }
 
@@ -0,0 +1,459 @@
+#include "EscapeAnalyzer.h"
+
+namespace lyrics
+{
+	void EscapeAnalyzer::Analyze(const BlockNode * const root, LiteralSet &localLiterals)
+	{
+		mLocalLiterals = &localLiterals;
+		mEscaped.clear();
+
+		Enter(false);
+		AnalyzeBlock(root);
+		Leave();
+
+		for (auto i : mEscaped)
+		{
+			mLocalLiterals->erase(i);
+		}
+	}
+
+	void EscapeAnalyzer::AnalyzeBlock(const BlockNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		for (auto i : node->list)
+		{
+			if (i)
+			{
+				AnalyzeStatement(i);
+			}
+		}
+	}
+
+	void EscapeAnalyzer::AnalyzeStatement(const StatementNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::IMPORT:
+		case Node::Type::BREAK:
+		case Node::Type::NEXT:
+			break;
+
+		case Node::Type::IF:
+			{
+				const IfNode * const ifNode = static_cast<const IfNode *>(node);
+
+				for (auto i : ifNode->list)
+				{
+					Use(i->condition);
+					AnalyzeBlock(i->block);
+				}
+
+				AnalyzeBlock(ifNode->block);
+			}
+			break;
+
+		case Node::Type::CASE:
+			{
+				const CaseNode * const caseNode = static_cast<const CaseNode *>(node);
+
+				Use(caseNode->value);
+
+				for (auto i : caseNode->list)
+				{
+					Use(i->condition);
+					AnalyzeBlock(i->block);
+				}
+
+				AnalyzeBlock(caseNode->block);
+			}
+			break;
+
+		case Node::Type::WHILE:
+			{
+				const WhileNode * const whileNode = static_cast<const WhileNode *>(node);
+
+				Use(whileNode->condition);
+				AnalyzeBlock(whileNode->block);
+			}
+			break;
+
+		case Node::Type::FOR:
+			{
+				const ForNode * const forNode = static_cast<const ForNode *>(node);
+
+				Use(forNode->initializer);
+				Use(forNode->condition);
+				Use(forNode->iterator);
+				AnalyzeBlock(forNode->block);
+			}
+			break;
+
+		case Node::Type::FOREACH:
+			{
+				const ForEachNode * const forEachNode = static_cast<const ForEachNode *>(node);
+
+				Use(forEachNode->collection);
+
+				if (forEachNode->variable && forEachNode->variable->type == Node::Type::IDENTIFIER)
+				{
+					const u32string &identifier = *static_cast<const IdentifierNode *>(forEachNode->variable)->identifier;
+
+					if (!Lookup(identifier))
+					{
+						Declare(identifier);
+					}
+				}
+
+				AnalyzeBlock(forEachNode->block);
+			}
+			break;
+
+		case Node::Type::RETURN:
+			if (static_cast<const ReturnNode *>(node)->value)
+			{
+				Escape(AnalyzeExpression(static_cast<const ReturnNode *>(node)->value));
+			}
+			break;
+
+		case Node::Type::ERROR:
+			break;
+
+		default:
+			Use(static_cast<const ExpressionNode *>(node));
+			break;
+		}
+	}
+
+	// Reading an element, iterating or comparing leaves no reference to the operand behind. Any other use is taken as an escape.
+	EscapeAnalyzer::Value EscapeAnalyzer::AnalyzeExpression(const ExpressionNode * const node)
+	{
+		Value value;
+
+		switch (node->type)
+		{
+		case Node::Type::IDENTIFIER:
+			value.variable = Lookup(*static_cast<const IdentifierNode *>(node)->identifier);
+			break;
+
+		case Node::Type::ARRAY_LITERAL:
+			for (auto i : static_cast<const ArrayLiteralNode *>(node)->list)
+			{
+				Escape(AnalyzeExpression(i));
+			}
+
+			mLocalLiterals->insert(node);
+			value.literal = node;
+			break;
+
+		case Node::Type::HASH_LITERAL:
+			for (auto i : static_cast<const HashLiteralNode *>(node)->list)
+			{
+				Escape(AnalyzeExpression(i->key));
+				Escape(AnalyzeExpression(i->value));
+			}
+
+			mLocalLiterals->insert(node);
+			value.literal = node;
+			break;
+
+		case Node::Type::FUNCTION_LITERAL:
+			AnalyzeFunction(static_cast<const FunctionLiteralNode *>(node));
+			break;
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			value = AnalyzeExpression(static_cast<const ParenthesizedExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			Use(static_cast<const IndexReferenceNode *>(node)->expression);
+			Use(static_cast<const IndexReferenceNode *>(node)->index);
+			break;
+
+		case Node::Type::FUNCTION_CALL:
+			{
+				const FunctionCallNode * const functionCall = static_cast<const FunctionCallNode *>(node);
+
+				Escape(AnalyzeExpression(functionCall->expression));
+				AnalyzeArguments(functionCall->list);
+			}
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			Escape(AnalyzeExpression(static_cast<const MemberReferenceNode *>(node)->expression));
+			break;
+
+		case Node::Type::UNARY_EXPRESSION:
+			{
+				const UnaryExpressionNode * const unary = static_cast<const UnaryExpressionNode *>(node);
+
+				if (unary->op == static_cast<Token::Type>(U'!'))
+				{
+					Use(unary->expression);
+				}
+				else
+				{
+					Escape(AnalyzeExpression(unary->expression));
+				}
+			}
+			break;
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			Use(static_cast<const RelationalExpressionNode *>(node)->left);
+			Use(static_cast<const RelationalExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			Use(static_cast<const EqualityExpressionNode *>(node)->left);
+			Use(static_cast<const EqualityExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			Escape(AnalyzeExpression(static_cast<const MultiplicativeExpressionNode *>(node)->left));
+			Escape(AnalyzeExpression(static_cast<const MultiplicativeExpressionNode *>(node)->right));
+			break;
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			Escape(AnalyzeExpression(static_cast<const AdditiveExpressionNode *>(node)->left));
+			Escape(AnalyzeExpression(static_cast<const AdditiveExpressionNode *>(node)->right));
+			break;
+
+		case Node::Type::SHIFT_EXPRESSION:
+			Escape(AnalyzeExpression(static_cast<const ShiftExpressionNode *>(node)->left));
+			Escape(AnalyzeExpression(static_cast<const ShiftExpressionNode *>(node)->right));
+			break;
+
+		case Node::Type::AND_EXPRESSION:
+			Escape(AnalyzeExpression(static_cast<const AndExpressionNode *>(node)->left));
+			Escape(AnalyzeExpression(static_cast<const AndExpressionNode *>(node)->right));
+			break;
+
+		case Node::Type::OR_EXPRESSION:
+			Escape(AnalyzeExpression(static_cast<const OrExpressionNode *>(node)->left));
+			Escape(AnalyzeExpression(static_cast<const OrExpressionNode *>(node)->right));
+			break;
+
+		case Node::Type::LOGICAL_AND_EXPRESSION:	// Evaluates to one of the operands.
+			Escape(AnalyzeExpression(static_cast<const LogicalAndExpressionNode *>(node)->left));
+			Escape(AnalyzeExpression(static_cast<const LogicalAndExpressionNode *>(node)->right));
+			break;
+
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			Escape(AnalyzeExpression(static_cast<const LogicalOrExpressionNode *>(node)->left));
+			Escape(AnalyzeExpression(static_cast<const LogicalOrExpressionNode *>(node)->right));
+			break;
+
+		case Node::Type::ASSIGNMENT_EXPRESSION:
+			value = AnalyzeAssignment(static_cast<const AssignmentExpressionNode *>(node));
+			break;
+
+		case Node::Type::CLASS:
+			AnalyzeClass(static_cast<const ClassNode *>(node));
+			break;
+
+		case Node::Type::PACKAGE:
+			Enter(false);
+			AnalyzeBlock(static_cast<const PackageNode *>(node)->block);
+			Leave();
+			break;
+
+		default:
+			break;
+		}
+
+		return value;
+	}
+
+	// A literal may flow into a variable of the function, as long as it is not copied to another one from there.
+	EscapeAnalyzer::Value EscapeAnalyzer::AnalyzeAssignment(const AssignmentExpressionNode * const node)
+	{
+		Value value;
+
+		switch (node->lhs->type)
+		{
+		case Node::Type::IDENTIFIER:
+			{
+				const u32string &identifier = *static_cast<const IdentifierNode *>(node->lhs)->identifier;
+				bool isDeclared = false;
+
+				for (auto &i : mFrames)
+				{
+					isDeclared |= i.variables.count(identifier) != 0;
+				}
+
+				Variable * const variable = isDeclared ? Lookup(identifier) : Declare(identifier);
+				const Value rhs = AnalyzeExpression(node->rhs);
+
+				if (variable && rhs.literal)
+				{
+					variable->literals.push_back(rhs.literal);
+				}
+				else if (!variable || rhs.variable != variable)
+				{
+					Escape(rhs);
+				}
+
+				value.variable = variable;
+			}
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			Use(static_cast<const IndexReferenceNode *>(node->lhs)->expression);
+			Escape(AnalyzeExpression(static_cast<const IndexReferenceNode *>(node->lhs)->index));
+			Escape(AnalyzeExpression(node->rhs));
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			Use(static_cast<const MemberReferenceNode *>(node->lhs)->expression);
+			Escape(AnalyzeExpression(node->rhs));
+			break;
+
+		default:
+			Escape(AnalyzeExpression(node->lhs));
+			Escape(AnalyzeExpression(node->rhs));
+			break;
+		}
+
+		return value;
+	}
+
+	void EscapeAnalyzer::AnalyzeFunction(const FunctionLiteralNode * const node)
+	{
+		Enter(true);
+
+		for (auto i : node->list)
+		{
+			Variable * const variable = Declare(*i->name->identifier);
+
+			if (i->type == Node::Type::OUTPUT_PARAMETER)	// Written back to the caller after the frame is gone.
+			{
+				variable->isEscaped = true;
+			}
+			else if (i->type == Node::Type::VALUE_PARAMETER && static_cast<const ValueParameterNode *>(i)->defalutArgument)
+			{
+				Escape(AnalyzeExpression(static_cast<const ValueParameterNode *>(i)->defalutArgument));
+			}
+		}
+
+		AnalyzeBlock(node->block);
+
+		Leave();
+	}
+
+	void EscapeAnalyzer::AnalyzeClass(const ClassNode * const node)
+	{
+		Enter(false);
+
+		for (auto i : node->list)
+		{
+			if (i->type == Node::Type::ASSIGNMENT_EXPRESSION)
+			{
+				const AssignmentExpressionNode * const assignment = static_cast<const AssignmentExpressionNode *>(i);
+
+				if (assignment->lhs->type == Node::Type::IDENTIFIER)
+				{
+					Declare(*static_cast<const IdentifierNode *>(assignment->lhs)->identifier);
+				}
+
+				Escape(AnalyzeExpression(assignment->rhs));
+			}
+			else if (i->type == Node::Type::IDENTIFIER)
+			{
+				Declare(*static_cast<const IdentifierNode *>(i)->identifier);
+			}
+		}
+
+		if (node->baseClassConstructorCall)
+		{
+			AnalyzeArguments(node->baseClassConstructorCall->list);
+		}
+
+		AnalyzeBlock(node->block);
+
+		Leave();
+	}
+
+	void EscapeAnalyzer::AnalyzeArguments(const forward_list<ExpressionNode *> &arguments)
+	{
+		for (auto i : arguments)
+		{
+			Escape(AnalyzeExpression(i));
+		}
+	}
+
+	void EscapeAnalyzer::Escape(const Value &value)
+	{
+		if (value.literal)
+		{
+			mEscaped.insert(value.literal);
+		}
+
+		if (value.variable)
+		{
+			value.variable->isEscaped = true;
+		}
+	}
+
+	void EscapeAnalyzer::Use(const ExpressionNode * const node)
+	{
+		if (node)
+		{
+			AnalyzeExpression(node);
+		}
+	}
+
+	// Variables of an enclosing function may be captured, so they escape as soon as a nested function refers to them.
+	EscapeAnalyzer::Variable *EscapeAnalyzer::Lookup(const u32string &identifier)
+	{
+		for (auto i = mFrames.begin(); i != mFrames.end(); i++)
+		{
+			auto variable = i->variables.find(identifier);
+
+			if (variable != i->variables.end())
+			{
+				if (i != mFrames.begin())
+				{
+					variable->second.isEscaped = true;
+				}
+
+				return i == mFrames.begin() && i->isFunction ? &variable->second : nullptr;
+			}
+		}
+
+		return nullptr;
+	}
+
+	EscapeAnalyzer::Variable *EscapeAnalyzer::Declare(const u32string &identifier)
+	{
+		Frame &frame = mFrames.front();
+		Variable &variable = frame.variables[identifier];
+
+		if (!frame.isFunction)
+		{
+			variable.isEscaped = true;
+		}
+
+		return frame.isFunction ? &variable : nullptr;
+	}
+
+	void EscapeAnalyzer::Enter(const bool isFunction)
+	{
+		mFrames.emplace_front(isFunction);
+	}
+
+	void EscapeAnalyzer::Leave()
+	{
+		for (auto &i : mFrames.front().variables)
+		{
+			if (i.second.isEscaped)
+			{
+				mEscaped.insert(i.second.literals.cbegin(), i.second.literals.cend());
+			}
+		}
+
+		mFrames.pop_front();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef ESCAPE_ANALYZER
+#define ESCAPE_ANALYZER
+
+#include <string>
+#include <vector>
+#include <forward_list>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Node.h"
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::vector;
+	using std::forward_list;
+	using std::unordered_map;
+	using std::unordered_set;
+
+	// Finds the array and hash literals whose value never outlives the frame, nor the next run of the literal itself.
+	class EscapeAnalyzer
+	{
+	public:
+		typedef unordered_set<const ExpressionNode *> LiteralSet;
+
+		void Analyze(const BlockNode * const root, LiteralSet &localLiterals);
+
+	private:
+		struct Variable
+		{
+			Variable() : isEscaped(false)
+			{
+			}
+
+			vector<const ExpressionNode *> literals;
+			bool isEscaped;
+		};
+
+		// Only the variables of a function can hold a local literal. Globals and members are reachable from other frames.
+		struct Frame
+		{
+			explicit Frame(const bool isFunction) : isFunction(isFunction)
+			{
+			}
+
+			const bool isFunction;
+			unordered_map<u32string, Variable> variables;
+		};
+
+		// What an expression evaluates to, as far as it matters here.
+		struct Value
+		{
+			Value() : literal(nullptr), variable(nullptr)
+			{
+			}
+
+			const ExpressionNode *literal;
+			Variable *variable;
+		};
+
+		void AnalyzeBlock(const BlockNode * const node);
+		void AnalyzeStatement(const StatementNode * const node);
+		Value AnalyzeExpression(const ExpressionNode * const node);
+		Value AnalyzeAssignment(const AssignmentExpressionNode * const node);
+		void AnalyzeFunction(const FunctionLiteralNode * const node);
+		void AnalyzeClass(const ClassNode * const node);
+		void AnalyzeArguments(const forward_list<ExpressionNode *> &arguments);
+
+		void Escape(const Value &value);
+		void Use(const ExpressionNode * const node);
+		Variable *Lookup(const u32string &identifier);
+		Variable *Declare(const u32string &identifier);
+		void Enter(const bool isFunction);
+		void Leave();
+
+		forward_list<Frame> mFrames;	// Innermost first.
+		LiteralSet mEscaped;
+		LiteralSet *mLocalLiterals;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -11,6 +11,11 @@ namespace lyrics
 		CANNOT_CLOSE_FILE,
 		NOT_ENOUGH_MEMORY,
 		CANNOT_PARSE,
+		CANNOT_WRITE_FILE,
+		INVALID_MODULE,
+		CANNOT_OPEN_SOCKET,
+		TOO_MANY_ERRORS,
+		FUNCTION_TOO_LONG,
 	};
 }
 
@@ -0,0 +1,45 @@
+#ifndef STRUCT_FUNCTION
+#define STRUCT_FUNCTION
+
+#include <vector>
+
+#include "ByteCode.h"
+#include "Literal.h"
+#include "InlineCache.h"
+#include "JumpTable.h"
+
+namespace lyrics
+{
+	using std::vector;
+
+	// Code of a function, a class body or the top level of a script.
+	// Slot 0 of a frame is the receiver, followed by the parameters and the variables. Temporaries are addressed from SP, which is FP + variableCount.
+	struct Function
+	{
+		// Copied into a closure when it is constructed, from a slot of the frame constructing it or from an upvalue of the closure running there.
+		struct Upvalue
+		{
+			bool isLocal;
+			unsigned short index;
+		};
+
+		Function() : parameterCount(0), variableCount(1), temporaryCount(0), isClass(false)
+		{
+		}
+
+		vector<ByteCode> code;
+		vector<unsigned int> lines;	// Source line of each instruction of the code.
+		vector<Literal> constants;
+		vector<InlineCache> inlineCaches;
+		vector<JumpTable> jumpTables;
+		vector<Upvalue> upvalues;
+		vector<unsigned int> entries;	// Where a call given i arguments starts, so that only the default arguments of the missing parameters are evaluated. Empty if there are none.
+		vector<unsigned short> outputParameters;	// Written back to the arguments by the caller, from the frame slots left behind.
+		unsigned short parameterCount;
+		unsigned short variableCount;
+		unsigned short temporaryCount;
+		bool isClass;
+	};
+}
+
+#endif
\ No newline at end of file
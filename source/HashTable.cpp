@@ -0,0 +1,395 @@
+#include "HashTable.h"
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <functional>
+#include <algorithm>
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	constexpr unsigned int HashTable::INLINE_CAPACITY;
+	constexpr unsigned int HashTable::GROUP_WIDTH;
+	constexpr unsigned int HashTable::MINIMUM_CAPACITY;
+	constexpr unsigned int HashTable::NOT_FOUND;
+	constexpr signed char HashTable::EMPTY;
+	constexpr signed char HashTable::DELETED;
+	constexpr unsigned long long HashTable::LOW_BITS;
+	constexpr unsigned long long HashTable::HIGH_BITS;
+
+	HashTable::HashTable() : mControl(nullptr), mSlots(nullptr), mCapacity(0), mSize(0), mGrowthLeft(0)
+	{
+	}
+
+	HashTable::~HashTable()
+	{
+		Utility::SafeArrayDelete(mControl);
+		Utility::SafeArrayDelete(mSlots);
+	}
+
+	Literal *HashTable::Find(const Literal &key)
+	{
+		return Find(HashTable::Key(key));
+	}
+
+	const Literal *HashTable::Find(const Literal &key) const
+	{
+		return Find(HashTable::Key(key));
+	}
+
+	Literal *HashTable::Find(const Key &key)
+	{
+		const unsigned int entry = FindEntry(key);
+
+		return entry != HashTable::NOT_FOUND ? &Entries()[entry].value : nullptr;
+	}
+
+	const Literal *HashTable::Find(const Key &key) const
+	{
+		const unsigned int entry = FindEntry(key);
+
+		return entry != HashTable::NOT_FOUND ? &Entries()[entry].value : nullptr;
+	}
+
+	Literal &HashTable::Insert(const Literal &key)
+	{
+		return Insert(HashTable::Key(key));
+	}
+
+	// The returned reference is valid until the next insertion.
+	Literal &HashTable::Insert(const Key &key)
+	{
+		const unsigned int entry = FindEntry(key);
+
+		if (entry != HashTable::NOT_FOUND)
+		{
+			return Entries()[entry].value;
+		}
+
+		if (mCapacity == 0)
+		{
+			if (mSize < HashTable::INLINE_CAPACITY)
+			{
+				mInlineEntries[mSize] = Entry(key);
+
+				return mInlineEntries[mSize++].value;
+			}
+
+			mEntries.assign(mInlineEntries, mInlineEntries + mSize);
+			Rehash(HashTable::MINIMUM_CAPACITY);
+		}
+		else if (mGrowthLeft == 0)
+		{
+			Rehash(mSize * 2 > mCapacity - (mCapacity >> 3) ? mCapacity << 1 : mCapacity);
+		}
+
+		const unsigned int slot = FindEmptySlot(key.hash);
+
+		mEntries.emplace_back(key);
+
+		if (mControl[slot] == HashTable::EMPTY)
+		{
+			mGrowthLeft--;
+		}
+
+		SetControl(slot, HashTable::H2(key.hash));
+		mSlots[slot] = mEntries.size() - 1;
+		mSize++;
+
+		return mEntries.back().value;
+	}
+
+	bool HashTable::Erase(const Literal &key)
+	{
+		using std::copy;
+
+		const HashTable::Key hashed(key);
+
+		if (mCapacity == 0)
+		{
+			const unsigned int entry = FindEntry(hashed);
+
+			if (entry == HashTable::NOT_FOUND)
+			{
+				return false;
+			}
+
+			copy(mInlineEntries + entry + 1, mInlineEntries + mSize, mInlineEntries + entry);
+			mSize--;
+
+			return true;
+		}
+
+		const unsigned int slot = FindSlot(hashed);
+
+		if (slot == HashTable::NOT_FOUND)
+		{
+			return false;
+		}
+
+		mEntries[mSlots[slot]].isErased = true;
+		SetControl(slot, HashTable::DELETED);
+		mSize--;
+
+		if (mEntries.size() - mSize > mSize)	// Keep foreach from walking mostly erased entries.
+		{
+			Rehash(mCapacity);
+		}
+
+		return true;
+	}
+
+	size_t HashTable::Hash(const Literal &key)
+	{
+		using std::hash;
+		using std::u32string;
+		using std::memcpy;
+
+		unsigned long long word;
+
+		switch (key.type)
+		{
+		case Literal::Type::NULL_LITERAL:
+			word = 0;
+			break;
+
+		case Literal::Type::BOOLEAN:
+			word = key.value.boolean;
+			break;
+
+		case Literal::Type::INTEGER:
+			word = static_cast<unsigned long long>(key.value.integer);
+			break;
+
+		case Literal::Type::REAL:
+			{
+				double real = key.value.real;
+
+				if (real == 0.0)	// -0.0 and 0.0 are the same key.
+				{
+					real = 0.0;
+				}
+				else if (std::isnan(real))	// As are all NaNs.
+				{
+					real = std::numeric_limits<double>::quiet_NaN();
+				}
+
+				memcpy(&word, &real, sizeof(word));
+			}
+			break;
+
+		case Literal::Type::STRING:
+		case Literal::Type::REFERENCE:
+			word = hash<u32string>()(*key.value.string);
+			break;
+
+		case Literal::Type::ARRAY:
+			word = reinterpret_cast<unsigned long long>(key.value.array);
+			break;
+
+		case Literal::Type::HASH:
+			word = reinterpret_cast<unsigned long long>(key.value.hash);
+			break;
+
+		case Literal::Type::OBJECT:
+			word = reinterpret_cast<unsigned long long>(key.value.object);
+			break;
+
+		default:
+			word = reinterpret_cast<unsigned long long>(key.value.function);
+			break;
+		}
+
+		// Mix the type in and spread the bits so that both H1 and H2 are usable.
+		word ^= static_cast<unsigned long long>(key.type) * 0x9E3779B97F4A7C15ull;
+		word = (word ^ (word >> 30)) * 0xBF58476D1CE4E5B9ull;
+		word = (word ^ (word >> 27)) * 0x94D049BB133111EBull;
+		word ^= word >> 31;
+
+		return static_cast<size_t>(word);
+	}
+
+	bool HashTable::IsEqual(const Literal &left, const Literal &right)
+	{
+		if (left.type != right.type)
+		{
+			return false;
+		}
+
+		switch (left.type)
+		{
+		case Literal::Type::NULL_LITERAL:
+			return true;
+
+		case Literal::Type::BOOLEAN:
+			return left.value.boolean == right.value.boolean;
+
+		case Literal::Type::INTEGER:
+			return left.value.integer == right.value.integer;
+
+		case Literal::Type::REAL:
+			return left.value.real == right.value.real || (std::isnan(left.value.real) && std::isnan(right.value.real));	// A NaN key is found again.
+
+		case Literal::Type::STRING:
+		case Literal::Type::REFERENCE:
+			return left.value.string == right.value.string || *left.value.string == *right.value.string;
+
+		case Literal::Type::ARRAY:
+			return left.value.array == right.value.array;
+
+		case Literal::Type::HASH:
+			return left.value.hash == right.value.hash;
+
+		case Literal::Type::OBJECT:
+			return left.value.object == right.value.object;
+
+		default:
+			return left.value.function == right.value.function;
+		}
+	}
+
+	unsigned long long HashTable::LoadGroup(const unsigned int position) const
+	{
+		unsigned long long group = 0;
+
+		for (unsigned int i = 0; i < HashTable::GROUP_WIDTH; i++)
+		{
+			group |= static_cast<unsigned long long>(static_cast<unsigned char>(mControl[position + i])) << (i << 3);
+		}
+
+		return group;
+	}
+
+	void HashTable::SetControl(const unsigned int slot, const signed char control)
+	{
+		mControl[slot] = control;
+
+		if (slot < HashTable::GROUP_WIDTH)	// The first group is mirrored after the last slot so that a group never wraps around.
+		{
+			mControl[mCapacity + slot] = control;
+		}
+	}
+
+	unsigned int HashTable::FindEntry(const Key &key) const
+	{
+		if (mCapacity == 0)
+		{
+			for (unsigned int i = 0; i < mSize; i++)
+			{
+				if (mInlineEntries[i].hash == key.hash && HashTable::IsEqual(mInlineEntries[i].key, key.literal))
+				{
+					return i;
+				}
+			}
+
+			return HashTable::NOT_FOUND;
+		}
+
+		const unsigned int slot = FindSlot(key);
+
+		return slot != HashTable::NOT_FOUND ? mSlots[slot] : HashTable::NOT_FOUND;
+	}
+
+	unsigned int HashTable::FindSlot(const Key &key) const
+	{
+		const unsigned int mask = mCapacity - 1;
+		const unsigned long long pattern = HashTable::LOW_BITS * static_cast<unsigned char>(HashTable::H2(key.hash));
+		unsigned int position = HashTable::H1(key.hash) & mask;
+		unsigned int step = 0;
+
+		for (;;)
+		{
+			const unsigned long long group = LoadGroup(position);
+			const unsigned long long difference = group ^ pattern;
+			const unsigned long long match = (difference - HashTable::LOW_BITS) & ~difference & HashTable::HIGH_BITS;
+
+			for (unsigned int i = 0; i < HashTable::GROUP_WIDTH; i++)
+			{
+				if (match & (0x80ull << (i << 3)))
+				{
+					const unsigned int slot = (position + i) & mask;
+					const Entry &entry = mEntries[mSlots[slot]];
+
+					if (entry.hash == key.hash && HashTable::IsEqual(entry.key, key.literal))
+					{
+						return slot;
+					}
+				}
+			}
+
+			if (group & (~group << 6) & HashTable::HIGH_BITS)	// The group has an empty slot, so the key was never inserted past it.
+			{
+				return HashTable::NOT_FOUND;
+			}
+
+			step += HashTable::GROUP_WIDTH;
+			position = (position + step) & mask;
+		}
+	}
+
+	unsigned int HashTable::FindEmptySlot(const size_t hash) const
+	{
+		const unsigned int mask = mCapacity - 1;
+		unsigned int position = HashTable::H1(hash) & mask;
+		unsigned int step = 0;
+
+		for (;;)
+		{
+			const unsigned long long group = LoadGroup(position);
+			const unsigned long long match = group & ~(group << 7) & HashTable::HIGH_BITS;	// Empty or deleted.
+
+			for (unsigned int i = 0; i < HashTable::GROUP_WIDTH; i++)
+			{
+				if (match & (0x80ull << (i << 3)))
+				{
+					return (position + i) & mask;
+				}
+			}
+
+			step += HashTable::GROUP_WIDTH;
+			position = (position + step) & mask;
+		}
+	}
+
+	void HashTable::Rehash(const unsigned int capacity)
+	{
+		using std::fill_n;
+		using std::remove_if;
+
+		signed char *control = new signed char[capacity + HashTable::GROUP_WIDTH];
+		unsigned int *slots;
+
+		try
+		{
+			slots = new unsigned int[capacity];
+		}
+		catch (...)
+		{
+			Utility::SafeArrayDelete(control);
+			throw;
+		}
+
+		mEntries.erase(remove_if(mEntries.begin(), mEntries.end(), HashTable::IsErased), mEntries.end());
+
+		Utility::SafeArrayDelete(mControl);
+		Utility::SafeArrayDelete(mSlots);
+
+		mControl = control;
+		mSlots = slots;
+		mCapacity = capacity;
+
+		fill_n(mControl, capacity + HashTable::GROUP_WIDTH, HashTable::EMPTY);
+
+		for (unsigned int i = 0; i < mEntries.size(); i++)
+		{
+			const unsigned int slot = FindEmptySlot(mEntries[i].hash);
+
+			SetControl(slot, HashTable::H2(mEntries[i].hash));
+			mSlots[slot] = i;
+		}
+
+		mGrowthLeft = capacity - (capacity >> 3) - mSize;
+	}
+}
\ No newline at end of file
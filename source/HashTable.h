@@ -0,0 +1,187 @@
+#ifndef HASH_TABLE
+#define HASH_TABLE
+
+#include <cstddef>
+#include <vector>
+
+#include "Literal.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::vector;
+
+	// Open addressing hash table keeping insertion order for foreach.
+	// Up to INLINE_CAPACITY entries are kept in the table itself and found by a linear scan, so a small table allocates nothing.
+	class HashTable
+	{
+	public:
+		// A key hashed once, to be looked up any number of times without hashing a string again.
+		struct Key
+		{
+			explicit Key(const Literal &literal) : literal(literal), hash(HashTable::Hash(literal))
+			{
+			}
+
+			Key(const Literal &literal, const size_t hash) : literal(literal), hash(hash)	// Of a literal equal to one already hashed.
+			{
+			}
+
+			Literal literal;
+			size_t hash;
+		};
+
+		struct Entry
+		{
+			Entry() : hash(0), isErased(false)
+			{
+			}
+
+			explicit Entry(const Key &key) : key(key.literal), hash(key.hash), isErased(false)
+			{
+			}
+
+			Literal key;
+			Literal value;
+			size_t hash;
+			bool isErased;
+		};
+
+		class ConstIterator
+		{
+		public:
+			ConstIterator(const Entry *entry, const Entry * const end) : mEntry(entry), mEnd(end)
+			{
+				SkipErased();
+			}
+
+			const Entry &operator*() const
+			{
+				return *mEntry;
+			}
+
+			const Entry *operator->() const
+			{
+				return mEntry;
+			}
+
+			ConstIterator &operator++()
+			{
+				mEntry++;
+				SkipErased();
+
+				return *this;
+			}
+
+			bool operator!=(const ConstIterator &iterator) const
+			{
+				return mEntry != iterator.mEntry;
+			}
+
+		private:
+			void SkipErased()
+			{
+				while (mEntry != mEnd && mEntry->isErased)
+				{
+					mEntry++;
+				}
+			}
+
+			const Entry *mEntry;
+			const Entry * const mEnd;
+		};
+
+		HashTable();
+		~HashTable();
+
+		HashTable(const HashTable &) = delete;
+		HashTable &operator=(const HashTable &) = delete;
+
+		unsigned int Size() const
+		{
+			return mSize;
+		}
+
+		ConstIterator begin() const
+		{
+			return ConstIterator(Entries(), Entries() + EntryCount());
+		}
+
+		ConstIterator end() const
+		{
+			return ConstIterator(Entries() + EntryCount(), Entries() + EntryCount());
+		}
+
+		Literal *Find(const Literal &key);
+		const Literal *Find(const Literal &key) const;
+		Literal *Find(const Key &key);
+		const Literal *Find(const Key &key) const;
+		Literal &Insert(const Literal &key);
+		Literal &Insert(const Key &key);
+		bool Erase(const Literal &key);
+
+		static size_t Hash(const Literal &key);
+		static bool IsEqual(const Literal &left, const Literal &right);
+
+	private:
+		static constexpr unsigned int INLINE_CAPACITY = 8;
+		static constexpr unsigned int GROUP_WIDTH = 8;
+		static constexpr unsigned int MINIMUM_CAPACITY = 16;
+
+		static constexpr unsigned int NOT_FOUND = ~0u;
+
+		static constexpr signed char EMPTY = -128;
+		static constexpr signed char DELETED = -2;
+
+		static constexpr unsigned long long LOW_BITS = 0x0101010101010101ull;
+		static constexpr unsigned long long HIGH_BITS = 0x8080808080808080ull;
+
+		static signed char H2(const size_t hash)
+		{
+			return static_cast<signed char>(hash & 0x7F);
+		}
+
+		static size_t H1(const size_t hash)
+		{
+			return hash >> 7;
+		}
+
+		// The inline entries after one erased are moved down over it, so none of them is marked erased.
+		Entry *Entries()
+		{
+			return mCapacity == 0 ? mInlineEntries : mEntries.data();
+		}
+
+		const Entry *Entries() const
+		{
+			return mCapacity == 0 ? mInlineEntries : mEntries.data();
+		}
+
+		unsigned int EntryCount() const
+		{
+			return mCapacity == 0 ? mSize : mEntries.size();
+		}
+
+		static bool IsErased(const Entry &entry)
+		{
+			return entry.isErased;
+		}
+
+		unsigned long long LoadGroup(const unsigned int position) const;
+		void SetControl(const unsigned int slot, const signed char control);
+		unsigned int FindEntry(const Key &key) const;
+		unsigned int FindSlot(const Key &key) const;
+		unsigned int FindEmptySlot(const size_t hash) const;
+		void Rehash(const unsigned int capacity);
+
+		Entry mInlineEntries[HashTable::INLINE_CAPACITY];	// Until the table outgrows them.
+		vector<Entry> mEntries;	// After.
+		signed char *mControl;
+		unsigned int *mSlots;
+		unsigned int mCapacity;
+		unsigned int mSize;
+		unsigned int mGrowthLeft;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,240 @@
+#ifndef STRUCT_IR
+#define STRUCT_IR
+
+#include <cstddef>
+#include <vector>
+
+#include "ByteCode.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::vector;
+
+	// SSA form of the code of a function, lifted from its ByteCode by IRBuilder. The registers and the frame slots are the variables.
+	// A value stays in the location it was defined in, so a phi only joins values of one location and lowering needs no copies.
+	struct IR
+	{
+		struct Value;
+		struct BasicBlock;
+
+		// Where the ByteCode holds a register operand, so that it can be made to read another register.
+		enum struct Field { IMPLICIT, OPERAND16, HIGH, LOW, HIGH_AND_LOW };
+
+		struct Instruction
+		{
+			Instruction(const ByteCode &code, BasicBlock * const block) : code(code), block(block), line(0), isPhi(false), hasSideEffect(false)
+			{
+			}
+
+			// A copy from another location, which holds the same value as its operand.
+			bool IsCopy() const
+			{
+				return !isPhi && (code.opcode == ByteCode::Opcode::MOVE || code.opcode == ByteCode::Opcode::LOAD_WORD || code.opcode == ByteCode::Opcode::STORE_WORD) &&
+					operands.size() == 1 && results.size() == 1;
+			}
+
+			ByteCode code;	// The targets are those of the ByteCode lifted until lowered.
+			BasicBlock * const block;
+			unsigned int line;	// Source line, carried into the line table of the code lowered.
+			vector<Value *> operands;	// In the order of the predecessors for a phi.
+			vector<Field> fields;
+			vector<Value *> results;
+			bool isPhi;
+			bool hasSideEffect;	// Kept even if no result is used.
+		};
+
+		struct Value
+		{
+			Value(const unsigned short location, Instruction * const definition) : location(location), definition(definition), replacement(nullptr)
+			{
+			}
+
+			unsigned short location;	// Moved only by RegisterAllocator.
+			Instruction * const definition;	// nullptr for the value a location has when the function is called.
+			vector<Instruction *> uses;	// Once per operand.
+			Value *replacement;
+		};
+
+		struct BasicBlock
+		{
+			explicit BasicBlock(const unsigned int address) : address(address), dominator(nullptr)
+			{
+			}
+
+			const unsigned int address;
+			vector<Instruction *> phis;
+			vector<Instruction *> instructions;
+			vector<BasicBlock *> predecessors;
+			vector<BasicBlock *> successors;
+			vector<Value *> values;	// Of each location on entry, to be resolved.
+			BasicBlock *dominator;	// Immediate.
+			vector<BasicBlock *> dominated;
+		};
+
+		IR() : variableCount(0), locationCount(0)
+		{
+		}
+
+		~IR()
+		{
+			for (auto i : blocks)
+			{
+				Utility::SafeDelete(i);
+			}
+			for (auto i : instructions)
+			{
+				Utility::SafeDelete(i);
+			}
+			for (auto i : values)
+			{
+				Utility::SafeDelete(i);
+			}
+		}
+
+		IR(const IR &) = delete;
+		IR &operator=(const IR &) = delete;
+
+		static unsigned short Location(const Register r)
+		{
+			return static_cast<unsigned short>(r);
+		}
+
+		static unsigned short SlotLocation(const unsigned short slot)
+		{
+			return static_cast<unsigned short>(Register::RA) + 1 + slot;
+		}
+
+		static bool IsRegister(const unsigned short location)	// Any of the registers the code may assign, GP and the ones after it are not.
+		{
+			return location < static_cast<unsigned short>(Register::GP);
+		}
+
+		static Value *Resolve(Value *value)
+		{
+			while (value && value->replacement)
+			{
+				value = value->replacement;
+			}
+
+			return value;
+		}
+
+		// The value a chain of copies started from.
+		static Value *Root(Value *value)
+		{
+			while (value->definition && value->definition->IsCopy())
+			{
+				value = value->definition->operands.front();
+			}
+
+			return value;
+		}
+
+		static void AddUse(Value * const value, Instruction * const instruction)
+		{
+			value->uses.push_back(instruction);
+		}
+
+		static void RemoveUse(Value * const value, Instruction * const instruction)
+		{
+			for (auto i = value->uses.begin(); i != value->uses.end(); i++)
+			{
+				if (*i == instruction)
+				{
+					value->uses.erase(i);
+
+					return;
+				}
+			}
+		}
+
+		// Makes an operand read the value from the location it is in, which has to be a register unless the operand is implicit.
+		static void SetOperand(Instruction * const instruction, const size_t index, Value * const value)
+		{
+			RemoveUse(instruction->operands[index], instruction);
+			AddUse(value, instruction);
+
+			instruction->operands[index] = value;
+
+			const short location = static_cast<short>(value->location);
+			ByteCode &code = instruction->code;
+
+			switch (instruction->fields[index])
+			{
+			case Field::OPERAND16:
+				code.operand16 = location;
+				break;
+
+			case Field::HIGH:
+				code.operand32 = (static_cast<long>(location) << 16) | (code.operand32 & 0xFFFFl);
+				break;
+
+			case Field::LOW:
+				code.operand32 = (code.operand32 & ~0xFFFFl) | (location & 0xFFFF);
+				break;
+
+			case Field::HIGH_AND_LOW:
+				code.operand32 = (static_cast<long>(location) << 16) | (location & 0xFFFF);
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		// Only between values of the same location, which the code then reads from where the other one was.
+		static void Replace(Value * const from, Value * const to)
+		{
+			for (auto i : from->uses)
+			{
+				for (auto &j : i->operands)
+				{
+					if (j == from)
+					{
+						j = to;
+						break;
+					}
+				}
+
+				AddUse(to, i);
+			}
+
+			from->uses.clear();
+			from->replacement = to;
+		}
+
+		// Drops the instruction from its block. It is kept alive until the IR is deleted.
+		static void Remove(Instruction * const instruction)
+		{
+			for (auto i : instruction->operands)
+			{
+				RemoveUse(i, instruction);
+			}
+
+			instruction->operands.clear();
+			instruction->fields.clear();
+
+			vector<Instruction *> &list = instruction->isPhi ? instruction->block->phis : instruction->block->instructions;
+
+			for (auto i = list.begin(); i != list.end(); i++)
+			{
+				if (*i == instruction)
+				{
+					list.erase(i);
+					break;
+				}
+			}
+		}
+
+		vector<BasicBlock *> blocks;	// The entry first, which defines the values on entry and leads to every entry of the function, then the others in the order of the code.
+		vector<Instruction *> instructions;
+		vector<Value *> values;
+		unsigned short variableCount;	// Slots from here on are the temporaries, addressed from SP.
+		unsigned short locationCount;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,913 @@
+#include "IRBuilder.h"
+
+#include <utility>
+#include <unordered_map>
+
+namespace lyrics
+{
+	using std::pair;
+	using std::unordered_map;
+
+	IR *IRBuilder::Build(const Module &module, const Function &function)
+	{
+		mIR = new IR();
+		mModule = &module;
+		mFunction = &function;
+		mOrder.clear();
+
+		try
+		{
+			mIR->variableCount = function.variableCount;
+			mIR->locationCount = IR::SlotLocation(function.variableCount + function.temporaryCount);
+
+			if (!Split())
+			{
+				Utility::SafeDelete(mIR);
+
+				return nullptr;
+			}
+
+			Prune();
+
+			if (!Lift())
+			{
+				Utility::SafeDelete(mIR);
+
+				return nullptr;
+			}
+
+			Join();
+			Dominate();
+		}
+		catch (...)
+		{
+			Utility::SafeDelete(mIR);
+			throw;
+		}
+
+		return mIR;
+	}
+
+	void IRBuilder::FindTargets(const Function &function, const ByteCode &code, vector<unsigned int> &targets)
+	{
+		switch (code.opcode)
+		{
+		case ByteCode::Opcode::JUMP:
+		case ByteCode::Opcode::BRANCH_IF_TRUE:
+		case ByteCode::Opcode::BRANCH_IF_FALSE:
+			targets.push_back(static_cast<unsigned int>(code.operand32));
+			break;
+
+		case ByteCode::Opcode::BRANCH_ON_EQUAL:
+		case ByteCode::Opcode::BRANCH_ON_NOT_EQUAL:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL:
+		case ByteCode::Opcode::BRANCH_IF_NOT_OUTPUT:
+		case ByteCode::Opcode::NEXT_ELEMENT:
+		case ByteCode::Opcode::BRANCH_ON_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_ON_NOT_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL_IMMEDIATE:
+			targets.push_back(static_cast<unsigned int>(code.operand32 & 0xFFFF));
+			break;
+
+		case ByteCode::Opcode::TABLE_SWITCH:
+		case ByteCode::Opcode::HASH_SWITCH:
+			if (static_cast<unsigned long>(code.operand32) < function.jumpTables.size())
+			{
+				const JumpTable &jumpTable = function.jumpTables[code.operand32];
+
+				targets.insert(targets.end(), jumpTable.targets.cbegin(), jumpTable.targets.cend());
+
+				for (auto &i : jumpTable.strings)
+				{
+					targets.push_back(i.second);
+				}
+
+				targets.push_back(jumpTable.defaultTarget);
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	bool IRBuilder::FallsThrough(const ByteCode::Opcode opcode)
+	{
+		switch (opcode)
+		{
+		case ByteCode::Opcode::JUMP:
+		case ByteCode::Opcode::JUMP_REGISTER:
+		case ByteCode::Opcode::TAIL_CALL:
+		case ByteCode::Opcode::TAIL_CALL_MEMBER:
+		case ByteCode::Opcode::RETURN:
+		case ByteCode::Opcode::RETURN_REGISTER:
+		case ByteCode::Opcode::RETURN_CONSTANT:
+			return false;
+
+		default:
+			return true;
+		}
+	}
+
+	// A block starts at every target and entry, and after every instruction that may not fall through to the next one.
+	bool IRBuilder::Split()
+	{
+		const vector<ByteCode> &code = mFunction->code;
+
+		if (code.empty() || FallsThrough(code.back().opcode))
+		{
+			return false;
+		}
+
+		vector<bool> isLeader(code.size() + 1, false);
+		vector<unsigned int> targets;
+
+		isLeader[0] = true;
+
+		for (auto i : mFunction->entries)
+		{
+			if (i >= code.size())
+			{
+				return false;
+			}
+
+			isLeader[i] = true;
+		}
+
+		for (unsigned int i = 0; i < code.size(); i++)
+		{
+			targets.clear();
+			FindTargets(*mFunction, code[i], targets);
+
+			for (auto j : targets)
+			{
+				if (j >= code.size())
+				{
+					return false;
+				}
+
+				isLeader[j] = true;
+			}
+
+			if (code[i].opcode == ByteCode::Opcode::TABLE_SWITCH || code[i].opcode == ByteCode::Opcode::HASH_SWITCH)
+			{
+				if (static_cast<unsigned long>(code[i].operand32) >= mFunction->jumpTables.size())
+				{
+					return false;
+				}
+			}
+
+			if (!targets.empty() || !FallsThrough(code[i].opcode))
+			{
+				isLeader[i + 1] = true;
+			}
+		}
+
+		vector<IR::BasicBlock *> leaders(code.size(), nullptr);
+
+		mIR->blocks.push_back(nullptr);
+		mIR->blocks.back() = new IR::BasicBlock(0);
+
+		for (unsigned int i = 0; i < code.size(); i++)
+		{
+			if (isLeader[i])
+			{
+				mIR->blocks.push_back(nullptr);
+				mIR->blocks.back() = new IR::BasicBlock(i);
+				leaders[i] = mIR->blocks.back();
+			}
+		}
+
+		auto link = [](IR::BasicBlock * const from, IR::BasicBlock * const to)
+		{
+			for (auto i : from->successors)
+			{
+				if (i == to)
+				{
+					return;
+				}
+			}
+
+			from->successors.push_back(to);
+			to->predecessors.push_back(from);
+		};
+
+		link(mIR->blocks.front(), leaders[0]);
+
+		for (auto i : mFunction->entries)
+		{
+			link(mIR->blocks.front(), leaders[i]);
+		}
+
+		IR::BasicBlock *block = nullptr;
+
+		for (unsigned int i = 0; i < code.size(); i++)
+		{
+			if (leaders[i])
+			{
+				block = leaders[i];
+			}
+
+			block->instructions.push_back(CreateInstruction(code[i], block));
+
+			if (i < mFunction->lines.size())
+			{
+				block->instructions.back()->line = mFunction->lines[i];
+			}
+
+			if (isLeader[i + 1])
+			{
+				if (FallsThrough(code[i].opcode))
+				{
+					link(block, leaders[i + 1]);
+				}
+
+				targets.clear();
+				FindTargets(*mFunction, code[i], targets);
+
+				for (auto j : targets)
+				{
+					link(block, leaders[j]);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Drops the blocks no entry reaches, such as a jump left behind a return.
+	void IRBuilder::Prune()
+	{
+		vector<IR::BasicBlock *> postorder;
+		unordered_map<IR::BasicBlock *, bool> isVisited;
+		vector<pair<IR::BasicBlock *, size_t>> stack;
+
+		stack.emplace_back(mIR->blocks.front(), 0);
+		isVisited[mIR->blocks.front()] = true;
+
+		while (!stack.empty())
+		{
+			IR::BasicBlock * const block = stack.back().first;
+			const size_t index = stack.back().second++;
+
+			if (index < block->successors.size())
+			{
+				IR::BasicBlock * const successor = block->successors[index];
+
+				if (!isVisited[successor])
+				{
+					isVisited[successor] = true;
+					stack.emplace_back(successor, 0);
+				}
+			}
+			else
+			{
+				postorder.push_back(block);
+				stack.pop_back();
+			}
+		}
+
+		mOrder.assign(postorder.rbegin(), postorder.rend());
+
+		vector<IR::BasicBlock *> blocks;
+
+		for (auto i : mIR->blocks)
+		{
+			if (isVisited[i])
+			{
+				blocks.push_back(i);
+			}
+			else
+			{
+				Utility::SafeDelete(i);
+			}
+		}
+
+		mIR->blocks.swap(blocks);
+
+		for (auto i : mIR->blocks)
+		{
+			vector<IR::BasicBlock *> predecessors;
+
+			for (auto j : i->predecessors)
+			{
+				if (isVisited[j])
+				{
+					predecessors.push_back(j);
+				}
+			}
+
+			i->predecessors.swap(predecessors);
+		}
+	}
+
+	// Blocks are lifted in reverse postorder, so that the single predecessor of a block is lifted before it.
+	bool IRBuilder::Lift()
+	{
+		const unsigned short count = mIR->locationCount;
+		unordered_map<IR::BasicBlock *, vector<IR::Value *>> exits;
+
+		for (auto i : mIR->blocks)
+		{
+			if (i->predecessors.size() > 1)
+			{
+				for (unsigned short j = 0; j < count; j++)
+				{
+					IR::Instruction * const phi = CreateInstruction(ByteCode(ByteCode::Opcode::NO_OPERATION), i);
+
+					phi->isPhi = true;
+					phi->results.push_back(CreateValue(j, phi));
+					i->phis.push_back(phi);
+				}
+			}
+		}
+
+		for (auto i : mOrder)
+		{
+			if (i == mIR->blocks.front())
+			{
+				mState.assign(count, nullptr);
+
+				for (unsigned short j = 0; j < count; j++)
+				{
+					mState[j] = CreateValue(j, nullptr);
+				}
+			}
+			else if (i->predecessors.size() == 1)
+			{
+				mState = exits[i->predecessors.front()];
+			}
+			else
+			{
+				for (unsigned short j = 0; j < count; j++)
+				{
+					mState[j] = i->phis[j]->results.front();
+				}
+			}
+
+			i->values = mState;
+
+			for (auto j : i->instructions)
+			{
+				if (!Lift(j))
+				{
+					return false;
+				}
+			}
+
+			exits[i] = mState;
+		}
+
+		for (auto i : mIR->blocks)
+		{
+			for (auto j : i->phis)
+			{
+				for (auto k : i->predecessors)
+				{
+					IR::Value * const value = exits[k][j->results.front()->location];
+
+					j->operands.push_back(value);
+					j->fields.push_back(IR::Field::IMPLICIT);
+					IR::AddUse(value, j);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// Uses are taken before the results are defined, as the operands are read before the destination is written.
+	bool IRBuilder::Lift(IR::Instruction * const instruction)
+	{
+		const ByteCode &code = instruction->code;
+		const short high = static_cast<short>(code.operand32 >> 16);
+		const short low = static_cast<short>(code.operand32 & 0xFFFF);
+		const Register base = static_cast<Register>(high);
+
+		switch (code.opcode)
+		{
+		case ByteCode::Opcode::NO_OPERATION:
+			return true;
+
+		case ByteCode::Opcode::DIVIDE:
+		case ByteCode::Opcode::REMAINDER:
+		case ByteCode::Opcode::DYNAMIC_ADD:
+		case ByteCode::Opcode::DYNAMIC_SUBTRACT:
+		case ByteCode::Opcode::DYNAMIC_MULTIPLY:
+		case ByteCode::Opcode::DYNAMIC_DIVIDE:
+		case ByteCode::Opcode::DYNAMIC_REMAINDER:
+		case ByteCode::Opcode::DYNAMIC_AND:
+		case ByteCode::Opcode::DYNAMIC_OR:
+		case ByteCode::Opcode::DYNAMIC_XOR:
+		case ByteCode::Opcode::DYNAMIC_SHIFT_LEFT:
+		case ByteCode::Opcode::DYNAMIC_SHIFT_RIGHT:
+		case ByteCode::Opcode::DYNAMIC_SET_ON_LESS_THAN:
+		case ByteCode::Opcode::DYNAMIC_SET_ON_LESS_THAN_OR_EQUAL:
+		case ByteCode::Opcode::DYNAMIC_SET_ON_EQUAL:
+		case ByteCode::Opcode::DYNAMIC_SET_ON_NOT_EQUAL:
+		case ByteCode::Opcode::REFERENCE_ARRAY_ELEMENT:
+		case ByteCode::Opcode::REFERENCE_HASH_ELEMENT:
+		case ByteCode::Opcode::REFERENCE_ELEMENT:
+			instruction->hasSideEffect = true;	// May raise an error.
+			return Use(instruction, high, IR::Field::HIGH) && Use(instruction, low, IR::Field::LOW) && Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::ADD:
+		case ByteCode::Opcode::SUBTRACT:
+		case ByteCode::Opcode::MULTIPLY:
+		case ByteCode::Opcode::FLOATING_POINT_ADD:
+		case ByteCode::Opcode::FLOATING_POINT_SUBTRACT:
+		case ByteCode::Opcode::FLOATING_POINT_MULTIPLY:
+		case ByteCode::Opcode::FLOATING_POINT_DIVIDE:
+		case ByteCode::Opcode::NAND:
+		case ByteCode::Opcode::NOR:
+		case ByteCode::Opcode::AND:
+		case ByteCode::Opcode::OR:
+		case ByteCode::Opcode::XOR:
+		case ByteCode::Opcode::SHIFT_LEFT:
+		case ByteCode::Opcode::SHIFT_RIGHT:
+		case ByteCode::Opcode::SET_ON_LESS_THAN:
+		case ByteCode::Opcode::SET_ON_LESS_THAN_OR_EQUAL:
+		case ByteCode::Opcode::SET_ON_EQUAL:
+		case ByteCode::Opcode::SET_ON_NOT_EQUAL:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_LESS_THAN:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_LESS_THAN_OR_EQUAL:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_EQUAL:
+		case ByteCode::Opcode::FLOATING_POINT_SET_ON_NOT_EQUAL:
+			return Use(instruction, high, IR::Field::HIGH) && Use(instruction, low, IR::Field::LOW) && Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::DYNAMIC_NEGATE:
+		case ByteCode::Opcode::DYNAMIC_PLUS:
+		case ByteCode::Opcode::DYNAMIC_NOT:
+		case ByteCode::Opcode::DYNAMIC_LOGICAL_NOT:
+		case ByteCode::Opcode::CONSTRUCT_ITERATOR:
+			instruction->hasSideEffect = true;
+			return Use(instruction, high, high == low ? IR::Field::HIGH_AND_LOW : IR::Field::HIGH) && Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::NEGATE:
+		case ByteCode::Opcode::FLOATING_POINT_NEGATE:
+		case ByteCode::Opcode::CONVERT_TO_FLOATING_POINT:
+		case ByteCode::Opcode::NOT:
+		case ByteCode::Opcode::LOGICAL_NOT:
+		case ByteCode::Opcode::MOVE:
+			return Use(instruction, high, high == low ? IR::Field::HIGH_AND_LOW : IR::Field::HIGH) && Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::ADD_IMMEDIATE:
+		case ByteCode::Opcode::AND_IMMEDIATE:
+		case ByteCode::Opcode::OR_IMMEDIATE:
+		case ByteCode::Opcode::SET_ON_LESS_THAN_IMMEDIATE:
+			return Use(instruction, high, IR::Field::HIGH) && Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::LOAD_WORD_IMMEDIATE:
+		case ByteCode::Opcode::LOAD_CONSTANT:
+		case ByteCode::Opcode::LOAD_UPVALUE:
+		case ByteCode::Opcode::LOAD_BOXED_UPVALUE:
+			return Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::LOAD_WORD:
+			if (base == Register::GP)
+			{
+				return Define(instruction, code.operand16);
+			}
+
+			return UseSlot(instruction, base, low) && Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::STORE_WORD:
+			if (base == Register::GP)
+			{
+				instruction->hasSideEffect = true;
+
+				return Use(instruction, code.operand16, IR::Field::OPERAND16);
+			}
+
+			return Use(instruction, code.operand16, IR::Field::OPERAND16) && DefineSlot(instruction, base, low);
+
+		case ByteCode::Opcode::STORE_WORD_IMMEDIATE:
+			if (base == Register::GP)
+			{
+				instruction->hasSideEffect = true;
+
+				return true;
+			}
+
+			return DefineSlot(instruction, base, low);
+
+		case ByteCode::Opcode::ADD_IMMEDIATE_WORD:
+			if (base == Register::GP)
+			{
+				instruction->hasSideEffect = true;
+
+				return true;
+			}
+
+			return UseSlot(instruction, base, low) && DefineSlot(instruction, base, low);
+
+		case ByteCode::Opcode::LOAD_BOX:
+			return UseSlot(instruction, base, low) && Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::STORE_BOX:
+			instruction->hasSideEffect = true;
+			return Use(instruction, code.operand16, IR::Field::OPERAND16) && UseSlot(instruction, base, low);
+
+		case ByteCode::Opcode::CONSTRUCT_BOX:
+			instruction->hasSideEffect = true;
+			return UseSlot(instruction, Register::FP, code.operand32) && DefineSlot(instruction, Register::FP, code.operand32);
+
+		case ByteCode::Opcode::STORE_BOXED_UPVALUE:
+			instruction->hasSideEffect = true;
+			return Use(instruction, code.operand16, IR::Field::OPERAND16);
+
+		case ByteCode::Opcode::REFERENCE_MEMBER:
+			instruction->hasSideEffect = true;
+			return Use(instruction, high, IR::Field::HIGH) && Define(instruction, code.operand16);
+
+		case ByteCode::Opcode::STORE_ARRAY_ELEMENT:
+		case ByteCode::Opcode::STORE_HASH_ELEMENT:
+		case ByteCode::Opcode::STORE_ELEMENT:
+			instruction->hasSideEffect = true;
+			return Use(instruction, code.operand16, IR::Field::OPERAND16) && Use(instruction, high, IR::Field::HIGH) && Use(instruction, low, IR::Field::LOW);
+
+		case ByteCode::Opcode::STORE_MEMBER:
+			instruction->hasSideEffect = true;
+			return Use(instruction, code.operand16, IR::Field::OPERAND16) && Use(instruction, high, IR::Field::HIGH);
+
+		case ByteCode::Opcode::CONSTRUCT_ARRAY:
+		case ByteCode::Opcode::CONSTRUCT_HASH:
+		case ByteCode::Opcode::CONSTRUCT_LOCAL_ARRAY:
+		case ByteCode::Opcode::CONSTRUCT_LOCAL_HASH:
+			{
+				const bool isHash = code.opcode == ByteCode::Opcode::CONSTRUCT_HASH || code.opcode == ByteCode::Opcode::CONSTRUCT_LOCAL_HASH;
+				const int count = isHash ? low * 2 : low;
+
+				for (int i = 0; i < count; i++)
+				{
+					if (!UseSlot(instruction, Register::SP, high + i))
+					{
+						return false;
+					}
+				}
+
+				if (code.opcode == ByteCode::Opcode::CONSTRUCT_ARRAY || code.opcode == ByteCode::Opcode::CONSTRUCT_HASH)
+				{
+					instruction->hasSideEffect = isHash;	// A key may not be hashable.
+
+					return Define(instruction, code.operand16);
+				}
+
+				instruction->hasSideEffect = true;
+
+				return DefineSlot(instruction, Register::FP, code.operand16);
+			}
+
+		case ByteCode::Opcode::CONSTRUCT_FUNCTION:
+			if (static_cast<unsigned long>(code.operand32) >= mModule->functions.size())
+			{
+				return false;
+			}
+
+			for (auto &i : mModule->functions[code.operand32]->upvalues)
+			{
+				if (i.isLocal && !UseSlot(instruction, Register::FP, i.index))
+				{
+					return false;
+				}
+			}
+
+			return Define(instruction, code.operand16);
+
+		// The temporaries from the callee up become its frame, so they are all assigned by the call, as are the registers.
+		case ByteCode::Opcode::CALL:
+		case ByteCode::Opcode::CALL_MEMBER:
+		case ByteCode::Opcode::CALL_BASE_CLASS_CONSTRUCTOR:
+			instruction->hasSideEffect = true;
+
+			if (code.opcode == ByteCode::Opcode::CALL_BASE_CLASS_CONSTRUCTOR && !UseSlot(instruction, Register::FP, 0))
+			{
+				return false;
+			}
+
+			for (int i = 0; i <= low; i++)
+			{
+				if (!UseSlot(instruction, Register::SP, code.operand16 + i))
+				{
+					return false;
+				}
+			}
+
+			for (short i = 0; i < static_cast<short>(Register::GP); i++)
+			{
+				Define(instruction, i);
+			}
+
+			for (int i = code.operand16; i < mFunction->temporaryCount; i++)
+			{
+				DefineSlot(instruction, Register::SP, i);
+			}
+
+			return true;
+
+		case ByteCode::Opcode::TAIL_CALL:
+		case ByteCode::Opcode::TAIL_CALL_MEMBER:
+			instruction->hasSideEffect = true;
+
+			for (int i = 0; i <= low; i++)
+			{
+				if (!UseSlot(instruction, Register::SP, code.operand16 + i))
+				{
+					return false;
+				}
+			}
+
+			return true;
+
+		case ByteCode::Opcode::RETURN:
+		case ByteCode::Opcode::RETURN_REGISTER:
+		case ByteCode::Opcode::RETURN_CONSTANT:
+			instruction->hasSideEffect = true;
+
+			if (code.opcode == ByteCode::Opcode::RETURN && !Use(instruction, static_cast<short>(Register::V0), IR::Field::IMPLICIT))
+			{
+				return false;
+			}
+
+			if (code.opcode == ByteCode::Opcode::RETURN_REGISTER && !Use(instruction, code.operand16, IR::Field::OPERAND16))
+			{
+				return false;
+			}
+
+			for (auto i : mFunction->outputParameters)
+			{
+				if (!UseSlot(instruction, Register::FP, i + 1))
+				{
+					return false;
+				}
+			}
+
+			return true;
+
+		case ByteCode::Opcode::JUMP:
+			instruction->hasSideEffect = true;
+			return true;
+
+		case ByteCode::Opcode::BRANCH_IF_TRUE:
+		case ByteCode::Opcode::BRANCH_IF_FALSE:
+		case ByteCode::Opcode::TABLE_SWITCH:
+		case ByteCode::Opcode::HASH_SWITCH:
+			instruction->hasSideEffect = true;
+			return Use(instruction, code.operand16, IR::Field::OPERAND16);
+
+		case ByteCode::Opcode::BRANCH_ON_EQUAL:
+		case ByteCode::Opcode::BRANCH_ON_NOT_EQUAL:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL:
+			instruction->hasSideEffect = true;
+			return Use(instruction, code.operand16, IR::Field::OPERAND16) && Use(instruction, high, IR::Field::HIGH);
+
+		case ByteCode::Opcode::BRANCH_ON_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_ON_NOT_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL_IMMEDIATE:
+			instruction->hasSideEffect = true;
+			return Use(instruction, code.operand16, IR::Field::OPERAND16);
+
+		case ByteCode::Opcode::BRANCH_IF_NOT_OUTPUT:
+			instruction->hasSideEffect = true;
+			return UseSlot(instruction, Register::SP, code.operand16);
+
+		case ByteCode::Opcode::NEXT_ELEMENT:
+			instruction->hasSideEffect = true;
+			return Use(instruction, high, IR::Field::HIGH) && Define(instruction, code.operand16);
+
+		default:
+			return false;
+		}
+	}
+
+	// Drops the phis joining a single value, until no more can be.
+	void IRBuilder::Join()
+	{
+		bool isChanged = true;
+
+		while (isChanged)
+		{
+			isChanged = false;
+
+			for (auto i : mIR->blocks)
+			{
+				const vector<IR::Instruction *> phis = i->phis;
+
+				for (auto j : phis)
+				{
+					IR::Value * const result = j->results.front();
+					IR::Value *same = nullptr;
+					bool isTrivial = true;
+
+					for (auto k : j->operands)
+					{
+						if (k == result || k == same)
+						{
+							continue;
+						}
+
+						if (same)
+						{
+							isTrivial = false;
+							break;
+						}
+
+						same = k;
+					}
+
+					if (isTrivial && same)
+					{
+						IR::Replace(result, same);
+						IR::Remove(j);
+						isChanged = true;
+					}
+				}
+			}
+		}
+	}
+
+	// Cooper, Harvey and Kennedy's iteration over the reverse postorder.
+	void IRBuilder::Dominate()
+	{
+		unordered_map<IR::BasicBlock *, size_t> indices;
+
+		for (size_t i = 0; i < mOrder.size(); i++)
+		{
+			indices[mOrder[i]] = i;
+		}
+
+		IR::BasicBlock * const entry = mOrder.front();
+		bool isChanged = true;
+
+		entry->dominator = entry;
+
+		while (isChanged)
+		{
+			isChanged = false;
+
+			for (size_t i = 1; i < mOrder.size(); i++)
+			{
+				IR::BasicBlock * const block = mOrder[i];
+				IR::BasicBlock *dominator = nullptr;
+
+				for (auto j : block->predecessors)
+				{
+					if (!j->dominator)
+					{
+						continue;
+					}
+
+					if (!dominator)
+					{
+						dominator = j;
+						continue;
+					}
+
+					IR::BasicBlock *left = j;
+					IR::BasicBlock *right = dominator;
+
+					while (left != right)
+					{
+						while (indices[left] > indices[right])
+						{
+							left = left->dominator;
+						}
+						while (indices[right] > indices[left])
+						{
+							right = right->dominator;
+						}
+					}
+
+					dominator = left;
+				}
+
+				if (block->dominator != dominator)
+				{
+					block->dominator = dominator;
+					isChanged = true;
+				}
+			}
+		}
+
+		entry->dominator = nullptr;
+
+		for (size_t i = 1; i < mOrder.size(); i++)
+		{
+			mOrder[i]->dominator->dominated.push_back(mOrder[i]);
+		}
+	}
+
+	bool IRBuilder::Use(IR::Instruction * const instruction, const short r, const IR::Field field)
+	{
+		if (r < 0 || !IR::IsRegister(static_cast<unsigned short>(r)))
+		{
+			return false;
+		}
+
+		instruction->operands.push_back(mState[r]);
+		instruction->fields.push_back(field);
+		IR::AddUse(mState[r], instruction);
+
+		return true;
+	}
+
+	bool IRBuilder::UseSlot(IR::Instruction * const instruction, const Register base, const int offset)
+	{
+		unsigned short location;
+
+		if (!Slot(base, offset, location))
+		{
+			return false;
+		}
+
+		instruction->operands.push_back(mState[location]);
+		instruction->fields.push_back(IR::Field::IMPLICIT);
+		IR::AddUse(mState[location], instruction);
+
+		return true;
+	}
+
+	bool IRBuilder::Define(IR::Instruction * const instruction, const short r)
+	{
+		if (r < 0 || !IR::IsRegister(static_cast<unsigned short>(r)))
+		{
+			return false;
+		}
+
+		mState[r] = CreateValue(static_cast<unsigned short>(r), instruction);
+		instruction->results.push_back(mState[r]);
+
+		return true;
+	}
+
+	bool IRBuilder::DefineSlot(IR::Instruction * const instruction, const Register base, const int offset)
+	{
+		unsigned short location;
+
+		if (!Slot(base, offset, location))
+		{
+			return false;
+		}
+
+		mState[location] = CreateValue(location, instruction);
+		instruction->results.push_back(mState[location]);
+
+		return true;
+	}
+
+	bool IRBuilder::Slot(const Register base, const int offset, unsigned short &location) const
+	{
+		int slot;
+
+		switch (base)
+		{
+		case Register::FP:
+			slot = offset;
+			break;
+
+		case Register::SP:
+			slot = mIR->variableCount + offset;
+			break;
+
+		default:
+			return false;
+		}
+
+		if (offset < 0 || IR::SlotLocation(0) + slot >= mIR->locationCount)
+		{
+			return false;
+		}
+
+		location = IR::SlotLocation(static_cast<unsigned short>(slot));
+
+		return true;
+	}
+
+	IR::Value *IRBuilder::CreateValue(const unsigned short location, IR::Instruction * const definition)
+	{
+		mIR->values.push_back(nullptr);
+		mIR->values.back() = new IR::Value(location, definition);
+
+		return mIR->values.back();
+	}
+
+	IR::Instruction *IRBuilder::CreateInstruction(const ByteCode &code, IR::BasicBlock * const block)
+	{
+		mIR->instructions.push_back(nullptr);
+		mIR->instructions.back() = new IR::Instruction(code, block);
+
+		return mIR->instructions.back();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef IR_BUILDER
+#define IR_BUILDER
+
+#include <vector>
+
+#include "ByteCode.h"
+#include "Function.h"
+#include "Module.h"
+#include "IR.h"
+
+namespace lyrics
+{
+	using std::vector;
+
+	// Lifts the code of a function into SSA form. A phi is put for every location at every join first, and the ones joining a single value are dropped after.
+	class IRBuilder
+	{
+	public:
+		IR *Build(const Module &module, const Function &function);	// nullptr if the code has any opcode not modeled, which leaves the function as it is.
+
+		static void FindTargets(const Function &function, const ByteCode &code, vector<unsigned int> &targets);
+		static bool FallsThrough(const ByteCode::Opcode opcode);
+
+	private:
+		bool Split();
+		void Prune();
+		bool Lift();
+		bool Lift(IR::Instruction * const instruction);
+		void Join();
+		void Dominate();
+
+		bool Use(IR::Instruction * const instruction, const short r, const IR::Field field);
+		bool UseSlot(IR::Instruction * const instruction, const Register base, const int offset);
+		bool Define(IR::Instruction * const instruction, const short r);
+		bool DefineSlot(IR::Instruction * const instruction, const Register base, const int offset);
+		bool Slot(const Register base, const int offset, unsigned short &location) const;
+		IR::Value *CreateValue(const unsigned short location, IR::Instruction * const definition);
+		IR::Instruction *CreateInstruction(const ByteCode &code, IR::BasicBlock * const block);
+
+		IR *mIR;
+		const Module *mModule;
+		const Function *mFunction;
+		vector<IR::BasicBlock *> mOrder;	// Reverse postorder.
+		vector<IR::Value *> mState;	// Of each location, while lifting a block.
+	};
+}
+
+#endif
\ No newline at end of file
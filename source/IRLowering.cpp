@@ -0,0 +1,98 @@
+#include "IRLowering.h"
+
+#include <vector>
+
+namespace lyrics
+{
+	using std::vector;
+
+	// Phis cost nothing here, as the values they join are already in the same location.
+	void IRLowering::Lower(const IR &ir, Function &function)
+	{
+		vector<ByteCode> code;
+		vector<unsigned int> lines;
+
+		mAddresses.clear();
+
+		for (auto i = ir.blocks.cbegin() + 1; i != ir.blocks.cend(); i++)
+		{
+			mAddresses[(*i)->address] = code.size();
+
+			for (auto j : (*i)->instructions)
+			{
+				code.push_back(j->code);
+				lines.push_back(j->line);
+			}
+
+			// A jump to the block right after is dropped, falling through costs no dispatch.
+			if (!code.empty() && code.back().opcode == ByteCode::Opcode::JUMP && i + 1 != ir.blocks.cend() && static_cast<unsigned int>(code.back().operand32) == (*(i + 1))->address)
+			{
+				code.pop_back();
+				lines.pop_back();
+			}
+		}
+
+		for (auto &i : code)
+		{
+			switch (i.opcode)
+			{
+			case ByteCode::Opcode::JUMP:
+			case ByteCode::Opcode::BRANCH_IF_TRUE:
+			case ByteCode::Opcode::BRANCH_IF_FALSE:
+				i.operand32 = Relocate(static_cast<unsigned int>(i.operand32));
+				break;
+
+			case ByteCode::Opcode::BRANCH_ON_EQUAL:
+			case ByteCode::Opcode::BRANCH_ON_NOT_EQUAL:
+			case ByteCode::Opcode::BRANCH_IF_LESS_THAN:
+			case ByteCode::Opcode::BRANCH_IF_GREATER_THAN:
+			case ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL:
+			case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL:
+			case ByteCode::Opcode::BRANCH_IF_NOT_OUTPUT:
+			case ByteCode::Opcode::NEXT_ELEMENT:
+			case ByteCode::Opcode::BRANCH_ON_EQUAL_IMMEDIATE:
+			case ByteCode::Opcode::BRANCH_ON_NOT_EQUAL_IMMEDIATE:
+			case ByteCode::Opcode::BRANCH_IF_LESS_THAN_IMMEDIATE:
+			case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_IMMEDIATE:
+			case ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL_IMMEDIATE:
+			case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL_IMMEDIATE:
+				i.operand32 = (i.operand32 & ~0xFFFFl) | (Relocate(static_cast<unsigned int>(i.operand32 & 0xFFFF)) & 0xFFFFu);
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		for (auto &i : function.jumpTables)
+		{
+			for (auto &j : i.targets)
+			{
+				j = Relocate(j);
+			}
+
+			for (auto &j : i.strings)
+			{
+				j.second = Relocate(j.second);
+			}
+
+			i.defaultTarget = Relocate(i.defaultTarget);
+		}
+
+		for (auto &i : function.entries)
+		{
+			i = Relocate(i);
+		}
+
+		function.code.swap(code);
+		function.lines.swap(lines);
+	}
+
+	// A target no block starts at any more is only left in a jump table of a switch that was dropped.
+	unsigned int IRLowering::Relocate(const unsigned int target) const
+	{
+		auto address = mAddresses.find(target);
+
+		return address != mAddresses.end() ? address->second : target;
+	}
+}
\ No newline at end of file
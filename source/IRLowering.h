@@ -0,0 +1,26 @@
+#ifndef IR_LOWERING
+#define IR_LOWERING
+
+#include <unordered_map>
+
+#include "Function.h"
+#include "IR.h"
+
+namespace lyrics
+{
+	using std::unordered_map;
+
+	// Puts the code of the IR back into the function, in the order of the blocks, and moves the targets, the entries and the jump tables along.
+	class IRLowering
+	{
+	public:
+		void Lower(const IR &ir, Function &function);
+
+	private:
+		unsigned int Relocate(const unsigned int target) const;
+
+		unordered_map<unsigned int, unsigned int> mAddresses;	// Where each block starts, by where it started in the ByteCode lifted.
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef STRUCT_INLINE_CACHE
+#define STRUCT_INLINE_CACHE
+
+#include "Shape.h"
+
+namespace lyrics
+{
+	// Per site cache of REFERENCE_MEMBER and CALL_MEMBER. A hit costs a shape comparison and an indexed load.
+	struct InlineCache
+	{
+		enum struct State : unsigned char { UNINITIALIZED, MONOMORPHIC, POLYMORPHIC, MEGAMORPHIC };
+
+		static constexpr unsigned int POLYMORPHIC_LIMIT = 4;
+
+		explicit InlineCache(const unsigned int member) : member(member), state(State::UNINITIALIZED), count(0)
+		{
+		}
+
+		unsigned int Lookup(const Shape * const shape) const
+		{
+			for (unsigned int i = 0; i < count; i++)
+			{
+				if (shapes[i] == shape)
+				{
+					return slots[i];
+				}
+			}
+
+			return Shape::NOT_FOUND;
+		}
+
+		void Update(const Shape * const shape, const unsigned int slot)
+		{
+			if (count < InlineCache::POLYMORPHIC_LIMIT)
+			{
+				shapes[count] = shape;
+				slots[count] = slot;
+				count++;
+
+				state = count == 1 ? State::MONOMORPHIC : State::POLYMORPHIC;
+			}
+			else
+			{
+				state = State::MEGAMORPHIC;
+			}
+		}
+
+		const unsigned int member;
+		State state;
+		unsigned int count;
+		const Shape *shapes[InlineCache::POLYMORPHIC_LIMIT];
+		unsigned int slots[InlineCache::POLYMORPHIC_LIMIT];
+	};
+}
+
+#endif
\ No newline at end of file
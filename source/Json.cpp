@@ -0,0 +1,522 @@
+#include "Json.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace lyrics
+{
+	constexpr unsigned int Json::MAX_DEPTH;
+
+	Json Json::Array()
+	{
+		Json value;
+
+		value.mType = Type::ARRAY;
+
+		return value;
+	}
+
+	Json Json::Object()
+	{
+		Json value;
+
+		value.mType = Type::OBJECT;
+
+		return value;
+	}
+
+	bool Json::Parse(const string &text, Json &value)
+	{
+		size_t index = 0;
+
+		if (!value.Parse(text, index, 0))
+		{
+			return false;
+		}
+
+		Skip(text, index);
+
+		return index == text.size();
+	}
+
+	const Json &Json::Get(const string &key) const
+	{
+		static const Json null;
+
+		for (size_t i = 0; i < mKeys.size(); i++)
+		{
+			if (mKeys[i] == key)
+			{
+				return mElements[i];
+			}
+		}
+
+		return null;
+	}
+
+	Json &Json::Add(const Json &element)
+	{
+		mElements.push_back(element);
+
+		return *this;
+	}
+
+	Json &Json::Set(const string &key, const Json &value)
+	{
+		for (size_t i = 0; i < mKeys.size(); i++)
+		{
+			if (mKeys[i] == key)
+			{
+				mElements[i] = value;
+
+				return *this;
+			}
+		}
+
+		mKeys.push_back(key);
+		mElements.push_back(value);
+
+		return *this;
+	}
+
+	string Json::Write() const
+	{
+		string text;
+
+		Write(text);
+
+		return text;
+	}
+
+	bool Json::Parse(const string &text, size_t &index, const unsigned int depth)
+	{
+		if (depth > Json::MAX_DEPTH)
+		{
+			return false;
+		}
+
+		Skip(text, index);
+
+		if (index == text.size())
+		{
+			return false;
+		}
+
+		switch (text[index])
+		{
+		case '{':
+			mType = Type::OBJECT;
+			index++;
+			Skip(text, index);
+
+			if (index < text.size() && text[index] == '}')
+			{
+				index++;
+				return true;
+			}
+
+			for (;;)
+			{
+				string key;
+
+				Skip(text, index);
+
+				if (!ParseString(text, index, key))
+				{
+					return false;
+				}
+
+				Skip(text, index);
+
+				if (index == text.size() || text[index] != ':')
+				{
+					return false;
+				}
+
+				index++;
+				mKeys.push_back(key);
+				mElements.emplace_back();
+
+				if (!mElements.back().Parse(text, index, depth + 1))
+				{
+					return false;
+				}
+
+				Skip(text, index);
+
+				if (index < text.size() && text[index] == ',')
+				{
+					index++;
+				}
+				else if (index < text.size() && text[index] == '}')
+				{
+					index++;
+					return true;
+				}
+				else
+				{
+					return false;
+				}
+			}
+
+		case '[':
+			mType = Type::ARRAY;
+			index++;
+			Skip(text, index);
+
+			if (index < text.size() && text[index] == ']')
+			{
+				index++;
+				return true;
+			}
+
+			for (;;)
+			{
+				mElements.emplace_back();
+
+				if (!mElements.back().Parse(text, index, depth + 1))
+				{
+					return false;
+				}
+
+				Skip(text, index);
+
+				if (index < text.size() && text[index] == ',')
+				{
+					index++;
+				}
+				else if (index < text.size() && text[index] == ']')
+				{
+					index++;
+					return true;
+				}
+				else
+				{
+					return false;
+				}
+			}
+
+		case '"':
+			mType = Type::STRING;
+			return ParseString(text, index, mString);
+
+		case 't':
+			mType = Type::BOOLEAN;
+			mBoolean = true;
+			index += 4;
+			return text.compare(index - 4, 4, "true") == 0;
+
+		case 'f':
+			mType = Type::BOOLEAN;
+			mBoolean = false;
+			index += 5;
+			return text.compare(index - 5, 5, "false") == 0;
+
+		case 'n':
+			mType = Type::NULL_VALUE;
+			index += 4;
+			return text.compare(index - 4, 4, "null") == 0;
+
+		default:
+		{
+			const char * const begin = text.c_str() + index;
+			char *end;
+
+			if (*begin != '-' && (*begin < '0' || *begin > '9'))
+			{
+				return false;
+			}
+
+			mType = Type::NUMBER;
+			mNumber = std::strtod(begin, &end);
+			index += end - begin;
+
+			return end != begin;
+		}
+		}
+	}
+
+	void Json::Write(string &text) const
+	{
+		switch (mType)
+		{
+		case Type::BOOLEAN:
+			text += mBoolean ? "true" : "false";
+			break;
+
+		case Type::NUMBER:
+		{
+			char buffer[32];
+
+			if (std::isfinite(mNumber) && mNumber == std::floor(mNumber) && std::fabs(mNumber) < 1e15)
+			{
+				std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(mNumber));
+			}
+			else if (std::isfinite(mNumber))
+			{
+				std::snprintf(buffer, sizeof(buffer), "%.17g", mNumber);
+			}
+			else
+			{
+				std::snprintf(buffer, sizeof(buffer), "null");
+			}
+
+			text += buffer;
+			break;
+		}
+
+		case Type::STRING:
+			WriteString(mString, text);
+			break;
+
+		case Type::ARRAY:
+			text += '[';
+
+			for (size_t i = 0; i < mElements.size(); i++)
+			{
+				if (i != 0)
+				{
+					text += ',';
+				}
+
+				mElements[i].Write(text);
+			}
+
+			text += ']';
+			break;
+
+		case Type::OBJECT:
+			text += '{';
+
+			for (size_t i = 0; i < mElements.size(); i++)
+			{
+				if (i != 0)
+				{
+					text += ',';
+				}
+
+				WriteString(mKeys[i], text);
+				text += ':';
+				mElements[i].Write(text);
+			}
+
+			text += '}';
+			break;
+
+		default:
+			text += "null";
+			break;
+		}
+	}
+
+	void Json::Skip(const string &text, size_t &index)
+	{
+		while (index < text.size() && (text[index] == ' ' || text[index] == '\t' || text[index] == '\n' || text[index] == '\r'))
+		{
+			index++;
+		}
+	}
+
+	bool Json::ParseString(const string &text, size_t &index, string &value)
+	{
+		if (index == text.size() || text[index] != '"')
+		{
+			return false;
+		}
+
+		for (index++; index < text.size(); index++)
+		{
+			const char c = text[index];
+
+			if (c == '"')
+			{
+				index++;
+				return true;
+			}
+
+			if (c != '\\')
+			{
+				value += c;
+				continue;
+			}
+
+			if (++index == text.size())
+			{
+				return false;
+			}
+
+			switch (text[index])
+			{
+			case '"':
+			case '\\':
+			case '/':
+				value += text[index];
+				break;
+
+			case 'b':
+				value += '\b';
+				break;
+
+			case 'f':
+				value += '\f';
+				break;
+
+			case 'n':
+				value += '\n';
+				break;
+
+			case 'r':
+				value += '\r';
+				break;
+
+			case 't':
+				value += '\t';
+				break;
+
+			case 'u':
+			{
+				unsigned int code;
+
+				if (!ParseHexadecimal(text, index, code))
+				{
+					return false;
+				}
+
+				// A surrogate pair makes one code point.
+				if (code >= 0xD800u && code < 0xDC00u && text.compare(index + 1, 2, "\\u") == 0)
+				{
+					size_t next = index + 2;
+					unsigned int low;
+
+					if (ParseHexadecimal(text, next, low) && low >= 0xDC00u && low < 0xE000u)
+					{
+						code = 0x10000u + ((code - 0xD800u) << 10) + (low - 0xDC00u);
+						index = next;
+					}
+				}
+
+				Encode(code, value);
+				break;
+			}
+
+			default:
+				return false;
+			}
+		}
+
+		return false;
+	}
+
+	// The four digits after the index, which is left at the last of them.
+	bool Json::ParseHexadecimal(const string &text, size_t &index, unsigned int &value)
+	{
+		value = 0;
+
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			if (++index == text.size())
+			{
+				return false;
+			}
+
+			const char c = text[index];
+
+			value <<= 4;
+
+			if (c >= '0' && c <= '9')
+			{
+				value |= c - '0';
+			}
+			else if (c >= 'a' && c <= 'f')
+			{
+				value |= c - 'a' + 10;
+			}
+			else if (c >= 'A' && c <= 'F')
+			{
+				value |= c - 'A' + 10;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void Json::WriteString(const string &value, string &text)
+	{
+		static constexpr char DIGITS[] = "0123456789abcdef";
+
+		text += '"';
+
+		for (auto i : value)
+		{
+			switch (i)
+			{
+			case '"':
+				text += "\\\"";
+				break;
+
+			case '\\':
+				text += "\\\\";
+				break;
+
+			case '\n':
+				text += "\\n";
+				break;
+
+			case '\r':
+				text += "\\r";
+				break;
+
+			case '\t':
+				text += "\\t";
+				break;
+
+			default:
+				if (static_cast<unsigned char>(i) < 0x20u)
+				{
+					text += "\\u00";
+					text += DIGITS[i >> 4];
+					text += DIGITS[i & 0xF];
+				}
+				else
+				{
+					text += i;
+				}
+				break;
+			}
+		}
+
+		text += '"';
+	}
+
+	// In UTF-8.
+	void Json::Encode(const unsigned int c, string &text)
+	{
+		if (c < 0x80u)
+		{
+			text += static_cast<char>(c);
+		}
+		else if (c < 0x800u)
+		{
+			text += static_cast<char>(0xC0u | (c >> 6));
+			text += static_cast<char>(0x80u | (c & 0x3Fu));
+		}
+		else if (c < 0x10000u)
+		{
+			text += static_cast<char>(0xE0u | (c >> 12));
+			text += static_cast<char>(0x80u | ((c >> 6) & 0x3Fu));
+			text += static_cast<char>(0x80u | (c & 0x3Fu));
+		}
+		else
+		{
+			text += static_cast<char>(0xF0u | (c >> 18));
+			text += static_cast<char>(0x80u | ((c >> 12) & 0x3Fu));
+			text += static_cast<char>(0x80u | ((c >> 6) & 0x3Fu));
+			text += static_cast<char>(0x80u | (c & 0x3Fu));
+		}
+	}
+}
\ No newline at end of file
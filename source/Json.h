@@ -0,0 +1,108 @@
+#ifndef JSON
+#define JSON
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::string;
+	using std::vector;
+
+	// A JSON value, as much of one as LanguageServer reads and writes. The strings are UTF-8, and the members of an object keep their order.
+	class Json
+	{
+	public:
+		enum struct Type : unsigned char { NULL_VALUE, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+		Json() : mType(Type::NULL_VALUE), mBoolean(false), mNumber(0)
+		{
+		}
+
+		Json(const bool boolean) : mType(Type::BOOLEAN), mBoolean(boolean), mNumber(0)
+		{
+		}
+
+		Json(const int number) : mType(Type::NUMBER), mBoolean(false), mNumber(number)
+		{
+		}
+
+		Json(const unsigned int number) : mType(Type::NUMBER), mBoolean(false), mNumber(number)
+		{
+		}
+
+		Json(const double number) : mType(Type::NUMBER), mBoolean(false), mNumber(number)
+		{
+		}
+
+		Json(const string &text) : mType(Type::STRING), mBoolean(false), mNumber(0), mString(text)
+		{
+		}
+
+		Json(const char * const text) : mType(Type::STRING), mBoolean(false), mNumber(0), mString(text)
+		{
+		}
+
+		static Json Array();
+		static Json Object();
+		static bool Parse(const string &text, Json &value);	// False if the text is not JSON.
+
+		Type GetType() const
+		{
+			return mType;
+		}
+
+		bool Boolean() const
+		{
+			return mBoolean;
+		}
+
+		double Number() const
+		{
+			return mNumber;
+		}
+
+		const string &String() const
+		{
+			return mString;
+		}
+
+		size_t Size() const
+		{
+			return mElements.size();
+		}
+
+		const Json &At(const size_t index) const	// Of an array.
+		{
+			return mElements[index];
+		}
+
+		const Json &Get(const string &key) const;	// Of an object, or null if it has none.
+		Json &Add(const Json &element);	// To an array.
+		Json &Set(const string &key, const Json &value);	// Of an object.
+		string Write() const;
+
+	private:
+		bool Parse(const string &text, size_t &index, const unsigned int depth);
+		void Write(string &text) const;
+
+		static void Skip(const string &text, size_t &index);
+		static bool ParseString(const string &text, size_t &index, string &value);
+		static bool ParseHexadecimal(const string &text, size_t &index, unsigned int &value);
+		static void WriteString(const string &value, string &text);
+		static void Encode(const unsigned int c, string &text);
+
+		static constexpr unsigned int MAX_DEPTH = 256;
+
+		Type mType;
+		bool mBoolean;
+		double mNumber;
+		string mString;
+		vector<Json> mElements;	// Of an array, or the values of an object.
+		vector<string> mKeys;	// Of an object.
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef STRUCT_JUMP_TABLE
+#define STRUCT_JUMP_TABLE
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::vector;
+	using std::unordered_map;
+
+	// Targets of a case statement whose when values are all integer or all string constants. A value matching none of them goes to the default target.
+	struct JumpTable
+	{
+		JumpTable() : minimum(0), defaultTarget(0)
+		{
+		}
+
+		unsigned int Lookup(const long long integer) const
+		{
+			const unsigned long long index = static_cast<unsigned long long>(integer) - static_cast<unsigned long long>(minimum);
+
+			return index < targets.size() ? targets[index] : defaultTarget;
+		}
+
+		unsigned int Lookup(const u32string &string) const
+		{
+			auto target = strings.find(string);
+
+			return target != strings.end() ? target->second : defaultTarget;
+		}
+
+		long long minimum;
+		vector<unsigned int> targets;	// Indexed by the integer less the minimum.
+		unordered_map<u32string, unsigned int> strings;
+		unsigned int defaultTarget;
+	};
+}
+
+#endif
\ No newline at end of file
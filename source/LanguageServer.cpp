@@ -0,0 +1,653 @@
+#include "LanguageServer.h"
+
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_set>
+
+#include "TextEncoder.h"
+#include "Logger.h"
+
+namespace lyrics
+{
+	constexpr int LanguageServer::PARSE_ERROR;
+	constexpr int LanguageServer::METHOD_NOT_FOUND;
+	constexpr int LanguageServer::SEVERITY_ERROR;
+	constexpr int LanguageServer::SEVERITY_WARNING;
+	constexpr int LanguageServer::INCREMENTAL_SYNC;
+
+	int LanguageServer::Serve(istream &input, ostream &output)
+	{
+		string content;
+
+		Logger::Redirect(&cerr, &cerr);	// What is not captured stays out of the messages.
+
+		while (Receive(input, content))
+		{
+			Json message;
+
+			if (!Json::Parse(content, message) || message.GetType() != Json::Type::OBJECT)
+			{
+				Send(output, Json::Object().Set("jsonrpc", "2.0").Set("id", Json()).Set("error", Json::Object().Set("code", LanguageServer::PARSE_ERROR).Set("message", "Parse error.")));
+				continue;
+			}
+
+			if (message.Get("method").String() == "exit")
+			{
+				return mIsShutDown ? 0 : 1;
+			}
+
+			Handle(message, output);
+		}
+
+		return 1;
+	}
+
+	void LanguageServer::Handle(const Json &message, ostream &output)
+	{
+		const string &method = message.Get("method").String();
+		const Json &id = message.Get("id");
+		const Json &parameters = message.Get("params");
+
+		if (method == "initialize")
+		{
+			Json capabilities = Json::Object();
+
+			capabilities.Set("textDocumentSync", Json::Object().Set("openClose", true).Set("change", LanguageServer::INCREMENTAL_SYNC));
+			capabilities.Set("definitionProvider", true);
+			capabilities.Set("hoverProvider", true);
+
+			Reply(output, id, Json::Object().Set("capabilities", capabilities).Set("serverInfo", Json::Object().Set("name", "lyrics")));
+		}
+		else if (method == "shutdown")
+		{
+			mIsShutDown = true;
+
+			Reply(output, id, Json());
+		}
+		else if (method == "textDocument/didOpen")
+		{
+			Open(parameters, output);
+		}
+		else if (method == "textDocument/didChange")
+		{
+			Change(parameters, output);
+		}
+		else if (method == "textDocument/didClose")
+		{
+			Close(parameters, output);
+		}
+		else if (method == "textDocument/definition")
+		{
+			Reply(output, id, Definition(parameters));
+		}
+		else if (method == "textDocument/hover")
+		{
+			Reply(output, id, Hover(parameters));
+		}
+		else if (!method.empty() && id.GetType() != Json::Type::NULL_VALUE)
+		{
+			Send(output, Json::Object().Set("jsonrpc", "2.0").Set("id", id).Set("error", Json::Object().Set("code", LanguageServer::METHOD_NOT_FOUND).Set("message", "Method not found.")));
+		}
+	}
+
+	void LanguageServer::Open(const Json &parameters, ostream &output)
+	{
+		const Json &textDocument = parameters.Get("textDocument");
+		const string &uri = textDocument.Get("uri").String();
+		Script *&script = mScripts[uri];
+
+		Utility::SafeDelete(script);
+		script = new Script(FileName(uri), TextEncoder().DecodeUTF_8(textDocument.Get("text").String()));
+
+		Resolve(*script);
+		Publish(uri, *script, output);
+	}
+
+	// Each change applies to the text the ones before it left. One without a range replaces the whole text.
+	void LanguageServer::Change(const Json &parameters, ostream &output)
+	{
+		const string &uri = parameters.Get("textDocument").Get("uri").String();
+		const Json &changes = parameters.Get("contentChanges");
+		auto i = mScripts.find(uri);
+
+		if (i == mScripts.end())
+		{
+			return;
+		}
+
+		Script &script = *i->second;
+
+		for (size_t j = 0; j < changes.Size(); j++)
+		{
+			const Json &range = changes.At(j).Get("range");
+			const u32string text = TextEncoder().DecodeUTF_8(changes.At(j).Get("text").String());
+			unsigned int offset = 0;
+			unsigned int length = static_cast<unsigned int>(script.document.Text().size());
+
+			if (range.GetType() == Json::Type::OBJECT)
+			{
+				offset = Offset(script, range.Get("start"));
+				length = std::max(offset, Offset(script, range.Get("end"))) - offset;
+			}
+
+			Update(script.lines, offset, length, text);
+			script.document.Edit(offset, length, text);
+		}
+
+		Resolve(script);
+		Publish(uri, script, output);
+	}
+
+	void LanguageServer::Close(const Json &parameters, ostream &output)
+	{
+		const string &uri = parameters.Get("textDocument").Get("uri").String();
+		auto i = mScripts.find(uri);
+
+		if (i == mScripts.end())
+		{
+			return;
+		}
+
+		Utility::SafeDelete(i->second);
+		mScripts.erase(i);
+
+		Send(output, Json::Object().Set("jsonrpc", "2.0").Set("method", "textDocument/publishDiagnostics").Set("params", Json::Object().Set("uri", uri).Set("diagnostics", Json::Array())));
+	}
+
+	Json LanguageServer::Definition(const Json &parameters) const
+	{
+		const Node *definition;
+		const Script *script;
+		const IdentifierNode * const declaration = Find(parameters, definition, script);
+
+		if (!declaration)
+		{
+			return Json();
+		}
+
+		return Json::Object().Set("uri", parameters.Get("textDocument").Get("uri")).Set("range", Range(*script, declaration->location, declaration->identifier->size()));
+	}
+
+	Json LanguageServer::Hover(const Json &parameters) const
+	{
+		const Node *definition;
+		const Script *script;
+		const IdentifierNode * const declaration = Find(parameters, definition, script);
+
+		if (!declaration)
+		{
+			return Json();
+		}
+
+		return Json::Object().Set("contents", Json::Object().Set("kind", "markdown").Set("value", Describe(declaration, definition)));
+	}
+
+	void LanguageServer::Publish(const string &uri, const Script &script, ostream &output) const
+	{
+		vector<Diagnostic> diagnostics;
+		Json list = Json::Array();
+
+		script.document.Diagnostics(diagnostics);
+
+		for (auto i : script.document.Root()->list)
+		{
+			auto resolution = script.resolutions.find(i);
+
+			if (resolution != script.resolutions.end())
+			{
+				diagnostics.insert(diagnostics.end(), resolution->second.diagnostics.cbegin(), resolution->second.diagnostics.cend());
+			}
+		}
+
+		for (auto &i : diagnostics)
+		{
+			Json diagnostic = Json::Object();
+
+			diagnostic.Set("range", Range(script, i.location, 1));
+			diagnostic.Set("severity", i.severity == Diagnostic::Severity::WARNING ? LanguageServer::SEVERITY_WARNING : LanguageServer::SEVERITY_ERROR);
+			diagnostic.Set("code", i.code);
+			diagnostic.Set("source", "lyrics");
+			diagnostic.Set("message", *i.message ? string(i.message) : Diagnostic::Name(i.severity) + (' ' + std::to_string(i.code)));
+
+			list.Add(diagnostic);
+		}
+
+		Send(output, Json::Object().Set("jsonrpc", "2.0").Set("method", "textDocument/publishDiagnostics").Set("params", Json::Object().Set("uri", uri).Set("diagnostics", list)));
+	}
+
+	// The identifier at the position, resolved again together with the statement of the root block it is in, and where it is declared.
+	const IdentifierNode *LanguageServer::Find(const Json &parameters, const Node *&definition, const Script *&script) const
+	{
+		auto i = mScripts.find(parameters.Get("textDocument").Get("uri").String());
+
+		definition = nullptr;
+		script = nullptr;
+
+		if (i == mScripts.end())
+		{
+			return nullptr;
+		}
+
+		script = i->second;
+
+		const unsigned int offset = Offset(*script, parameters.Get("position"));
+		const StatementNode * const statement = script->document.Statement(offset);
+
+		if (!statement)
+		{
+			return nullptr;
+		}
+
+		Scope scope(nullptr);
+		unordered_map<const IdentifierNode *, const Node *> definitions;
+
+		for (auto j : script->document.Root()->list)
+		{
+			if (j == statement)
+			{
+				break;
+			}
+
+			auto resolution = script->resolutions.find(j);
+
+			if (resolution != script->resolutions.end())
+			{
+				for (auto &k : resolution->second.globals)
+				{
+					scope.AddVariable(k.first);
+					definitions.insert(k);
+				}
+			}
+		}
+
+		vector<Diagnostic> diagnostics;
+		vector<Diagnostic> * const captured = Logger::Captured();
+		LocalResolver::Record record;
+
+		Logger::Capture(&diagnostics);
+		LocalResolver().Resolve(statement, &scope, record);
+		Logger::Capture(captured);
+
+		const auto line = std::upper_bound(script->lines.cbegin(), script->lines.cend(), offset);
+		const unsigned int lineNumber = static_cast<unsigned int>(line - script->lines.cbegin()) + 1;
+		const unsigned int column = offset - (line == script->lines.cbegin() ? 0 : *(line - 1)) + 1;
+
+		for (auto &j : record.declarations)
+		{
+			const Location &location = j.first->location;
+
+			if (location.Line() == lineNumber && location.Column() <= column && column <= location.Column() + j.first->identifier->size())
+			{
+				auto local = record.definitions.find(j.second);
+
+				if (local != record.definitions.end())
+				{
+					definition = local->second;
+				}
+				else if (definitions.count(j.second) != 0)
+				{
+					definition = definitions.at(j.second);
+				}
+
+				return j.second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// The statements of the root block before the first one changed and after the last one are kept, and the ones between are resolved again unless they were not changed and are valid.
+	// The ones after are checked as well if the names the ones between declare are not those they did. The diagnostics kept are moved by the edits.
+	void LanguageServer::Resolve(Script &script)
+	{
+		std::unordered_set<const StatementNode *> changes;
+		vector<Document::Shift> shifts;
+		vector<const StatementNode *> statements;
+		const vector<const StatementNode *> &old = script.statements;
+
+		script.document.TakeChanges(changes, shifts);
+
+		for (auto &i : script.resolutions)
+		{
+			for (auto &j : i.second.diagnostics)
+			{
+				for (auto &k : shifts)
+				{
+					k.Move(j.location);
+				}
+			}
+		}
+
+		for (auto i : script.document.Root()->list)
+		{
+			if (i)
+			{
+				statements.push_back(i);
+			}
+		}
+
+		size_t first = 0;
+		size_t keptCount = 0;
+
+		while (first < statements.size() && first < old.size() && statements[first] == old[first] && changes.count(statements[first]) == 0)
+		{
+			first++;
+		}
+
+		while (keptCount < statements.size() - first && keptCount < old.size() - first && statements[statements.size() - keptCount - 1] == old[old.size() - keptCount - 1] && changes.count(old[old.size() - keptCount - 1]) == 0)
+		{
+			keptCount++;
+		}
+
+		for (; script.scopedCount > first; script.scopedCount--)
+		{
+			Undeclare(script.scope, script.resolutions.at(old[script.scopedCount - 1]));
+		}
+
+		for (; script.scopedCount < first; script.scopedCount++)
+		{
+			Declare(script.scope, script.resolutions.at(old[script.scopedCount]));
+		}
+
+		const size_t last = statements.size() - keptCount;
+		const std::unordered_set<const StatementNode *> between(statements.cbegin() + first, statements.cbegin() + last);
+		std::unordered_set<u32string> names;
+		std::unordered_set<u32string> newNames;
+
+		for (size_t i = first; i < old.size() - keptCount; i++)
+		{
+			auto resolution = script.resolutions.find(old[i]);
+
+			names.insert(resolution->second.names.cbegin(), resolution->second.names.cend());
+
+			if (between.count(old[i]) == 0)
+			{
+				script.resolutions.erase(resolution);
+			}
+		}
+
+		for (size_t i = first; i < last; i++)
+		{
+			Resolve(script, statements[i], changes.count(statements[i]) != 0);
+
+			const Resolution &resolution = script.resolutions.at(statements[i]);
+
+			newNames.insert(resolution.names.cbegin(), resolution.names.cend());
+		}
+
+		const size_t end = newNames == names ? last : statements.size();
+
+		for (size_t i = last; i < end; i++)
+		{
+			Resolve(script, statements[i], false);
+		}
+
+		for (size_t i = end; i > first; i--)
+		{
+			Undeclare(script.scope, script.resolutions.at(statements[i - 1]));
+		}
+
+		script.statements.swap(statements);
+	}
+
+	// In the root scope as it is, again only if it was changed or is no longer valid.
+	void LanguageServer::Resolve(Script &script, const StatementNode * const statement, const bool isChanged)
+	{
+		auto cached = script.resolutions.find(statement);
+
+		if (cached != script.resolutions.end() && !isChanged && IsValid(cached->second, script.scope))
+		{
+			Declare(script.scope, cached->second);
+			return;
+		}
+
+		Resolution &resolution = script.resolutions[statement];
+		vector<Diagnostic> * const captured = Logger::Captured();
+		LocalResolver::Record record;
+
+		resolution = Resolution();
+
+		Logger::Capture(&resolution.diagnostics);
+		LocalResolver().Resolve(statement, &script.scope, record);
+		Logger::Capture(captured);
+
+		resolution.lookups.swap(record.lookups);
+
+		for (auto i : record.globals)
+		{
+			resolution.globals.emplace_back(i, record.definitions.at(i));
+			resolution.names.push_back(*i->identifier);
+		}
+	}
+
+	void LanguageServer::Declare(Scope &scope, const Resolution &resolution)
+	{
+		for (auto &i : resolution.globals)
+		{
+			scope.AddVariable(i.first);
+		}
+	}
+
+	void LanguageServer::Undeclare(Scope &scope, const Resolution &resolution)
+	{
+		for (size_t i = 0; i < resolution.globals.size(); i++)
+		{
+			scope.RemoveVariable(&resolution.names[i], resolution.globals[i].first);
+		}
+	}
+
+	bool LanguageServer::IsValid(const Resolution &resolution, const Scope &scope)
+	{
+		for (auto &i : resolution.lookups)
+		{
+			if (scope.IsExist(&i.first) != i.second)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// A message after its header, which is lines ended by CR LF and an empty one.
+	bool LanguageServer::Receive(istream &input, string &content)
+	{
+		string line;
+		size_t length = 0;
+		bool hasLength = false;
+
+		while (std::getline(input, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+
+			if (line.empty())
+			{
+				if (hasLength)
+				{
+					break;
+				}
+
+				continue;
+			}
+
+			if (line.compare(0, 15, "Content-Length:") == 0)
+			{
+				length = static_cast<size_t>(std::strtoul(line.c_str() + 15, nullptr, 10));
+				hasLength = true;
+			}
+		}
+
+		if (!input || !hasLength)
+		{
+			return false;
+		}
+
+		content.resize(length);
+		input.read(&content[0], length);
+
+		return static_cast<size_t>(input.gcount()) == length;
+	}
+
+	void LanguageServer::Send(ostream &output, const Json &message)
+	{
+		const string content = message.Write();
+
+		output << "Content-Length: " << content.size() << "\r\n\r\n" << content;
+		output.flush();
+	}
+
+	void LanguageServer::Reply(ostream &output, const Json &id, const Json &result)
+	{
+		Send(output, Json::Object().Set("jsonrpc", "2.0").Set("id", id).Set("result", result));
+	}
+
+	// Of the line starts, for the characters from the offset on replaced with the text.
+	void LanguageServer::Update(vector<unsigned int> &lines, const unsigned int offset, const unsigned int length, const u32string &text)
+	{
+		const auto begin = std::upper_bound(lines.begin(), lines.end(), offset);
+		const auto end = std::upper_bound(begin, lines.end(), offset + length);
+		const long long delta = static_cast<long long>(text.size()) - length;
+		vector<unsigned int> added;
+
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			if (text[i] == U'\n')
+			{
+				added.push_back(offset + static_cast<unsigned int>(i) + 1);
+			}
+		}
+
+		for (auto i = end; i != lines.end(); i++)
+		{
+			*i = static_cast<unsigned int>(*i + delta);
+		}
+
+		lines.insert(lines.erase(begin, end), added.begin(), added.end());
+	}
+
+	// Of the character at the position, or of the end of its line if it is past it.
+	unsigned int LanguageServer::Offset(const Script &script, const Json &position)
+	{
+		const u32string &text = script.document.Text();
+		const size_t line = static_cast<size_t>(std::max(0.0, position.Get("line").Number()));
+		const double character = position.Get("character").Number();
+		size_t offset = line == 0 ? 0 : line <= script.lines.size() ? script.lines[line - 1] : text.size();
+
+		for (double units = 0; offset < text.size() && text[offset] != U'\n' && units < character; offset++)
+		{
+			units += text[offset] >= 0x10000u ? 2 : 1;
+		}
+
+		return static_cast<unsigned int>(offset);
+	}
+
+	Json LanguageServer::Position(const Script &script, const Location &location)
+	{
+		const u32string &text = script.document.Text();
+		const unsigned int line = location.Line() - 1;
+		size_t offset = line == 0 ? 0 : line <= script.lines.size() ? script.lines[line - 1] : text.size();
+		unsigned int character = 0;
+
+		for (unsigned int i = 1; i < location.Column() && offset < text.size() && text[offset] != U'\n'; i++, offset++)
+		{
+			character += text[offset] >= 0x10000u ? 2 : 1;
+		}
+
+		return Json::Object().Set("line", line).Set("character", character);
+	}
+
+	Json LanguageServer::Range(const Script &script, const Location &location, const size_t length)
+	{
+		Location end = location;
+
+		end.IncreaseColumn(static_cast<unsigned int>(length));
+
+		return Json::Object().Set("start", Position(script, location)).Set("end", Position(script, end));
+	}
+
+	// The path of a file URI, or the URI itself if it is not one.
+	string LanguageServer::FileName(const string &uri)
+	{
+		static constexpr char SCHEME[] = "file://";
+
+		if (uri.compare(0, sizeof(SCHEME) - 1, SCHEME) != 0)
+		{
+			return uri;
+		}
+
+		string fileName;
+
+		for (size_t i = sizeof(SCHEME) - 1; i < uri.size(); i++)
+		{
+			if (uri[i] == '%' && i + 2 < uri.size())
+			{
+				fileName += static_cast<char>(std::strtoul(uri.substr(i + 1, 2).c_str(), nullptr, 16));
+				i += 2;
+			}
+			else
+			{
+				fileName += uri[i];
+			}
+		}
+
+		return fileName;
+	}
+
+	// In Markdown, what the name is and the line it is declared on.
+	string LanguageServer::Describe(const IdentifierNode * const name, const Node * const definition)
+	{
+		TextEncoder encoder;
+		string kind = "variable";
+		string signature;
+
+		if (definition && (definition->type == Node::Type::VALUE_PARAMETER || definition->type == Node::Type::OUTPUT_PARAMETER || definition->type == Node::Type::CLASS))
+		{
+			kind = "parameter";
+		}
+		else if (definition && definition->type == Node::Type::ASSIGNMENT_EXPRESSION && static_cast<const AssignmentExpressionNode *>(definition)->rhs)
+		{
+			const ExpressionNode * const value = static_cast<const AssignmentExpressionNode *>(definition)->rhs;
+
+			if (value->type == Node::Type::CLASS)
+			{
+				kind = "class";
+			}
+			else if (value->type == Node::Type::PACKAGE)
+			{
+				kind = "package";
+			}
+			else if (value->type == Node::Type::FUNCTION_LITERAL)
+			{
+				kind = "function";
+				signature = "(";
+
+				for (auto i : static_cast<const FunctionLiteralNode *>(value)->list)
+				{
+					if (!i || !static_cast<const ParameterNode *>(i)->name)
+					{
+						continue;
+					}
+
+					if (signature.size() > 1)
+					{
+						signature += ", ";
+					}
+
+					if (i->type == Node::Type::OUTPUT_PARAMETER)
+					{
+						signature += "out ";
+					}
+
+					signature += encoder.EncodeUTF_8(*static_cast<const ParameterNode *>(i)->name->identifier);
+				}
+
+				signature += ")";
+			}
+		}
+
+		return "```lyrics\n" + kind + ' ' + encoder.EncodeUTF_8(*name->identifier) + signature + "\n```\nDeclared on line " + std::to_string(name->location.Line()) + '.';
+	}
+}
\ No newline at end of file
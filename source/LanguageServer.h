@@ -0,0 +1,117 @@
+#ifndef LANGUAGE_SERVER
+#define LANGUAGE_SERVER
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <utility>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+
+#include "Document.h"
+#include "Diagnostic.h"
+#include "LocalResolver.h"
+#include "Scope.h"
+#include "Node.h"
+#include "Json.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::string;
+	using std::u32string;
+	using std::vector;
+	using std::pair;
+	using std::istream;
+	using std::ostream;
+	using std::unordered_map;
+
+	// Serves an editor diagnostics, definitions and hovers over the Language Server Protocol, on the standard input and output.
+	// Each script open is a Document, which the edits the editor sends change in place, and the statements of its root block are resolved one at a time.
+	// A statement is resolved again only if it was parsed again or a name it looked up in the root scope is there now and was not or the other way around.
+	// The root scope is kept as it is before the first statement an edit changed, and the statements after the last one are checked only if the names declared between changed, so an edit costs about what the statements it touched cost.
+	// The diagnostics are the logs of the tokenizer, the parser and LocalResolver, kept instead of written. A position is a line and a count of UTF-16 code units, both from 0.
+	class LanguageServer
+	{
+	public:
+		LanguageServer() : mIsShutDown(false)
+		{
+		}
+
+		~LanguageServer()
+		{
+			for (auto &i : mScripts)
+			{
+				Utility::SafeDelete(i.second);
+			}
+		}
+
+		LanguageServer(const LanguageServer &) = delete;
+		LanguageServer &operator=(const LanguageServer &) = delete;
+
+		int Serve(istream &input, ostream &output);	// Until the editor says to exit. The exit status.
+
+	private:
+		// What resolving a statement of the root block found, kept while the statement and its lookups stay the same.
+		struct Resolution
+		{
+			vector<Diagnostic> diagnostics;
+			unordered_map<u32string, bool> lookups;
+			vector<pair<const IdentifierNode *, const Node *>> globals;	// Declared in the root scope, and what declares each.
+			vector<u32string> names;	// Of the globals, which are needed once the statement is gone.
+		};
+
+		struct Script
+		{
+			Script(const string &fileName, const u32string &text) : document(fileName, text), scope(nullptr), scopedCount(0)
+			{
+				Update(lines, 0, 0, text);
+			}
+
+			Document document;
+			vector<unsigned int> lines;	// Where each line but the first starts.
+			unordered_map<const StatementNode *, Resolution> resolutions;
+			vector<const StatementNode *> statements;	// Of the root block, when they were last resolved.
+			Scope scope;	// The root scope, with what the first statements declare.
+			size_t scopedCount;	// Of those statements.
+		};
+
+		void Handle(const Json &message, ostream &output);
+		void Open(const Json &parameters, ostream &output);
+		void Change(const Json &parameters, ostream &output);
+		void Close(const Json &parameters, ostream &output);
+		Json Definition(const Json &parameters) const;
+		Json Hover(const Json &parameters) const;
+		void Publish(const string &uri, const Script &script, ostream &output) const;
+		const IdentifierNode *Find(const Json &parameters, const Node *&definition, const Script *&script) const;
+
+		static void Resolve(Script &script);
+		static void Resolve(Script &script, const StatementNode * const statement, const bool isChanged);
+		static void Declare(Scope &scope, const Resolution &resolution);
+		static void Undeclare(Scope &scope, const Resolution &resolution);
+		static bool IsValid(const Resolution &resolution, const Scope &scope);
+		static bool Receive(istream &input, string &content);
+		static void Send(ostream &output, const Json &message);
+		static void Reply(ostream &output, const Json &id, const Json &result);
+		static void Update(vector<unsigned int> &lines, const unsigned int offset, const unsigned int length, const u32string &text);
+		static unsigned int Offset(const Script &script, const Json &position);
+		static Json Position(const Script &script, const Location &location);
+		static Json Range(const Script &script, const Location &location, const size_t length);
+		static string FileName(const string &uri);
+		static string Describe(const IdentifierNode * const name, const Node * const definition);
+
+		static constexpr int PARSE_ERROR = -32700;
+		static constexpr int METHOD_NOT_FOUND = -32601;
+		static constexpr int SEVERITY_ERROR = 1;
+		static constexpr int SEVERITY_WARNING = 2;
+		static constexpr int INCREMENTAL_SYNC = 2;
+
+		unordered_map<string, Script *> mScripts;	// By URI.
+		bool mIsShutDown;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -3,13 +3,14 @@
 
 #include <string>
 #include <vector>
-#include <unordered_map>
 
 namespace lyrics
 {
 	using std::u32string;
 	using std::vector;
-	using std::unordered_map;
+
+	class HashTable;
+	struct Object;
 
 	struct Literal
 	{
@@ -22,9 +23,9 @@ namespace lyrics
 			double real;
 			u32string *string;
 			vector<Literal> *array;
-			unordered_map<u32string, Literal> *hash;
+			HashTable *hash;
 			char *function;
-			char *object;
+			Object *object;
 			u32string *reference;
 		};
 
@@ -52,7 +53,7 @@ namespace lyrics
 			value.array = array;
 		}
 
-		Literal(unordered_map<u32string, Literal> * const hash) : type(Type::HASH)
+		Literal(HashTable * const hash) : type(Type::HASH)
 		{
 			value.hash = hash;
 		}
@@ -62,12 +63,17 @@ namespace lyrics
 			value.string = string;
 		}
 
-		Literal(const Type type, char * const object) : type(type)
+		Literal(Object * const object) : type(Type::OBJECT)
 		{
 			value.object = object;
 		}
 
-		const Type type;
+		Literal(const Type type, char * const function) : type(type)
+		{
+			value.function = function;
+		}
+
+		Type type;
 		Value value;
 	};
 }
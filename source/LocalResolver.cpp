@@ -13,6 +13,19 @@ namespace lyrics
 		return node->Accept(*this);
 	}
 
+	bool LocalResolver::Resolve(const StatementNode * const node, Scope * const scope, Record &record)
+	{
+		mScopeStack.push(scope);
+		mRecord = &record;
+
+		const bool canProgress = node->Accept(*this);
+
+		mRecord = nullptr;
+		mScopeStack.pop();
+
+		return canProgress;
+	}
+
 	bool LocalResolver::Visit(const BlockNode * const node)
 	{
 		bool canProgress = true;
@@ -34,17 +47,17 @@ namespace lyrics
 
 	bool LocalResolver::Visit(const IdentifierNode * const node)
 	{
-		const Scope *scope = mScopeStack.top();
+		const IdentifierNode * const declaration = Find(node->identifier);
 
-		while (!scope->IsExist(node->identifier))
+		if (!declaration)
 		{
-			scope = scope->Parent();
+			ErrorLogger::Error(node->location, ErrorCode::USE_OF_UNDECLARED_IDENTIFIER);
+			return false;
+		}
 
-			if (!scope)
-			{
-				ErrorLogger::Error(node->location, ErrorCode::USE_OF_UNDECLARED_IDENTIFIER);
-				return false;
-			}
+		if (mRecord)
+		{
+			mRecord->declarations[node] = declaration;
 		}
 
 		return true;
@@ -149,20 +162,20 @@ namespace lyrics
 	{
 		bool canProgress = true;
 
+		if (node->defalutArgument)
+		{
+			canProgress &= node->defalutArgument->Accept(*this);
+		}
+
 		if (node->name)
 		{
-			canProgress &= node->name->Accept(*this);
+			Add(node->name, node);
 		}
 		else
 		{
 			canProgress = false;
 		}
 
-		if (node->defalutArgument)
-		{
-			canProgress &= node->defalutArgument->Accept(*this);
-		}
-
 		return canProgress;
 	}
 
@@ -172,7 +185,7 @@ namespace lyrics
 
 		if (node->name)
 		{
-			canProgress &= node->name->Accept(*this);
+			Add(node->name, node);
 		}
 		else
 		{
@@ -264,11 +277,7 @@ namespace lyrics
 			canProgress = false;
 		}
 
-		if (node->member)
-		{
-			canProgress &= node->member->Accept(*this);
-		}
-		else
+		if (!node->member)	// Which is not a variable.
 		{
 			canProgress = false;
 		}
@@ -525,19 +534,7 @@ namespace lyrics
 		{
 			if (node->lhs->type == Node::Type::IDENTIFIER)
 			{
-				const Scope *scope = mScopeStack.top();
-				const u32string * const identifier = static_cast<const IdentifierNode * const>(node->lhs)->identifier;
-
-				while (!scope->IsExist(identifier))
-				{
-					scope = scope->Parent();
-
-					if (!scope)
-					{
-						mScopeStack.top()->AddVariable(identifier);
-						break;
-					}
-				}
+				Declare(static_cast<const IdentifierNode *>(node->lhs), node);
 			}
 		}
 		else
@@ -565,13 +562,17 @@ namespace lyrics
 
 		for (auto i : node->list)
 		{
-			if (i)
+			if (!i)
 			{
-				canProgress &= i->Accept(*this);
+				canProgress = false;
+			}
+			else if (i->type == Node::Type::IDENTIFIER)	// A parameter of the constructor.
+			{
+				Add(static_cast<const IdentifierNode *>(i), node);
 			}
 			else
 			{
-				canProgress = false;
+				canProgress &= i->Accept(*this);
 			}
 		}
 
@@ -668,21 +669,9 @@ namespace lyrics
 
 	bool LocalResolver::Visit(const ImportNode * const node)
 	{
-		bool canProgress = true;
+		(void)node;	// The names are of a script, which BatchCompiler finds, not of variables.
 
-		for (auto i : node->list)
-		{
-			if (i)
-			{
-				canProgress &= i->Accept(*this);
-			}
-			else
-			{
-				canProgress = false;
-			}
-		}
-
-		return canProgress;
+		return true;
 	}
 
 	bool LocalResolver::Visit(const IfNode * const node)
@@ -864,7 +853,11 @@ namespace lyrics
 	{
 		bool canProgress = true;
 
-		if (node->variable)
+		if (node->variable && node->variable->type == Node::Type::IDENTIFIER)
+		{
+			Declare(static_cast<const IdentifierNode *>(node->variable), node);
+		}
+		else if (node->variable)
 		{
 			canProgress &= node->variable->Accept(*this);
 		}
@@ -905,4 +898,74 @@ namespace lyrics
 
 		return canProgress;
 	}
+
+	bool LocalResolver::Visit(const ErrorNode * const node)
+	{
+		if (node->name)
+		{
+			Declare(node->name, node);
+		}
+
+		return false;
+	}
+
+	// Looked up from the innermost scope out.
+	const IdentifierNode *LocalResolver::Find(const u32string * const identifier)
+	{
+		const Scope *scope = mScopeStack.top();
+
+		for (;;)
+		{
+			const IdentifierNode * const declaration = scope->Find(identifier);
+
+			if (declaration || !scope->Parent())
+			{
+				if (mRecord && !scope->Parent())
+				{
+					mRecord->lookups.emplace(*identifier, declaration != nullptr);
+				}
+
+				return declaration;
+			}
+
+			scope = scope->Parent();
+		}
+	}
+
+	// In the innermost scope, unless a scope it is in has it already.
+	void LocalResolver::Declare(const IdentifierNode * const name, const Node * const definition)
+	{
+		const IdentifierNode * const declaration = Find(name->identifier);
+
+		if (!declaration)
+		{
+			Add(name, definition);
+		}
+		else if (mRecord)
+		{
+			mRecord->declarations[name] = declaration;
+		}
+	}
+
+	void LocalResolver::Add(const IdentifierNode * const name, const Node * const definition)
+	{
+		Scope * const scope = mScopeStack.top();
+
+		scope->AddVariable(name);
+
+		if (mRecord)
+		{
+			mRecord->declarations[name] = scope->Find(name->identifier);
+
+			if (mRecord->declarations[name] == name)
+			{
+				mRecord->definitions[name] = definition;
+
+				if (!scope->Parent())
+				{
+					mRecord->globals.push_back(name);
+				}
+			}
+		}
+	}
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <stack>
+#include <vector>
+#include <unordered_map>
 
 #include "Visitor.h"
 #include "Node.h"
@@ -12,11 +14,27 @@ namespace lyrics
 {
 	using std::u32string;
 	using std::stack;
+	using std::vector;
+	using std::unordered_map;
 
 	class LocalResolver : public Visitor
 	{
 	public:
+		// What resolving a statement of the outermost scope found, for a client resolving them one at a time.
+		struct Record
+		{
+			unordered_map<u32string, bool> lookups;	// Of the names looked up as far as the outermost scope, whether they were there the first time.
+			vector<const IdentifierNode *> globals;	// Declared in the outermost scope.
+			unordered_map<const IdentifierNode *, const IdentifierNode *> declarations;	// Of each identifier resolved, the one declaring it.
+			unordered_map<const IdentifierNode *, const Node *> definitions;	// Of each identifier declaring one, the assignment, the parameter, the class or the loop it is in.
+		};
+
+		LocalResolver() : mRecord(nullptr)
+		{
+		}
+
 		bool Resolve(const BlockNode * const node, Scope *&scope);
+		bool Resolve(const StatementNode * const node, Scope * const scope, Record &record);	// As the next statement of the scope, which is the outermost.
 		virtual bool Visit(const BlockNode * const node);
 		virtual bool Visit(const IdentifierNode * const node);
 		virtual bool Visit(const ArrayLiteralNode * const node);
@@ -53,9 +71,15 @@ namespace lyrics
 		virtual bool Visit(const ForNode * const node);
 		virtual bool Visit(const ForEachNode * const node);
 		virtual bool Visit(const ReturnNode * const node);
+		virtual bool Visit(const ErrorNode * const node);
 
 	private:
+		const IdentifierNode *Find(const u32string * const identifier);
+		void Declare(const IdentifierNode * const name, const Node * const definition);
+		void Add(const IdentifierNode * const name, const Node * const definition);
+
 		stack<Scope *> mScopeStack;
+		Record *mRecord;
 	};
 }
 
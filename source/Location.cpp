@@ -1,11 +1,28 @@
 #include "Location.h"
 
 #include <ostream>
+#include <mutex>
+#include <unordered_set>
 
 namespace lyrics
 {
+	// The names are kept until the program ends, one for each file it ever compiled, and looked up only when the first location in a file is made.
+	const string *Location::Share(const string &fileName)
+	{
+		using std::mutex;
+		using std::lock_guard;
+		using std::unordered_set;
+
+		static mutex guard;
+		static unordered_set<string> fileNames;
+
+		lock_guard<mutex> lock(guard);
+
+		return &*fileNames.insert(fileName).first;
+	}
+
 	ostream &operator<<(ostream &out, const Location &location)
 	{
-		return out << location.mFileName << ':' << location.mLine << ':' << location.mColumn << ':';
+		return out << *location.mFileName << ':' << location.mLine << ':' << location.mColumn << ':';
 	}
 }
\ No newline at end of file
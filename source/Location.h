@@ -12,7 +12,7 @@ namespace lyrics
 	struct Location
 	{
 	public:
-		explicit Location(const string &fileName) : mFileName(fileName), mLine(1), mColumn(1)
+		explicit Location(const string &fileName) : mFileName(Location::Share(fileName)), mLine(1), mColumn(1)
 		{
 		}
 
@@ -32,10 +32,33 @@ namespace lyrics
 			mColumn += length;
 		}
 
+		void MoveTo(const unsigned int line, const unsigned int column)
+		{
+			mLine = line;
+			mColumn = column;
+		}
+
+		const string &FileName() const
+		{
+			return *mFileName;
+		}
+
+		unsigned int Line() const
+		{
+			return mLine;
+		}
+
+		unsigned int Column() const
+		{
+			return mColumn;
+		}
+
 		friend ostream &operator<<(ostream &out, const Location &location);
 
 	private:
-		const string mFileName;
+		static const string *Share(const string &fileName);
+
+		const string *mFileName;	// Shared by every location in the file, so that a location is copied without its file name.
 		unsigned int mLine;
 		unsigned int mColumn;
 	};
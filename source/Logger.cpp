@@ -0,0 +1,146 @@
+#include "Logger.h"
+
+#include "Json.h"
+
+namespace lyrics
+{
+	void Logger::Log( const Diagnostic::Severity severity, const unsigned int code, const char * const message )
+	{
+		Flush();
+
+		Write(*Output(), Pending().format, severity, code, message);
+		Output()->flush();
+	}
+
+	void Logger::CompilationTerminated()
+	{
+		Flush();
+
+		if (Pending().format == Format::TEXT)
+		{
+			*Output() << "Compilation terminated.\n";
+			Output()->flush();
+		}
+	}
+
+	void Logger::StandardErrorLog( const Diagnostic::Severity severity, const unsigned int code )
+	{
+		Flush();
+
+		Write(*ErrorOutput(), Pending().format, severity, code, "");
+		ErrorOutput()->flush();
+	}
+
+	void Logger::Write( const string &output, const string &errorOutput )
+	{
+		Flush();
+
+		*Output() << output;
+		*ErrorOutput() << errorOutput;
+	}
+
+	// Those without a message go to the error output, as they did when written at once.
+	void Logger::Flush()
+	{
+		Buffer &buffer = Pending();
+
+		if (buffer.diagnostics.empty())
+		{
+			buffer.errorCount = 0;
+			return;
+		}
+
+		for (auto &i : buffer.diagnostics)
+		{
+			Write(*i.message ? *Output() : *ErrorOutput(), buffer.format, i);
+		}
+
+		buffer.diagnostics.clear();
+		buffer.errorCount = 0;
+
+		Output()->flush();
+		ErrorOutput()->flush();
+	}
+
+	void Logger::Keep( const Location &location, const Diagnostic::Severity severity, const unsigned int code, const char * const message )
+	{
+		if (Diagnostics())
+		{
+			Diagnostics()->emplace_back(location, severity, code, message);
+			return;
+		}
+
+		Buffer &buffer = Pending();
+
+		if (IsErrorLimitReached())
+		{
+			return;
+		}
+
+		buffer.diagnostics.emplace_back(location, severity, code, message);
+
+		if (severity == Diagnostic::Severity::ERROR)
+		{
+			buffer.errorCount++;
+		}
+	}
+
+	void Logger::Write( ostream &output, const Format format, const Diagnostic &diagnostic )
+	{
+		if (format == Format::JSON_LINES)
+		{
+			Json log = Json::Object();
+
+			log.Set("file", diagnostic.location.FileName());
+			log.Set("line", diagnostic.location.Line());
+			log.Set("column", diagnostic.location.Column());
+			log.Set("severity", Diagnostic::Name(diagnostic.severity));
+			log.Set("code", diagnostic.code);
+
+			if (*diagnostic.message)
+			{
+				log.Set("message", diagnostic.message);
+			}
+
+			output << log.Write() << '\n';
+			return;
+		}
+
+		output << diagnostic.location << ' ' << Diagnostic::Name(diagnostic.severity) << ' ' << diagnostic.code;
+
+		if (*diagnostic.message)
+		{
+			output << ": " << diagnostic.message;
+		}
+
+		output << '\n';
+	}
+
+	void Logger::Write( ostream &output, const Format format, const Diagnostic::Severity severity, const unsigned int code, const char * const message )
+	{
+		if (format == Format::JSON_LINES)
+		{
+			Json log = Json::Object();
+
+			log.Set("severity", Diagnostic::Name(severity));
+			log.Set("code", code);
+
+			if (*message)
+			{
+				log.Set("message", message);
+			}
+
+			output << log.Write() << '\n';
+			return;
+		}
+
+		output << Diagnostic::Name(severity) << ' ' << code;
+
+		if (*message)
+		{
+			output << ": " << message;
+		}
+
+		output << '\n';
+	}
+}
\ No newline at end of file
@@ -2,44 +2,127 @@
 #define LOGGER
 
 #include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
 
 #include "Location.h"
+#include "Diagnostic.h"
 
 namespace lyrics
 {
 	using std::cout;
 	using std::cerr;
-	using std::endl;
+	using std::ostream;
+	using std::string;
+	using std::vector;
 
+	// The logs with a location are kept as they come and written together, when the logs of the calling thread are next written somewhere or go elsewhere, in the order they came.
+	// Those without one are written at once, after the ones kept. Once as many errors as the limit are kept, the ones after are dropped, and the caller stops at the next step it can.
 	class Logger
 	{
 	private:
 		Logger() = delete;
 
 	public:
-		static void Log( const Location location, const char logType[], const unsigned int code, const char * const message )
+		enum struct Format : unsigned char { TEXT, JSON_LINES };	// JSON_LINES is a JSON object a line, and nothing for what is not a log.
+
+		static void Log( const Location &location, const Diagnostic::Severity severity, const unsigned int code, const char * const message )
+		{
+			Keep(location, severity, code, message);
+		}
+
+		static void Log( const Diagnostic::Severity severity, const unsigned int code, const char * const message );
+
+		static void CompilationTerminated();
+
+		static void StandardErrorLog( const Location &location, const Diagnostic::Severity severity, const unsigned int code )
+		{
+			Keep(location, severity, code, "");
+		}
+
+		static void StandardErrorLog( const Diagnostic::Severity severity, const unsigned int code );
+
+		// Writes logs kept apart to where the logs of the calling thread go.
+		static void Write( const string &output, const string &errorOutput );
+
+		// Sends the logs of the calling thread to the streams given, so that each file of a batch is logged apart. nullptr goes back to cout and cerr.
+		static void Redirect( ostream * const output, ostream * const errorOutput )
+		{
+			Flush();
+
+			Output() = output ? output : &cout;
+			ErrorOutput() = errorOutput ? errorOutput : &cerr;
+		}
+
+		// Keeps the logs of the calling thread that have a location in the list given instead of writing them. nullptr writes them again.
+		static void Capture( vector<Diagnostic> * const diagnostics )
+		{
+			Diagnostics() = diagnostics;
+		}
+
+		static vector<Diagnostic> *Captured()
 		{
-			cout << location << ' ' << logType << ' ' << code << ": " << message << endl;
+			return Diagnostics();
 		}
 
-		static void Log( const char logType[], const unsigned int code, const char * const message )
+		// Of the logs of the calling thread. An error limit of 0 is none.
+		static void Configure( const Format format, const unsigned int errorLimit )
 		{
-			cout << logType << ' ' << code << ": " << message << endl;
+			Pending().format = format;
+			Pending().errorLimit = errorLimit;
 		}
 
-		static void CompilationTerminated()
+		static bool IsErrorLimitReached()	// Since the logs were last written.
 		{
-			cout << "Compilation terminated." << endl;
+			return Pending().errorLimit != 0 && Pending().errorCount >= Pending().errorLimit;
 		}
 
-		static void StandardErrorLog( const Location location, const char logType[], const unsigned int code )
+		static void Flush();	// Writes the logs kept.
+
+	private:
+		struct Buffer
 		{
-			cerr << location << ' ' << logType << ' ' << code << endl;
+			Buffer() : format(Format::TEXT), errorLimit(0), errorCount(0)
+			{
+			}
+
+			vector<Diagnostic> diagnostics;
+			Format format;
+			unsigned int errorLimit;
+			unsigned int errorCount;
+		};
+
+		static void Keep( const Location &location, const Diagnostic::Severity severity, const unsigned int code, const char * const message );
+		static void Write( ostream &output, const Format format, const Diagnostic &diagnostic );
+		static void Write( ostream &output, const Format format, const Diagnostic::Severity severity, const unsigned int code, const char * const message );
+
+		static ostream *&Output()
+		{
+			thread_local ostream *output = &cout;
+
+			return output;
 		}
 
-		static void StandardErrorLog( const char logType[], const unsigned int code )
+		static ostream *&ErrorOutput()
 		{
-			cerr << logType << ' ' << code << endl;
+			thread_local ostream *errorOutput = &cerr;
+
+			return errorOutput;
+		}
+
+		static vector<Diagnostic> *&Diagnostics()
+		{
+			thread_local vector<Diagnostic> *diagnostics = nullptr;
+
+			return diagnostics;
+		}
+
+		static Buffer &Pending()
+		{
+			thread_local Buffer buffer;
+
+			return buffer;
 		}
 	};
 }
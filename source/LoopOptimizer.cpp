@@ -0,0 +1,626 @@
+#include "LoopOptimizer.h"
+
+namespace lyrics
+{
+	void LoopOptimizer::FindInvariants(const StatementNode * const loop, const StaticTypeChecker::TypeTable &typeTable, const unordered_set<u32string> &variables, ExpressionList &invariants)
+	{
+		mTypeTable = &typeTable;
+		mVariables = &variables;
+		mInvariants = &invariants;
+		mAssigned.clear();
+
+		FindAssigned(loop);
+
+		switch (loop->type)
+		{
+		case Node::Type::WHILE:
+			FindInvariants(static_cast<const WhileNode *>(loop)->condition);
+			FindInvariants(static_cast<const WhileNode *>(loop)->block);
+			break;
+
+		case Node::Type::FOR:
+			FindInvariants(static_cast<const ForNode *>(loop)->condition);
+			FindInvariants(static_cast<const ForNode *>(loop)->block);
+			FindInvariants(static_cast<const ForNode *>(loop)->iterator);
+			break;
+
+		case Node::Type::FOREACH:
+			FindInvariants(static_cast<const ForEachNode *>(loop)->block);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// Nested functions are searched as well, though they could only assign a variable of the frame through a box.
+	void LoopOptimizer::FindAssigned(const StatementNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::IMPORT:
+		case Node::Type::BREAK:
+		case Node::Type::NEXT:
+			break;
+
+		case Node::Type::IF:
+			for (auto i : static_cast<const IfNode *>(node)->list)
+			{
+				FindAssigned(i->condition);
+				FindAssigned(i->block);
+			}
+
+			FindAssigned(static_cast<const IfNode *>(node)->block);
+			break;
+
+		case Node::Type::CASE:
+			FindAssigned(static_cast<const CaseNode *>(node)->value);
+
+			for (auto i : static_cast<const CaseNode *>(node)->list)
+			{
+				FindAssigned(i->condition);
+				FindAssigned(i->block);
+			}
+
+			FindAssigned(static_cast<const CaseNode *>(node)->block);
+			break;
+
+		case Node::Type::WHILE:
+			FindAssigned(static_cast<const WhileNode *>(node)->condition);
+			FindAssigned(static_cast<const WhileNode *>(node)->block);
+			break;
+
+		case Node::Type::FOR:
+			FindAssigned(static_cast<const ForNode *>(node)->initializer);
+			FindAssigned(static_cast<const ForNode *>(node)->condition);
+			FindAssigned(static_cast<const ForNode *>(node)->iterator);
+			FindAssigned(static_cast<const ForNode *>(node)->block);
+			break;
+
+		case Node::Type::FOREACH:
+			if (static_cast<const ForEachNode *>(node)->variable->type == Node::Type::IDENTIFIER)
+			{
+				mAssigned.insert(*static_cast<const IdentifierNode *>(static_cast<const ForEachNode *>(node)->variable)->identifier);
+			}
+
+			FindAssigned(static_cast<const ForEachNode *>(node)->collection);
+			FindAssigned(static_cast<const ForEachNode *>(node)->block);
+			break;
+
+		case Node::Type::RETURN:
+			if (static_cast<const ReturnNode *>(node)->value)
+			{
+				FindAssigned(static_cast<const ReturnNode *>(node)->value);
+			}
+			break;
+
+		case Node::Type::ERROR:
+			break;
+
+		default:
+			FindAssigned(static_cast<const ExpressionNode *>(node));
+			break;
+		}
+	}
+
+	void LoopOptimizer::FindAssigned(const BlockNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		for (auto i : node->list)
+		{
+			if (i)
+			{
+				FindAssigned(i);
+			}
+		}
+	}
+
+	void LoopOptimizer::FindAssigned(const ExpressionNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::ARRAY_LITERAL:
+			for (auto i : static_cast<const ArrayLiteralNode *>(node)->list)
+			{
+				FindAssigned(i);
+			}
+			break;
+
+		case Node::Type::HASH_LITERAL:
+			for (auto i : static_cast<const HashLiteralNode *>(node)->list)
+			{
+				FindAssigned(i->key);
+				FindAssigned(i->value);
+			}
+			break;
+
+		case Node::Type::FUNCTION_LITERAL:
+			for (auto i : static_cast<const FunctionLiteralNode *>(node)->list)
+			{
+				if (i->type == Node::Type::VALUE_PARAMETER && static_cast<const ValueParameterNode *>(i)->defalutArgument)
+				{
+					FindAssigned(static_cast<const ValueParameterNode *>(i)->defalutArgument);
+				}
+			}
+
+			FindAssigned(static_cast<const FunctionLiteralNode *>(node)->block);
+			break;
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			FindAssigned(static_cast<const ParenthesizedExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			FindAssigned(static_cast<const IndexReferenceNode *>(node)->expression);
+			FindAssigned(static_cast<const IndexReferenceNode *>(node)->index);
+			break;
+
+		case Node::Type::FUNCTION_CALL:
+			FindAssigned(static_cast<const FunctionCallNode *>(node)->expression);
+			FindAssigned(static_cast<const FunctionCallNode *>(node)->list);
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			FindAssigned(static_cast<const MemberReferenceNode *>(node)->expression);
+			break;
+
+		case Node::Type::UNARY_EXPRESSION:
+			FindAssigned(static_cast<const UnaryExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			FindAssigned(static_cast<const MultiplicativeExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const MultiplicativeExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			FindAssigned(static_cast<const AdditiveExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const AdditiveExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::SHIFT_EXPRESSION:
+			FindAssigned(static_cast<const ShiftExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const ShiftExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::AND_EXPRESSION:
+			FindAssigned(static_cast<const AndExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const AndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::OR_EXPRESSION:
+			FindAssigned(static_cast<const OrExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const OrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			FindAssigned(static_cast<const RelationalExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const RelationalExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			FindAssigned(static_cast<const EqualityExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const EqualityExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_AND_EXPRESSION:
+			FindAssigned(static_cast<const LogicalAndExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const LogicalAndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			FindAssigned(static_cast<const LogicalOrExpressionNode *>(node)->left);
+			FindAssigned(static_cast<const LogicalOrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ASSIGNMENT_EXPRESSION:
+			{
+				const AssignmentExpressionNode * const assignment = static_cast<const AssignmentExpressionNode *>(node);
+
+				if (assignment->lhs->type == Node::Type::IDENTIFIER)
+				{
+					mAssigned.insert(*static_cast<const IdentifierNode *>(assignment->lhs)->identifier);
+				}
+				else
+				{
+					FindAssigned(assignment->lhs);
+				}
+
+				FindAssigned(assignment->rhs);
+			}
+			break;
+
+		case Node::Type::CLASS:
+			{
+				const ClassNode * const classNode = static_cast<const ClassNode *>(node);
+
+				for (auto i : classNode->list)
+				{
+					FindAssigned(i);
+				}
+
+				if (classNode->baseClassConstructorCall)
+				{
+					FindAssigned(classNode->baseClassConstructorCall->list);
+				}
+
+				FindAssigned(classNode->block);
+			}
+			break;
+
+		case Node::Type::PACKAGE:
+			FindAssigned(static_cast<const PackageNode *>(node)->block);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	// A variable passed to a function may be written back by an output parameter.
+	void LoopOptimizer::FindAssigned(const forward_list<ExpressionNode *> &arguments)
+	{
+		for (auto i : arguments)
+		{
+			if (i->type == Node::Type::IDENTIFIER)
+			{
+				mAssigned.insert(*static_cast<const IdentifierNode *>(i)->identifier);
+			}
+			else
+			{
+				FindAssigned(i);
+			}
+		}
+	}
+
+	void LoopOptimizer::FindInvariants(const StatementNode * const node)
+	{
+		switch (node->type)
+		{
+		case Node::Type::IF:
+			for (auto i : static_cast<const IfNode *>(node)->list)
+			{
+				FindInvariants(i->condition);
+				FindInvariants(i->block);
+			}
+
+			FindInvariants(static_cast<const IfNode *>(node)->block);
+			break;
+
+		case Node::Type::CASE:
+			FindInvariants(static_cast<const CaseNode *>(node)->value);
+
+			for (auto i : static_cast<const CaseNode *>(node)->list)
+			{
+				FindInvariants(i->block);
+			}
+
+			FindInvariants(static_cast<const CaseNode *>(node)->block);
+			break;
+
+		case Node::Type::WHILE:
+			FindInvariants(static_cast<const WhileNode *>(node)->condition);
+			FindInvariants(static_cast<const WhileNode *>(node)->block);
+			break;
+
+		case Node::Type::FOR:
+			FindInvariants(static_cast<const ForNode *>(node)->initializer);
+			FindInvariants(static_cast<const ForNode *>(node)->condition);
+			FindInvariants(static_cast<const ForNode *>(node)->iterator);
+			FindInvariants(static_cast<const ForNode *>(node)->block);
+			break;
+
+		case Node::Type::FOREACH:
+			FindInvariants(static_cast<const ForEachNode *>(node)->collection);
+			FindInvariants(static_cast<const ForEachNode *>(node)->block);
+			break;
+
+		case Node::Type::RETURN:
+			if (static_cast<const ReturnNode *>(node)->value)
+			{
+				FindInvariants(static_cast<const ReturnNode *>(node)->value);
+			}
+			break;
+
+		case Node::Type::IMPORT:
+		case Node::Type::BREAK:
+		case Node::Type::NEXT:
+		case Node::Type::ERROR:
+			break;
+
+		default:
+			FindInvariants(static_cast<const ExpressionNode *>(node));
+			break;
+		}
+	}
+
+	void LoopOptimizer::FindInvariants(const BlockNode * const node)
+	{
+		if (!node)
+		{
+			return;
+		}
+
+		for (auto i : node->list)
+		{
+			if (i)
+			{
+				FindInvariants(i);
+			}
+		}
+	}
+
+	// Takes the largest invariant expressions only. A variable or a constant alone costs no more to load than a hoisted value.
+	void LoopOptimizer::FindInvariants(const ExpressionNode * const node)
+	{
+		if (IsInvariant(node))
+		{
+			if (node->type != Node::Type::IDENTIFIER && node->type != Node::Type::BOOLEAN_LITERAL && node->type != Node::Type::INTEGER_LITERAL &&
+				node->type != Node::Type::REAL_LITERAL)
+			{
+				mInvariants->push_back(node);
+			}
+
+			return;
+		}
+
+		switch (node->type)
+		{
+		case Node::Type::ARRAY_LITERAL:
+			for (auto i : static_cast<const ArrayLiteralNode *>(node)->list)
+			{
+				FindInvariants(i);
+			}
+			break;
+
+		case Node::Type::HASH_LITERAL:
+			for (auto i : static_cast<const HashLiteralNode *>(node)->list)
+			{
+				FindInvariants(i->key);
+				FindInvariants(i->value);
+			}
+			break;
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			FindInvariants(static_cast<const ParenthesizedExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::INDEX_REFERENCE:
+			FindInvariants(static_cast<const IndexReferenceNode *>(node)->expression);
+			FindInvariants(static_cast<const IndexReferenceNode *>(node)->index);
+			break;
+
+		case Node::Type::FUNCTION_CALL:
+			FindInvariants(static_cast<const FunctionCallNode *>(node)->expression);
+
+			for (auto i : static_cast<const FunctionCallNode *>(node)->list)
+			{
+				FindInvariants(i);
+			}
+			break;
+
+		case Node::Type::MEMBER_REFERENCE:
+			FindInvariants(static_cast<const MemberReferenceNode *>(node)->expression);
+			break;
+
+		case Node::Type::UNARY_EXPRESSION:
+			FindInvariants(static_cast<const UnaryExpressionNode *>(node)->expression);
+			break;
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			FindInvariants(static_cast<const MultiplicativeExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const MultiplicativeExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			FindInvariants(static_cast<const AdditiveExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const AdditiveExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::SHIFT_EXPRESSION:
+			FindInvariants(static_cast<const ShiftExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const ShiftExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::AND_EXPRESSION:
+			FindInvariants(static_cast<const AndExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const AndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::OR_EXPRESSION:
+			FindInvariants(static_cast<const OrExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const OrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			FindInvariants(static_cast<const RelationalExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const RelationalExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			FindInvariants(static_cast<const EqualityExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const EqualityExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_AND_EXPRESSION:
+			FindInvariants(static_cast<const LogicalAndExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const LogicalAndExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::LOGICAL_OR_EXPRESSION:
+			FindInvariants(static_cast<const LogicalOrExpressionNode *>(node)->left);
+			FindInvariants(static_cast<const LogicalOrExpressionNode *>(node)->right);
+			break;
+
+		case Node::Type::ASSIGNMENT_EXPRESSION:
+			if (static_cast<const AssignmentExpressionNode *>(node)->lhs->type != Node::Type::IDENTIFIER)
+			{
+				FindInvariants(static_cast<const AssignmentExpressionNode *>(node)->lhs);
+			}
+
+			FindInvariants(static_cast<const AssignmentExpressionNode *>(node)->rhs);
+			break;
+
+		default:	// Functions, classes and packages run in frames of their own.
+			break;
+		}
+	}
+
+	bool LoopOptimizer::IsInvariant(const ExpressionNode * const node) const
+	{
+		switch (node->type)
+		{
+		case Node::Type::BOOLEAN_LITERAL:
+		case Node::Type::INTEGER_LITERAL:
+		case Node::Type::REAL_LITERAL:
+			return true;
+
+		case Node::Type::IDENTIFIER:
+			{
+				const u32string &identifier = *static_cast<const IdentifierNode *>(node)->identifier;
+
+				return mVariables->count(identifier) != 0 && mAssigned.count(identifier) == 0;
+			}
+
+		case Node::Type::PARENTHESIZED_EXPRESSION:
+			return IsInvariant(static_cast<const ParenthesizedExpressionNode *>(node)->expression);
+
+		case Node::Type::UNARY_EXPRESSION:
+			return IsArithmetic(node) && IsInvariant(static_cast<const UnaryExpressionNode *>(node)->expression);
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			return IsArithmetic(node) && IsInvariant(static_cast<const MultiplicativeExpressionNode *>(node)->left) &&
+				IsInvariant(static_cast<const MultiplicativeExpressionNode *>(node)->right);
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			return IsArithmetic(node) && IsInvariant(static_cast<const AdditiveExpressionNode *>(node)->left) &&
+				IsInvariant(static_cast<const AdditiveExpressionNode *>(node)->right);
+
+		case Node::Type::SHIFT_EXPRESSION:
+			return IsArithmetic(node) && IsInvariant(static_cast<const ShiftExpressionNode *>(node)->left) &&
+				IsInvariant(static_cast<const ShiftExpressionNode *>(node)->right);
+
+		case Node::Type::AND_EXPRESSION:
+			return IsArithmetic(node) && IsInvariant(static_cast<const AndExpressionNode *>(node)->left) &&
+				IsInvariant(static_cast<const AndExpressionNode *>(node)->right);
+
+		case Node::Type::OR_EXPRESSION:
+			return IsArithmetic(node) && IsInvariant(static_cast<const OrExpressionNode *>(node)->left) &&
+				IsInvariant(static_cast<const OrExpressionNode *>(node)->right);
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			return IsArithmetic(node) && IsInvariant(static_cast<const RelationalExpressionNode *>(node)->left) &&
+				IsInvariant(static_cast<const RelationalExpressionNode *>(node)->right);
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			return IsArithmetic(node) && IsInvariant(static_cast<const EqualityExpressionNode *>(node)->left) &&
+				IsInvariant(static_cast<const EqualityExpressionNode *>(node)->right);
+
+		default:
+			return false;
+		}
+	}
+
+	// Division is left out, as an integer division by zero fails.
+	bool LoopOptimizer::IsArithmetic(const ExpressionNode * const node) const
+	{
+		const ExpressionNode *left = nullptr;
+		const ExpressionNode *right = nullptr;
+		bool isIntegerOnly = false;
+		bool isBooleanAllowed = false;
+
+		switch (node->type)
+		{
+		case Node::Type::UNARY_EXPRESSION:
+			{
+				const UnaryExpressionNode * const unary = static_cast<const UnaryExpressionNode *>(node);
+
+				if (unary->op == static_cast<Token::Type>(U'!'))
+				{
+					auto typeSet = mTypeTable->find(unary->expression);
+
+					return typeSet != mTypeTable->cend() && StaticTypeChecker::IsOnly(typeSet->second, Literal::Type::BOOLEAN);
+				}
+
+				left = right = unary->expression;
+				isIntegerOnly = unary->op == static_cast<Token::Type>(U'~');
+			}
+			break;
+
+		case Node::Type::MULTIPLICATIVE_EXPRESSION:
+			if (static_cast<const MultiplicativeExpressionNode *>(node)->op != static_cast<Token::Type>(U'*'))
+			{
+				return false;
+			}
+
+			left = static_cast<const MultiplicativeExpressionNode *>(node)->left;
+			right = static_cast<const MultiplicativeExpressionNode *>(node)->right;
+			break;
+
+		case Node::Type::ADDITIVE_EXPRESSION:
+			left = static_cast<const AdditiveExpressionNode *>(node)->left;
+			right = static_cast<const AdditiveExpressionNode *>(node)->right;
+			break;
+
+		case Node::Type::SHIFT_EXPRESSION:
+			left = static_cast<const ShiftExpressionNode *>(node)->left;
+			right = static_cast<const ShiftExpressionNode *>(node)->right;
+			isIntegerOnly = true;
+
+			// A shift by a count out of range fails, so only a literal count in range is taken.
+			if (right->type != Node::Type::INTEGER_LITERAL || static_cast<const IntegerLiteralNode *>(right)->integer < 0 ||
+				static_cast<const IntegerLiteralNode *>(right)->integer > 63)
+			{
+				return false;
+			}
+			break;
+
+		case Node::Type::AND_EXPRESSION:
+			left = static_cast<const AndExpressionNode *>(node)->left;
+			right = static_cast<const AndExpressionNode *>(node)->right;
+			isIntegerOnly = true;
+			break;
+
+		case Node::Type::OR_EXPRESSION:
+			left = static_cast<const OrExpressionNode *>(node)->left;
+			right = static_cast<const OrExpressionNode *>(node)->right;
+			isIntegerOnly = true;
+			break;
+
+		case Node::Type::RELATIONAL_EXPRESSION:
+			left = static_cast<const RelationalExpressionNode *>(node)->left;
+			right = static_cast<const RelationalExpressionNode *>(node)->right;
+			break;
+
+		case Node::Type::EQUALITY_EXPRESSION:
+			left = static_cast<const EqualityExpressionNode *>(node)->left;
+			right = static_cast<const EqualityExpressionNode *>(node)->right;
+			isBooleanAllowed = true;
+			break;
+
+		default:
+			return false;
+		}
+
+		auto leftTypeSet = mTypeTable->find(left);
+		auto rightTypeSet = mTypeTable->find(right);
+
+		if (leftTypeSet == mTypeTable->cend() || rightTypeSet == mTypeTable->cend())
+		{
+			return false;
+		}
+
+		const StaticTypeChecker::TypeSet number = isIntegerOnly ? StaticTypeChecker::TypeOf(Literal::Type::INTEGER) :
+			StaticTypeChecker::TypeOf(Literal::Type::INTEGER) | StaticTypeChecker::TypeOf(Literal::Type::REAL);
+		const bool isNumber = leftTypeSet->second != StaticTypeChecker::NONE && (leftTypeSet->second & ~number) == 0u &&
+			rightTypeSet->second != StaticTypeChecker::NONE && (rightTypeSet->second & ~number) == 0u;
+		const bool isBoolean = isBooleanAllowed && StaticTypeChecker::IsOnly(leftTypeSet->second, Literal::Type::BOOLEAN) &&
+			StaticTypeChecker::IsOnly(rightTypeSet->second, Literal::Type::BOOLEAN);
+
+		return isNumber || isBoolean;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef LOOP_OPTIMIZER
+#define LOOP_OPTIMIZER
+
+#include <string>
+#include <vector>
+#include <forward_list>
+#include <unordered_set>
+
+#include "Node.h"
+#include "StaticTypeChecker.h"
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::vector;
+	using std::forward_list;
+	using std::unordered_set;
+
+	// Finds the expressions of a loop whose value can not change while it runs, so that they are evaluated once before it.
+	// Only arithmetic over integers and reals is taken, with no division and shifts only by a literal count in range, which never fails, so evaluating it even when the loop runs no times is harmless.
+	class LoopOptimizer
+	{
+	public:
+		typedef vector<const ExpressionNode *> ExpressionList;
+
+		void FindInvariants(const StatementNode * const loop, const StaticTypeChecker::TypeTable &typeTable, const unordered_set<u32string> &variables, ExpressionList &invariants);
+
+	private:
+		void FindAssigned(const StatementNode * const node);
+		void FindAssigned(const BlockNode * const node);
+		void FindAssigned(const ExpressionNode * const node);
+		void FindAssigned(const forward_list<ExpressionNode *> &arguments);
+		void FindInvariants(const StatementNode * const node);
+		void FindInvariants(const BlockNode * const node);
+		void FindInvariants(const ExpressionNode * const node);
+
+		bool IsInvariant(const ExpressionNode * const node) const;
+		bool IsArithmetic(const ExpressionNode * const node) const;
+
+		const StaticTypeChecker::TypeTable *mTypeTable;
+		const unordered_set<u32string> *mVariables;	// Variables in the frame that nothing else can assign.
+		unordered_set<u32string> mAssigned;
+		ExpressionList *mInvariants;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -1,20 +1,54 @@
+#include <iostream>
+
 #include "Compiler.h"
+#include "BatchCompiler.h"
+#include "CompileServer.h"
+#include "LanguageServer.h"
 
 #include "Option.h"
+#include "ErrorCode.h"
 #include "FatalErrorCode.h"
 #include "ErrorLogger.h"
+#include "Logger.h"
 
 int main(int argc, char *argv[])
 {
 	using lyrics::Option;
 	using lyrics::Compiler;
+	using lyrics::BatchCompiler;
+	using lyrics::CompileServer;
+	using lyrics::LanguageServer;
+	using lyrics::ErrorCode;
 	using lyrics::FatalErrorCode;
 	using lyrics::ErrorLogger;
+	using lyrics::Logger;
 
 	const Option option = Option(argc, argv);
 
+	Logger::Configure(option.IsJsonLog() ? Logger::Format::JSON_LINES : Logger::Format::TEXT, option.ErrorLimit());
+
 	try
 	{
+		if (option.IsLanguageServer())
+		{
+			return LanguageServer().Serve(std::cin, std::cout);
+		}
+
+		if (!option.ServerSocketName().empty())
+		{
+			CompileServer().Serve(option.ServerSocketName());
+		}
+
+		if (!option.RemoteSocketName().empty())
+		{
+			return CompileServer::Request(option.RemoteSocketName(), argc, argv);
+		}
+
+		if (BatchCompiler::IsBatch(option))
+		{
+			return BatchCompiler().Compile(option) ? 0 : 1;
+		}
+
 		Compiler().Compile(option);
 	}
 	catch (const FatalErrorCode fatalErrorCode)
@@ -22,6 +56,11 @@ int main(int argc, char *argv[])
 		ErrorLogger::FatalError(fatalErrorCode);
 		return 1;
 	}
+	catch (const ErrorCode errorCode)	// Logged already, but maybe kept.
+	{
+		Logger::Flush();
+		return 1;
+	}
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef STRUCT_MODULE
+#define STRUCT_MODULE
+
+#include <string>
+#include <vector>
+
+#include "Function.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::vector;
+
+	// Output of the code generator. Function 0 is the top level of the script.
+	struct Module
+	{
+		Module()
+		{
+		}
+
+		~Module()
+		{
+			for (auto i : functions)
+			{
+				Utility::SafeDelete(i);
+			}
+			for (auto i : strings)
+			{
+				Utility::SafeDelete(i);
+			}
+		}
+
+		Module(const Module &) = delete;
+		Module &operator=(const Module &) = delete;
+
+		vector<Function *> functions;
+		vector<u32string *> strings;
+		vector<unsigned int> globals;	// Name of each GP slot as an index into strings.
+	};
+}
+
+#endif
\ No newline at end of file
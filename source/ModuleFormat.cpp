@@ -0,0 +1,9 @@
+#include "ModuleFormat.h"
+
+namespace lyrics
+{
+	constexpr char ModuleFormat::MAGIC[4];
+	constexpr uint32_t ModuleFormat::VERSION;
+	constexpr uint32_t ModuleFormat::BYTE_ORDER_MARK;
+	constexpr uint32_t ModuleFormat::ALIGNMENT;
+}
\ No newline at end of file
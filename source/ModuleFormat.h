@@ -0,0 +1,97 @@
+#ifndef STRUCT_MODULE_FORMAT
+#define STRUCT_MODULE_FORMAT
+
+#include <cstdint>
+
+namespace lyrics
+{
+	using std::uint16_t;
+	using std::uint32_t;
+	using std::int64_t;
+
+	// Layout of a compiled module file, written by ModuleWriter and mapped by ModuleImage. Every record is at a multiple of ALIGNMENT and refers to the others by offsets from the start of the file,
+	// so that the file is used where it is mapped. The code is kept as ByteCode, which is why the byte order and the size of a ByteCode have to match those of the reader.
+	struct ModuleFormat
+	{
+		static constexpr char MAGIC[4] = { 'L', 'Y', 'M', 'D' };
+		static constexpr uint32_t VERSION = 1;
+		static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+		static constexpr uint32_t ALIGNMENT = 8;
+
+		struct Section
+		{
+			uint32_t offset;
+			uint32_t count;
+		};
+
+		struct Header
+		{
+			char magic[4];
+			uint32_t version;
+			uint32_t byteOrderMark;
+			uint32_t byteCodeSize;
+			uint32_t size;	// Of the whole file.
+			Section functions;
+			Section strings;	// Each a Section of char32_t.
+			Section globals;	// uint32_t indices into strings.
+		};
+
+		struct Function
+		{
+			Section code;
+			Section constants;
+			Section inlineCaches;	// uint32_t member names as indices into strings.
+			Section jumpTables;
+			Section upvalues;
+			Section entries;	// uint32_t.
+			Section outputParameters;	// uint16_t.
+			Section lines;
+			uint16_t parameterCount;
+			uint16_t variableCount;
+			uint16_t temporaryCount;
+			uint16_t isClass;
+		};
+
+		// A string constant is an index into strings, a boolean is kept as an integer.
+		struct Constant
+		{
+			uint32_t type;
+			uint32_t string;
+			union
+			{
+				int64_t integer;
+				double real;
+			};
+		};
+
+		struct Case
+		{
+			uint32_t string;
+			uint32_t target;
+		};
+
+		struct JumpTable
+		{
+			int64_t minimum;
+			Section targets;	// uint32_t.
+			Section strings;	// Case.
+			uint32_t defaultTarget;
+			uint32_t padding;
+		};
+
+		struct Upvalue
+		{
+			uint16_t isLocal;
+			uint16_t index;
+		};
+
+		// The line of the instructions from address up to the address of the next one.
+		struct Line
+		{
+			uint32_t address;
+			uint32_t line;
+		};
+	};
+}
+
+#endif
\ No newline at end of file
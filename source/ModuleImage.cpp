@@ -0,0 +1,249 @@
+#include "ModuleImage.h"
+
+#include <new>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "Literal.h"
+#include "FatalErrorCode.h"
+
+namespace lyrics
+{
+	void ModuleImage::Map(const string &name)
+	{
+		using std::bad_alloc;
+
+		Unmap();
+
+#ifdef _WIN32
+		const HANDLE file = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			throw FatalErrorCode::CANNOT_OPEN_FILE;
+		}
+
+		LARGE_INTEGER size;
+
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || static_cast<unsigned long long>(size.QuadPart) > 0xFFFFFFFFull)
+		{
+			CloseHandle(file);
+			throw FatalErrorCode::INVALID_MODULE;
+		}
+
+		const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		const void * const base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+		if (mapping)
+		{
+			CloseHandle(mapping);	// The view keeps the mapping alive.
+		}
+		CloseHandle(file);
+
+		if (!base)
+		{
+			throw FatalErrorCode::CANNOT_READ_FILE;
+		}
+
+		mSize = static_cast<size_t>(size.QuadPart);
+#else
+		const int file = open(name.c_str(), O_RDONLY);
+
+		if (file == -1)
+		{
+			throw FatalErrorCode::CANNOT_OPEN_FILE;
+		}
+
+		struct stat status;
+
+		if (fstat(file, &status) == -1 || status.st_size == 0 || static_cast<unsigned long long>(status.st_size) > 0xFFFFFFFFull)
+		{
+			close(file);
+			throw FatalErrorCode::INVALID_MODULE;
+		}
+
+		void * const base = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+		close(file);	// The mapping stays after the file is closed.
+
+		if (base == MAP_FAILED)
+		{
+			throw FatalErrorCode::CANNOT_READ_FILE;
+		}
+
+		mSize = static_cast<size_t>(status.st_size);
+#endif
+		mBase = static_cast<const char *>(base);
+
+		try
+		{
+			Check();
+		}
+		catch (const bad_alloc &e)
+		{
+			Unmap();
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+		catch (const FatalErrorCode fatalErrorCode)
+		{
+			Unmap();
+			throw fatalErrorCode;
+		}
+	}
+
+	void ModuleImage::Unmap()
+	{
+		if (mBase)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(mBase);
+#else
+			munmap(const_cast<char *>(mBase), mSize);
+#endif
+		}
+
+		mBase = nullptr;
+		mSize = 0;
+		mFunctions.clear();
+		mStrings = nullptr;
+		mStringCount = 0;
+		mGlobals = nullptr;
+		mGlobalCount = 0;
+	}
+
+	uint32_t ModuleImage::Line(const Function &function, const uint32_t address)
+	{
+		const ModuleFormat::Line * const begin = function.lines;
+		const ModuleFormat::Line * const end = function.lines + function.record->lines.count;
+		ModuleFormat::Line key;
+
+		key.address = address;
+		key.line = 0;
+
+		// The last entry at or before the address.
+		const ModuleFormat::Line *line = std::upper_bound(begin, end, key, LineOrder());
+
+		return line != begin ? (line - 1)->line : 0;
+	}
+
+	// Turns the offsets into pointers, checking that each section lies in the file and that every string index is in the table.
+	void ModuleImage::Check()
+	{
+		if (mSize < sizeof(ModuleFormat::Header))
+		{
+			throw FatalErrorCode::INVALID_MODULE;
+		}
+
+		const ModuleFormat::Header &header = *reinterpret_cast<const ModuleFormat::Header *>(mBase);
+
+		if (std::memcmp(header.magic, ModuleFormat::MAGIC, sizeof(header.magic)) != 0 || header.version != ModuleFormat::VERSION ||
+			header.byteOrderMark != ModuleFormat::BYTE_ORDER_MARK || header.byteCodeSize != sizeof(ByteCode) || header.size != mSize)
+		{
+			throw FatalErrorCode::INVALID_MODULE;
+		}
+
+		mStrings = Resolve<ModuleFormat::Section>(header.strings);
+		mStringCount = header.strings.count;
+
+		for (uint32_t i = 0; i < mStringCount; i++)
+		{
+			Resolve<char32_t>(mStrings[i]);
+		}
+
+		mGlobals = Resolve<uint32_t>(header.globals);
+		mGlobalCount = header.globals.count;
+
+		for (uint32_t i = 0; i < mGlobalCount; i++)
+		{
+			CheckString(mGlobals[i]);
+		}
+
+		const ModuleFormat::Function * const records = Resolve<ModuleFormat::Function>(header.functions);
+
+		mFunctions.resize(header.functions.count);
+
+		for (uint32_t i = 0; i < header.functions.count; i++)
+		{
+			CheckFunction(records[i]);
+
+			Function &function = mFunctions[i];
+
+			function.record = &records[i];
+			function.code = Resolve<ByteCode>(records[i].code);
+			function.constants = Resolve<ModuleFormat::Constant>(records[i].constants);
+			function.inlineCaches = Resolve<uint32_t>(records[i].inlineCaches);
+			function.jumpTables = Resolve<ModuleFormat::JumpTable>(records[i].jumpTables);
+			function.upvalues = Resolve<ModuleFormat::Upvalue>(records[i].upvalues);
+			function.entries = Resolve<uint32_t>(records[i].entries);
+			function.outputParameters = Resolve<uint16_t>(records[i].outputParameters);
+			function.lines = Resolve<ModuleFormat::Line>(records[i].lines);
+		}
+	}
+
+	void ModuleImage::CheckFunction(const ModuleFormat::Function &record)
+	{
+		const ModuleFormat::Constant * const constants = Resolve<ModuleFormat::Constant>(record.constants);
+
+		for (uint32_t i = 0; i < record.constants.count; i++)
+		{
+			if (constants[i].type > static_cast<uint32_t>(Literal::Type::REFERENCE))
+			{
+				throw FatalErrorCode::INVALID_MODULE;
+			}
+
+			if (constants[i].type == static_cast<uint32_t>(Literal::Type::STRING))
+			{
+				CheckString(constants[i].string);
+			}
+		}
+
+		const uint32_t * const inlineCaches = Resolve<uint32_t>(record.inlineCaches);
+
+		for (uint32_t i = 0; i < record.inlineCaches.count; i++)
+		{
+			CheckString(inlineCaches[i]);
+		}
+
+		const ModuleFormat::JumpTable * const jumpTables = Resolve<ModuleFormat::JumpTable>(record.jumpTables);
+
+		for (uint32_t i = 0; i < record.jumpTables.count; i++)
+		{
+			Resolve<uint32_t>(jumpTables[i].targets);
+
+			const ModuleFormat::Case * const cases = Resolve<ModuleFormat::Case>(jumpTables[i].strings);
+
+			for (uint32_t j = 0; j < jumpTables[i].strings.count; j++)
+			{
+				CheckString(cases[j].string);
+			}
+		}
+	}
+
+	void ModuleImage::CheckString(const uint32_t index) const
+	{
+		if (index >= mStringCount)
+		{
+			throw FatalErrorCode::INVALID_MODULE;
+		}
+	}
+
+	template <typename T>
+	const T *ModuleImage::Resolve(const ModuleFormat::Section &section) const
+	{
+		if (section.offset % alignof(T) != 0 || section.offset > mSize || section.count > (mSize - section.offset) / sizeof(T))
+		{
+			throw FatalErrorCode::INVALID_MODULE;
+		}
+
+		return reinterpret_cast<const T *>(mBase + section.offset);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,117 @@
+#ifndef MODULE_IMAGE
+#define MODULE_IMAGE
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ByteCode.h"
+#include "ModuleFormat.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::string;
+	using std::vector;
+
+	// A module file mapped read only, used where it is mapped. Loading it costs the checks of the header and of the offsets, which are turned into pointers once.
+	// The code itself is not verified, so a file is expected to come from ModuleWriter.
+	class ModuleImage
+	{
+	public:
+		struct Function
+		{
+			const ModuleFormat::Function *record;	// For the counts.
+			const ByteCode *code;
+			const ModuleFormat::Constant *constants;
+			const uint32_t *inlineCaches;
+			const ModuleFormat::JumpTable *jumpTables;
+			const ModuleFormat::Upvalue *upvalues;
+			const uint32_t *entries;
+			const uint16_t *outputParameters;
+			const ModuleFormat::Line *lines;
+		};
+
+		ModuleImage() : mBase(nullptr), mSize(0), mStrings(nullptr), mStringCount(0), mGlobals(nullptr), mGlobalCount(0)
+		{
+		}
+
+		~ModuleImage()
+		{
+			Unmap();
+		}
+
+		ModuleImage(const ModuleImage &) = delete;
+		ModuleImage &operator=(const ModuleImage &) = delete;
+
+		void Map(const string &name);
+		void Unmap();
+
+		const char *Data() const
+		{
+			return mBase;
+		}
+
+		size_t Size() const
+		{
+			return mSize;
+		}
+
+		const vector<Function> &Functions() const
+		{
+			return mFunctions;
+		}
+
+		const uint32_t *Globals(uint32_t &count) const
+		{
+			count = mGlobalCount;
+
+			return mGlobals;
+		}
+
+		const char32_t *String(const uint32_t index, uint32_t &length) const
+		{
+			length = mStrings[index].count;
+
+			return reinterpret_cast<const char32_t *>(mBase + mStrings[index].offset);
+		}
+
+		const ModuleFormat::JumpTable &GetJumpTable(const Function &function, const uint32_t index, const uint32_t *&targets, const ModuleFormat::Case *&cases) const
+		{
+			const ModuleFormat::JumpTable &jumpTable = function.jumpTables[index];
+
+			targets = reinterpret_cast<const uint32_t *>(mBase + jumpTable.targets.offset);
+			cases = reinterpret_cast<const ModuleFormat::Case *>(mBase + jumpTable.strings.offset);
+
+			return jumpTable;
+		}
+
+		static uint32_t Line(const Function &function, const uint32_t address);	// 0 if the function has no line table.
+
+	private:
+		struct LineOrder
+		{
+			bool operator()(const ModuleFormat::Line &left, const ModuleFormat::Line &right) const
+			{
+				return left.address < right.address;
+			}
+		};
+
+		void Check();
+		void CheckFunction(const ModuleFormat::Function &record);
+		void CheckString(const uint32_t index) const;
+
+		template <typename T>
+		const T *Resolve(const ModuleFormat::Section &section) const;
+
+		const char *mBase;
+		size_t mSize;
+		vector<Function> mFunctions;
+		const ModuleFormat::Section *mStrings;
+		uint32_t mStringCount;
+		const uint32_t *mGlobals;
+		uint32_t mGlobalCount;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "ModuleWriter.h"
+
+#include <new>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+
+#include "FatalErrorCode.h"
+
+namespace lyrics
+{
+	void ModuleWriter::Write(const Module &module, const string &name)
+	{
+		Image(module);
+		WriteFile(name);
+	}
+
+	const vector<char> &ModuleWriter::Image(const Module &module)
+	{
+		using std::bad_alloc;
+
+		mImage.clear();
+		mStrings.clear();
+		mIndices.clear();
+
+		try
+		{
+			for (auto i : module.strings)
+			{
+				mIndices.emplace(*i, static_cast<uint32_t>(mStrings.size()));
+				mStrings.push_back(i);
+			}
+
+			const size_t header = Reserve(sizeof(ModuleFormat::Header));
+			const size_t functions = Reserve(sizeof(ModuleFormat::Function) * module.functions.size());
+
+			for (size_t i = 0; i < module.functions.size(); i++)
+			{
+				WriteFunction(*module.functions[i], functions + sizeof(ModuleFormat::Function) * i);
+			}
+
+			ModuleFormat::Header record;
+
+			std::memcpy(record.magic, ModuleFormat::MAGIC, sizeof(record.magic));
+			record.version = ModuleFormat::VERSION;
+			record.byteOrderMark = ModuleFormat::BYTE_ORDER_MARK;
+			record.byteCodeSize = sizeof(ByteCode);
+			record.functions.offset = static_cast<uint32_t>(functions);
+			record.functions.count = static_cast<uint32_t>(module.functions.size());
+			record.globals = Append(module.globals.data(), module.globals.size());
+			record.strings.offset = static_cast<uint32_t>(Reserve(sizeof(ModuleFormat::Section) * mStrings.size()));
+			record.strings.count = static_cast<uint32_t>(mStrings.size());
+
+			for (size_t i = 0; i < mStrings.size(); i++)
+			{
+				Put(record.strings.offset + sizeof(ModuleFormat::Section) * i, Append(mStrings[i]->data(), mStrings[i]->size()));
+			}
+
+			record.size = static_cast<uint32_t>(Reserve(0));
+
+			Put(header, record);
+		}
+		catch (const bad_alloc &e)
+		{
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+
+		return mImage;
+	}
+
+	void ModuleWriter::WriteFunction(const Function &function, const size_t record)
+	{
+		using std::pair;
+		using std::sort;
+
+		ModuleFormat::Function header;
+
+		// Field by field, so that the padding of a ByteCode is written as zeros.
+		header.code.offset = static_cast<uint32_t>(Reserve(sizeof(ByteCode) * function.code.size()));
+		header.code.count = static_cast<uint32_t>(function.code.size());
+
+		for (size_t i = 0; i < function.code.size(); i++)
+		{
+			const size_t offset = header.code.offset + sizeof(ByteCode) * i;
+
+			Put(offset + offsetof(ByteCode, opcode), function.code[i].opcode);
+			Put(offset + offsetof(ByteCode, operand16), function.code[i].operand16);
+			Put(offset + offsetof(ByteCode, operand32), function.code[i].operand32);
+		}
+
+		vector<ModuleFormat::Constant> constants(function.constants.size());
+
+		for (size_t i = 0; i < constants.size(); i++)
+		{
+			const Literal &literal = function.constants[i];
+			ModuleFormat::Constant &constant = constants[i];
+
+			constant.type = static_cast<uint32_t>(literal.type);
+			constant.string = 0;
+			constant.integer = 0;
+
+			// Only the literals the code generator makes constants of.
+			switch (literal.type)
+			{
+			case Literal::Type::BOOLEAN:
+				constant.integer = literal.value.boolean ? 1 : 0;
+				break;
+
+			case Literal::Type::INTEGER:
+				constant.integer = literal.value.integer;
+				break;
+
+			case Literal::Type::REAL:
+				constant.real = literal.value.real;
+				break;
+
+			case Literal::Type::STRING:
+				constant.string = Intern(*literal.value.string);
+				break;
+
+			default:
+				constant.type = static_cast<uint32_t>(Literal::Type::NULL_LITERAL);
+				break;
+			}
+		}
+
+		header.constants = Append(constants.data(), constants.size());
+
+		vector<uint32_t> members;
+
+		for (auto &i : function.inlineCaches)
+		{
+			members.push_back(i.member);
+		}
+
+		header.inlineCaches = Append(members.data(), members.size());
+
+		vector<ModuleFormat::JumpTable> jumpTables(function.jumpTables.size());
+
+		for (size_t i = 0; i < jumpTables.size(); i++)
+		{
+			const JumpTable &jumpTable = function.jumpTables[i];
+			vector<pair<uint32_t, uint32_t>> cases;
+
+			for (auto &j : jumpTable.strings)
+			{
+				cases.emplace_back(Intern(j.first), j.second);
+			}
+
+			sort(cases.begin(), cases.end());	// In the order of the strings, not of the hash table, so that a module is written the same each time.
+
+			vector<ModuleFormat::Case> records(cases.size());
+
+			for (size_t j = 0; j < cases.size(); j++)
+			{
+				records[j].string = cases[j].first;
+				records[j].target = cases[j].second;
+			}
+
+			jumpTables[i].minimum = jumpTable.minimum;
+			jumpTables[i].targets = Append(jumpTable.targets.data(), jumpTable.targets.size());
+			jumpTables[i].strings = Append(records.data(), records.size());
+			jumpTables[i].defaultTarget = jumpTable.defaultTarget;
+			jumpTables[i].padding = 0;
+		}
+
+		header.jumpTables = Append(jumpTables.data(), jumpTables.size());
+
+		vector<ModuleFormat::Upvalue> upvalues(function.upvalues.size());
+
+		for (size_t i = 0; i < upvalues.size(); i++)
+		{
+			upvalues[i].isLocal = function.upvalues[i].isLocal ? 1 : 0;
+			upvalues[i].index = function.upvalues[i].index;
+		}
+
+		header.upvalues = Append(upvalues.data(), upvalues.size());
+		header.entries = Append(function.entries.data(), function.entries.size());
+		header.outputParameters = Append(function.outputParameters.data(), function.outputParameters.size());
+
+		vector<ModuleFormat::Line> lines;
+
+		for (size_t i = 0; i < function.lines.size() && i < function.code.size(); i++)
+		{
+			if (lines.empty() || lines.back().line != function.lines[i])
+			{
+				ModuleFormat::Line line;
+
+				line.address = static_cast<uint32_t>(i);
+				line.line = function.lines[i];
+				lines.push_back(line);
+			}
+		}
+
+		header.lines = Append(lines.data(), lines.size());
+		header.parameterCount = function.parameterCount;
+		header.variableCount = function.variableCount;
+		header.temporaryCount = function.temporaryCount;
+		header.isClass = function.isClass ? 1 : 0;
+
+		Put(record, header);
+	}
+
+	void ModuleWriter::WriteFile(const string &name) const
+	{
+		using std::ios;
+		using std::ofstream;
+
+		ofstream output(name, ios::out | ios::binary | ios::trunc);
+
+		if (!output.is_open())
+		{
+			throw FatalErrorCode::CANNOT_OPEN_FILE;
+		}
+
+		output.write(mImage.data(), mImage.size());
+		if (!output)
+		{
+			throw FatalErrorCode::CANNOT_WRITE_FILE;
+		}
+
+		output.close();
+		if (output.fail())
+		{
+			throw FatalErrorCode::CANNOT_CLOSE_FILE;
+		}
+	}
+
+	uint32_t ModuleWriter::Intern(const u32string &string)
+	{
+		auto index = mIndices.emplace(string, static_cast<uint32_t>(mStrings.size()));
+
+		if (index.second)
+		{
+			mStrings.push_back(&index.first->first);
+		}
+
+		return index.first->second;
+	}
+
+	// Offset of size bytes of zeros at the end, aligned for any record.
+	size_t ModuleWriter::Reserve(const size_t size)
+	{
+		const size_t offset = (mImage.size() + ModuleFormat::ALIGNMENT - 1) / ModuleFormat::ALIGNMENT * ModuleFormat::ALIGNMENT;
+
+		mImage.resize(offset + size, 0);
+
+		return offset;
+	}
+}
\ No newline at end of file
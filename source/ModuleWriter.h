@@ -0,0 +1,63 @@
+#ifndef MODULE_WRITER
+#define MODULE_WRITER
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Module.h"
+#include "ModuleFormat.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::string;
+	using std::u32string;
+	using std::vector;
+	using std::unordered_map;
+
+	// Writes a module in ModuleFormat. The strings of the module keep their indices, and any other string a constant holds is added after them.
+	class ModuleWriter
+	{
+	public:
+		void Write(const Module &module, const string &name);
+		const vector<char> &Image(const Module &module);	// What Write writes, kept until the next module.
+
+	private:
+		void WriteFunction(const Function &function, const size_t record);
+		void WriteFile(const string &name) const;
+		uint32_t Intern(const u32string &string);
+
+		size_t Reserve(const size_t size);
+
+		template <typename T>
+		void Put(const size_t offset, const T &value)
+		{
+			std::memcpy(&mImage[offset], &value, sizeof(T));
+		}
+
+		template <typename T>
+		ModuleFormat::Section Append(const T * const elements, const size_t count)
+		{
+			ModuleFormat::Section section;
+
+			section.offset = static_cast<uint32_t>(Reserve(sizeof(T) * count));
+			section.count = static_cast<uint32_t>(count);
+
+			if (count != 0)
+			{
+				std::memcpy(&mImage[section.offset], elements, sizeof(T) * count);
+			}
+
+			return section;
+		}
+
+		vector<char> mImage;
+		vector<const u32string *> mStrings;
+		unordered_map<u32string, uint32_t> mIndices;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -38,6 +38,7 @@ namespace lyrics
 						WHEN,
 					WHILE, FOR, FOREACH,
 					BREAK, NEXT, RETURN,
+				ERROR,
 		};
 
 		explicit Node(const Location &location, const Type type) : location(location), type(type)
@@ -48,7 +49,7 @@ namespace lyrics
 		{
 		}
 
-		const Location location;
+		Location location;	// Moved by the Document that owns the node when an edit before it adds or removes lines.
 		const Type type;
 	};
 
@@ -100,6 +101,7 @@ namespace lyrics
 			class BreakNode;
 			class NextNode;
 			class ReturnNode;
+		class ErrorNode;
 
 	class StatementNode : public Node
 	{
@@ -304,7 +306,7 @@ namespace lyrics
 	class HashNode : public Node
 	{
 	public:
-		HashNode(const Location &location, const ExpressionNode * const key, const ExpressionNode * const value) : Node(location, Type::HASH), key(key), value(value)
+		HashNode(const Location &location, ExpressionNode * const key, ExpressionNode * const value) : Node(location, Type::HASH), key(key), value(value)
 		{
 		}
 
@@ -314,8 +316,8 @@ namespace lyrics
 			delete value;
 		}
 
-		const ExpressionNode * const key;
-		const ExpressionNode * const value;
+		ExpressionNode *key;
+		ExpressionNode *value;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -374,7 +376,7 @@ namespace lyrics
 		{
 		}
 
-		ValueParameterNode(const Location &location, const IdentifierNode * const name, const ExpressionNode * const defalutArgument) : ParameterNode(location, Type::VALUE_PARAMETER, name), defalutArgument(defalutArgument)
+		ValueParameterNode(const Location &location, const IdentifierNode * const name, ExpressionNode * const defalutArgument) : ParameterNode(location, Type::VALUE_PARAMETER, name), defalutArgument(defalutArgument)
 		{
 		}
 
@@ -383,7 +385,7 @@ namespace lyrics
 			delete defalutArgument;
 		}
 
-		const ExpressionNode * const defalutArgument;
+		ExpressionNode *defalutArgument;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -458,7 +460,7 @@ namespace lyrics
 	class PostfixExpressionNode : public ExpressionNode
 	{
 	public:
-		PostfixExpressionNode(const Location &location, const Type type, const ExpressionNode * const expression) : ExpressionNode(location, type), expression(expression)
+		PostfixExpressionNode(const Location &location, const Type type, ExpressionNode * const expression) : ExpressionNode(location, type), expression(expression)
 		{
 		}
 
@@ -467,13 +469,13 @@ namespace lyrics
 			delete expression;
 		}
 
-		const ExpressionNode * const expression;
+		ExpressionNode *expression;
 	};
 
 	class IndexReferenceNode : public PostfixExpressionNode
 	{
 	public:
-		IndexReferenceNode(const Location &location, const ExpressionNode * const expression, const ExpressionNode * const index) : PostfixExpressionNode(location, Type::INDEX_REFERENCE, expression), index(index)
+		IndexReferenceNode(const Location &location, ExpressionNode * const expression, ExpressionNode * const index) : PostfixExpressionNode(location, Type::INDEX_REFERENCE, expression), index(index)
 		{
 		}
 
@@ -482,7 +484,7 @@ namespace lyrics
 			delete index;
 		}
 
-		const ExpressionNode * const index;
+		ExpressionNode *index;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -493,7 +495,7 @@ namespace lyrics
 	class FunctionCallNode : public PostfixExpressionNode
 	{
 	public:
-		FunctionCallNode(const Location &location, const ExpressionNode * const expression) : PostfixExpressionNode(location, Type::FUNCTION_CALL, expression), last(list.cbefore_begin())
+		FunctionCallNode(const Location &location, ExpressionNode * const expression) : PostfixExpressionNode(location, Type::FUNCTION_CALL, expression), last(list.cbefore_begin())
 		{
 		}
 
@@ -522,7 +524,7 @@ namespace lyrics
 	class MemberReferenceNode : public PostfixExpressionNode
 	{
 	public:
-		MemberReferenceNode(const Location &location, const ExpressionNode * const expression, const IdentifierNode * const member) : PostfixExpressionNode(location, Type::MEMBER_REFERENCE, expression), member(member)
+		MemberReferenceNode(const Location &location, ExpressionNode * const expression, const IdentifierNode * const member) : PostfixExpressionNode(location, Type::MEMBER_REFERENCE, expression), member(member)
 		{
 		}
 
@@ -542,7 +544,7 @@ namespace lyrics
 	class UnaryExpressionNode : public ExpressionNode
 	{
 	public:
-		UnaryExpressionNode(const Location &location, const Token::Type op, const ExpressionNode * const expression) : ExpressionNode(location, Type::UNARY_EXPRESSION), op(op), expression(expression)
+		UnaryExpressionNode(const Location &location, const Token::Type op, ExpressionNode * const expression) : ExpressionNode(location, Type::UNARY_EXPRESSION), op(op), expression(expression)
 		{
 		}
 
@@ -552,7 +554,7 @@ namespace lyrics
 		}
 
 		const Token::Type op;
-		const ExpressionNode * const expression;
+		ExpressionNode *expression;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -563,7 +565,7 @@ namespace lyrics
 	class MultiplicativeExpressionNode : public ExpressionNode
 	{
 	public:
-		MultiplicativeExpressionNode(const Location &location, const Token::Type op, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::MULTIPLICATIVE_EXPRESSION), op(op), left(left), right(right)
+		MultiplicativeExpressionNode(const Location &location, const Token::Type op, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::MULTIPLICATIVE_EXPRESSION), op(op), left(left), right(right)
 		{
 		}
 
@@ -574,8 +576,8 @@ namespace lyrics
 		}
 
 		const Token::Type op;
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -586,7 +588,7 @@ namespace lyrics
 	class AdditiveExpressionNode : public ExpressionNode
 	{
 	public:
-		AdditiveExpressionNode(const Location &location, const Token::Type op, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::ADDITIVE_EXPRESSION), op(op), left(left), right(right)
+		AdditiveExpressionNode(const Location &location, const Token::Type op, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::ADDITIVE_EXPRESSION), op(op), left(left), right(right)
 		{
 		}
 
@@ -597,8 +599,8 @@ namespace lyrics
 		}
 
 		const Token::Type op;
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -609,7 +611,7 @@ namespace lyrics
 	class ShiftExpressionNode : public ExpressionNode
 	{
 	public:
-		ShiftExpressionNode(const Location &location, const Token::Type op, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::SHIFT_EXPRESSION), op(op), left(left), right(right)
+		ShiftExpressionNode(const Location &location, const Token::Type op, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::SHIFT_EXPRESSION), op(op), left(left), right(right)
 		{
 		}
 
@@ -620,8 +622,8 @@ namespace lyrics
 		}
 
 		const Token::Type op;
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -632,7 +634,7 @@ namespace lyrics
 	class AndExpressionNode : public ExpressionNode
 	{
 	public:
-		AndExpressionNode(const Location &location, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::AND_EXPRESSION), left(left), right(right)
+		AndExpressionNode(const Location &location, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::AND_EXPRESSION), left(left), right(right)
 		{
 		}
 
@@ -642,8 +644,8 @@ namespace lyrics
 			delete right;
 		}
 
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -654,7 +656,7 @@ namespace lyrics
 	class OrExpressionNode : public ExpressionNode
 	{
 	public:
-		OrExpressionNode(const Location &location, const Token::Type op, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::OR_EXPRESSION), op(op), left(left), right(right)
+		OrExpressionNode(const Location &location, const Token::Type op, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::OR_EXPRESSION), op(op), left(left), right(right)
 		{
 		}
 
@@ -665,8 +667,8 @@ namespace lyrics
 		}
 
 		const Token::Type op;
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -677,7 +679,7 @@ namespace lyrics
 	class RelationalExpressionNode : public ExpressionNode
 	{
 	public:
-		RelationalExpressionNode(const Location &location, const Token::Type op, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::RELATIONAL_EXPRESSION), op(op), left(left), right(right)
+		RelationalExpressionNode(const Location &location, const Token::Type op, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::RELATIONAL_EXPRESSION), op(op), left(left), right(right)
 		{
 		}
 
@@ -688,8 +690,8 @@ namespace lyrics
 		}
 
 		const Token::Type op;
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -700,7 +702,7 @@ namespace lyrics
 	class EqualityExpressionNode : public ExpressionNode
 	{
 	public:
-		EqualityExpressionNode(const Location &location, const Token::Type op, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::EQUALITY_EXPRESSION), op(op), left(left), right(right)
+		EqualityExpressionNode(const Location &location, const Token::Type op, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::EQUALITY_EXPRESSION), op(op), left(left), right(right)
 		{
 		}
 
@@ -711,8 +713,8 @@ namespace lyrics
 		}
 
 		const Token::Type op;
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -723,7 +725,7 @@ namespace lyrics
 	class LogicalAndExpressionNode : public ExpressionNode
 	{
 	public:
-		LogicalAndExpressionNode(const Location &location, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::LOGICAL_AND_EXPRESSION), left(left), right(right)
+		LogicalAndExpressionNode(const Location &location, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::LOGICAL_AND_EXPRESSION), left(left), right(right)
 		{
 		}
 
@@ -733,8 +735,8 @@ namespace lyrics
 			delete right;
 		}
 
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -745,7 +747,7 @@ namespace lyrics
 	class LogicalOrExpressionNode : public ExpressionNode
 	{
 	public:
-		LogicalOrExpressionNode(const Location &location, const ExpressionNode * const left, const ExpressionNode * const right) : ExpressionNode(location, Type::LOGICAL_OR_EXPRESSION), left(left), right(right)
+		LogicalOrExpressionNode(const Location &location, ExpressionNode * const left, ExpressionNode * const right) : ExpressionNode(location, Type::LOGICAL_OR_EXPRESSION), left(left), right(right)
 		{
 		}
 
@@ -755,8 +757,8 @@ namespace lyrics
 			delete right;
 		}
 
-		const ExpressionNode * const left;
-		const ExpressionNode * const right;
+		ExpressionNode *left;
+		ExpressionNode *right;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -767,7 +769,7 @@ namespace lyrics
 	class AssignmentExpressionNode : public ExpressionNode
 	{
 	public:
-		AssignmentExpressionNode(const Location &location, const ExpressionNode * const lhs, const ExpressionNode * const rhs) : ExpressionNode(location, Type::ASSIGNMENT_EXPRESSION), lhs(lhs), rhs(rhs)
+		AssignmentExpressionNode(const Location &location, ExpressionNode * const lhs, ExpressionNode * const rhs) : ExpressionNode(location, Type::ASSIGNMENT_EXPRESSION), lhs(lhs), rhs(rhs)
 		{
 		}
 
@@ -777,8 +779,8 @@ namespace lyrics
 			delete rhs;
 		}
 
-		const ExpressionNode * const lhs;
-		const ExpressionNode * const rhs;
+		ExpressionNode *lhs;
+		ExpressionNode *rhs;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -884,7 +886,7 @@ namespace lyrics
 	class PackageNode : public PrimaryExpressionNode
 	{
 	public:
-		PackageNode(const Location &location, const BlockNode * const block) : PrimaryExpressionNode(location, Type::PACKAGE), block(block)
+		PackageNode(const Location &location, BlockNode * const block) : PrimaryExpressionNode(location, Type::PACKAGE), block(block)
 		{
 		}
 
@@ -893,7 +895,7 @@ namespace lyrics
 			delete block;
 		}
 
-		const BlockNode * const block;
+		BlockNode *block;
 
 		virtual bool Accept(Visitor &visitor) const
 		{
@@ -1179,7 +1181,7 @@ namespace lyrics
 		{
 		}
 
-		ReturnNode(const Location &location, const ExpressionNode * const value) : JumpNode(location, Type::RETURN), value(value)
+		ReturnNode(const Location &location, ExpressionNode * const value) : JumpNode(location, Type::RETURN), value(value)
 		{
 		}
 
@@ -1188,7 +1190,28 @@ namespace lyrics
 			delete value;
 		}
 
-		const ExpressionNode * const value;
+		ExpressionNode *value;
+
+		virtual bool Accept(Visitor &visitor) const
+		{
+			return visitor.Visit(this);
+		}
+	};
+
+	// In place of a statement that failed to parse, and of the tokens skipped after it. A visitor fails on it, but still declares the name the statement assigned to, so that the uses after it are not errors too.
+	class ErrorNode : public StatementNode
+	{
+	public:
+		ErrorNode(const Location &location, IdentifierNode * const name) : StatementNode(location, Type::ERROR), name(name)
+		{
+		}
+
+		~ErrorNode()
+		{
+			delete name;
+		}
+
+		IdentifierNode *name;	// Or nullptr.
 
 		virtual bool Accept(Visitor &visitor) const
 		{
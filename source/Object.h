@@ -0,0 +1,49 @@
+#ifndef STRUCT_OBJECT
+#define STRUCT_OBJECT
+
+#include <string>
+#include <vector>
+
+#include "Literal.h"
+#include "Shape.h"
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::vector;
+
+	struct Object
+	{
+		explicit Object(Shape * const shape) : shape(shape), slots(shape->SlotCount())
+		{
+		}
+
+		Literal *Member(const u32string &member)
+		{
+			const unsigned int slot = shape->Lookup(member);
+
+			return slot != Shape::NOT_FOUND ? &slots[slot] : nullptr;
+		}
+
+		// The slot the member already has, if any, as a shape never has the same member twice.
+		Literal &AddMember(const u32string &member)
+		{
+			const unsigned int slot = shape->Lookup(member);
+
+			if (slot != Shape::NOT_FOUND)
+			{
+				return slots[slot];
+			}
+
+			shape = shape->AddMember(member);
+			slots.emplace_back();
+
+			return slots.back();
+		}
+
+		Shape *shape;
+		vector<Literal> slots;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "Option.h"
 
+#include <cstdlib>
+#include <cstring>
+
 namespace lyrics
 {
-	Option::Option(const int argc, const char * const argv[])
+	Option::Option(const int argc, const char * const argv[]) : mThreadCount(0), mIsLanguageServer(false), mErrorLimit(0), mIsJsonLog(false)
 	{
 		for (int i = 1; i < argc; i++)
 		{
@@ -11,12 +14,61 @@ namespace lyrics
 				if (argv[i][1] == 's' && argv[i][2] == '\0')
 				{
 					mSourceCodeFileName = argv[++i];
+					mSourceCodeFileNames.push_back(mSourceCodeFileName);
+				}
+				else if (argv[i][1] == 'o' && argv[i][2] == '\0' && i + 1 < argc)
+				{
+					mModuleFileName = argv[++i];
+				}
+				else if (argv[i][1] == 'c' && argv[i][2] == '\0' && i + 1 < argc)
+				{
+					mCacheDirectoryName = argv[++i];
+				}
+				else if (argv[i][1] == 'I' && argv[i][2] == '\0' && i + 1 < argc)
+				{
+					mImportDirectoryNames.push_back(argv[++i]);
+				}
+				else if (argv[i][1] == 'j' && argv[i][2] == '\0' && i + 1 < argc)
+				{
+					mThreadCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+				}
+				else if (argv[i][1] == 'S' && argv[i][2] == '\0' && i + 1 < argc)
+				{
+					mServerSocketName = argv[++i];
+				}
+				else if (argv[i][1] == 'C' && argv[i][2] == '\0' && i + 1 < argc)
+				{
+					mRemoteSocketName = argv[++i];
+				}
+				else if (argv[i][1] == 'L' && argv[i][2] == '\0')
+				{
+					mIsLanguageServer = true;
+				}
+				else if (argv[i][1] == 'e' && argv[i][2] == '\0' && i + 1 < argc)
+				{
+					mErrorLimit = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+				}
+				else if (argv[i][1] == 'f' && argv[i][2] == '\0' && i + 1 < argc)
+				{
+					mIsJsonLog = std::strcmp(argv[++i], "json") == 0;
 				}
 			}
 			else
 			{
 				mSourceCodeFileName = argv[i];
+				mSourceCodeFileNames.push_back(mSourceCodeFileName);
 			}
 		}
 	}
+
+	Option Option::ForSource(const string &sourceCodeFileName, const string &moduleFileName) const
+	{
+		Option option = *this;
+
+		option.mSourceCodeFileName = sourceCodeFileName;
+		option.mSourceCodeFileNames.assign(1, sourceCodeFileName);
+		option.mModuleFileName = moduleFileName;
+
+		return option;
+	}
 }
\ No newline at end of file
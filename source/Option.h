@@ -2,10 +2,12 @@
 #define OPTION
 
 #include <string>
+#include <vector>
 
 namespace lyrics
 {
 	using std::string;
+	using std::vector;
 
 	class Option
 	{
@@ -17,8 +19,70 @@ namespace lyrics
 			return mSourceCodeFileName;
 		}
 
+		const vector<string> &SourceCodeFileNames() const	// Every one given, in order. A directory or a response file, @name, stands for the files in it.
+		{
+			return mSourceCodeFileNames;
+		}
+
+		const string ModuleFileName() const
+		{
+			return mModuleFileName;
+		}
+
+		const string CacheDirectoryName() const
+		{
+			return mCacheDirectoryName;
+		}
+
+		const vector<string> &ImportDirectoryNames() const	// Searched for an imported script after the directory of the script importing it.
+		{
+			return mImportDirectoryNames;
+		}
+
+		unsigned int ThreadCount() const	// 0 for one per core.
+		{
+			return mThreadCount;
+		}
+
+		const string ServerSocketName() const	// Listened on by a compile server, which compiles nothing else.
+		{
+			return mServerSocketName;
+		}
+
+		const string RemoteSocketName() const	// Of a compile server to send the other options to.
+		{
+			return mRemoteSocketName;
+		}
+
+		bool IsLanguageServer() const	// Serving an editor on the standard input and output, which compiles nothing else.
+		{
+			return mIsLanguageServer;
+		}
+
+		unsigned int ErrorLimit() const	// Of the errors logged for a script before it stops, 0 for none.
+		{
+			return mErrorLimit;
+		}
+
+		bool IsJsonLog() const	// Logging a JSON object a line instead of text, as -f json asks.
+		{
+			return mIsJsonLog;
+		}
+
+		Option ForSource(const string &sourceCodeFileName, const string &moduleFileName) const;	// For one file of a batch.
+
 	private:
 		string mSourceCodeFileName;
+		vector<string> mSourceCodeFileNames;
+		string mModuleFileName;	// Where the compiled module is written, none if empty. The directory of the modules in a batch.
+		string mCacheDirectoryName;	// Of CompilationCache, not used if empty.
+		vector<string> mImportDirectoryNames;
+		unsigned int mThreadCount;
+		string mServerSocketName;
+		string mRemoteSocketName;
+		bool mIsLanguageServer;
+		unsigned int mErrorLimit;
+		bool mIsJsonLog;
 	};
 }
 
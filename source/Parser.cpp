@@ -4,6 +4,7 @@
 
 #include "ErrorCode.h"
 #include "ErrorLogger.h"
+#include "Logger.h"
 
 #include "Utility.h"
 
@@ -35,15 +36,265 @@ namespace lyrics
 		return root;
 	}
 
+	BlockNode *Parser::Parse(const forward_list<Token> *tokenList, Spans &spans)
+	{
+		mIsCopied = true;
+		mSpans = &spans;
+
+		BlockNode * const root = Parse(tokenList);
+
+		mIsCopied = false;
+		mSpans = nullptr;
+
+		return root;
+	}
+
+	forward_list<Token>::const_iterator Parser::Parse(forward_list<Token>::const_iterator token, const forward_list<Token>::const_iterator end, forward_list<StatementNode *> &statements, Span &span, Spans &spans)
+	{
+		using std::bad_alloc;
+
+		auto last = statements.cbefore_begin();
+
+		mToken = token;
+		mIsCopied = true;
+		mSpans = &spans;
+
+		try
+		{
+			while (mToken != end && !IsEndOfBlock(mToken->type))
+			{
+				last = statements.insert_after(last, Statement(&span));
+			}
+		}
+		catch (const bad_alloc &e)
+		{
+			for (auto i : statements)
+			{
+				Utility::SafeDelete(i);
+			}
+
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+
+		mIsCopied = false;
+		mSpans = nullptr;
+		span.end = mToken;
+
+		return mToken;
+	}
+
+	bool Parser::IsEndOfBlock(const Token::Type type)
+	{
+		return type == Token::Type::END || type == Token::Type::ELSE || type == Token::Type::ELSEIF || type == Token::Type::PRIVATE || type == Token::Type::PUBLIC || type == Token::Type::WHEN || type == Token::Type::END_OF_FILE;
+	}
+
+	bool Parser::IsStartOfStatement(const Token::Type type)
+	{
+		return type == Token::Type::IF || type == Token::Type::CASE || type == Token::Type::WHILE || type == Token::Type::FOR || type == Token::Type::FOREACH || type == Token::Type::BREAK || type == Token::Type::NEXT || type == Token::Type::RETURN || type == Token::Type::IMPORT || type == Token::Type::INCLUDE || type == Token::Type::CLASS || type == Token::Type::PACKAGE;
+	}
+
+	// How many blocks the token opens, or closes if negative. The do of a loop is on the line the loop starts on, and opens no block of its own as that of a function literal does.
+	int Parser::Nesting(const Token &token, unsigned int &loopLine)
+	{
+		switch (token.type)
+		{
+		case Token::Type::IF:
+		case Token::Type::CASE:
+		case Token::Type::CLASS:
+		case Token::Type::PACKAGE:
+			return 1;
+
+		case Token::Type::WHILE:
+		case Token::Type::FOR:
+		case Token::Type::FOREACH:
+			loopLine = token.location.Line();
+			return 1;
+
+		case Token::Type::DO:
+			if (token.location.Line() == loopLine)
+			{
+				loopLine = 0;
+				return 0;
+			}
+
+			return 1;
+
+		case Token::Type::END:
+			return -1;
+
+		default:
+			return 0;
+		}
+	}
+
+	void Parser::Error(const Location &location, const ErrorCode errorCode)
+	{
+		if (!mIsRecovering)
+		{
+			ErrorLogger::Error(location, errorCode);
+
+			mIsRecovering = true;
+		}
+	}
+
+	// Skips what is left of the statement that starts at the token, at least the token.
+	// Past the ends of the blocks it opened and did not end, or else to the end of its line, a statement or the end of its block.
+	void Parser::Synchronize(forward_list<Token>::const_iterator token)
+	{
+		int depth = 0;
+		unsigned int loopLine = 0;
+
+		if (mToken == token)
+		{
+			Skip();
+		}
+
+		auto previous = token;
+
+		for (; token != mToken; previous = token++)
+		{
+			depth += Nesting(*token, loopLine);
+		}
+
+		while (mToken->type != Token::Type::END_OF_FILE && (depth > 0 || (mToken->location.Line() == previous->location.Line() && !IsEndOfBlock(mToken->type) && !IsStartOfStatement(mToken->type))))
+		{
+			depth += Nesting(*mToken, loopLine);
+			previous = mToken;
+			Skip();
+		}
+	}
+
+	// No node takes the name or the string of a token skipped, which is deleted unless the token outlives the parse.
+	void Parser::Skip()
+	{
+		if (!mIsCopied)
+		{
+			if (mToken->type == Token::Type::IDENTIFIER)
+			{
+				delete mToken->value.identifier;
+			}
+			else if (mToken->type == Token::Type::STRING_LITERAL)
+			{
+				delete mToken->value.string;
+			}
+		}
+
+		mToken++;
+	}
+
+	// The node owns the name, which the token keeps too if it outlives the parse.
+	u32string *Parser::Identifier(u32string * const identifier) const
+	{
+		return mIsCopied ? new u32string(*identifier) : identifier;
+	}
+
 	BlockNode *Parser::Block()
 	{
+		using std::bad_alloc;
+
 		BlockNode *node = new BlockNode(mToken->location);
+		Span *span = nullptr;
+
+		try
+		{
+			if (mSpans)
+			{
+				span = &(*mSpans)[node];
+				span->statements.clear();	// Of a block deleted on an error, at the same address.
+				span->diagnostics.clear();
+			}
+
+			while (!IsEndOfBlock(mToken->type))
+			{
+				node->AddStatement(Statement(span));
+			}
+		}
+		catch (const bad_alloc &e)
+		{
+			Utility::SafeDelete(node);
+			throw;
+		}
+
+		if (span)
+		{
+			span->end = mToken;
+		}
+
+		return node;
+	}
+
+	// Recording where it starts and what it logs if its block is spanned. The blocks in it take theirs first.
+	StatementNode *Parser::Statement(Span * const span)
+	{
+		if (!span)
+		{
+			return RecoverableStatement();
+		}
+
+		using std::size_t;
+
+		vector<Diagnostic> * const captured = Logger::Captured();
+		const size_t count = captured ? captured->size() : 0;
+
+		span->statements.push_back(mToken);
+
+		StatementNode * const node = RecoverableStatement();
+
+		span->diagnostics.emplace_back();
+
+		if (captured)
+		{
+			span->diagnostics.back().assign(captured->begin() + count, captured->end());
+			captured->erase(captured->begin() + count, captured->end());
+		}
+
+		return node;
+	}
+
+	// After the first error in it, which is the only one logged, an error node in place of what is skipped to recover.
+	// The error node keeps the variable an assignment was to, whose uses are then not errors as well.
+	StatementNode *Parser::RecoverableStatement()
+	{
+		using std::bad_alloc;
+
+		const bool isRecovering = mIsRecovering;
+		const forward_list<Token>::const_iterator token = mToken;
 
-		while (mToken->type != Token::Type::END && mToken->type != Token::Type::ELSE && mToken->type != Token::Type::ELSEIF && mToken->type != Token::Type::PRIVATE && mToken->type != Token::Type::PUBLIC && mToken->type != Token::Type::WHEN && mToken->type != Token::Type::END_OF_FILE)
+		mIsRecovering = false;
+
+		StatementNode *node = Statement();
+
+		if (!node || mIsRecovering)
 		{
-			node->AddStatement(Statement());
+			IdentifierNode *name = nullptr;
+
+			if (node && node->type == Node::Type::ASSIGNMENT_EXPRESSION)
+			{
+				AssignmentExpressionNode * const assignment = static_cast<AssignmentExpressionNode *>(node);
+
+				if (assignment->lhs && assignment->lhs->type == Node::Type::IDENTIFIER)
+				{
+					name = static_cast<IdentifierNode *>(assignment->lhs);
+					assignment->lhs = nullptr;
+				}
+			}
+
+			Utility::SafeDelete(node);
+			Synchronize(token);
+
+			try
+			{
+				node = new ErrorNode(token->location, name);
+			}
+			catch (const bad_alloc &e)
+			{
+				Utility::SafeDelete(name);
+				throw;
+			}
 		}
 
+		mIsRecovering = isRecovering;
+
 		return node;
 	}
 
@@ -85,25 +336,27 @@ namespace lyrics
 
 	ExpressionNode *Parser::PrimaryExpression()
 	{
+		const forward_list<Token>::const_iterator token = mToken;	// Whose location is taken, as the arguments may be evaluated in any order.
+
 		switch (mToken->type)
 		{
 		case Token::Type::IDENTIFIER:
-			return new IdentifierNode(mToken->location, mToken++->value.identifier);
+			return new IdentifierNode(token->location, Identifier(mToken++->value.identifier));
 
 		case Token::Type::INTEGER_LITERAL:
-			return new IntegerLiteralNode(mToken->location, mToken++->value.integer);
+			return new IntegerLiteralNode(token->location, mToken++->value.integer);
 
 		case Token::Type::STRING_LITERAL:
-			return new StringLiteralNode(mToken->location, mToken++->value.string);
+			return new StringLiteralNode(token->location, mToken++->value.string);
 
 		case Token::Type::BOOLEAN_LITERAL:
-			return new BooleanLiteralNode(mToken->location, mToken++->value.boolean);
+			return new BooleanLiteralNode(token->location, mToken++->value.boolean);
 
 		case Token::Type::NULL_LITERAL:
 			return new NullLiteralNode(mToken++->location);
 
 		case Token::Type::REAL_LITERAL:
-			return new RealLiteralNode(mToken->location, mToken++->value.real);
+			return new RealLiteralNode(token->location, mToken++->value.real);
 
 		case Token::Type::DO:
 			return FunctionLiteral(mToken++);
@@ -118,13 +371,10 @@ namespace lyrics
 			return HashLiteral();
 
 		case Token::Type::THIS:
-			return new ThisNode(mToken->location);
+			return new ThisNode(mToken++->location);
 
 		default:
-			ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_PRIMARY_EXPRESSION);
-
-			mToken++;
-
+			Error(mToken->location, ErrorCode::EXPECTED_PRIMARY_EXPRESSION);
 			return nullptr;
 		}
 	}
@@ -136,7 +386,7 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_ARRAY_LITERAL);
+			Error(mToken->location, ErrorCode::INCOMPLETE_ARRAY_LITERAL);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -152,7 +402,7 @@ namespace lyrics
 					mToken++;
 					if (mToken->type == Token::Type::END_OF_FILE)
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_ARRAY_LITERAL);
+						Error(mToken->location, ErrorCode::INCOMPLETE_ARRAY_LITERAL);
 						Utility::SafeDelete(node);
 						return nullptr;
 					}
@@ -167,7 +417,7 @@ namespace lyrics
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_ARRAY_LITERAL);
+					Error(mToken->location, ErrorCode::INCOMPLETE_ARRAY_LITERAL);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
@@ -186,7 +436,7 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_HASH_LITERAL);
+			Error(mToken->location, ErrorCode::INCOMPLETE_HASH_LITERAL);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -203,7 +453,7 @@ namespace lyrics
 
 				if (mToken->type != static_cast<Token::Type>(U':'))
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_HASH);
+					Error(mToken->location, ErrorCode::EXPECTED_HASH);
 					Utility::SafeDelete(expression);
 					Utility::SafeDelete(node);
 					return nullptr;
@@ -212,7 +462,7 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_HASH_LITERAL);
+					Error(mToken->location, ErrorCode::INCOMPLETE_HASH_LITERAL);
 					Utility::SafeDelete(expression);
 					Utility::SafeDelete(node);
 					return nullptr;
@@ -225,7 +475,7 @@ namespace lyrics
 					mToken++;
 					if (mToken->type == Token::Type::END_OF_FILE)
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_HASH_LITERAL);
+						Error(mToken->location, ErrorCode::INCOMPLETE_HASH_LITERAL);
 						Utility::SafeDelete(node);
 						return nullptr;
 					}
@@ -240,7 +490,7 @@ namespace lyrics
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_HASH_LITERAL);
+					Error(mToken->location, ErrorCode::INCOMPLETE_HASH_LITERAL);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
@@ -259,7 +509,7 @@ namespace lyrics
 			mToken++;
 			if (mToken->type == Token::Type::END_OF_FILE)
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
+				Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
 				return nullptr;
 			}
 
@@ -284,7 +534,7 @@ namespace lyrics
 						mToken++;
 						if (mToken->type == Token::Type::END_OF_FILE)
 						{
-							ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
+							Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
 							Utility::SafeDelete(node);
 							return nullptr;
 						}
@@ -294,12 +544,12 @@ namespace lyrics
 
 					if (mToken->type == Token::Type::IDENTIFIER)
 					{
-						name = new IdentifierNode(mToken->location, mToken->value.identifier);
+						name = new IdentifierNode(mToken->location, Identifier(mToken->value.identifier));
 
 						mToken++;
 						if (mToken->type == Token::Type::END_OF_FILE)
 						{
-							ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
+							Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
 							Utility::SafeDelete(name);
 							Utility::SafeDelete(node);
 							return nullptr;
@@ -307,7 +557,7 @@ namespace lyrics
 					}
 					else
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_PARAMETER_NAME);
+						Error(mToken->location, ErrorCode::EXPECTED_PARAMETER_NAME);
 						Utility::SafeDelete(node);
 						return nullptr;
 					}
@@ -328,7 +578,7 @@ namespace lyrics
 						mToken++;
 						if (mToken->type == Token::Type::END_OF_FILE)
 						{
-							ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
+							Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
 							Utility::SafeDelete(name);
 							Utility::SafeDelete(node);
 							return nullptr;
@@ -340,7 +590,7 @@ namespace lyrics
 						}
 						else
 						{
-							ErrorLogger::Error(mToken->location, ErrorCode::OUTPUT_PARAMETER_DEFAULT_ARGUMENT);
+							Error(mToken->location, ErrorCode::OUTPUT_PARAMETER_DEFAULT_ARGUMENT);
 							Utility::SafeDelete(name);
 							Utility::SafeDelete(node);
 							return nullptr;
@@ -354,7 +604,7 @@ namespace lyrics
 						mToken++;
 						if (mToken->type == Token::Type::END_OF_FILE)
 						{
-							ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
+							Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
 							Utility::SafeDelete(node);
 							return nullptr;
 						}
@@ -365,7 +615,7 @@ namespace lyrics
 					}
 					else
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
+						Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
 						Utility::SafeDelete(node);
 						return nullptr;
 					}
@@ -375,7 +625,7 @@ namespace lyrics
 			mToken++;
 			if (mToken->type == Token::Type::END_OF_FILE)
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
+				Error(mToken->location, ErrorCode::INCOMPLETE_FUNCTION);
 				Utility::SafeDelete(node);
 				return nullptr;
 			}
@@ -390,14 +640,14 @@ namespace lyrics
 			}
 			else
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END);
+				Error(mToken->location, ErrorCode::EXPECTED_END);
 				Utility::SafeDelete(node);
 				return nullptr;
 			}
 		}
 		else
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_PARAMETER);
+			Error(mToken->location, ErrorCode::EXPECTED_PARAMETER);
 			return nullptr;
 		}
 	}
@@ -409,7 +659,7 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
+			Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -424,7 +674,7 @@ namespace lyrics
 		}
 		else
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_RIGHT_PARENTHESIS);
+			Error(mToken->location, ErrorCode::EXPECTED_RIGHT_PARENTHESIS);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -447,7 +697,7 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_INDEX);
+					Error(mToken->location, ErrorCode::EXPECTED_INDEX);
 					Utility::SafeDelete(expression);
 					return nullptr;
 				}
@@ -459,14 +709,14 @@ namespace lyrics
 					mToken++;
 					if (mToken->type == Token::Type::END_OF_FILE)
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_INDEX);
+						Error(mToken->location, ErrorCode::EXPECTED_INDEX);
 						Utility::SafeDelete(expression);
 						return nullptr;
 					}
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_INDEX);
+					Error(mToken->location, ErrorCode::EXPECTED_INDEX);
 					Utility::SafeDelete(expression);
 					return nullptr;
 				}
@@ -476,7 +726,7 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_FUNCTION_CALL);
+					Error(mToken->location, ErrorCode::EXPECTED_FUNCTION_CALL);
 					Utility::SafeDelete(expression);
 					return nullptr;
 				}
@@ -494,7 +744,7 @@ namespace lyrics
 							mToken++;
 							if (mToken->type == Token::Type::END_OF_FILE)
 							{
-								ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_FUNCTION_CALL);
+								Error(mToken->location, ErrorCode::EXPECTED_FUNCTION_CALL);
 								Utility::SafeDelete(node);
 								return nullptr;
 							}
@@ -505,7 +755,7 @@ namespace lyrics
 						}
 						else
 						{
-							ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_FUNCTION_CALL);
+							Error(mToken->location, ErrorCode::EXPECTED_FUNCTION_CALL);
 							Utility::SafeDelete(node);
 							return nullptr;
 						}
@@ -521,26 +771,26 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_MEMBER);
+					Error(mToken->location, ErrorCode::EXPECTED_MEMBER);
 					Utility::SafeDelete(expression);
 					return nullptr;
 				}
 
 				if (mToken->type == Token::Type::IDENTIFIER)
 				{
-					expression = new MemberReferenceNode(tLocation, expression, new IdentifierNode(mToken->location, mToken->value.identifier));
+					expression = new MemberReferenceNode(tLocation, expression, new IdentifierNode(mToken->location, Identifier(mToken->value.identifier)));
 
 					mToken++;
 					if (mToken->type == Token::Type::END_OF_FILE)
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_MEMBER);
+						Error(mToken->location, ErrorCode::EXPECTED_MEMBER);
 						Utility::SafeDelete(expression);
 						return nullptr;
 					}
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_MEMBER);
+					Error(mToken->location, ErrorCode::EXPECTED_MEMBER);
 					Utility::SafeDelete(expression);
 					return nullptr;
 				}
@@ -556,7 +806,7 @@ namespace lyrics
 	{
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
+			Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
 			return nullptr;
 		}
 		else if (mToken->type != static_cast<Token::Type>(U'+') && mToken->type != static_cast<Token::Type>(U'-') && mToken->type != static_cast<Token::Type>(U'~') && mToken->type != static_cast<Token::Type>(U'!'))
@@ -571,155 +821,108 @@ namespace lyrics
 		}
 	}
 
-	ExpressionNode *Parser::MultiplicativeExpression()
+	// How tightly the token binds the operands around it as a binary operator, if it is one.
+	Parser::Precedence Parser::PrecedenceOf(const Token::Type type)
 	{
-		Location tLocation = mToken->location;
-		ExpressionNode *expression = UnaryExpression();
-
-		while (mToken->type == static_cast<Token::Type>(U'*') || mToken->type == static_cast<Token::Type>(U'/') || mToken->type == static_cast<Token::Type>(U'%'))
+		switch (type)
 		{
-			auto tToken = mToken++;
+		case Token::Type::OR:
+			return Precedence::LOGICAL_OR;
 
-			expression = new MultiplicativeExpressionNode(tLocation, tToken->type, expression, UnaryExpression());
-		}
+		case Token::Type::AND:
+			return Precedence::LOGICAL_AND;
 
-		return expression;
-	}
+		case Token::Type::EQUAL:
+		case Token::Type::NOT_EQUAL:
+			return Precedence::EQUALITY;
 
-	ExpressionNode *Parser::AdditiveExpression()
-	{
-		Location tLocation = mToken->location;
-		ExpressionNode *expression = MultiplicativeExpression();
+		case static_cast<Token::Type>(U'<'):
+		case static_cast<Token::Type>(U'>'):
+		case Token::Type::LESS_THAN_OR_EQUAL:
+		case Token::Type::GREATER_THAN_OR_EQUAL:
+			return Precedence::RELATIONAL;
 
-		while (mToken->type == static_cast<Token::Type>(U'+') || mToken->type == static_cast<Token::Type>(U'-'))
-		{
-			auto tToken = mToken++;
+		case static_cast<Token::Type>(U'|'):
+		case static_cast<Token::Type>(U'^'):
+			return Precedence::OR;
 
-			expression = new AdditiveExpressionNode(tLocation, tToken->type, expression, MultiplicativeExpression());
-		}
+		case static_cast<Token::Type>(U'&'):
+			return Precedence::AND;
 
-		return expression;
-	}
+		case Token::Type::SHIFT_LEFT:
+		case Token::Type::SHIFT_RIGHT:
+			return Precedence::SHIFT;
 
-	ExpressionNode *Parser::ShiftExpression()
-	{
-		Location tLocation = mToken->location;
-		ExpressionNode *expression = AdditiveExpression();
+		case static_cast<Token::Type>(U'+'):
+		case static_cast<Token::Type>(U'-'):
+			return Precedence::ADDITIVE;
 
-		while (mToken->type == Token::Type::SHIFT_LEFT || mToken->type == Token::Type::SHIFT_RIGHT)
-		{
-			auto tToken = mToken++;
+		case static_cast<Token::Type>(U'*'):
+		case static_cast<Token::Type>(U'/'):
+		case static_cast<Token::Type>(U'%'):
+			return Precedence::MULTIPLICATIVE;
 
-			expression = new ShiftExpressionNode(tLocation, tToken->type, expression, AdditiveExpression());
+		default:
+			return Precedence::NONE;
 		}
-
-		return expression;
 	}
 
-	ExpressionNode *Parser::AndExpression()
+	// Of the operators that bind tighter than the precedence, taking those that bind as tightly as each other from the left.
+	// Each operand is parsed once, by a call for each precedence higher than that of the operator before it, not for every precedence there is.
+	ExpressionNode *Parser::BinaryExpression(const Precedence precedence)
 	{
 		Location tLocation = mToken->location;
-		ExpressionNode *expression = ShiftExpression();
+		ExpressionNode *expression = UnaryExpression();
 
-		while (mToken->type == static_cast<Token::Type>(U'&'))
+		for (Precedence tPrecedence = PrecedenceOf(mToken->type); expression != nullptr && tPrecedence > precedence; tPrecedence = PrecedenceOf(mToken->type))
 		{
-			mToken++;
+			auto tToken = mToken++;
+			ExpressionNode * const right = BinaryExpression(tPrecedence);
 
-			if (mToken->type == Token::Type::END_OF_FILE)
+			if (right == nullptr)
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
 				Utility::SafeDelete(expression);
 				return nullptr;
 			}
 
-			expression = new AndExpressionNode(tLocation, expression, ShiftExpression());
-		}
-
-		return expression;
-	}
-
-	ExpressionNode *Parser::OrExpression()
-	{
-		Location tLocation = mToken->location;
-		ExpressionNode *expression = AndExpression();
-
-		while (mToken->type == static_cast<Token::Type>(U'|') || mToken->type == static_cast<Token::Type>(U'^'))
-		{
-			auto tToken = mToken++;
-
-			expression = new OrExpressionNode(tLocation, tToken->type, expression, AndExpression());
-		}
-
-		return expression;
-	}
-
-	ExpressionNode *Parser::RelationalExpression()
-	{
-		Location tLocation = mToken->location;
-		ExpressionNode *expression = OrExpression();
-
-		while (mToken->type == static_cast<Token::Type>(U'<') || mToken->type == static_cast<Token::Type>(U'>') || mToken->type == Token::Type::LESS_THAN_OR_EQUAL || mToken->type == Token::Type::GREATER_THAN_OR_EQUAL)
-		{
-			auto tToken = mToken++;
-
-			expression = new RelationalExpressionNode(tLocation, tToken->type, expression, OrExpression());
-		}
-
-		return expression;
-	}
-
-	ExpressionNode *Parser::EqualityExpression()
-	{
-		Location tLocation = mToken->location;
-		ExpressionNode *expression = RelationalExpression();
-
-		while (mToken->type == Token::Type::EQUAL || mToken->type == Token::Type::NOT_EQUAL)
-		{
-			auto tToken = mToken++;
+			switch (tPrecedence)
+			{
+			case Precedence::LOGICAL_OR:
+				expression = new LogicalOrExpressionNode(tLocation, expression, right);
+				break;
 
-			expression = new EqualityExpressionNode(tLocation, tToken->type, expression, RelationalExpression());
-		}
+			case Precedence::LOGICAL_AND:
+				expression = new LogicalAndExpressionNode(tLocation, expression, right);
+				break;
 
-		return expression;
-	}
+			case Precedence::EQUALITY:
+				expression = new EqualityExpressionNode(tLocation, tToken->type, expression, right);
+				break;
 
-	ExpressionNode *Parser::LogicalAndExpression()
-	{
-		Location tLocation = mToken->location;
-		ExpressionNode *expression = EqualityExpression();
+			case Precedence::RELATIONAL:
+				expression = new RelationalExpressionNode(tLocation, tToken->type, expression, right);
+				break;
 
-		while (mToken->type == Token::Type::AND)
-		{
-			mToken++;
-			if (mToken->type == Token::Type::END_OF_FILE)
-			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
-				Utility::SafeDelete(expression);
-				return nullptr;
-			}
+			case Precedence::OR:
+				expression = new OrExpressionNode(tLocation, tToken->type, expression, right);
+				break;
 
-			expression = new LogicalAndExpressionNode(tLocation, expression, EqualityExpression());
-		}
+			case Precedence::AND:
+				expression = new AndExpressionNode(tLocation, expression, right);
+				break;
 
-		return expression;
-	}
+			case Precedence::SHIFT:
+				expression = new ShiftExpressionNode(tLocation, tToken->type, expression, right);
+				break;
 
-	ExpressionNode *Parser::LogicalOrExpression()
-	{
-		Location tLocation = mToken->location;
-		ExpressionNode *expression = LogicalAndExpression();
+			case Precedence::ADDITIVE:
+				expression = new AdditiveExpressionNode(tLocation, tToken->type, expression, right);
+				break;
 
-		while (mToken->type == Token::Type::OR)
-		{
-			mToken++;
-			if (mToken->type == Token::Type::END_OF_FILE)
-			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
-				Utility::SafeDelete(expression);
-				return nullptr;
+			default:
+				expression = new MultiplicativeExpressionNode(tLocation, tToken->type, expression, right);
+				break;
 			}
-
-			expression = new LogicalOrExpressionNode(tLocation, expression, LogicalAndExpression());
 		}
 
 		return expression;
@@ -738,11 +941,11 @@ namespace lyrics
 			return Package();
 
 		case Token::Type::END_OF_FILE:
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
+			Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
 			return nullptr;
 
 		default:
-			ExpressionNode *expression = LogicalOrExpression();
+			ExpressionNode *expression = BinaryExpression(Precedence::NONE);
 
 			if (expression == nullptr || mToken->type != static_cast<Token::Type>(U'='))
 			{
@@ -756,7 +959,7 @@ namespace lyrics
 
 					if (mToken->type == Token::Type::END_OF_FILE)
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
+						Error(mToken->location, ErrorCode::INCOMPLETE_EXPRESSION);
 						Utility::SafeDelete(expression);
 						return nullptr;
 					}
@@ -765,7 +968,7 @@ namespace lyrics
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_LHS);
+					Error(mToken->location, ErrorCode::EXPECTED_LHS);
 					Utility::SafeDelete(expression);
 					return nullptr;
 				}
@@ -780,7 +983,7 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::IDENTIFIER)
 		{
-			IdentifierNode *name = new IdentifierNode(mToken->location, mToken->value.identifier);
+			IdentifierNode *name = new IdentifierNode(mToken->location, Identifier(mToken->value.identifier));
 			ClassNode *node = new ClassNode(tLocation);
 
 			mToken++;
@@ -789,7 +992,7 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
+					Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
 					Utility::SafeDelete(node);
 					Utility::SafeDelete(name);
 					return nullptr;
@@ -806,7 +1009,7 @@ namespace lyrics
 							mToken++;
 							if (mToken->type == Token::Type::END_OF_FILE)
 							{
-								ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
+								Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
 								Utility::SafeDelete(node);
 								Utility::SafeDelete(name);
 								return nullptr;
@@ -818,7 +1021,7 @@ namespace lyrics
 						}
 						else
 						{
-							ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
+							Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
 							Utility::SafeDelete(node);
 							Utility::SafeDelete(name);
 							return nullptr;
@@ -828,7 +1031,7 @@ namespace lyrics
 			}
 			else
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
+				Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
 				Utility::SafeDelete(node);
 				Utility::SafeDelete(name);
 				return nullptr;
@@ -842,7 +1045,7 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::IDENTIFIER)
 				{
-					node->baseClassConstructorCall->baseClass = new IdentifierNode(mToken->location, mToken->value.identifier);
+					node->baseClassConstructorCall->baseClass = new IdentifierNode(mToken->location, Identifier(mToken->value.identifier));
 
 					mToken++;
 					if (mToken->type == static_cast<Token::Type>(U'('))
@@ -850,7 +1053,7 @@ namespace lyrics
 						mToken++;
 						if (mToken->type == Token::Type::END_OF_FILE)
 						{
-							ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
+							Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
 							Utility::SafeDelete(node);
 							Utility::SafeDelete(name);
 							return nullptr;
@@ -867,7 +1070,7 @@ namespace lyrics
 									mToken++;
 									if (mToken->type == Token::Type::END_OF_FILE)
 									{
-										ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
+										Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
 										Utility::SafeDelete(node);
 										Utility::SafeDelete(name);
 										return nullptr;
@@ -879,17 +1082,19 @@ namespace lyrics
 								}
 								else
 								{
-									ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
+									Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
 									Utility::SafeDelete(node);
 									Utility::SafeDelete(name);
 									return nullptr;
 								}
 							}
 						}
+
+						mToken++;
 					}
 					else
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
+						Error(mToken->location, ErrorCode::INCOMPLETE_CLASS_DEFINITION);
 						Utility::SafeDelete(node);
 						Utility::SafeDelete(name);
 						return nullptr;
@@ -897,14 +1102,13 @@ namespace lyrics
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_BASE_CLASS);
+					Error(mToken->location, ErrorCode::EXPECTED_BASE_CLASS);
 					Utility::SafeDelete(node);
 					Utility::SafeDelete(name);
 					return nullptr;
 				}
 			}
 
-			mToken++;
 			if (mToken->type == Token::Type::INCLUDE)
 			{
 				node->include = Include();
@@ -912,7 +1116,6 @@ namespace lyrics
 
 			node->block = Block();
 
-			mToken++;
 			if (mToken->type == Token::Type::END)
 			{
 				mToken++;
@@ -921,7 +1124,7 @@ namespace lyrics
 			}
 			else
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END);
+				Error(mToken->location, ErrorCode::EXPECTED_END);
 				Utility::SafeDelete(node);
 				Utility::SafeDelete(name);
 				return nullptr;
@@ -929,7 +1132,7 @@ namespace lyrics
 		}
 		else
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_CLASS_NAME);
+			Error(mToken->location, ErrorCode::EXPECTED_CLASS_NAME);
 			return nullptr;
 		}
 	}
@@ -943,11 +1146,12 @@ namespace lyrics
 			mToken++;
 			if (mToken->type == Token::Type::IDENTIFIER)
 			{
-				node->AddPackage(new IdentifierNode(mToken->location, mToken++->value.identifier));
+				node->AddPackage(new IdentifierNode(mToken->location, Identifier(mToken->value.identifier)));
+				mToken++;
 			}
 			else
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_PACKAGE);
+				Error(mToken->location, ErrorCode::EXPECTED_PACKAGE);
 				Utility::SafeDelete(node);
 				return nullptr;
 			}
@@ -963,10 +1167,12 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::IDENTIFIER)
 		{
-			IdentifierNode *name = new IdentifierNode(mToken->location, mToken->value.identifier);
-			PackageNode *node = new PackageNode(tLocation, Block());
+			IdentifierNode *name = new IdentifierNode(mToken->location, Identifier(mToken->value.identifier));
 
 			mToken++;
+
+			PackageNode *node = new PackageNode(tLocation, Block());
+
 			if (mToken->type == Token::Type::END)
 			{
 				mToken++;
@@ -975,7 +1181,7 @@ namespace lyrics
 			}
 			else
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END);
+				Error(mToken->location, ErrorCode::EXPECTED_END);
 				Utility::SafeDelete(node);
 				Utility::SafeDelete(name);
 				return nullptr;
@@ -983,7 +1189,7 @@ namespace lyrics
 		}
 		else
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_PACKAGE_NAME);
+			Error(mToken->location, ErrorCode::EXPECTED_PACKAGE_NAME);
 			return nullptr;
 		}
 	}
@@ -1002,11 +1208,12 @@ namespace lyrics
 			mToken++;
 			if (mToken->type == Token::Type::IDENTIFIER)
 			{
-				node->AddIdentifier(new IdentifierNode(mToken->location, mToken++->value.identifier));
+				node->AddIdentifier(new IdentifierNode(mToken->location, Identifier(mToken->value.identifier)));
+				mToken++;
 			}
 			else
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_IDENTIFIER);
+				Error(mToken->location, ErrorCode::EXPECTED_IDENTIFIER);
 				Utility::SafeDelete(node);
 				return nullptr;
 			}
@@ -1027,7 +1234,7 @@ namespace lyrics
 			mToken++;
 			if (mToken->type == Token::Type::END_OF_FILE)
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_IF_STATEMENT);
+				Error(mToken->location, ErrorCode::INCOMPLETE_IF_STATEMENT);
 				Utility::SafeDelete(elseIfNode);
 				Utility::SafeDelete(node);
 				return nullptr;
@@ -1042,7 +1249,7 @@ namespace lyrics
 
 			if (mToken->type == Token::Type::END_OF_FILE)
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_IF_STATEMENT);
+				Error(mToken->location, ErrorCode::INCOMPLETE_IF_STATEMENT);
 				Utility::SafeDelete(elseIfNode);
 				Utility::SafeDelete(node);
 				return nullptr;
@@ -1062,7 +1269,7 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_IF_STATEMENT);
+					Error(mToken->location, ErrorCode::INCOMPLETE_IF_STATEMENT);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
@@ -1077,14 +1284,14 @@ namespace lyrics
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END);
+					Error(mToken->location, ErrorCode::EXPECTED_END);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
 			}
 			else if (mToken->type != Token::Type::ELSEIF)
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END_ELSE_ELSEIF);
+				Error(mToken->location, ErrorCode::EXPECTED_END_ELSE_ELSEIF);
 				Utility::SafeDelete(node);
 				return nullptr;
 			}
@@ -1098,7 +1305,7 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CASE_STATEMENT);
+			Error(mToken->location, ErrorCode::INCOMPLETE_CASE_STATEMENT);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -1116,7 +1323,7 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CASE_STATEMENT);
+					Error(mToken->location, ErrorCode::INCOMPLETE_CASE_STATEMENT);
 					Utility::SafeDelete(whenNode);
 					Utility::SafeDelete(node);
 					return nullptr;
@@ -1131,7 +1338,7 @@ namespace lyrics
 
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CASE_STATEMENT);
+					Error(mToken->location, ErrorCode::INCOMPLETE_CASE_STATEMENT);
 					Utility::SafeDelete(whenNode);
 					Utility::SafeDelete(node);
 					return nullptr;
@@ -1145,7 +1352,7 @@ namespace lyrics
 					mToken++;
 					if (mToken->type == Token::Type::END_OF_FILE)
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_CASE_STATEMENT);
+						Error(mToken->location, ErrorCode::INCOMPLETE_CASE_STATEMENT);
 						Utility::SafeDelete(node);
 						return nullptr;
 					}
@@ -1160,7 +1367,7 @@ namespace lyrics
 					}
 					else
 					{
-						ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END);
+						Error(mToken->location, ErrorCode::EXPECTED_END);
 						Utility::SafeDelete(node);
 						return nullptr;
 					}
@@ -1173,7 +1380,7 @@ namespace lyrics
 				}
 				else if (mToken->type != Token::Type::WHEN)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_WHEN_ELSE_ELSEIF);
+					Error(mToken->location, ErrorCode::EXPECTED_WHEN_ELSE_ELSEIF);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
@@ -1181,7 +1388,7 @@ namespace lyrics
 		}
 		else
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_WHEN);
+			Error(mToken->location, ErrorCode::EXPECTED_WHEN);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -1194,7 +1401,7 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_WHILE_STATEMENT);
+			Error(mToken->location, ErrorCode::INCOMPLETE_WHILE_STATEMENT);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -1208,7 +1415,7 @@ namespace lyrics
 
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_WHILE_STATEMENT);
+			Error(mToken->location, ErrorCode::INCOMPLETE_WHILE_STATEMENT);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -1223,7 +1430,7 @@ namespace lyrics
 		}
 		else
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END);
+			Error(mToken->location, ErrorCode::EXPECTED_END);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -1236,7 +1443,7 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
+			Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -1248,7 +1455,7 @@ namespace lyrics
 			mToken++;
 			if (mToken->type == Token::Type::END_OF_FILE)
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
+				Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
 				Utility::SafeDelete(node);
 				return nullptr;
 			}
@@ -1260,7 +1467,7 @@ namespace lyrics
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
+					Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
@@ -1274,7 +1481,7 @@ namespace lyrics
 
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
+					Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
@@ -1289,21 +1496,21 @@ namespace lyrics
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END);
+					Error(mToken->location, ErrorCode::EXPECTED_END);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
 			}
 			else
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
+				Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
 				Utility::SafeDelete(node);
 				return nullptr;
 			}
 		}
 		else
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
+			Error(mToken->location, ErrorCode::INCOMPLETE_FOR_STATEMENT);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -1316,30 +1523,30 @@ namespace lyrics
 		mToken++;
 		if (mToken->type == Token::Type::END_OF_FILE)
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOREACH_STATEMENT);
+			Error(mToken->location, ErrorCode::INCOMPLETE_FOREACH_STATEMENT);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
 
 		node->variable = Expression();
 
-		if (node->variable->type == Node::Type::IDENTIFIER || node->variable->type == Node::Type::MEMBER_REFERENCE || node->variable->type == Node::Type::INDEX_REFERENCE)
+		if (node->variable && (node->variable->type == Node::Type::IDENTIFIER || node->variable->type == Node::Type::MEMBER_REFERENCE || node->variable->type == Node::Type::INDEX_REFERENCE))
 		{
 			if (mToken->type == Token::Type::IN)
 			{
 				mToken++;
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOREACH_STATEMENT);
+					Error(mToken->location, ErrorCode::INCOMPLETE_FOREACH_STATEMENT);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
 
 				node->collection = Expression();
 
-				if (node->collection->type != Node::Type::IDENTIFIER && node->collection->type != Node::Type::MEMBER_REFERENCE && node->collection->type != Node::Type::INDEX_REFERENCE)
+				if (!node->collection || (node->collection->type != Node::Type::IDENTIFIER && node->collection->type != Node::Type::MEMBER_REFERENCE && node->collection->type != Node::Type::INDEX_REFERENCE))
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_LHS);
+					Error(mToken->location, ErrorCode::EXPECTED_LHS);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
@@ -1351,7 +1558,7 @@ namespace lyrics
 
 				if (mToken->type == Token::Type::END_OF_FILE)
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOREACH_STATEMENT);
+					Error(mToken->location, ErrorCode::INCOMPLETE_FOREACH_STATEMENT);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
@@ -1366,21 +1573,21 @@ namespace lyrics
 				}
 				else
 				{
-					ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_END);
+					Error(mToken->location, ErrorCode::EXPECTED_END);
 					Utility::SafeDelete(node);
 					return nullptr;
 				}
 			}
 			else
 			{
-				ErrorLogger::Error(mToken->location, ErrorCode::INCOMPLETE_FOREACH_STATEMENT);
+				Error(mToken->location, ErrorCode::INCOMPLETE_FOREACH_STATEMENT);
 				Utility::SafeDelete(node);
 				return nullptr;
 			}
 		}
 		else
 		{
-			ErrorLogger::Error(mToken->location, ErrorCode::EXPECTED_LHS);
+			Error(mToken->location, ErrorCode::EXPECTED_LHS);
 			Utility::SafeDelete(node);
 			return nullptr;
 		}
@@ -1402,7 +1609,7 @@ namespace lyrics
 
 		mToken++;
 
-		if (mToken->type == Token::Type::END || mToken->type == Token::Type::ELSE || mToken->type == Token::Type::ELSEIF || mToken->type == Token::Type::PRIVATE || mToken->type == Token::Type::PUBLIC || mToken->type == Token::Type::WHEN || mToken->type == Token::Type::END_OF_FILE)
+		if (IsEndOfBlock(mToken->type))
 		{
 			return new ReturnNode(tLocation);
 		}
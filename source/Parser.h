@@ -2,25 +2,69 @@
 #define PARSER
 
 #include <string>
+#include <vector>
 #include <forward_list>
+#include <unordered_map>
 
 #include "Token.h"
 #include "Node.h"
+#include "Diagnostic.h"
+#include "ErrorCode.h"
 
 namespace lyrics
 {
 	using std::string;
+	using std::u32string;
+	using std::vector;
 	using std::forward_list;
+	using std::unordered_map;
 
 	class Parser
 	{
 	public:
+		// Where the statements of a block start, and the token it ends at.
+		struct Span
+		{
+			vector<forward_list<Token>::const_iterator> statements;
+			vector<vector<Diagnostic>> diagnostics;	// Logged by each statement and not by a block in it, if the logs were captured.
+			forward_list<Token>::const_iterator end;
+		};
+
+		typedef unordered_map<const BlockNode *, Span> Spans;
+
+		Parser() : mIsCopied(false), mSpans(nullptr), mIsRecovering(false)
+		{
+		}
+
 		BlockNode *Parse(const forward_list<Token> *tokenList);
+		BlockNode *Parse(const forward_list<Token> *tokenList, Spans &spans);	// For tokens kept after the parse, whose names are copied.
+		forward_list<Token>::const_iterator Parse(forward_list<Token>::const_iterator token, const forward_list<Token>::const_iterator end, forward_list<StatementNode *> &statements, Span &span, Spans &spans);	// Where it stopped, at the end or at that of the block.
 	
 	private:
+		// Of the binary operators, from the loosest.
+		enum struct Precedence
+		{
+			NONE, LOGICAL_OR, LOGICAL_AND, EQUALITY, RELATIONAL, OR, AND, SHIFT, ADDITIVE, MULTIPLICATIVE
+		};
+
 		forward_list<Token>::const_iterator mToken;
+		bool mIsCopied;
+		Spans *mSpans;
+		bool mIsRecovering;	// From the first error of a statement, whose others are not logged.
+
+		static bool IsEndOfBlock(const Token::Type type);
+		static bool IsStartOfStatement(const Token::Type type);
+		static int Nesting(const Token &token, unsigned int &loopLine);
+		static Precedence PrecedenceOf(const Token::Type type);
+
+		void Error(const Location &location, const ErrorCode errorCode);
+		void Synchronize(forward_list<Token>::const_iterator token);
+		void Skip();
 
+		u32string *Identifier(u32string * const identifier) const;
 		BlockNode *Block();
+		StatementNode *Statement(Span * const span);
+		StatementNode *RecoverableStatement();
 		StatementNode *Statement();
 		ExpressionNode *PrimaryExpression();
 		ArrayLiteralNode *ArrayLiteral();
@@ -29,15 +73,7 @@ namespace lyrics
 		ParenthesizedExpressionNode *ParenthesizedExpression();
 		ExpressionNode *PostfixExpression();
 		ExpressionNode *UnaryExpression();
-		ExpressionNode *MultiplicativeExpression();
-		ExpressionNode *AdditiveExpression();
-		ExpressionNode *ShiftExpression();
-		ExpressionNode *AndExpression();
-		ExpressionNode *OrExpression();
-		ExpressionNode *RelationalExpression();
-		ExpressionNode *EqualityExpression();
-		ExpressionNode *LogicalAndExpression();
-		ExpressionNode *LogicalOrExpression();
+		ExpressionNode *BinaryExpression(const Precedence precedence);
 		ExpressionNode *AssignmentExpression();
 		AssignmentExpressionNode *Class();
 		IncludeNode *Include();
@@ -0,0 +1,20 @@
+#ifndef PASS
+#define PASS
+
+#include "IR.h"
+
+namespace lyrics
+{
+	// A transformation of the IR of a function, run by PassManager. It must keep every value in the location it was defined in, unless it is the register allocator, which goes last.
+	class Pass
+	{
+	public:
+		virtual ~Pass()
+		{
+		}
+
+		virtual void Run(IR &ir) = 0;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "PassManager.h"
+
+#include <new>
+
+#include "IR.h"
+#include "IRBuilder.h"
+#include "IRLowering.h"
+
+#include "FatalErrorCode.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	// Copies made by common subexpression elimination are propagated again, and whatever is left unused goes before the registers are allocated.
+	// Reads of the slots moved to registers are then propagated from those, and the instructions are fused last.
+	PassManager::PassManager() : mPasses{ &mCopyPropagation, &mCommonSubexpressionElimination, &mCopyPropagation, &mDeadCodeElimination, &mRegisterAllocator, &mCopyPropagation, &mDeadCodeElimination, &mSuperinstructionFuser }
+	{
+	}
+
+	void PassManager::Run(Module &module)
+	{
+		using std::bad_alloc;
+
+		IR *ir = nullptr;
+
+		try
+		{
+			for (auto i : module.functions)
+			{
+				ir = IRBuilder().Build(module, *i);
+
+				if (!ir)
+				{
+					continue;
+				}
+
+				for (auto j : mPasses)
+				{
+					j->Run(*ir);
+				}
+
+				IRLowering().Lower(*ir, *i);
+				Utility::SafeDelete(ir);
+			}
+		}
+		catch (const bad_alloc &e)
+		{
+			Utility::SafeDelete(ir);
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+	}
+}
\ No newline at end of file
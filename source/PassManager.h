@@ -0,0 +1,39 @@
+#ifndef PASS_MANAGER
+#define PASS_MANAGER
+
+#include <vector>
+
+#include "Module.h"
+#include "Pass.h"
+#include "CopyPropagation.h"
+#include "CommonSubexpressionElimination.h"
+#include "DeadCodeElimination.h"
+#include "RegisterAllocator.h"
+#include "SuperinstructionFuser.h"
+
+namespace lyrics
+{
+	using std::vector;
+
+	// Lifts each function of a module into the IR, runs the passes over it in order and lowers it back.
+	class PassManager
+	{
+	public:
+		PassManager();
+
+		PassManager(const PassManager &) = delete;
+		PassManager &operator=(const PassManager &) = delete;
+
+		void Run(Module &module);
+
+	private:
+		CopyPropagation mCopyPropagation;
+		CommonSubexpressionElimination mCommonSubexpressionElimination;
+		DeadCodeElimination mDeadCodeElimination;
+		RegisterAllocator mRegisterAllocator;
+		SuperinstructionFuser mSuperinstructionFuser;
+		vector<Pass *> mPasses;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include "RegisterAllocator.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace lyrics
+{
+	using std::pair;
+
+	constexpr Register RegisterAllocator::REGISTERS[];
+	constexpr size_t RegisterAllocator::REGISTER_COUNT;
+
+	void RegisterAllocator::Run(IR &ir)
+	{
+		mIntervals.clear();
+		mWebs.clear();
+		mBlocks.clear();
+		mStarts.clear();
+		mEnds.clear();
+		mClobbers.assign(REGISTER_COUNT, vector<unsigned int>());
+		mAvailable.assign(REGISTER_COUNT, true);
+
+		Join(ir);
+		Number(ir);
+		Measure(ir);
+		Scan();
+		Rewrite(ir);
+	}
+
+	// The values of a slot joined by phis make one interval, as a phi does not move its value.
+	void RegisterAllocator::Join(const IR &ir)
+	{
+		vector<IR::Value *> values;
+
+		for (auto i : ir.blocks)
+		{
+			for (auto j : i->phis)
+			{
+				values.insert(values.end(), j->results.begin(), j->results.end());
+			}
+
+			for (auto j : i->instructions)
+			{
+				values.insert(values.end(), j->operands.begin(), j->operands.end());
+				values.insert(values.end(), j->results.begin(), j->results.end());
+			}
+		}
+
+		for (auto i : values)
+		{
+			if (IR::IsRegister(i->location) || mWebs.count(i) != 0)
+			{
+				continue;
+			}
+
+			const size_t index = mIntervals.size();
+			vector<IR::Value *> work(1, i);
+
+			mIntervals.emplace_back();
+			mIntervals.back().slot = i->location;
+			mWebs[i] = index;
+
+			while (!work.empty())
+			{
+				IR::Value * const value = work.back();
+				IR::Instruction * const definition = value->definition;
+				Interval &interval = mIntervals[index];
+
+				work.pop_back();
+				interval.values.push_back(value);
+
+				if (!definition || !(definition->isPhi || definition->IsCopy()))
+				{
+					interval.isFixed = true;
+				}
+				else if (definition->isPhi)
+				{
+					for (auto j : definition->operands)
+					{
+						if (mWebs.emplace(j, index).second)
+						{
+							work.push_back(j);
+						}
+					}
+				}
+
+				for (auto j : value->uses)
+				{
+					if (j->isPhi)
+					{
+						if (mWebs.emplace(j->results.front(), index).second)
+						{
+							work.push_back(j->results.front());
+						}
+					}
+					else if (!j->IsCopy())
+					{
+						interval.isFixed = true;
+					}
+				}
+			}
+		}
+	}
+
+	// Registers the code already reads are left alone, and the ones it writes are clobbered there.
+	void RegisterAllocator::Number(const IR &ir)
+	{
+		unsigned int position = 0;
+
+		for (size_t i = 0; i < ir.blocks.size(); i++)
+		{
+			const IR::BasicBlock * const block = ir.blocks[i];
+
+			mBlocks[block] = i;
+			mStarts.push_back(position);
+
+			for (auto j : block->instructions)
+			{
+				for (size_t k = 0; k < REGISTER_COUNT; k++)
+				{
+					const unsigned short location = IR::Location(REGISTERS[k]);
+
+					for (auto l : j->operands)
+					{
+						if (l->location == location)
+						{
+							mAvailable[k] = false;
+						}
+					}
+
+					for (auto l : j->results)
+					{
+						if (l->location == location)
+						{
+							mClobbers[k].push_back(position + 1);
+						}
+					}
+				}
+
+				position += 2;
+			}
+
+			mEnds.push_back(position == mStarts.back() ? position : position - 1);
+		}
+	}
+
+	// Liveness of each interval as if it were a variable, from which the interval spans the first position it is live at to the last.
+	void RegisterAllocator::Measure(const IR &ir)
+	{
+		const size_t count = mIntervals.size();
+		const size_t blockCount = ir.blocks.size();
+		vector<vector<bool>> generated(blockCount, vector<bool>(count, false));
+		vector<vector<bool>> killed(blockCount, vector<bool>(count, false));
+		vector<vector<bool>> outs(blockCount, vector<bool>(count, false));
+
+		mIns.assign(blockCount, vector<bool>(count, false));
+
+		for (size_t i = 0; i < blockCount; i++)
+		{
+			unsigned int position = mStarts[i];
+
+			for (auto j : ir.blocks[i]->instructions)
+			{
+				for (auto k : j->operands)
+				{
+					auto found = mWebs.find(k);
+
+					if (found != mWebs.end() && !mIntervals[found->second].isFixed)
+					{
+						if (!killed[i][found->second])
+						{
+							generated[i][found->second] = true;
+						}
+
+						Extend(found->second, position);
+					}
+				}
+
+				for (auto k : j->results)
+				{
+					auto found = mWebs.find(k);
+
+					if (found != mWebs.end() && !mIntervals[found->second].isFixed)
+					{
+						killed[i][found->second] = true;
+						Extend(found->second, position + 1);
+					}
+				}
+
+				position += 2;
+			}
+		}
+
+		for (bool isChanged = true; isChanged;)
+		{
+			isChanged = false;
+
+			for (size_t i = blockCount; i-- > 0;)
+			{
+				for (auto j : ir.blocks[i]->successors)
+				{
+					const vector<bool> &in = mIns[mBlocks[j]];
+
+					for (size_t k = 0; k < count; k++)
+					{
+						if (in[k] && !outs[i][k])
+						{
+							outs[i][k] = true;
+						}
+					}
+				}
+
+				for (size_t k = 0; k < count; k++)
+				{
+					if (!mIns[i][k] && (generated[i][k] || (outs[i][k] && !killed[i][k])))
+					{
+						mIns[i][k] = true;
+						isChanged = true;
+					}
+				}
+			}
+		}
+
+		for (size_t i = 0; i < blockCount; i++)
+		{
+			for (size_t j = 0; j < count; j++)
+			{
+				if (mIns[i][j])
+				{
+					Extend(j, mStarts[i]);
+				}
+
+				if (outs[i][j])
+				{
+					Extend(j, mEnds[i]);
+				}
+			}
+		}
+	}
+
+	// When no register is free, the interval ending last is the one spilled.
+	void RegisterAllocator::Scan()
+	{
+		vector<pair<unsigned int, size_t>> order;
+		vector<size_t> active;
+
+		for (size_t i = 0; i < mIntervals.size(); i++)
+		{
+			if (!mIntervals[i].isFixed && mIntervals[i].start <= mIntervals[i].end)
+			{
+				order.emplace_back(mIntervals[i].start, i);
+			}
+		}
+
+		std::sort(order.begin(), order.end());
+
+		for (auto &i : order)
+		{
+			Interval &interval = mIntervals[i.second];
+			vector<bool> isHeld(REGISTER_COUNT, false);
+
+			for (auto j = active.begin(); j != active.end();)
+			{
+				if (mIntervals[*j].end < interval.start)
+				{
+					j = active.erase(j);
+				}
+				else
+				{
+					isHeld[mIntervals[*j].r] = true;
+					j++;
+				}
+			}
+
+			for (size_t j = 0; j < REGISTER_COUNT && interval.r < 0; j++)
+			{
+				if (mAvailable[j] && !isHeld[j] && !IsClobbered(j, interval))
+				{
+					interval.r = static_cast<short>(j);
+				}
+			}
+
+			if (interval.r >= 0)
+			{
+				active.push_back(i.second);
+				continue;
+			}
+
+			auto spilled = active.end();
+
+			for (auto j = active.begin(); j != active.end(); j++)
+			{
+				const Interval &other = mIntervals[*j];
+
+				if (other.end > interval.end && (spilled == active.end() || other.end > mIntervals[*spilled].end) && !IsClobbered(other.r, interval))
+				{
+					spilled = j;
+				}
+			}
+
+			if (spilled != active.end())
+			{
+				interval.r = mIntervals[*spilled].r;
+				mIntervals[*spilled].r = -1;
+				*spilled = i.second;
+			}
+		}
+	}
+
+	// Stores to the slot become moves to the register, and loads from it moves from it.
+	void RegisterAllocator::Rewrite(const IR &ir)
+	{
+		for (auto &i : mIntervals)
+		{
+			if (i.r < 0)
+			{
+				continue;
+			}
+
+			const short r = static_cast<short>(REGISTERS[i.r]);
+
+			for (auto j : i.values)
+			{
+				IR::Instruction * const definition = j->definition;
+
+				j->location = static_cast<unsigned short>(r);
+
+				if (!definition->isPhi)
+				{
+					const short rs = definition->code.operand16;
+
+					definition->code = ByteCode(ByteCode::Opcode::MOVE, r, rs, rs);
+					definition->fields.front() = IR::Field::HIGH_AND_LOW;
+				}
+
+				for (auto k : j->uses)
+				{
+					if (!k->isPhi)
+					{
+						k->code = ByteCode(ByteCode::Opcode::MOVE, k->code.operand16, r, r);
+						k->fields.front() = IR::Field::HIGH_AND_LOW;
+					}
+				}
+			}
+		}
+
+		// Where an interval is live on entry to a block, the block now finds it in the register, for the passes after to read it from there.
+		for (size_t i = 0; i < ir.blocks.size(); i++)
+		{
+			IR::BasicBlock * const block = ir.blocks[i];
+
+			for (size_t j = 0; j < mIntervals.size(); j++)
+			{
+				const Interval &interval = mIntervals[j];
+
+				if (interval.r >= 0 && mIns[i][j])
+				{
+					const unsigned short location = IR::Location(REGISTERS[interval.r]);
+					IR::Value * const value = IR::Resolve(block->values[interval.slot]);
+
+					if (value && value->location == location)
+					{
+						block->values[location] = value;
+					}
+				}
+			}
+		}
+	}
+
+	void RegisterAllocator::Extend(const size_t interval, const unsigned int position)
+	{
+		Interval &extended = mIntervals[interval];
+
+		extended.start = std::min(extended.start, position);
+		extended.end = std::max(extended.end, position);
+	}
+
+	// A register written inside the interval, past where it starts, cannot hold it.
+	bool RegisterAllocator::IsClobbered(const size_t r, const Interval &interval) const
+	{
+		const vector<unsigned int> &clobbers = mClobbers[r];
+		auto found = std::upper_bound(clobbers.begin(), clobbers.end(), interval.start);
+
+		return found != clobbers.end() && *found <= interval.end;
+	}
+}
\ No newline at end of file
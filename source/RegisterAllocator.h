@@ -0,0 +1,64 @@
+#ifndef REGISTER_ALLOCATOR
+#define REGISTER_ALLOCATOR
+
+#include <climits>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+#include "ByteCode.h"
+#include "Pass.h"
+#include "IR.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::vector;
+	using std::unordered_map;
+
+	// Linear scan over the live ranges of the frame slots only ever copied to and from registers, which are moved to the registers the code generator leaves unused.
+	// A slot stays in the frame, and keeps being loaded and stored, where its live range crosses a call or no register is free for it.
+	class RegisterAllocator : public Pass
+	{
+	public:
+		virtual void Run(IR &ir);
+
+	private:
+		struct Interval
+		{
+			Interval() : slot(0), start(UINT_MAX), end(0), isFixed(false), r(-1)
+			{
+			}
+
+			unsigned short slot;
+			vector<IR::Value *> values;	// Joined by phis, so that they go to one register together.
+			unsigned int start;
+			unsigned int end;
+			bool isFixed;	// Read or written by more than copies, so it has to stay in its slot.
+			short r;	// Index into REGISTERS, -1 if spilled.
+		};
+
+		static constexpr Register REGISTERS[] = { Register::TV0, Register::TV1, Register::TA0, Register::TA1, Register::TT0, Register::TT1 };
+		static constexpr size_t REGISTER_COUNT = sizeof(REGISTERS) / sizeof(REGISTERS[0]);
+
+		void Join(const IR &ir);
+		void Number(const IR &ir);
+		void Measure(const IR &ir);
+		void Scan();
+		void Rewrite(const IR &ir);
+
+		void Extend(const size_t interval, const unsigned int position);
+		bool IsClobbered(const size_t r, const Interval &interval) const;
+
+		vector<Interval> mIntervals;
+		unordered_map<const IR::Value *, size_t> mWebs;	// Interval of each value of a slot.
+		unordered_map<const IR::BasicBlock *, size_t> mBlocks;
+		vector<unsigned int> mStarts;	// Positions of the blocks. An instruction uses its operands at an even position and defines its results at the odd one after.
+		vector<unsigned int> mEnds;
+		vector<vector<unsigned int>> mClobbers;	// Positions each register is written at, by calls for the most part.
+		vector<bool> mAvailable;
+		vector<vector<bool>> mIns;	// Of each block, whether each interval is live on entry.
+	};
+}
+
+#endif
\ No newline at end of file
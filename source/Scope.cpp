@@ -1,5 +1,7 @@
 #include "Scope.h"
 
+#include "Node.h"
+
 #include "Utility.h"
 
 namespace lyrics
@@ -26,21 +28,36 @@ namespace lyrics
 	}
 
 	bool Scope::IsExist(const u32string * const identifier) const
+	{
+		return mEntities.find(*identifier) != mEntities.cend();
+	}
+
+	const IdentifierNode *Scope::Find(const u32string * const identifier) const
 	{
 		auto iterator = mEntities.find(*identifier);
 
-		if (iterator != mEntities.cend() && *iterator == *identifier)
+		if (iterator != mEntities.cend())
 		{
-			return true;
+			return iterator->second;
 		}
 		else
 		{
-			return false;
+			return nullptr;
 		}
 	}
 
-	void Scope::AddVariable(const u32string * const entity)
+	void Scope::AddVariable(const IdentifierNode * const entity)
 	{
-		mEntities.insert(*entity);
+		mEntities.emplace(*entity->identifier, entity);
+	}
+
+	void Scope::RemoveVariable(const u32string * const identifier, const IdentifierNode * const entity)
+	{
+		auto iterator = mEntities.find(*identifier);
+
+		if (iterator != mEntities.end() && iterator->second == entity)
+		{
+			mEntities.erase(iterator);
+		}
 	}
 }
\ No newline at end of file
@@ -3,13 +3,15 @@
 
 #include <string>
 #include <forward_list>
-#include <unordered_set>
+#include <unordered_map>
 
 namespace lyrics
 {
 	using std::u32string;
 	using std::forward_list;
-	using std::unordered_set;
+	using std::unordered_map;
+
+	class IdentifierNode;
 
 	class Scope
 	{
@@ -24,13 +26,15 @@ namespace lyrics
 
 		void AddChlid(Scope * const child);
 		bool IsExist(const u32string * const identifier) const;
-		void AddVariable(const u32string * const entity);
+		const IdentifierNode *Find(const u32string * const identifier) const;	// Where it is declared, or nullptr if it is not here.
+		void AddVariable(const IdentifierNode * const entity);	// Unless it is declared already.
+		void RemoveVariable(const u32string * const identifier, const IdentifierNode * const entity);	// If the entity is what declares it here, which may be gone.
 
 	private:
 		const Scope * const mParent;
 		forward_list<Scope *> mChildren;
 		forward_list<Scope *>::const_iterator mLastChild;
-		unordered_set<u32string> mEntities;
+		unordered_map<u32string, const IdentifierNode *> mEntities;
 	};
 }
 
@@ -6,15 +6,17 @@
 #include "LocalResolver.h"
 #include "DereferenceChecker.h"
 #include "StaticTypeChecker.h"
+#include "ConstantFolder.h"
 
 #include "ErrorCode.h"
 #include "FatalErrorCode.h"
+#include "Logger.h"
 
 #include "Utility.h"
 
 namespace lyrics
 {
-	BlockNode *SemanticAnalyzer::SemanticAnalysis(BlockNode *root)
+	BlockNode *SemanticAnalyzer::SemanticAnalysis(BlockNode *root, StaticTypeChecker::TypeTable &typeTable)
 	{
 		using std::bad_alloc;
 
@@ -34,7 +36,37 @@ namespace lyrics
 
 		canProgress &= DereferenceChecker().Check(root);
 
-		canProgress &= StaticTypeChecker().Check(root);
+		if (Logger::IsErrorLimitReached())
+		{
+			throw FatalErrorCode::TOO_MANY_ERRORS;
+		}
+
+		if (canProgress)
+		{
+			try
+			{
+				root = ConstantFolder().Fold(root);
+			}
+			catch (const bad_alloc &e)
+			{
+				throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+			}
+		}
+
+		try
+		{
+			canProgress &= StaticTypeChecker().Check(root, typeTable);
+
+			if (canProgress && ConstantFolder().Refold(root, typeTable))
+			{
+				typeTable.clear();
+				StaticTypeChecker().Check(root, typeTable);
+			}
+		}
+		catch (const bad_alloc &e)
+		{
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
 
 		if (!canProgress)
 		{
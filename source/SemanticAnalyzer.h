@@ -4,6 +4,7 @@
 #include <string>
 
 #include "Node.h"
+#include "StaticTypeChecker.h"
 
 namespace lyrics
 {
@@ -12,7 +13,7 @@ namespace lyrics
 	class SemanticAnalyzer
 	{
 	public:
-		BlockNode *SemanticAnalysis(BlockNode *root);
+		BlockNode *SemanticAnalysis(BlockNode *root, StaticTypeChecker::TypeTable &typeTable);
 	};
 }
 
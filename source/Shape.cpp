@@ -0,0 +1,54 @@
+#include "Shape.h"
+
+#include "Utility.h"
+
+namespace lyrics
+{
+	constexpr unsigned int Shape::NOT_FOUND;
+
+	Shape::Shape() : mParent(nullptr), mSlotCount(0)
+	{
+	}
+
+	Shape::Shape(Shape * const parent, const u32string &member) : mParent(parent), mMember(member), mSlotCount(parent->mSlotCount + 1)
+	{
+	}
+
+	Shape::~Shape()
+	{
+		for (auto i : mTransitions)
+		{
+			Utility::SafeDelete(i);
+		}
+	}
+
+	// Slow path taken on an inline cache miss.
+	unsigned int Shape::Lookup(const u32string &member) const
+	{
+		for (const Shape *shape = this; shape->mParent; shape = shape->mParent)
+		{
+			if (shape->mMember == member)
+			{
+				return shape->mSlotCount - 1;
+			}
+		}
+
+		return Shape::NOT_FOUND;
+	}
+
+	// The shape a member not in this one leads to. Object::AddMember looks the member up first and keeps its slot if it is already there.
+	Shape *Shape::AddMember(const u32string &member)
+	{
+		for (auto i : mTransitions)
+		{
+			if (i->mMember == member)
+			{
+				return i;
+			}
+		}
+
+		mTransitions.push_front(new Shape(this, member));
+
+		return mTransitions.front();
+	}
+}
\ No newline at end of file
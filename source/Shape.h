@@ -0,0 +1,47 @@
+#ifndef SHAPE
+#define SHAPE
+
+#include <string>
+#include <forward_list>
+
+namespace lyrics
+{
+	using std::u32string;
+	using std::forward_list;
+
+	// Hidden class shared by objects that got the same members in the same order.
+	class Shape
+	{
+	public:
+		Shape();
+		~Shape();
+
+		Shape(const Shape &) = delete;
+		Shape &operator=(const Shape &) = delete;
+
+		const Shape *Parent() const
+		{
+			return mParent;
+		}
+
+		unsigned int SlotCount() const
+		{
+			return mSlotCount;
+		}
+
+		unsigned int Lookup(const u32string &member) const;
+		Shape *AddMember(const u32string &member);
+
+		static constexpr unsigned int NOT_FOUND = ~0u;
+
+	private:
+		Shape(Shape * const parent, const u32string &member);
+
+		const Shape * const mParent;
+		const u32string mMember;
+		const unsigned int mSlotCount;
+		forward_list<Shape *> mTransitions;
+	};
+}
+
+#endif
\ No newline at end of file
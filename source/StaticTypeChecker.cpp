@@ -2,9 +2,30 @@
 
 namespace lyrics
 {
-	bool StaticTypeChecker::Check(const BlockNode * const node)
+	constexpr StaticTypeChecker::TypeSet StaticTypeChecker::NONE;
+	constexpr StaticTypeChecker::TypeSet StaticTypeChecker::ANY;
+
+	bool StaticTypeChecker::Check(const BlockNode * const node, TypeTable &typeTable)
 	{
-		return node->Accept(*this);
+		bool canProgress;
+		size_t clobberedCount;
+
+		mTypeTable = &typeTable;
+
+		// A call can change what a function defined later in the script assigns, so run again until no more such variables are found.
+		do
+		{
+			clobberedCount = mClobbered.size();
+
+			mFrames.clear();
+			mFrames.emplace_back();
+
+			canProgress = node->Accept(*this);
+		} while (mClobbered.size() != clobberedCount);
+
+		mFrames.clear();
+
+		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const BlockNode * const node)
@@ -15,7 +36,21 @@ namespace lyrics
 		{
 			if (i)
 			{
-				canProgress &= i->Accept(*this);
+				if (i->type == Node::Type::BREAK || i->type == Node::Type::NEXT)
+				{
+					Frame &frame = mFrames.back();
+
+					if (!frame.loops.empty())
+					{
+						StaticTypeChecker::Join(i->type == Node::Type::BREAK ? frame.loops.back().breaks : frame.loops.back().nexts, frame.environment);
+					}
+
+					frame.environment.isReachable = false;
+				}
+				else
+				{
+					canProgress &= i->Accept(*this);
+				}
 			}
 			else
 			{
@@ -28,7 +63,30 @@ namespace lyrics
 
 	bool StaticTypeChecker::Visit(const IdentifierNode * const node)
 	{
-		(void)node;	// Hide warning.
+		for (auto i = mFrames.crbegin(); i != mFrames.crend(); i++)
+		{
+			if (i->variables.count(*node->identifier))
+			{
+				if (i != mFrames.crbegin() || i->isObject)	// Captured from an enclosing function or a member, so anything can be assigned to it.
+				{
+					mTypeSet = StaticTypeChecker::ANY;
+				}
+				else if (!i->environment.isReachable)
+				{
+					mTypeSet = StaticTypeChecker::NONE;
+				}
+				else
+				{
+					auto type = i->environment.types.find(*node->identifier);
+
+					mTypeSet = type != i->environment.types.cend() ? type->second : StaticTypeChecker::TypeOf(Literal::Type::NULL_LITERAL);
+				}
+
+				return true;
+			}
+		}
+
+		mTypeSet = StaticTypeChecker::ANY;
 
 		return true;
 	}
@@ -41,7 +99,7 @@ namespace lyrics
 		{
 			if (i)
 			{
-				canProgress &= i->Accept(*this);
+				canProgress &= Infer(i);
 			}
 			else
 			{
@@ -49,6 +107,8 @@ namespace lyrics
 			}
 		}
 
+		mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::ARRAY);
+
 		return canProgress;
 	}
 
@@ -68,6 +128,8 @@ namespace lyrics
 			}
 		}
 
+		mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::HASH);
+
 		return canProgress;
 	}
 
@@ -77,7 +139,7 @@ namespace lyrics
 
 		if (node->key)
 		{
-			canProgress &= node->key->Accept(*this);
+			canProgress &= Infer(node->key);
 		}
 		else
 		{
@@ -86,7 +148,7 @@ namespace lyrics
 
 		if (node->value)
 		{
-			canProgress &= node->value->Accept(*this);
+			canProgress &= Infer(node->value);
 		}
 		else
 		{
@@ -100,10 +162,18 @@ namespace lyrics
 	{
 		bool canProgress = true;
 
+		mFrames.emplace_back();
+
 		for (auto i : node->list)
 		{
 			if (i)
 			{
+				if (i->name)
+				{
+					mFrames.back().variables.insert(*i->name->identifier);
+					mFrames.back().environment.types[*i->name->identifier] = StaticTypeChecker::ANY;
+				}
+
 				canProgress &= i->Accept(*this);
 			}
 			else
@@ -121,6 +191,10 @@ namespace lyrics
 			canProgress = false;
 		}
 
+		mFrames.pop_back();
+
+		mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::FUNCTION);
+
 		return canProgress;
 	}
 
@@ -128,18 +202,14 @@ namespace lyrics
 	{
 		bool canProgress = true;
 
-		if (node->name)
-		{
-			canProgress &= node->name->Accept(*this);
-		}
-		else
+		if (!node->name)
 		{
 			canProgress = false;
 		}
 
 		if (node->defalutArgument)
 		{
-			canProgress &= node->defalutArgument->Accept(*this);
+			canProgress &= Infer(node->defalutArgument);
 		}
 
 		return canProgress;
@@ -149,11 +219,7 @@ namespace lyrics
 	{
 		bool canProgress = true;
 
-		if (node->name)
-		{
-			canProgress &= node->name->Accept(*this);
-		}
-		else
+		if (!node->name)
 		{
 			canProgress = false;
 		}
@@ -167,7 +233,7 @@ namespace lyrics
 
 		if (node->expression)
 		{
-			canProgress &= node->expression->Accept(*this);
+			canProgress &= Infer(node->expression);
 		}
 		else
 		{
@@ -183,7 +249,7 @@ namespace lyrics
 
 		if (node->expression)
 		{
-			canProgress &= node->expression->Accept(*this);
+			canProgress &= Infer(node->expression);
 		}
 		else
 		{
@@ -192,13 +258,15 @@ namespace lyrics
 
 		if (node->index)
 		{
-			canProgress &= node->index->Accept(*this);
+			canProgress &= Infer(node->index);
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = StaticTypeChecker::ANY;
+
 		return canProgress;
 	}
 
@@ -208,7 +276,7 @@ namespace lyrics
 
 		if (node->expression)
 		{
-			canProgress &= node->expression->Accept(*this);
+			canProgress &= Infer(node->expression);
 		}
 		else
 		{
@@ -219,7 +287,7 @@ namespace lyrics
 		{
 			if (i)
 			{
-				canProgress &= i->Accept(*this);
+				canProgress &= Infer(i);
 			}
 			else
 			{
@@ -227,6 +295,10 @@ namespace lyrics
 			}
 		}
 
+		Clobber(node->list);
+
+		mTypeSet = StaticTypeChecker::ANY;
+
 		return canProgress;
 	}
 
@@ -236,22 +308,20 @@ namespace lyrics
 
 		if (node->expression)
 		{
-			canProgress &= node->expression->Accept(*this);
+			canProgress &= Infer(node->expression);
 		}
 		else
 		{
 			canProgress = false;
 		}
 
-		if (node->member)
-		{
-			canProgress &= node->member->Accept(*this);
-		}
-		else
+		if (!node->member)
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = StaticTypeChecker::ANY;
+
 		return canProgress;
 	}
 
@@ -261,11 +331,40 @@ namespace lyrics
 
 		if (node->expression)
 		{
-			canProgress &= node->expression->Accept(*this);
+			canProgress &= Infer(node->expression);
 		}
 		else
 		{
 			canProgress = false;
+			mTypeSet = StaticTypeChecker::ANY;
+		}
+
+		if (mTypeSet == StaticTypeChecker::NONE)
+		{
+			return canProgress;
+		}
+
+		switch (node->op)
+		{
+		case static_cast<Token::Type>(U'+'):
+		case static_cast<Token::Type>(U'-'):
+			if ((mTypeSet & ~(StaticTypeChecker::TypeOf(Literal::Type::INTEGER) | StaticTypeChecker::TypeOf(Literal::Type::REAL))) != 0u)
+			{
+				mTypeSet = StaticTypeChecker::ANY;
+			}
+			break;
+
+		case static_cast<Token::Type>(U'~'):
+			mTypeSet = StaticTypeChecker::IsOnly(mTypeSet, Literal::Type::INTEGER) ? StaticTypeChecker::TypeOf(Literal::Type::INTEGER) : StaticTypeChecker::ANY;
+			break;
+
+		case static_cast<Token::Type>(U'!'):
+			mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::BOOLEAN);
+			break;
+
+		default:
+			mTypeSet = StaticTypeChecker::ANY;
+			break;
 		}
 
 		return canProgress;
@@ -274,10 +373,13 @@ namespace lyrics
 	bool StaticTypeChecker::Visit(const MultiplicativeExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
@@ -286,23 +388,29 @@ namespace lyrics
 
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = StaticTypeChecker::Arithmetic(node->op, left, right);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const AdditiveExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
@@ -311,23 +419,29 @@ namespace lyrics
 
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = StaticTypeChecker::Arithmetic(node->op, left, right);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const ShiftExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
@@ -336,23 +450,29 @@ namespace lyrics
 
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = StaticTypeChecker::Bitwise(left, right);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const AndExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
@@ -361,23 +481,29 @@ namespace lyrics
 
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = StaticTypeChecker::Bitwise(left, right);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const OrExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
@@ -386,23 +512,29 @@ namespace lyrics
 
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = StaticTypeChecker::Bitwise(left, right);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const RelationalExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
@@ -411,23 +543,29 @@ namespace lyrics
 
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = left == StaticTypeChecker::NONE || right == StaticTypeChecker::NONE ? StaticTypeChecker::NONE : StaticTypeChecker::TypeOf(Literal::Type::BOOLEAN);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const EqualityExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
@@ -436,73 +574,116 @@ namespace lyrics
 
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = left == StaticTypeChecker::NONE || right == StaticTypeChecker::NONE ? StaticTypeChecker::NONE : StaticTypeChecker::TypeOf(Literal::Type::BOOLEAN);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const LogicalAndExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		const Environment shortCircuited = mFrames.back().environment;
+
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		StaticTypeChecker::Join(mFrames.back().environment, shortCircuited);
+
+		mTypeSet = left == StaticTypeChecker::NONE ? StaticTypeChecker::NONE : left | right | StaticTypeChecker::TypeOf(Literal::Type::BOOLEAN);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const LogicalOrExpressionNode * const node)
 	{
 		bool canProgress = true;
+		TypeSet left = StaticTypeChecker::ANY;
+		TypeSet right = StaticTypeChecker::ANY;
 
 		if (node->left)
 		{
-			canProgress &= node->left->Accept(*this);
+			canProgress &= Infer(node->left);
+			left = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		const Environment shortCircuited = mFrames.back().environment;
+
 		if (node->right)
 		{
-			canProgress &= node->right->Accept(*this);
+			canProgress &= Infer(node->right);
+			right = mTypeSet;
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		StaticTypeChecker::Join(mFrames.back().environment, shortCircuited);
+
+		mTypeSet = left == StaticTypeChecker::NONE ? StaticTypeChecker::NONE : left | right | StaticTypeChecker::TypeOf(Literal::Type::BOOLEAN);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const AssignmentExpressionNode * const node)
 	{
 		bool canProgress = true;
+		const u32string *identifier = nullptr;
 
 		if (node->lhs)
 		{
-			canProgress &= node->lhs->Accept(*this);
+			if (node->lhs->type == Node::Type::IDENTIFIER)
+			{
+				identifier = static_cast<const IdentifierNode *>(node->lhs)->identifier;
+
+				bool isDeclared = false;
+
+				for (auto &i : mFrames)
+				{
+					isDeclared |= i.variables.count(*identifier) != 0;
+				}
+
+				if (!isDeclared)	// Declared before the right hand side is resolved, as LocalResolver does.
+				{
+					mFrames.back().variables.insert(*identifier);
+				}
+			}
+			else
+			{
+				canProgress &= Infer(node->lhs);
+			}
 		}
 		else
 		{
@@ -511,11 +692,17 @@ namespace lyrics
 
 		if (node->rhs)
 		{
-			canProgress &= node->rhs->Accept(*this);
+			canProgress &= Infer(node->rhs);
 		}
 		else
 		{
 			canProgress = false;
+			mTypeSet = StaticTypeChecker::ANY;
+		}
+
+		if (identifier)
+		{
+			Assign(*identifier, mTypeSet);
 		}
 
 		return canProgress;
@@ -525,11 +712,38 @@ namespace lyrics
 	{
 		bool canProgress = true;
 
+		mFrames.emplace_back();
+		mFrames.back().isObject = true;
+
 		for (auto i : node->list)
 		{
 			if (i)
 			{
-				canProgress &= i->Accept(*this);
+				const ExpressionNode *parameter = i;
+
+				if (i->type == Node::Type::ASSIGNMENT_EXPRESSION)	// The default argument does not tell what a caller passes.
+				{
+					const AssignmentExpressionNode * const assignment = static_cast<const AssignmentExpressionNode *>(i);
+
+					if (assignment->rhs)
+					{
+						canProgress &= Infer(assignment->rhs);
+					}
+
+					parameter = assignment->lhs;
+				}
+
+				if (parameter && parameter->type == Node::Type::IDENTIFIER)
+				{
+					const u32string * const identifier = static_cast<const IdentifierNode *>(parameter)->identifier;
+
+					mFrames.back().variables.insert(*identifier);
+					mFrames.back().environment.types[*identifier] = StaticTypeChecker::ANY;
+				}
+				else if (parameter)
+				{
+					canProgress &= Infer(parameter);
+				}
 			}
 			else
 			{
@@ -556,6 +770,10 @@ namespace lyrics
 			canProgress = false;
 		}
 
+		mFrames.pop_back();
+
+		mTypeSet = StaticTypeChecker::ANY;
+
 		return canProgress;
 	}
 
@@ -565,7 +783,7 @@ namespace lyrics
 
 		if (node->baseClass)
 		{
-			canProgress &= node->baseClass->Accept(*this);
+			canProgress &= Infer(node->baseClass);
 		}
 		else
 		{
@@ -576,7 +794,7 @@ namespace lyrics
 		{
 			if (i)
 			{
-				canProgress &= i->Accept(*this);
+				canProgress &= Infer(i);
 			}
 			else
 			{
@@ -584,26 +802,16 @@ namespace lyrics
 			}
 		}
 
+		Clobber(node->list);
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const IncludeNode * const node)
 	{
-		bool canProgress = true;
-
-		for (auto i : node->list)
-		{
-			if (i)
-			{
-				canProgress &= i->Accept(*this);
-			}
-			else
-			{
-				canProgress = false;
-			}
-		}
+		(void)node;	// Hide warning.
 
-		return canProgress;
+		return true;
 	}
 
 	bool StaticTypeChecker::Visit(const PackageNode * const node)
@@ -612,44 +820,63 @@ namespace lyrics
 
 		if (node->block)
 		{
+			mFrames.emplace_back();
+			mFrames.back().isObject = true;
+
 			canProgress &= node->block->Accept(*this);
+
+			mFrames.pop_back();
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		mTypeSet = StaticTypeChecker::ANY;
+
 		return canProgress;
 	}
 
 	bool StaticTypeChecker::Visit(const ImportNode * const node)
 	{
-		bool canProgress = true;
-
-		for (auto i : node->list)
-		{
-			if (i)
-			{
-				canProgress &= i->Accept(*this);
-			}
-			else
-			{
-				canProgress = false;
-			}
-		}
+		(void)node;	// Hide warning.
 
-		return canProgress;
+		return true;
 	}
 
 	bool StaticTypeChecker::Visit(const IfNode * const node)
 	{
 		bool canProgress = true;
+		Environment exit;
+
+		exit.isReachable = false;
 
 		for (auto i : node->list)
 		{
 			if (i)
 			{
-				canProgress &= i->Accept(*this);
+				if (i->condition)
+				{
+					canProgress &= Infer(i->condition);
+				}
+				else
+				{
+					canProgress = false;
+				}
+
+				const Environment otherwise = mFrames.back().environment;
+
+				if (i->block)
+				{
+					canProgress &= i->block->Accept(*this);
+				}
+				else
+				{
+					canProgress = false;
+				}
+
+				StaticTypeChecker::Join(exit, mFrames.back().environment);
+				mFrames.back().environment = otherwise;
 			}
 			else
 			{
@@ -662,6 +889,9 @@ namespace lyrics
 			canProgress &= node->block->Accept(*this);
 		}
 
+		StaticTypeChecker::Join(exit, mFrames.back().environment);
+		mFrames.back().environment = exit;
+
 		return canProgress;
 	}
 
@@ -671,7 +901,7 @@ namespace lyrics
 
 		if (node->condition)
 		{
-			canProgress &= node->condition->Accept(*this);
+			canProgress &= Infer(node->condition);
 		}
 		else
 		{
@@ -693,10 +923,13 @@ namespace lyrics
 	bool StaticTypeChecker::Visit(const CaseNode * const node)
 	{
 		bool canProgress = true;
+		Environment exit;
+
+		exit.isReachable = false;
 
 		if (node->value)
 		{
-			canProgress &= node->value->Accept(*this);
+			canProgress &= Infer(node->value);
 		}
 		else
 		{
@@ -707,7 +940,28 @@ namespace lyrics
 		{
 			if (i)
 			{
-				canProgress &= i->Accept(*this);
+				if (i->condition)
+				{
+					canProgress &= Infer(i->condition);
+				}
+				else
+				{
+					canProgress = false;
+				}
+
+				const Environment otherwise = mFrames.back().environment;
+
+				if (i->block)
+				{
+					canProgress &= i->block->Accept(*this);
+				}
+				else
+				{
+					canProgress = false;
+				}
+
+				StaticTypeChecker::Join(exit, mFrames.back().environment);
+				mFrames.back().environment = otherwise;
 			}
 			else
 			{
@@ -720,6 +974,9 @@ namespace lyrics
 			canProgress &= node->block->Accept(*this);
 		}
 
+		StaticTypeChecker::Join(exit, mFrames.back().environment);
+		mFrames.back().environment = exit;
+
 		return canProgress;
 	}
 
@@ -729,7 +986,7 @@ namespace lyrics
 
 		if (node->condition)
 		{
-			canProgress &= node->condition->Accept(*this);
+			canProgress &= Infer(node->condition);
 		}
 		else
 		{
@@ -752,113 +1009,357 @@ namespace lyrics
 	{
 		bool canProgress = true;
 
-		if (node->condition)
+		if (!node->condition)
+		{
+			canProgress = false;
+		}
+
+		canProgress &= Iterate(node->condition, node->block, nullptr, nullptr);
+
+		return canProgress;
+	}
+
+	bool StaticTypeChecker::Visit(const ForNode * const node)
+	{
+		bool canProgress = true;
+
+		if (node->initializer)
 		{
-			canProgress &= node->condition->Accept(*this);
+			canProgress &= Infer(node->initializer);
 		}
 		else
 		{
 			canProgress = false;
 		}
 
-		if (node->block)
+		if (!node->condition || !node->iterator)
 		{
-			canProgress &= node->block->Accept(*this);
+			canProgress = false;
+		}
+
+		canProgress &= Iterate(node->condition, node->block, node->iterator, nullptr);
+
+		return canProgress;
+	}
+
+	bool StaticTypeChecker::Visit(const ForEachNode * const node)
+	{
+		bool canProgress = true;
+
+		if (node->collection)
+		{
+			canProgress &= Infer(node->collection);
 		}
 		else
 		{
 			canProgress = false;
 		}
 
+		if (!node->variable)
+		{
+			canProgress = false;
+		}
+
+		canProgress &= Iterate(nullptr, node->block, nullptr, node->variable);
+
 		return canProgress;
 	}
 
-	bool StaticTypeChecker::Visit(const ForNode * const node)
+	bool StaticTypeChecker::Visit(const ReturnNode * const node)
 	{
 		bool canProgress = true;
 
-		if (node->initializer)
+		if (node->value)
 		{
-			canProgress &= node->initializer->Accept(*this);
+			canProgress &= Infer(node->value);
 		}
-		else
+
+		mFrames.back().environment.isReachable = false;
+
+		return canProgress;
+	}
+
+	// Of any type, as nothing is known of what the statement assigned.
+	bool StaticTypeChecker::Visit(const ErrorNode * const node)
+	{
+		if (node->name)
 		{
-			canProgress = false;
+			const u32string * const identifier = node->name->identifier;
+			bool isDeclared = false;
+
+			for (auto &i : mFrames)
+			{
+				isDeclared |= i.variables.count(*identifier) != 0;
+			}
+
+			if (!isDeclared)
+			{
+				mFrames.back().variables.insert(*identifier);
+			}
+
+			Assign(*identifier, StaticTypeChecker::ANY);
 		}
 
-		if (node->condition)
+		return false;
+	}
+
+	bool StaticTypeChecker::Infer(const ExpressionNode * const node)
+	{
+		bool canProgress = true;
+
+		switch (node->type)
 		{
-			canProgress &= node->condition->Accept(*this);
+		case Node::Type::NULL_LITERAL:
+			mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::NULL_LITERAL);
+			break;
+
+		case Node::Type::BOOLEAN_LITERAL:
+			mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::BOOLEAN);
+			break;
+
+		case Node::Type::INTEGER_LITERAL:
+			mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::INTEGER);
+			break;
+
+		case Node::Type::REAL_LITERAL:
+			mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::REAL);
+			break;
+
+		case Node::Type::STRING_LITERAL:
+			mTypeSet = StaticTypeChecker::TypeOf(Literal::Type::STRING);
+			break;
+
+		case Node::Type::THIS:
+			mTypeSet = StaticTypeChecker::ANY;
+			break;
+
+		default:
+			canProgress = node->Accept(*this);
+			break;
 		}
-		else
+
+		(*mTypeTable)[node] = mTypeSet;
+
+		return canProgress;
+	}
+
+	// The loop body is inferred again until the types at the head of the loop stop growing.
+	bool StaticTypeChecker::Iterate(const ExpressionNode * const condition, const BlockNode * const block, const ExpressionNode * const iterator, const ExpressionNode * const variable)
+	{
+		bool canProgress = true;
+		const Environment entry = mFrames.back().environment;
+		Environment head = entry;
+
+		for (;;)
 		{
-			canProgress = false;
+			mFrames.back().environment = head;
+			mFrames.back().loops.emplace_back();
+
+			if (condition)
+			{
+				canProgress &= Infer(condition);
+			}
+
+			Environment exit = mFrames.back().environment;
+
+			if (variable)
+			{
+				if (variable->type == Node::Type::IDENTIFIER)
+				{
+					Assign(*static_cast<const IdentifierNode *>(variable)->identifier, StaticTypeChecker::ANY);
+				}
+				else
+				{
+					canProgress &= Infer(variable);
+				}
+			}
+
+			if (block)
+			{
+				canProgress &= block->Accept(*this);
+			}
+			else
+			{
+				canProgress = false;
+			}
+
+			const Loop loop = mFrames.back().loops.back();
+
+			mFrames.back().loops.pop_back();
+
+			StaticTypeChecker::Join(mFrames.back().environment, loop.nexts);
+
+			if (iterator)
+			{
+				canProgress &= Infer(iterator);
+			}
+
+			StaticTypeChecker::Join(exit, loop.breaks);
+
+			Environment next = entry;
+
+			StaticTypeChecker::Join(next, mFrames.back().environment);
+
+			if (StaticTypeChecker::IsEqual(next, head))
+			{
+				mFrames.back().environment = exit;
+				break;
+			}
+
+			head = next;
 		}
 
-		if (node->iterator)
+		return canProgress;
+	}
+
+	void StaticTypeChecker::Assign(const u32string &identifier, const TypeSet typeSet)
+	{
+		for (auto i = mFrames.rbegin(); i != mFrames.rend(); i++)
 		{
-			canProgress &= node->iterator->Accept(*this);
+			if (i->variables.count(identifier))
+			{
+				if (i != mFrames.rbegin())
+				{
+					mClobbered.insert(identifier);
+				}
+				else if (i->environment.isReachable)
+				{
+					i->environment.types[identifier] = typeSet;
+				}
+
+				return;
+			}
 		}
-		else
+
+		mFrames.back().variables.insert(identifier);
+
+		if (mFrames.back().environment.isReachable)
 		{
-			canProgress = false;
+			mFrames.back().environment.types[identifier] = typeSet;
 		}
+	}
 
-		if (node->block)
+	// A call may run a function that assigns to a variable of this frame, or write back to an output argument.
+	void StaticTypeChecker::Clobber(const forward_list<ExpressionNode *> &arguments)
+	{
+		Environment &environment = mFrames.back().environment;
+
+		if (!environment.isReachable)
 		{
-			canProgress &= node->block->Accept(*this);
+			return;
 		}
-		else
+
+		for (auto &i : environment.types)
 		{
-			canProgress = false;
+			if (mClobbered.count(i.first))
+			{
+				i.second = StaticTypeChecker::ANY;
+			}
 		}
 
-		return canProgress;
+		for (auto i : arguments)
+		{
+			if (i && i->type == Node::Type::IDENTIFIER)
+			{
+				const u32string * const identifier = static_cast<const IdentifierNode *>(i)->identifier;
+
+				if (mFrames.back().variables.count(*identifier))
+				{
+					environment.types[*identifier] = StaticTypeChecker::ANY;
+				}
+			}
+		}
 	}
 
-	bool StaticTypeChecker::Visit(const ForEachNode * const node)
+	StaticTypeChecker::TypeSet StaticTypeChecker::Arithmetic(const Token::Type op, const TypeSet left, const TypeSet right)
 	{
-		bool canProgress = true;
+		const TypeSet integer = StaticTypeChecker::TypeOf(Literal::Type::INTEGER);
+		const TypeSet real = StaticTypeChecker::TypeOf(Literal::Type::REAL);
+		const TypeSet string = StaticTypeChecker::TypeOf(Literal::Type::STRING);
+		const TypeSet number = integer | real;
 
-		if (node->variable)
+		if (left == StaticTypeChecker::NONE || right == StaticTypeChecker::NONE)
 		{
-			canProgress &= node->variable->Accept(*this);
+			return StaticTypeChecker::NONE;
 		}
-		else
+
+		if ((left | right) & ~(op == static_cast<Token::Type>(U'+') ? number | string : number))
 		{
-			canProgress = false;
+			return StaticTypeChecker::ANY;
 		}
 
-		if (node->collection)
+		if (((left & string) && (right & number)) || ((left & number) && (right & string)))
 		{
-			canProgress &= node->collection->Accept(*this);
+			return StaticTypeChecker::ANY;
 		}
-		else
+
+		TypeSet result = StaticTypeChecker::NONE;
+
+		if ((left & integer) && (right & integer))
 		{
-			canProgress = false;
+			result |= integer;
 		}
 
-		if (node->block)
+		if (((left & real) && (right & number)) || ((left & number) && (right & real)))
 		{
-			canProgress &= node->block->Accept(*this);
+			result |= real;
 		}
-		else
+
+		if ((left & string) && (right & string))
 		{
-			canProgress = false;
+			result |= string;
 		}
 
-		return canProgress;
+		return result;
 	}
 
-	bool StaticTypeChecker::Visit(const ReturnNode * const node)
+	StaticTypeChecker::TypeSet StaticTypeChecker::Bitwise(const TypeSet left, const TypeSet right)
 	{
-		bool canProgress = true;
+		if (left == StaticTypeChecker::NONE || right == StaticTypeChecker::NONE)
+		{
+			return StaticTypeChecker::NONE;
+		}
 
-		if (node->value)
+		if (StaticTypeChecker::IsOnly(left, Literal::Type::INTEGER) && StaticTypeChecker::IsOnly(right, Literal::Type::INTEGER))
 		{
-			node->value->Accept(*this);
+			return StaticTypeChecker::TypeOf(Literal::Type::INTEGER);
 		}
 
-		return canProgress;
+		return StaticTypeChecker::ANY;
+	}
+
+	// A variable missing on one side was not assigned on that path yet, so it may still be null.
+	void StaticTypeChecker::Join(Environment &environment, const Environment &other)
+	{
+		if (!other.isReachable)
+		{
+			return;
+		}
+
+		if (!environment.isReachable)
+		{
+			environment = other;
+			return;
+		}
+
+		for (auto &i : environment.types)
+		{
+			auto type = other.types.find(i.first);
+
+			i.second |= type != other.types.cend() ? type->second : StaticTypeChecker::TypeOf(Literal::Type::NULL_LITERAL);
+		}
+
+		for (auto &i : other.types)
+		{
+			if (!environment.types.count(i.first))
+			{
+				environment.types[i.first] = i.second | StaticTypeChecker::TypeOf(Literal::Type::NULL_LITERAL);
+			}
+		}
+	}
+
+	bool StaticTypeChecker::IsEqual(const Environment &left, const Environment &right)
+	{
+		return left.isReachable == right.isReachable && (!left.isReachable || left.types == right.types);
 	}
 }
\ No newline at end of file
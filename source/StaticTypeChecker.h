@@ -1,15 +1,46 @@
 #ifndef STATIC_TYPE_CHECKER
 #define STATIC_TYPE_CHECKER
 
+#include <string>
+#include <vector>
+#include <forward_list>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "Visitor.h"
 #include "Node.h"
+#include "Literal.h"
 
 namespace lyrics
 {
+	using std::u32string;
+	using std::vector;
+	using std::forward_list;
+	using std::unordered_map;
+	using std::unordered_set;
+
+	// Flow sensitive inference of the literal types each expression can evaluate to.
 	class StaticTypeChecker : public Visitor
 	{
 	public:
-		bool Check(const BlockNode * const node);
+		// One bit per Literal::Type.
+		typedef unsigned int TypeSet;
+		typedef unordered_map<const ExpressionNode *, TypeSet> TypeTable;
+
+		static constexpr TypeSet NONE = 0u;
+		static constexpr TypeSet ANY = ~0u;
+
+		static constexpr TypeSet TypeOf(const Literal::Type type)
+		{
+			return 1u << static_cast<unsigned int>(type);
+		}
+
+		static constexpr bool IsOnly(const TypeSet typeSet, const Literal::Type type)
+		{
+			return (typeSet & ~StaticTypeChecker::TypeOf(type)) == 0u;
+		}
+
+		bool Check(const BlockNode * const node, TypeTable &typeTable);
 		virtual bool Visit(const BlockNode * const node);
 		virtual bool Visit(const IdentifierNode * const node);
 		virtual bool Visit(const ArrayLiteralNode * const node);
@@ -46,6 +77,58 @@ namespace lyrics
 		virtual bool Visit(const ForNode * const node);
 		virtual bool Visit(const ForEachNode * const node);
 		virtual bool Visit(const ReturnNode * const node);
+		virtual bool Visit(const ErrorNode * const node);
+
+	private:
+		struct Environment
+		{
+			Environment() : isReachable(true)
+			{
+			}
+
+			unordered_map<u32string, TypeSet> types;
+			bool isReachable;
+		};
+
+		struct Loop
+		{
+			Loop()
+			{
+				breaks.isReachable = false;
+				nexts.isReachable = false;
+			}
+
+			Environment breaks;
+			Environment nexts;
+		};
+
+		// Scope of a function, a class or a package, resolved the same way as LocalResolver does.
+		struct Frame
+		{
+			Frame() : isObject(false)
+			{
+			}
+
+			unordered_set<u32string> variables;
+			bool isObject;	// Of a class or a package, whose variables are members that any holder of the object can store to.
+			Environment environment;
+			vector<Loop> loops;
+		};
+
+		bool Infer(const ExpressionNode * const node);
+		bool Iterate(const ExpressionNode * const condition, const BlockNode * const block, const ExpressionNode * const iterator, const ExpressionNode * const variable);
+		void Assign(const u32string &identifier, const TypeSet typeSet);
+		void Clobber(const forward_list<ExpressionNode *> &arguments);
+		static TypeSet Arithmetic(const Token::Type op, const TypeSet left, const TypeSet right);
+		static TypeSet Bitwise(const TypeSet left, const TypeSet right);
+
+		static void Join(Environment &environment, const Environment &other);
+		static bool IsEqual(const Environment &left, const Environment &right);
+
+		TypeTable *mTypeTable;
+		vector<Frame> mFrames;
+		unordered_set<u32string> mClobbered;	// Variables assigned from a nested function, which a call may change.
+		TypeSet mTypeSet;
 	};
 }
 
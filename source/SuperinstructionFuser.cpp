@@ -0,0 +1,206 @@
+#include "SuperinstructionFuser.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace lyrics
+{
+	// By how often the runs were found in the code generated for sample scripts, most often first. A longer run goes before a shorter one it starts with.
+	const SuperinstructionFuser::Fusion SuperinstructionFuser::FUSIONS[] =
+	{
+		{ ByteCode::Opcode::STORE_WORD_IMMEDIATE, 2, { ByteCode::Opcode::LOAD_WORD_IMMEDIATE, ByteCode::Opcode::STORE_WORD } },
+		{ ByteCode::Opcode::RETURN_REGISTER, 2, { ByteCode::Opcode::MOVE, ByteCode::Opcode::RETURN } },
+		{ ByteCode::Opcode::RETURN_CONSTANT, 2, { ByteCode::Opcode::LOAD_CONSTANT, ByteCode::Opcode::RETURN } },
+		{ ByteCode::Opcode::ADD_IMMEDIATE_WORD, 3, { ByteCode::Opcode::LOAD_WORD, ByteCode::Opcode::ADD_IMMEDIATE, ByteCode::Opcode::STORE_WORD } },
+		{ ByteCode::Opcode::BRANCH_IF_LESS_THAN_IMMEDIATE, 2, { ByteCode::Opcode::LOAD_WORD_IMMEDIATE, ByteCode::Opcode::BRANCH_IF_LESS_THAN } },
+		{ ByteCode::Opcode::BRANCH_ON_EQUAL_IMMEDIATE, 2, { ByteCode::Opcode::LOAD_WORD_IMMEDIATE, ByteCode::Opcode::BRANCH_ON_EQUAL } },
+		{ ByteCode::Opcode::BRANCH_ON_NOT_EQUAL_IMMEDIATE, 2, { ByteCode::Opcode::LOAD_WORD_IMMEDIATE, ByteCode::Opcode::BRANCH_ON_NOT_EQUAL } },
+		{ ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL_IMMEDIATE, 2, { ByteCode::Opcode::LOAD_WORD_IMMEDIATE, ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL } },
+		{ ByteCode::Opcode::BRANCH_IF_GREATER_THAN_IMMEDIATE, 2, { ByteCode::Opcode::LOAD_WORD_IMMEDIATE, ByteCode::Opcode::BRANCH_IF_GREATER_THAN } },
+		{ ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL_IMMEDIATE, 2, { ByteCode::Opcode::LOAD_WORD_IMMEDIATE, ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL } },
+	};
+
+	const size_t SuperinstructionFuser::FUSION_COUNT = sizeof(FUSIONS) / sizeof(FUSIONS[0]);
+
+	void SuperinstructionFuser::Run(IR &ir)
+	{
+		for (auto i : ir.blocks)
+		{
+			const vector<IR::Instruction *> instructions = i->instructions;
+			vector<IR::Instruction *> fused;
+
+			for (size_t j = 0; j < instructions.size();)
+			{
+				size_t length = 1;
+
+				for (size_t k = 0; k < FUSION_COUNT; k++)
+				{
+					if (Fuse(FUSIONS[k], instructions, j))
+					{
+						length = FUSIONS[k].length;
+						break;
+					}
+				}
+
+				fused.push_back(instructions[j + length - 1]);
+				j += length;
+			}
+
+			i->instructions.swap(fused);
+		}
+	}
+
+	// The last instruction of the run becomes the superinstruction, reading what the run read from outside of it.
+	bool SuperinstructionFuser::Fuse(const Fusion &fusion, const vector<IR::Instruction *> &instructions, const size_t index)
+	{
+		if (index + fusion.length > instructions.size())
+		{
+			return false;
+		}
+
+		const vector<IR::Instruction *> run(instructions.begin() + index, instructions.begin() + index + fusion.length);
+
+		for (size_t i = 0; i < run.size(); i++)
+		{
+			if (run[i]->code.opcode != fusion.opcodes[i])
+			{
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i + 1 < run.size(); i++)
+		{
+			for (auto j : run[i]->results)
+			{
+				for (auto k : j->uses)
+				{
+					if (std::find(run.begin() + i + 1, run.end(), k) == run.end())
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		ByteCode code(fusion.superinstruction);
+
+		if (!Encode(fusion, run, code))
+		{
+			return false;
+		}
+
+		IR::Instruction * const superinstruction = run.back();
+		vector<IR::Value *> operands;
+		vector<IR::Field> fields;
+		bool hasSideEffect = false;
+
+		for (auto i : run)
+		{
+			for (auto j : i->operands)
+			{
+				IR::RemoveUse(j, i);
+			}
+
+			for (size_t j = 0; j < i->operands.size(); j++)
+			{
+				if (std::find(run.begin(), run.end(), i->operands[j]->definition) == run.end())
+				{
+					operands.push_back(i->operands[j]);
+					fields.push_back(i->fields[j] == IR::Field::IMPLICIT ? IR::Field::IMPLICIT : IR::Field::OPERAND16);	// A superinstruction reads its register from operand16.
+				}
+			}
+
+			hasSideEffect = hasSideEffect || i->hasSideEffect;
+
+			i->operands.clear();
+			i->fields.clear();
+		}
+
+		for (auto i : operands)
+		{
+			IR::AddUse(i, superinstruction);
+		}
+
+		superinstruction->code = code;
+		superinstruction->operands.swap(operands);
+		superinstruction->fields.swap(fields);
+		superinstruction->hasSideEffect = hasSideEffect;
+
+		return true;
+	}
+
+	// The operands of the run have to fit into a single ByteCode, and chain through the register each instruction writes.
+	bool SuperinstructionFuser::Encode(const Fusion &fusion, const vector<IR::Instruction *> &run, ByteCode &code) const
+	{
+		const ByteCode &first = run.front()->code;
+		const ByteCode &last = run.back()->code;
+		const short v0 = static_cast<short>(Register::V0);
+
+		switch (fusion.superinstruction)
+		{
+		case ByteCode::Opcode::STORE_WORD_IMMEDIATE:
+			if (last.operand16 != first.operand16 || !IsShort(first.operand32))
+			{
+				return false;
+			}
+
+			code = ByteCode(fusion.superinstruction, static_cast<short>(first.operand32), last.operand32);
+			return true;
+
+		case ByteCode::Opcode::ADD_IMMEDIATE_WORD:
+		{
+			const ByteCode &add = run[1]->code;
+			const short rd = first.operand16;
+
+			if (add.operand16 != rd || static_cast<short>(add.operand32 >> 16) != rd || last.operand16 != rd || last.operand32 != first.operand32)
+			{
+				return false;
+			}
+
+			code = ByteCode(fusion.superinstruction, static_cast<short>(add.operand32 & 0xFFFF), first.operand32);
+			return true;
+		}
+
+		case ByteCode::Opcode::BRANCH_ON_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_ON_NOT_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_LESS_THAN_OR_EQUAL_IMMEDIATE:
+		case ByteCode::Opcode::BRANCH_IF_GREATER_THAN_OR_EQUAL_IMMEDIATE:
+			if (static_cast<short>(last.operand32 >> 16) != first.operand16 || last.operand16 == first.operand16 || !IsShort(first.operand32))
+			{
+				return false;
+			}
+
+			code = ByteCode(fusion.superinstruction, last.operand16, static_cast<short>(first.operand32), static_cast<short>(last.operand32 & 0xFFFF));
+			return true;
+
+		case ByteCode::Opcode::RETURN_REGISTER:
+			if (first.operand16 != v0)
+			{
+				return false;
+			}
+
+			code = ByteCode(fusion.superinstruction, static_cast<short>(first.operand32 >> 16));
+			return true;
+
+		case ByteCode::Opcode::RETURN_CONSTANT:
+			if (first.operand16 != v0)
+			{
+				return false;
+			}
+
+			code = ByteCode(fusion.superinstruction, 0, first.operand32);
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	// The immediate a superinstruction takes in place of the word LOAD_WORD_IMMEDIATE loads is only 16 bits.
+	bool SuperinstructionFuser::IsShort(const long integer)
+	{
+		return integer >= SHRT_MIN && integer <= SHRT_MAX;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef SUPERINSTRUCTION_FUSER
+#define SUPERINSTRUCTION_FUSER
+
+#include <cstddef>
+#include <vector>
+
+#include "ByteCode.h"
+#include "Pass.h"
+#include "IR.h"
+
+namespace lyrics
+{
+	using std::size_t;
+	using std::vector;
+
+	// Fuses runs of instructions into the superinstruction doing what they did, so that each run is dispatched once.
+	// A run is only fused where nothing after it reads the registers written in between.
+	class SuperinstructionFuser : public Pass
+	{
+	public:
+		virtual void Run(IR &ir);
+
+	private:
+		struct Fusion
+		{
+			ByteCode::Opcode superinstruction;
+			size_t length;
+			ByteCode::Opcode opcodes[3];
+		};
+
+		static const Fusion FUSIONS[];
+		static const size_t FUSION_COUNT;
+
+		static bool IsShort(const long integer);
+
+		bool Fuse(const Fusion &fusion, const vector<IR::Instruction *> &instructions, const size_t index);
+		bool Encode(const Fusion &fusion, const vector<IR::Instruction *> &run, ByteCode &code) const;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -182,4 +182,92 @@ namespace lyrics
 
 		return tStr;
 	}
+
+	// Of text that is not a file, so without a byte order mark. A sequence cut short or out of place is taken for U+FFFD.
+	u32string TextEncoder::DecodeUTF_8(const string &text) const
+	{
+		using std::size_t;
+
+		u32string decoded;
+
+		decoded.reserve(text.size());
+
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			const unsigned char first = static_cast<unsigned char>(text[i]);
+			unsigned int length;
+			char32_t c;
+
+			if (first < 0x80u)
+			{
+				decoded += first;
+				continue;
+			}
+			else if (first >= 0xF0u && first < 0xF8u)
+			{
+				length = 3;
+				c = first & 7u;
+			}
+			else if (first >= 0xE0u)
+			{
+				length = first < 0xF0u ? 2 : 0;
+				c = first & 15u;
+			}
+			else if (first >= 0xC0u)
+			{
+				length = 1;
+				c = first & 31u;
+			}
+			else
+			{
+				length = 0;
+				c = 0;
+			}
+
+			unsigned int j = 0;
+
+			while (j < length && i + 1 < text.size() && (static_cast<unsigned char>(text[i + 1]) & 0xC0u) == 0x80u)
+			{
+				c = c << 6 | (static_cast<unsigned char>(text[++i]) & 0x3Fu);
+				j++;
+			}
+
+			decoded += length != 0 && j == length ? c : U'\xFFFD';
+		}
+
+		return decoded;
+	}
+
+	string TextEncoder::EncodeUTF_8(const u32string &text) const
+	{
+		string encoded;
+
+		for (auto i : text)
+		{
+			if (i < 0x80u)
+			{
+				encoded += static_cast<char>(i);
+			}
+			else if (i < 0x800u)
+			{
+				encoded += static_cast<char>(0xC0u | (i >> 6));
+				encoded += static_cast<char>(0x80u | (i & 0x3Fu));
+			}
+			else if (i < 0x10000u)
+			{
+				encoded += static_cast<char>(0xE0u | (i >> 12));
+				encoded += static_cast<char>(0x80u | ((i >> 6) & 0x3Fu));
+				encoded += static_cast<char>(0x80u | (i & 0x3Fu));
+			}
+			else
+			{
+				encoded += static_cast<char>(0xF0u | (i >> 18));
+				encoded += static_cast<char>(0x80u | ((i >> 12) & 0x3Fu));
+				encoded += static_cast<char>(0x80u | ((i >> 6) & 0x3Fu));
+				encoded += static_cast<char>(0x80u | (i & 0x3Fu));
+			}
+		}
+
+		return encoded;
+	}
 }
\ No newline at end of file
@@ -1,12 +1,19 @@
 #ifndef TEXT_ENCODER
 #define TEXT_ENCODER
 
+#include <string>
+
 namespace lyrics
 {
+	using std::string;
+	using std::u32string;
+
 	class TextEncoder
 	{
 	public:
 		char32_t *DecodeUnicode(const unsigned char * const data, const unsigned int size, unsigned int &length);
+		u32string DecodeUTF_8(const string &text) const;
+		string EncodeUTF_8(const u32string &text) const;
 
 	private:
 		static const unsigned int SIZE_UTF_8_BOM = 3;
@@ -12,8 +12,6 @@ namespace lyrics
 {
 	char32_t *TextLoader::Load(const string &name, unsigned int &length)
 	{
-		using std::bad_alloc;
-
 		char *data = nullptr;
 		unsigned int size = 0;
 
@@ -23,15 +21,29 @@ namespace lyrics
 
 		try
 		{
-			text = TextEncoder().DecodeUnicode((const unsigned char * const)data, size, length);
+			text = Decode(data, size, length);
 		}
-		catch (const bad_alloc &e)
+		catch (const FatalErrorCode fatalErrorCode)
 		{
 			Utility::SafeArrayDelete(data);
-			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+			throw fatalErrorCode;
 		}
 
 		Utility::SafeArrayDelete(data);
 		return text;
 	}
+
+	char32_t *TextLoader::Decode(const char * const data, const unsigned int size, unsigned int &length) const
+	{
+		using std::bad_alloc;
+
+		try
+		{
+			return TextEncoder().DecodeUnicode((const unsigned char * const)data, size, length);
+		}
+		catch (const bad_alloc &e)
+		{
+			throw FatalErrorCode::NOT_ENOUGH_MEMORY;
+		}
+	}
 }
\ No newline at end of file
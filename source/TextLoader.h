@@ -13,6 +13,7 @@ namespace lyrics
 	{
 	public:
 		char32_t *Load(const string &name, unsigned int &length);
+		char32_t *Decode(const char * const data, const unsigned int size, unsigned int &length) const;	// Of the bytes Loader::Load read, which are left to the caller.
 	};
 }
 
@@ -15,7 +15,7 @@ namespace lyrics
 		{
 			END_OF_FILE,
 
-			CHAR40 = 40, CHAR91 = 91, CHAR123 = 123,
+			CHAR33 = 33, CHAR37 = 37, CHAR38 = 38, CHAR40 = 40, CHAR42 = 42, CHAR43 = 43, CHAR45 = 45, CHAR47 = 47, CHAR60 = 60, CHAR62 = 62, CHAR91 = 91, CHAR94 = 94, CHAR123 = 123, CHAR124 = 124, CHAR126 = 126,
 
 			BREAK = 256, CASE, CLASS, DO, END, ELSE, ELSEIF, FOR, FOREACH, IF, IMPORT, IN, INCLUDE, NEXT, OUT, PACKAGE, PRIVATE, PUBLIC, RETURN, THEN, THIS, WHEN, WHILE,
 			SHIFT_LEFT, SHIFT_RIGHT, LESS_THAN_OR_EQUAL, GREATER_THAN_OR_EQUAL, EQUAL, NOT_EQUAL, AND, OR,
@@ -32,38 +32,39 @@ namespace lyrics
 			u32string *identifier;
 		};
 
-		Token(const Type type, const Location &location) : type(type), location(location)
+		Token(const Type type, const Location &location) : type(type), location(location), offset(0)
 		{
 		}
 
-		Token(const bool boolean, const Location &location) : type(Type::BOOLEAN_LITERAL), location(location)
+		Token(const bool boolean, const Location &location) : type(Type::BOOLEAN_LITERAL), location(location), offset(0)
 		{
 			value.boolean = boolean;
 		}
 
-		Token(const long long integer, const Location &location) : type(Type::INTEGER_LITERAL), location(location)
+		Token(const long long integer, const Location &location) : type(Type::INTEGER_LITERAL), location(location), offset(0)
 		{
 			value.integer = integer;
 		}
 
-		Token(const double real, const Location &location) : type(Type::REAL_LITERAL), location(location)
+		Token(const double real, const Location &location) : type(Type::REAL_LITERAL), location(location), offset(0)
 		{
 			value.real = real;
 		}
 
-		Token(u32string * const string, const Location &location) : type(Type::STRING_LITERAL), location(location)
+		Token(u32string * const string, const Location &location) : type(Type::STRING_LITERAL), location(location), offset(0)
 		{
 			value.string = string;
 		}
 
-		Token(const Type type, u32string * const identifier, const Location &location) : type(type), location(location)
+		Token(const Type type, u32string * const identifier, const Location &location) : type(type), location(location), offset(0)
 		{
 			value.identifier = identifier;
 		}
 
 		const Type type;
 		Value value;
-		const Location location;
+		Location location;
+		unsigned int offset;	// Of its first character in the text.
 	};
 }
 
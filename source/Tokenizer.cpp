@@ -47,15 +47,13 @@ namespace lyrics
 		forward_list<Token> *tokenList = new forward_list<Token>();
 		Location currentLocation(fileName);
 
-		mText = text;
-		mTextLength = textLength;
-		mOffset = 0;
-		mLastToken = tokenList->cbefore_begin();
+		Start(text, textLength, 0, tokenList->before_begin());
 
 		try
 		{
-			while (TokenizeUnicode(tokenList, currentLocation));
+			while (Next(tokenList, currentLocation));
 			mLastToken = tokenList->emplace_after(mLastToken, Token::Type::END_OF_FILE, currentLocation);
+			mLastToken->offset = mOffset;
 		}
 		catch (const bad_alloc &e)
 		{
@@ -66,11 +64,35 @@ namespace lyrics
 		return tokenList;
 	}
 
+	void Tokenizer::Start(const char32_t * const text, const unsigned int textLength, const unsigned int offset, const forward_list<Token>::iterator lastToken)
+	{
+		mText = text;
+		mTextLength = textLength;
+		mOffset = offset;
+		mLastToken = lastToken;
+	}
+
+	// One token at most, after the last one, with where it starts.
+	bool Tokenizer::Next(forward_list<Token> *tokenList, Location &currentLocation)
+	{
+		const forward_list<Token>::iterator lastToken = mLastToken;
+		const bool isLeft = TokenizeUnicode(tokenList, currentLocation);
+
+		if (mLastToken != lastToken)
+		{
+			mLastToken->offset = mTokenOffset;
+		}
+
+		return isLeft;
+	}
+
 	// TODO: mTextLength is byte of mText, not number of characters.
 	bool Tokenizer::TokenizeUnicode(forward_list<Token> *tokenList, Location &currentLocation)
 	{
 		char32_t tChar;
 
+		mTokenOffset = mOffset;	// Until the spaces before the token are skipped.
+
 		if (mOffset < mTextLength)
 		{
 			tChar = mText[mOffset];
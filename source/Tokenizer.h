@@ -17,6 +17,8 @@ namespace lyrics
 	{
 	public:
 		forward_list<Token> *Tokenize(const string &fileName, const char32_t * const text, const unsigned int textLength);
+		void Start(const char32_t * const text, const unsigned int textLength, const unsigned int offset, const forward_list<Token>::iterator lastToken);	// From the offset on, after the token given, for a text tokenized before and edited since.
+		bool Next(forward_list<Token> *tokenList, Location &currentLocation);	// False once the text is over.
 		bool TokenizeUnicode(forward_list<Token> *tokenList, Location &currentLocation);
 
 	private:
@@ -77,8 +79,9 @@ namespace lyrics
 		const char32_t *mText;
 		unsigned int mTextLength;
 		unsigned int mOffset;
+		unsigned int mTokenOffset;
 
-		forward_list<Token>::const_iterator mLastToken;
+		forward_list<Token>::iterator mLastToken;
 	};
 }
 
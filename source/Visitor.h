@@ -43,6 +43,7 @@ namespace lyrics
 		class ForNode;
 		class ForEachNode;
 		class ReturnNode;
+		class ErrorNode;
 
 	class Visitor
 	{
@@ -86,6 +87,7 @@ namespace lyrics
 		virtual bool Visit(const ForNode * const node) = 0;
 		virtual bool Visit(const ForEachNode * const node) = 0;
 		virtual bool Visit(const ReturnNode * const node) = 0;
+		virtual bool Visit(const ErrorNode * const node) = 0;
 
 		constexpr bool Visit() const
 		{
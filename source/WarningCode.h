@@ -6,6 +6,8 @@ namespace lyrics
 	enum class WarningCode: unsigned int
 	{
 		UNKNOWN_ESCAPE_SEQUENCE = 2001,
+
+		UNRESOLVED_IMPORT = 6001,
 	};
 }
 